@@ -0,0 +1,204 @@
+#include "ADC_Pipeline.h"
+#include <string.h>
+#include <math.h>
+
+/**
+ * Initialize the pipeline
+ * nb_clamp : number of clamp channels
+ * zero : the adc value of the zero current for each clamp
+ * period : the number of samples of a period (sampling frequency of a channel / 50 Hz)
+ */
+bool ADC_Pipeline_Init(ADC_Pipeline *pipe, uint8_t nb_clamp, const int16_t *zero, uint16_t period)
+{
+	const float SQRT2 = 1.41421356;
+	const float TwoPI = 6.28318531;
+
+	if ((nb_clamp == 0) || (nb_clamp > ADC_MAX_CLAMP) || (period < 8) || (period > ADC_PIPELINE_MAX_PERIOD))
+		return false;
+
+	// Not a memset : the Snapshot of the results is not a POD. The last result stays published.
+	pipe->nb_clamp = nb_clamp;
+	memset(pipe->zero, 0, sizeof(pipe->zero));
+	memcpy(pipe->zero, zero, nb_clamp * sizeof(int16_t));
+	pipe->period = period;
+	pipe->sample_index = 0;
+	pipe->period_start = 0;
+	pipe->synchronised = false;
+	pipe->first_top = false;
+	pipe->windows = 0;
+	memset(pipe->acc, 0, sizeof(pipe->acc));
+
+	// Reference sinus for a voltage of 1 V, with a margin if the period is a little longer
+	pipe->sinus_len = period + period / 8;
+	for (uint16_t i = 0; i < pipe->sinus_len; i++)
+		pipe->sinus[i] = (int16_t) (SQRT2 * sin(TwoPI * (float) i / (float) period) * ADC_PIPELINE_SINUS);
+	return true;
+}
+
+/**
+ * Multiply-accumulate over count samples of one clamp
+ * sinus is the reference at the phase of the first sample
+ * (sample - zero) is 13 bits, the products fit in 32 bits, the sums are 64 bits
+ */
+void ADC_MAC_Kernel(const int16_t *samples, uint16_t count, int16_t zero, const int16_t *sinus,
+		int64_t *square, int64_t *sinus_sum)
+{
+	int32_t sq = 0, sn = 0;
+	int64_t sq64 = 0, sn64 = 0;
+
+	// Partial sums in 32 bits : 64 * 4096² < 2^31
+	while (count > 0)
+	{
+		uint16_t n = (count > 64) ? 64 : count;
+		count -= n;
+		sq = 0;
+		sn = 0;
+		for (uint16_t i = 0; i < n; i++)
+		{
+			int32_t v = samples[i] - zero;
+			sq += v * v;
+			sn += v * sinus[i];
+		}
+		samples += n;
+		sinus += n;
+		sq64 += (uint32_t) sq;
+		sn64 += sn;
+	}
+	*square += sq64;
+	*sinus_sum += sn64;
+}
+
+/**
+ * Zero cross : end of the half period (see Compute_Mean_Wave())
+ * The sinus reference begins every two zero cross
+ */
+static void ADC_Pipeline_Top(ADC_Pipeline *pipe, uint32_t index)
+{
+	bool ended = false;
+	for (uint8_t c = 0; c < pipe->nb_clamp; c++)
+	{
+		ADC_Clamp_Acc *acc = &pipe->acc[c];
+		if (acc->count != 0)
+		{
+			acc->square_mean += acc->square / acc->count;
+			acc->sinus_mean += acc->sinus / (int32_t) acc->count;
+			ended = true;
+		}
+		acc->square = 0;
+		acc->sinus = 0;
+		acc->count = 0;
+	}
+	if (ended)
+		pipe->windows++;
+
+	// Publish the mean of ADC_PIPELINE_WINDOWS half periods
+	if (pipe->windows == ADC_PIPELINE_WINDOWS)
+	{
+		ADC_Pipeline_Results results = {};
+		for (uint8_t c = 0; c < pipe->nb_clamp; c++)
+		{
+			ADC_Clamp_Acc *acc = &pipe->acc[c];
+			results.clamp[c].current_raw = acc->square_mean / ADC_PIPELINE_WINDOWS;
+			results.clamp[c].power_raw = acc->sinus_mean / ADC_PIPELINE_WINDOWS;
+			acc->square_mean = 0;
+			acc->sinus_mean = 0;
+		}
+		pipe->results.Publish(results);
+		pipe->windows = 0;
+	}
+
+	if (!pipe->first_top)
+	{
+		// First 1/2 alternance
+		pipe->first_top = true;
+		pipe->period_start = index;
+		pipe->synchronised = true;
+	}
+	else
+		pipe->first_top = false;
+}
+
+/**
+ * The synchronisation with the zero cross is lost (zero cross or samples missing) :
+ * the half period in progress is dropped and the sinus reference begins again at the next zero cross.
+ * The half periods already averaged are kept.
+ */
+void ADC_Pipeline_Lost_Sync(ADC_Pipeline *pipe)
+{
+	for (uint8_t c = 0; c < pipe->nb_clamp; c++)
+	{
+		pipe->acc[c].square = 0;
+		pipe->acc[c].sinus = 0;
+		pipe->acc[c].count = 0;
+	}
+	pipe->synchronised = false;
+	pipe->first_top = false;
+}
+
+/**
+ * Accumulate the samples [from, to) of the frame
+ */
+static void ADC_Pipeline_Run(ADC_Pipeline *pipe, const int16_t *const*samples, uint16_t from, uint16_t to)
+{
+	while (from < to)
+	{
+		uint32_t phase = pipe->sample_index + from - pipe->period_start;
+		// No zero cross since more than a period : wait for the next one
+		if (phase >= pipe->sinus_len)
+		{
+			ADC_Pipeline_Lost_Sync(pipe);
+			return;
+		}
+		uint16_t n = to - from;
+		if (n > pipe->sinus_len - phase)
+			n = pipe->sinus_len - phase;
+		for (uint8_t c = 0; c < pipe->nb_clamp; c++)
+		{
+			ADC_MAC_Kernel(&samples[c][from], n, pipe->zero[c], &pipe->sinus[phase], &pipe->acc[c].square,
+					&pipe->acc[c].sinus);
+			pipe->acc[c].count += n;
+		}
+		from += n;
+	}
+}
+
+/**
+ * Process a frame of count samples for each clamp (samples[clamp][i])
+ * zc_index : the sample indexes of the zero cross in the frame, in increasing order.
+ * The index of the first sample of the frame is the number of samples already processed,
+ * a zero cross after the frame is ignored (give it with the next frame).
+ */
+void ADC_Pipeline_Process(ADC_Pipeline *pipe, const int16_t *const*samples, uint16_t count,
+		const uint32_t *zc_index, uint8_t zc_count)
+{
+	uint16_t from = 0;
+
+	for (uint8_t z = 0; z < zc_count; z++)
+	{
+		// The zero cross in the frame (a late one is taken at the beginning)
+		uint32_t to = (zc_index[z] > pipe->sample_index) ? zc_index[z] - pipe->sample_index : 0;
+		if (to > count)
+			break;
+		if (to < from)
+			to = from;
+		if (pipe->synchronised)
+			ADC_Pipeline_Run(pipe, samples, from, to);
+		ADC_Pipeline_Top(pipe, pipe->sample_index + to);
+		from = to;
+	}
+	if (pipe->synchronised)
+		ADC_Pipeline_Run(pipe, samples, from, count);
+	pipe->sample_index += count;
+}
+
+/**
+ * The last result published for a clamp, from any task
+ * return false if there is no result yet
+ */
+bool ADC_Pipeline_Get(const ADC_Pipeline *pipe, uint8_t clamp, ADC_Clamp_Result *result)
+{
+	if ((clamp >= pipe->nb_clamp) || (pipe->results.GetCount() == 0))
+		return false;
+	*result = pipe->results.Get().clamp[clamp];
+	return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * RMS current and power of the clamp channels (Talema) computed by frames
+ *
+ * The samples come by frames (DMA of the ADC in continuous mode), one array per clamp.
+ * The computation is done with integers only :
+ * - square : sum of (sample - zero)², the RMS current,
+ * - sinus : sum of (sample - zero) * sinus reference, the active power for a voltage of 1 V.
+ * The reference sinus is indexed by the number of samples since the zero cross that begins
+ * the period, so the synchronisation with the voltage is done by sample index : the zero cross
+ * are given as sample indexes with the frame (see ADC_Pipeline_Process()).
+ *
+ * Like Compute_Mean_Wave() of ADC_utils, the zero cross come every half period, the sums are
+ * divided by the number of samples at each zero cross and ADC_PIPELINE_WINDOWS half periods
+ * are averaged. The results of all the clamps are then published together with a Snapshot
+ * (seqlock and double buffer, see Snapshot.h) : the reader of any task always gets a complete
+ * result of one publication without lock.
+ *
+ * This part does not depend on the hardware (test on PC).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Snapshot.h"
+
+// Max number of clamp channels
+#ifndef ADC_MAX_CLAMP
+#define ADC_MAX_CLAMP	3
+#endif
+
+// Number of half periods averaged (like PERIOD_COUNT)
+#define ADC_PIPELINE_WINDOWS	5
+
+// Precision of the reference sinus (like SINUS_PRECISION)
+#define ADC_PIPELINE_SINUS	1000
+
+// Max number of samples of a period for the sinus reference
+#define ADC_PIPELINE_MAX_PERIOD	512
+
+typedef struct
+{
+		int32_t current_raw;  // Mean of (sample - zero)²
+		int32_t power_raw;    // Mean of (sample - zero) * sinus
+} ADC_Clamp_Result;
+
+// The results of all the clamps, published together
+typedef struct
+{
+		ADC_Clamp_Result clamp[ADC_MAX_CLAMP];
+} ADC_Pipeline_Results;
+
+typedef struct
+{
+		int64_t square;       // Sums of the current half period
+		int64_t sinus;
+		uint32_t count;
+		int64_t square_mean;  // Sum of the means of the half periods
+		int64_t sinus_mean;
+} ADC_Clamp_Acc;
+
+typedef struct
+{
+		uint8_t nb_clamp;
+		int16_t zero[ADC_MAX_CLAMP];
+		uint16_t period;          // Number of samples of a period
+		int16_t sinus[ADC_PIPELINE_MAX_PERIOD + ADC_PIPELINE_MAX_PERIOD / 8];
+		uint16_t sinus_len;
+
+		uint32_t sample_index;    // Index of the next sample
+		uint32_t period_start;    // Index of the zero cross that begins the period
+		bool synchronised;        // A zero cross has been seen
+		bool first_top;           // Same as ZC_First_Top of Compute_Mean_Wave()
+		uint8_t windows;
+
+		ADC_Clamp_Acc acc[ADC_MAX_CLAMP];
+		Snapshot<ADC_Pipeline_Results> results; // The last result published
+} ADC_Pipeline;
+
+bool ADC_Pipeline_Init(ADC_Pipeline *pipe, uint8_t nb_clamp, const int16_t *zero, uint16_t period);
+void ADC_Pipeline_Process(ADC_Pipeline *pipe, const int16_t *const*samples, uint16_t count,
+		const uint32_t *zc_index, uint8_t zc_count);
+void ADC_Pipeline_Lost_Sync(ADC_Pipeline *pipe);
+bool ADC_Pipeline_Get(const ADC_Pipeline *pipe, uint8_t clamp, ADC_Clamp_Result *result);
+
+void ADC_MAC_Kernel(const int16_t *samples, uint16_t count, int16_t zero, const int16_t *sinus,
+		int64_t *square, int64_t *sinus_sum);
@@ -14,6 +14,17 @@ adc_oneshot_unit_handle_t adc1_handle; // @suppress("Type cannot be resolved")
 adc_channel_t ADC_Channel[2];
 #endif
 
+#ifdef ADC_USE_DMA
+#include "soc/soc_caps.h"
+#include <esp_adc/adc_continuous.h>
+#include "esp_timer.h"
+#include "ADC_Pipeline.h"
+
+// The computation of the clamps
+static ADC_Pipeline Talema_Pipeline;
+static void ADC_Begin_DMA(int zero);
+#endif
+
 // IRAM_ATTR is necessary for timer or callback
 #ifdef ADC_USE_TASK
 #define ADC_INTO_IRAM
@@ -25,7 +36,8 @@ typedef enum
 {
 	adcUndef,
 	adcOnseShot,
-	adcContinuous
+	adcContinuous,
+	adcDMA
 } ADC_Status_typedef;
 
 ADC_Status_typedef ADC_Status = adcUndef;
@@ -367,6 +379,247 @@ bool ADC_Initialize_Continuous(std::initializer_list<uint8_t> gpios, ADC_Action_
 #endif
 }
 
+// ********************************************************************************
+// Continuous mode with DMA and frame computation
+// ********************************************************************************
+#ifdef ADC_USE_DMA
+/**
+ * The ADC DMA driver fills frames of ADC_DMA_FRAME conversions of all the channels.
+ * A worker task, woken by the end of frame callback, sorts the samples by channel and gives
+ * the clamp samples to the pipeline (see ADC_Pipeline.h) : no work per sample in interrupt,
+ * no critical section per sample.
+ * The zero cross interrupt only stores its time (ADC_ZC_Top()). The worker converts this time
+ * into a sample index with the time of the end of the frame, the pipeline begins the sinus
+ * reference at this index.
+ * The first gpio is the raw channel (keyboard, ADC_Read0), the next ones are the clamps.
+ */
+
+// Conversions of all channels in a frame (256 at 20 kHz = 12.8 ms)
+#define ADC_DMA_FRAME	256
+#define ADC_DMA_FRAME_BYTES	(ADC_DMA_FRAME * SOC_ADC_DIGI_RESULT_BYTES)
+// Times kept for the frames and the zero cross
+#define ADC_DMA_TIMES	8
+
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define ADC_DMA_OUTPUT_TYPE	ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ADC_DMA_GET_CHANNEL(p)	((p)->type1.channel)
+#define ADC_DMA_GET_DATA(p)	((p)->type1.data)
+#else
+#define ADC_DMA_OUTPUT_TYPE	ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ADC_DMA_GET_CHANNEL(p)	((p)->type2.channel)
+#define ADC_DMA_GET_DATA(p)	((p)->type2.data)
+#endif
+
+static adc_continuous_handle_t ADC_DMA_Handle = NULL; // @suppress("Type cannot be resolved")
+static TaskHandle_t ADC_DMA_Task = NULL;
+static adc_channel_t ADC_DMA_Channel[ADC_MAX_CLAMP + 1];
+static uint8_t ADC_DMA_Nb_Channel = 0;
+static uint32_t ADC_DMA_Channel_Freq = 0; // Sampling frequency of one channel
+static int16_t ADC_DMA_Zero[ADC_MAX_CLAMP];
+
+// Time (us) of the end of the frames and of the zero cross, written in interrupt
+static volatile int64_t ADC_DMA_Frame_Time[ADC_DMA_TIMES];
+static volatile uint32_t ADC_DMA_Frame_Head = 0;
+static volatile int64_t ADC_ZC_Time[ADC_DMA_TIMES];
+static volatile uint32_t ADC_ZC_Head = 0;
+static volatile bool ADC_DMA_Overflow = false;
+
+/**
+ * To call in the zero cross interrupt (see onCirrusZC() of SSR)
+ */
+void IRAM_ATTR ADC_ZC_Top(void)
+{
+	ADC_ZC_Time[ADC_ZC_Head % ADC_DMA_TIMES] = esp_timer_get_time();
+	ADC_ZC_Head = ADC_ZC_Head + 1;
+}
+
+static bool IRAM_ATTR ADC_DMA_Conv_Done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, // @suppress("Type cannot be resolved")
+		void *user_data)
+{
+	BaseType_t woken = pdFALSE;
+	ADC_DMA_Frame_Time[ADC_DMA_Frame_Head % ADC_DMA_TIMES] = esp_timer_get_time();
+	ADC_DMA_Frame_Head = ADC_DMA_Frame_Head + 1;
+	vTaskNotifyGiveFromISR(ADC_DMA_Task, &woken);
+	return (woken == pdTRUE);
+}
+
+static bool IRAM_ATTR ADC_DMA_Pool_Overflow(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, // @suppress("Type cannot be resolved")
+		void *user_data)
+{
+	ADC_DMA_Overflow = true;
+	return false;
+}
+
+static void ADC_DMA_Task_code(void *parameter)
+{
+	static uint8_t frame[ADC_DMA_FRAME_BYTES];
+	static int16_t clamp_samples[ADC_MAX_CLAMP][ADC_DMA_FRAME];
+	const int16_t *samples[ADC_MAX_CLAMP];
+	uint16_t count[ADC_MAX_CLAMP];
+	uint32_t zc_index[ADC_DMA_TIMES];
+	uint32_t frame_tail = 0, zc_tail = ADC_ZC_Head;
+	uint8_t nb_clamp = ADC_DMA_Nb_Channel - 1;
+	int64_t frame_end = 0;
+	uint32_t len;
+
+	for (uint8_t c = 0; c < nb_clamp; c++)
+		samples[c] = clamp_samples[c];
+
+	for (;;)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		while (adc_continuous_read(ADC_DMA_Handle, frame, ADC_DMA_FRAME_BYTES, &len, 0) == ESP_OK) // @suppress("Invalid arguments")
+		{
+			// Frames lost : the times are no more those of the frames, wait for the next zero cross
+			if (ADC_DMA_Overflow)
+			{
+				ADC_DMA_Overflow = false;
+				frame_tail = ADC_DMA_Frame_Head;
+				zc_tail = ADC_ZC_Head;
+				ADC_Pipeline_Lost_Sync(&Talema_Pipeline);
+			}
+			if (frame_tail != ADC_DMA_Frame_Head)
+				frame_end = ADC_DMA_Frame_Time[(frame_tail++) % ADC_DMA_TIMES];
+
+			// Sort the samples by channel
+			int raw0 = -1;
+			memset(count, 0, sizeof(count));
+			for (uint32_t i = 0; i < len; i += SOC_ADC_DIGI_RESULT_BYTES)
+			{
+				adc_digi_output_data_t *p = (adc_digi_output_data_t*) &frame[i]; // @suppress("Type cannot be resolved")
+				adc_channel_t channel = (adc_channel_t) ADC_DMA_GET_CHANNEL(p);
+				if (channel == ADC_DMA_Channel[0])
+					raw0 = ADC_DMA_GET_DATA(p);
+				else
+					for (uint8_t c = 0; c < nb_clamp; c++)
+						if (channel == ADC_DMA_Channel[c + 1])
+						{
+							clamp_samples[c][count[c]++] = ADC_DMA_GET_DATA(p);
+							break;
+						}
+			}
+			uint16_t n = ADC_DMA_FRAME;
+			for (uint8_t c = 0; c < nb_clamp; c++)
+				if (count[c] < n)
+					n = count[c];
+
+			// The zero cross of the frame, time to sample index
+			uint8_t nb_zc = 0;
+			int64_t frame_start = frame_end - ((int64_t) n * 1000000) / ADC_DMA_Channel_Freq;
+			if (ADC_ZC_Head - zc_tail > ADC_DMA_TIMES)
+				zc_tail = ADC_ZC_Head - ADC_DMA_TIMES;
+			while ((zc_tail != ADC_ZC_Head) && (nb_zc < ADC_DMA_TIMES))
+			{
+				int64_t time = ADC_ZC_Time[zc_tail % ADC_DMA_TIMES];
+				if (time > frame_end)
+					break;
+				int64_t index = (time <= frame_start) ? 0 : ((time - frame_start) * ADC_DMA_Channel_Freq) / 1000000;
+				zc_index[nb_zc++] = Talema_Pipeline.sample_index + (uint32_t) index;
+				zc_tail++;
+			}
+
+			ADC_Pipeline_Process(&Talema_Pipeline, samples, n, zc_index, nb_zc);
+
+			if (raw0 >= 0)
+			{
+				portENTER_CRITICAL(&ADC_Keyboard_Mux);
+				ADC_Value0 = raw0;
+				portEXIT_CRITICAL(&ADC_Keyboard_Mux);
+			}
+		}
+	}
+}
+
+/**
+ * Initialize ADC in continuous mode with DMA
+ * The first gpio is used in the ADC_Read0 function. This raw value, no treatment.
+ * The next gpios (up to ADC_MAX_CLAMP) are the clamps.
+ * frequency : the total sampling frequency, each channel is sampled at frequency / number of gpios
+ */
+bool ADC_Initialize_DMA(std::initializer_list<uint8_t> gpios, uint32_t frequency)
+{
+	adc_digi_pattern_config_t pattern[ADC_MAX_CLAMP + 1]; // @suppress("Type cannot be resolved")
+	adc_unit_t adc_unit;
+
+	if ((gpios.size() < 2) || (gpios.size() > ADC_MAX_CLAMP + 1))
+		return false;
+
+	adc_continuous_handle_cfg_t handle_config = { // @suppress("Type cannot be resolved")
+			.max_store_buf_size = 4 * ADC_DMA_FRAME_BYTES,
+			.conv_frame_size = ADC_DMA_FRAME_BYTES,
+	};
+	if (adc_continuous_new_handle(&handle_config, &ADC_DMA_Handle) != ESP_OK) // @suppress("Invalid arguments")
+		return false;
+
+	uint8_t i = 0;
+	for (auto gpio : gpios)
+	{
+		adc_continuous_io_to_channel(gpio, &adc_unit, &ADC_DMA_Channel[i]); // @suppress("Invalid arguments")
+		pattern[i].atten = ADC_ATTEN_DB_12;
+		pattern[i].channel = ADC_DMA_Channel[i] & 0x7;
+		pattern[i].unit = adc_unit;
+		pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+		i++;
+	}
+	ADC_DMA_Nb_Channel = i;
+	ADC_DMA_Channel_Freq = frequency / i;
+
+	adc_continuous_config_t config = { // @suppress("Type cannot be resolved")
+			.pattern_num = i,
+			.adc_pattern = pattern,
+			.sample_freq_hz = frequency,
+			.conv_mode = ADC_CONV_SINGLE_UNIT_1,
+			.format = ADC_DMA_OUTPUT_TYPE,
+	};
+	if (adc_continuous_config(ADC_DMA_Handle, &config) != ESP_OK) // @suppress("Invalid arguments")
+		return false;
+
+	adc_continuous_evt_cbs_t callbacks = { // @suppress("Type cannot be resolved")
+			.on_conv_done = ADC_DMA_Conv_Done,
+			.on_pool_ovf = ADC_DMA_Pool_Overflow,
+	};
+	if (adc_continuous_register_event_callbacks(ADC_DMA_Handle, &callbacks, NULL) != ESP_OK) // @suppress("Invalid arguments")
+		return false;
+
+	for (uint8_t c = 0; c < ADC_MAX_CLAMP; c++)
+		ADC_DMA_Zero[c] = ADC_ZERO;
+
+	ADC_Status = adcDMA;
+	Use_Two_Channel = true;
+	Current_Action = adc_Sigma;
+	ADC_Initialized = true;
+	return true;
+}
+
+/**
+ * The zero of a clamp. ADC_Begin(zero) set the same zero for all the clamps
+ */
+void ADC_Set_Zero(uint8_t clamp, int zero)
+{
+	if (clamp < ADC_MAX_CLAMP)
+	{
+		ADC_DMA_Zero[clamp] = zero;
+		Talema_Pipeline.zero[clamp] = zero;
+	}
+}
+
+static void ADC_Begin_DMA(int zero)
+{
+	for (uint8_t c = 0; c < ADC_MAX_CLAMP; c++)
+		if (ADC_DMA_Zero[c] == ADC_ZERO)
+			ADC_DMA_Zero[c] = zero;
+
+	if (!ADC_Pipeline_Init(&Talema_Pipeline, ADC_DMA_Nb_Channel - 1, ADC_DMA_Zero, ADC_DMA_Channel_Freq / 50))
+	{
+		print_debug("ADC pipeline error.\r\n");
+		return;
+	}
+	xTaskCreatePinnedToCore(ADC_DMA_Task_code, "ADC_DMA_Task", 4096, NULL, ESP_TASK_PRIO_MAX / 2, &ADC_DMA_Task, 0);
+	adc_continuous_start(ADC_DMA_Handle); // @suppress("Invalid arguments")
+}
+#endif
+
 /**
  * Start ADC reading
  * If we use the two channel, then :
@@ -377,7 +630,7 @@ void ADC_Begin(int zero)
 {
 	ADC_zero = zero;
 
-	if (Use_Two_Channel && (Current_Action == adc_Sigma))
+	if (Use_Two_Channel && (Current_Action == adc_Sigma) && (ADC_Status != adcDMA))
 	{
 		if (!Fill_Sinus_Ref())
 			return;
@@ -386,6 +639,14 @@ void ADC_Begin(int zero)
 	if (ADC_Status == adcUndef)
 		return;
 
+#ifdef ADC_USE_DMA
+	if (ADC_Status == adcDMA)
+	{
+		ADC_Begin_DMA(zero);
+		return;
+	}
+#endif
+
 	if (ADC_Status == adcOnseShot)
 	{
 #ifndef ADC_USE_TASK
@@ -568,8 +829,19 @@ void ADC_INTO_IRAM Compute_Mean_Wave(void)
 }
 #endif
 
-float ADC_GetTalemaCurrent()
+float ADC_GetTalemaCurrent(uint8_t clamp)
 {
+#ifdef ADC_USE_DMA
+	if (ADC_Status == adcDMA)
+	{
+		ADC_Clamp_Result result;
+		if (!ADC_Pipeline_Get(&Talema_Pipeline, clamp, &result))
+			return 0;
+		return 0.0125 * sqrt(result.current_raw);
+	}
+#else
+	(void) clamp;
+#endif
 	portENTER_CRITICAL(&ADC_Tore_Mux);
 #if MEAN_WAVE_CUMUL == true
 	float raw;
@@ -589,8 +861,19 @@ float ADC_GetTalemaCurrent()
 }
 
 // We assume that power is always positive
-float ADC_GetTalemaPower()
+float ADC_GetTalemaPower(uint8_t clamp)
 {
+#ifdef ADC_USE_DMA
+	if (ADC_Status == adcDMA)
+	{
+		ADC_Clamp_Result result;
+		if (!ADC_Pipeline_Get(&Talema_Pipeline, clamp, &result))
+			return 0;
+		return 0.0125 * (float) abs(result.power_raw) / ADC_PIPELINE_SINUS;
+	}
+#else
+	(void) clamp;
+#endif
 	portENTER_CRITICAL(&ADC_Tore_Mux);
 #if MEAN_WAVE_CUMUL == true
 	float raw;
@@ -4,6 +4,11 @@
 #include "config_lib.h"
 #endif
 
+// The DMA mode use the ADC continuous driver of the ESP32 (IDF 5)
+#if defined(ADC_USE_DMA) && (defined(ESP8266) || defined(ADC_USE_ARDUINO))
+#undef ADC_USE_DMA
+#endif
+
 #include "Arduino.h"
 #include <stdint.h>
 #include <initializer_list>
@@ -19,12 +24,19 @@ typedef enum {
 
 bool ADC_Initialize_OneShot(std::initializer_list<uint8_t> gpios, ADC_Action_Enum action = adc_Sigma);
 bool ADC_Initialize_Continuous(std::initializer_list<uint8_t> gpios, ADC_Action_Enum action = adc_Sigma);
+#ifdef ADC_USE_DMA
+// Total sampling frequency of all the channels (20 kHz minimum on ESP32)
+#define ADC_DMA_FREQ	20000
+bool ADC_Initialize_DMA(std::initializer_list<uint8_t> gpios, uint32_t frequency = ADC_DMA_FREQ);
+void ADC_Set_Zero(uint8_t clamp, int zero);
+void ADC_ZC_Top(void);
+#endif
 void ADC_Begin(int zero = ADC_ZERO);
 int ADC_Read0(void);
 int ADC_Read1(void);
 int ADC_Get_Error(void);
 
-// Get Talema rms current
-float ADC_GetTalemaCurrent();
-float ADC_GetTalemaPower();
+// Get Talema rms current, clamp is only used with ADC_USE_DMA
+float ADC_GetTalemaCurrent(uint8_t clamp = 0);
+float ADC_GetTalemaPower(uint8_t clamp = 0);
 float ADC_GetZero(uint32_t *count);
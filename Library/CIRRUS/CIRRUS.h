@@ -59,6 +59,12 @@
 #include "SPI.h"
 #endif
 
+/**
+ * Maximum number of registers read in one burst transaction (see read_registers)
+ * In UART, the answers (3 bytes per register) must fit in the RX buffer
+ */
+#define CIRRUS_MAX_BURST	16
+
 // ******************************************************************
 // Type definition
 // ******************************************************************
@@ -589,6 +595,8 @@ class CIRRUS_Communication
 		// Transmit and receive data
 		CIRRUS_State_typedef Transmit(uint8_t *pData, uint16_t Size);
 		CIRRUS_State_typedef Receive(Bit_List *pResult, uint8_t Size = 3);
+		CIRRUS_State_typedef Receive_Burst(const uint8_t *pCommand, uint8_t Size, Bit_List *pResult,
+				uint8_t Count);
 
 		// Reset
 		void Chip_Reset(GPIO_PinState PinState);
@@ -814,6 +822,7 @@ class CIRRUS_Base
 		bool get_rms_data(volatile float *uRMS, volatile float *pRMS);
 		bool get_rms_data(float *uRMS, float *iRMS, float *pRMS, float *CosPhi);
 		float get_data(CIRRUS_Data _data, float *result);
+		bool get_data_multi(const CIRRUS_Data *data_list, uint8_t count, float *results);
 
 		bool Check_Positive_Power(CIRRUS_Channel channel);
 
@@ -832,6 +841,7 @@ class CIRRUS_Base
 
 		// Basic functions
 		bool read_register(uint8_t register_no, uint8_t page_no, Bit_List *result);
+		bool read_registers(uint8_t page_no, const uint8_t *register_list, uint8_t count, Bit_List *results);
 		void write_register(uint8_t register_no, uint8_t page_no, Bit_List *thedata);
 		void send_instruction(uint8_t instruction);
 
@@ -863,6 +873,18 @@ class CIRRUS_Base
 		// mask is a combination of CIRRUS_INT_Mask enumeration (use | operator)
 		// Interrupt callback must be declared with IRAM_ATTR directive
 		void Interrupt_Initialize(uint8_t INT_Pin, onDO_INT_callback onINT, uint32_t mask = CIRRUS_INT_NONE);
+
+#ifdef ESP32
+		// Data ready event mode : the INT pin (DRDY mask) notify the task waiting for data
+		// wait_for_data_ready() then block without bus traffic. Polling is the fallback.
+		void DataReady_Initialize(uint8_t INT_Pin);
+		void DataReady_Stop(void);
+		bool IsDataReadyEvent(void) const
+		{
+			return DRDY_Event;
+		}
+		static void onDataReady(void *cirrus);
+#endif
 	protected:
 
 // ********************************************************************************
@@ -891,12 +913,20 @@ class CIRRUS_Base
 		void select_page(uint8_t page_no);
 		void select_register(uint8_t register_no, CIRRUS_Reg_Operation operation);
 
+		// Data to register conversion
+		bool data_to_register(CIRRUS_Data _data, uint8_t *page_no, uint8_t *register_no);
+		float register_to_data(CIRRUS_Data _data, const Bit_List *reg);
+
 		CIRRUS_RegBit temp_updated(void);
 		CIRRUS_RegBit rx_timeout();
 		CIRRUS_RegBit rx_checksum_err(void);
 		CIRRUS_RegBit invalid_cmnd();
 		bool data_ready(void);
 		void clear_data_ready(void);
+		void flush_clear_data_ready(void);
+#ifdef ESP32
+		bool wait_for_data_ready_event(bool clear_ready);
+#endif
 
 		void CorrectBug(void);
 		uint8_t pivor(void);
@@ -976,6 +1006,20 @@ class CIRRUS_Base
 		uint32_t Sample_Count_ms = 25;
 		uint32_t Ready_TimeOut = 25 + 10;
 
+		// Data ready event mode
+#ifdef ESP32
+		bool DRDY_Event = false;
+		uint8_t DRDY_Pin = 0;
+		// The task waiting for the data ready notification
+		volatile TaskHandle_t DRDY_Task = NULL;
+		// Set by the interruption : the notification may come from another Cirrus of the task
+		volatile bool DRDY_Flag = false;
+		// DRDY received but not cleared (wait_for_data_ready(false))
+		bool DRDY_Pending = false;
+#endif
+		// The clear of DRDY is sent with the next register read
+		bool DRDY_Clear_Pending = false;
+
 		// Old values
 		float old_temp = 0.0;
 		float old_freq = 0.0;
@@ -664,6 +664,66 @@ void CIRRUS_Base::Interrupt_Initialize(uint8_t INT_Pin, onDO_INT_callback onINT,
 	set_interrupt_mask(mask);
 }
 
+#ifdef ESP32
+/**
+ * Initialise the data ready event mode
+ * The INT pin is active low and stay low until DRDY is cleared in Status0.
+ * The interruption notify the task waiting in wait_for_data_ready() so there is no
+ * polling of Status0 on the bus. The clear of DRDY is sent with the next register read.
+ * If the notification is missed (timeout), wait_for_data_ready() fallback to polling.
+ * Note : the task notification of the CIRRUS task is used, don't use it elsewhere.
+ * Several Cirrus may share the task : each one has its own flag set by the interruption.
+ */
+void CIRRUS_Base::DataReady_Initialize(uint8_t INT_Pin)
+{
+	DRDY_Pin = INT_Pin;
+	DRDY_Task = NULL;
+	DRDY_Flag = false;
+	DRDY_Pending = false;
+	DRDY_Clear_Pending = false;
+
+	pinMode(DRDY_Pin, INPUT_PULLUP);
+	attachInterruptArg(digitalPinToInterrupt(DRDY_Pin), onDataReady, (void*) this, FALLING);
+	set_interrupt_mask(CIRRUS_INT_DRDY);
+	// Clear DRDY to have the next falling edge
+	clear_data_ready();
+	DRDY_Event = true;
+}
+
+/**
+ * Stop the data ready event mode, return to polling mode
+ */
+void CIRRUS_Base::DataReady_Stop(void)
+{
+	if (!DRDY_Event)
+		return;
+	DRDY_Event = false;
+	detachInterrupt(digitalPinToInterrupt(DRDY_Pin));
+	set_interrupt_mask(CIRRUS_INT_NONE);
+	DRDY_Task = NULL;
+	DRDY_Pending = false;
+}
+
+/**
+ * Data ready interruption
+ * The parameter is the Cirrus who rise the interruption.
+ * May also be called to simulate the INT pin.
+ */
+void IRAM_ATTR CIRRUS_Base::onDataReady(void *cirrus)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	TaskHandle_t task = ((CIRRUS_Base*) cirrus)->DRDY_Task;
+
+	((CIRRUS_Base*) cirrus)->DRDY_Flag = true;
+	if (task != NULL)
+	{
+		vTaskNotifyGiveFromISR(task, &xHigherPriorityTaskWoken);
+		if (xHigherPriorityTaskWoken == pdTRUE)
+			portYIELD_FROM_ISR();
+	}
+}
+#endif
+
 // ********************************************************************************
 // Utilitary functions
 // ********************************************************************************
@@ -1029,6 +1089,10 @@ bool CIRRUS_Base::read_register(uint8_t register_no, uint8_t page_no, Bit_List *
 {
 	if (IS_READ_REG)
 		return false;
+
+	if (DRDY_Clear_Pending)
+		flush_clear_data_ready();
+
 	IS_READ_REG = true;
 	*result = Bit_List_Zero;
 
@@ -1060,6 +1124,83 @@ bool CIRRUS_Base::read_register(uint8_t register_no, uint8_t page_no, Bit_List *
 	return csResponse;
 }
 
+/**
+ * Read several registers of the same page in one transaction
+ * The page select is sent only if the page change, then all the register read commands
+ * are queued and all the answers are parsed at once.
+ * register_list : the list of count registers (count <= CIRRUS_MAX_BURST)
+ * results : array of count Bit_List
+ */
+bool CIRRUS_Base::read_registers(uint8_t page_no, const uint8_t *register_list, uint8_t count,
+		Bit_List *results)
+{
+	// Page select, write Status0 (clear DRDY), page select, read commands
+	uint8_t command[CIRRUS_MAX_BURST + 6];
+	uint8_t size = 0;
+
+	if ((count == 0) || (count > CIRRUS_MAX_BURST))
+		return false;
+
+#ifdef USE_CHECKSUN
+	// With checksum, each command and each answer has its own checksum byte : one by one
+	if (comm_checksum)
+	{
+		bool success = true;
+		for (uint8_t i = 0; i < count; i++)
+			success &= read_register(register_list[i], page_no, &results[i]);
+		return success;
+	}
+#endif
+
+	if (IS_READ_REG)
+		return false;
+	IS_READ_REG = true;
+
+#ifdef CIRRUS_USE_UART
+	Com->ClearBuffer();
+#endif
+
+	// Clear DRDY in the same transaction
+	if (DRDY_Clear_Pending)
+	{
+		Bit_List reg = 0x800000;
+
+		if (current_selected_page != PAGE0)
+			command[size++] = PAGE_SELECT | PAGE0;
+		command[size++] = REGISTER_WRITE | P0_Status0;
+#ifdef CIRRUS_USE_UART
+		// LSB first
+		for (uint8_t i = 0; i < 3; i++)
+			command[size++] = reg.tab[i];
+#else
+		// HSB first
+		for (uint8_t i = 3; i > 0; i--)
+			command[size++] = reg.tab[i - 1];
+#endif
+		current_selected_page = PAGE0;
+		DRDY_Clear_Pending = false;
+	}
+
+	// Page select only if needed
+	if (page_no != current_selected_page)
+		command[size++] = PAGE_SELECT | page_no;
+	for (uint8_t i = 0; i < count; i++)
+		command[size++] = REGISTER_READ | register_list[i];
+
+	CIRRUS_Last_Error = Com->Receive_Burst(command, size, results, count);
+	csResponse = (CIRRUS_Last_Error == CIRRUS_OK);
+
+	// The page select has been sent, even if the answer is wrong
+	current_selected_page = page_no;
+
+#ifdef DEBUG_CIRRUS
+	print_int("Burst read", count);
+#endif
+
+	IS_READ_REG = false;
+	return csResponse;
+}
+
 /*
  @data = list of 3 integers 0..255 (or 4 if checksum is True)
  */
@@ -1228,6 +1369,24 @@ void CIRRUS_Base::clear_data_ready(void)
 	Bit_List reg;
 	reg.Bit32 = 0x800000;
 	write_register(P0_Status0, PAGE0, &reg);
+	DRDY_Clear_Pending = false;
+}
+
+/**
+ * Send the pending clear of Data ready bit.
+ * The write of Status0 is only a bit clear so we don't need the write delay.
+ */
+void CIRRUS_Base::flush_clear_data_ready(void)
+{
+	Bit_List reg;
+	reg.Bit32 = 0x800000;
+	DRDY_Clear_Pending = false;
+	select_page(PAGE0);
+	select_register(P0_Status0, FOR_WRITE);
+#ifdef USE_CHECKSUN
+	add_comm_checksum(&reg);
+#endif
+	send(&reg, 3);
 }
 
 /**
@@ -1243,9 +1402,20 @@ void CIRRUS_Base::clear_data_ready(void)
 bool CIRRUS_Base::wait_for_data_ready(bool clear_ready)
 {
 	Bit_List reg;
-	uint32_t StartTime = millis(); //csReferenceTime
+	uint32_t StartTime;
 	bool IsNotTimeOut = true;
 
+#ifdef ESP32
+	if (DRDY_Event)
+	{
+		if (wait_for_data_ready_event(clear_ready))
+			return true;
+		// Notification missed : fallback to polling
+		DRDY_Pending = false;
+	}
+#endif
+
+	StartTime = millis(); //csReferenceTime
 	CIRRUS_Last_Error = CIRRUS_OK;
 	while ((!data_ready()) && IsNotTimeOut)
 	{
@@ -1268,9 +1438,47 @@ bool CIRRUS_Base::wait_for_data_ready(bool clear_ready)
 		write_register(P0_Status0, PAGE0, &reg);
 	}
 
+#ifdef ESP32
+	// The mask may have been lost (reset of the Cirrus) : set it again for the next data
+	if (DRDY_Event && (CIRRUS_Last_Error == CIRRUS_OK))
+		set_interrupt_mask(CIRRUS_INT_DRDY);
+#endif
+
 	return (IsNotTimeOut && (CIRRUS_Last_Error == CIRRUS_OK));
 }
 
+#ifdef ESP32
+/**
+ * Wait for data ready in event mode : block on the task notification, no bus traffic.
+ * If clear_ready, the clear of DRDY is sent with the next register read.
+ * If not clear_ready (several channels), the next call return immediately.
+ */
+bool CIRRUS_Base::wait_for_data_ready_event(bool clear_ready)
+{
+	if (!DRDY_Pending)
+	{
+		uint32_t start = millis();
+		uint32_t elapsed = 0;
+
+		DRDY_Task = xTaskGetCurrentTaskHandle();
+		while (!DRDY_Flag)
+		{
+			if ((elapsed >= Ready_TimeOut)
+					|| (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(Ready_TimeOut - elapsed)) == 0))
+				return false;
+			elapsed = millis() - start;
+		}
+		DRDY_Flag = false;
+	}
+
+	CIRRUS_Last_Error = CIRRUS_OK;
+	DRDY_Pending = !clear_ready;
+	if (clear_ready)
+		DRDY_Clear_Pending = true;
+	return true;
+}
+#endif
+
 /**
  * Return FALSE if P_AVG is negative on the channel
  * Bit 0 on Status2, Page0
@@ -1852,117 +2060,169 @@ bool CIRRUS_Base::get_rms_data(float *uRMS, float *iRMS, float *pRMS, float *Cos
 }
 
 /**
- * Get the data _data of type CIRRUS_Data
- * The verification of data ready is NOT done, you must verify this point before
- * If you have 2 channels, you must select channel before
+ * Return the page and the register of the data _data for the current channel
+ * Return false if _data is unknown
  */
-float CIRRUS_Base::get_data(CIRRUS_Data _data, float *result)
+bool CIRRUS_Base::data_to_register(CIRRUS_Data _data, uint8_t *page_no, uint8_t *register_no)
 {
-	Bit_List reg = Bit_List_Zero;
-
+	*page_no = PAGE16;
 	switch (_data)
 	{
 		// Specific channel
+		case CIRRUS_Inst_Voltage: *register_no = P16_V; break;
+		case CIRRUS_Inst_Current: *register_no = P16_I; break;
+		case CIRRUS_Inst_Power: *register_no = P16_P; break;
+		case CIRRUS_Inst_React_Power: *register_no = P16_Q; break;
+		case CIRRUS_RMS_Voltage: *register_no = P16_V_RMS; break;
+		case CIRRUS_RMS_Current: *register_no = P16_I_RMS; break;
+		case CIRRUS_Peak_Voltage: *page_no = PAGE0; *register_no = P0_V_PEAK; break;
+		case CIRRUS_Peak_Current: *page_no = PAGE0; *register_no = P0_I_PEAK; break;
+		case CIRRUS_Active_Power: *register_no = P16_P_AVG; break;
+		case CIRRUS_Reactive_Power: *register_no = P16_Q_AVG; break;
+		case CIRRUS_Apparent_Power: *register_no = P16_S; break;
+		case CIRRUS_Power_Factor: *register_no = P16_PF; break;
+
+		// common channel
+		case CIRRUS_Total_Active_Power: *register_no = P16_P_SUM; break;
+		case CIRRUS_Total_Reactive_Power: *register_no = P16_Q_SUM; break;
+		case CIRRUS_Total_Apparent_Power: *register_no = P16_S_SUM; break;
+		case CIRRUS_Frequency: *register_no = P16_Epsilon; break;
+
+		default:
+			*register_no = 0;
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Convert the register reg to the data _data with the scale of the current channel
+ */
+float CIRRUS_Base::register_to_data(CIRRUS_Data _data, const Bit_List *reg)
+{
+	switch (_data)
+	{
 		case CIRRUS_Inst_Voltage:
-		{
-			if (read_register(P16_V, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->V_SCALE);
-			break;
-		}
+		case CIRRUS_Peak_Voltage:
+			return (twoscompl_to_real(reg) * Scale->V_SCALE);
+
 		case CIRRUS_Inst_Current:
-		{
-			if (read_register(P16_I, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->I_SCALE);
-			break;
-		}
+		case CIRRUS_Peak_Current:
+			return (twoscompl_to_real(reg) * Scale->I_SCALE);
+
 		case CIRRUS_Inst_Power:
-		{
-			if (read_register(P16_P, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->P_SCALE);
-			break;
-		}
 		case CIRRUS_Inst_React_Power:
-		{
-			if (read_register(P16_Q, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->P_SCALE);
-			break;
-		}
-		case CIRRUS_RMS_Voltage:
-		{
-			if (read_register(P16_V_RMS, PAGE16, &reg))
-				*result = (float) (blist_to_int(&reg) * over_pow2_24 * Scale->V_SCALE);
-			break;
-		}
-		case CIRRUS_RMS_Current:
-		{
-			if (read_register(P16_I_RMS, PAGE16, &reg))
-				*result = (float) (blist_to_int(&reg) * over_pow2_24 * Scale->I_SCALE);
-			break;
-		}
-		case CIRRUS_Peak_Voltage:
-		{
-			if (read_register(P0_V_PEAK, PAGE0, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->V_SCALE);
-			break;
-		}
-		case CIRRUS_Peak_Current:
-		{
-			if (read_register(P0_I_PEAK, PAGE0, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->I_SCALE);
-			break;
-		}
 		case CIRRUS_Active_Power:
-		{
-			if (read_register(P16_P_AVG, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->P_SCALE);
-			break;
-		}
 		case CIRRUS_Reactive_Power:
-		{
-			if (read_register(P16_Q_AVG, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->P_SCALE);
-			break;
-		}
+		case CIRRUS_Total_Active_Power:
+		case CIRRUS_Total_Reactive_Power:
+			return (twoscompl_to_real(reg) * Scale->P_SCALE);
+
+		case CIRRUS_RMS_Voltage:
+			return (float) (blist_to_int(reg) * over_pow2_24 * Scale->V_SCALE);
+		case CIRRUS_RMS_Current:
+			return (float) (blist_to_int(reg) * over_pow2_24 * Scale->I_SCALE);
+
 		case CIRRUS_Apparent_Power:
-		{
-			if (read_register(P16_S, PAGE16, &reg))
-				*result = (fabs(twoscompl_to_real(&reg)) * Scale->P_SCALE);
-			break;
-		}
+		case CIRRUS_Total_Apparent_Power:
+			return (fabs(twoscompl_to_real(reg)) * Scale->P_SCALE);
+
 		case CIRRUS_Power_Factor:
-		{
-			if (read_register(P16_PF, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg));
-			break;
-		}
+			return (twoscompl_to_real(reg));
 
-			// common channel
-		case CIRRUS_Total_Active_Power:
+		case CIRRUS_Frequency:
+			return (fabs(twoscompl_to_real(reg)) * 4000);
+	}
+	return 0;
+}
+
+/**
+ * Get the data _data of type CIRRUS_Data
+ * The verification of data ready is NOT done, you must verify this point before
+ * If you have 2 channels, you must select channel before
+ */
+float CIRRUS_Base::get_data(CIRRUS_Data _data, float *result)
+{
+	Bit_List reg = Bit_List_Zero;
+	uint8_t page_no, register_no;
+
+	if (data_to_register(_data, &page_no, &register_no) && read_register(register_no, page_no, &reg))
+		*result = register_to_data(_data, &reg);
+	return *result;
+}
+
+/**
+ * Get a list of data of type CIRRUS_Data with burst read (see read_registers)
+ * The data are grouped by page, the current page first to avoid a page select.
+ * results[i] is updated only if the read of data_list[i] succeed.
+ * The verification of data ready is NOT done, you must verify this point before
+ * If you have 2 channels, you must select channel before
+ */
+bool CIRRUS_Base::get_data_multi(const CIRRUS_Data *data_list, uint8_t count, float *results)
+{
+	uint8_t pages[CIRRUS_MAX_BURST];
+	uint8_t registers[CIRRUS_MAX_BURST];
+	uint8_t burst[CIRRUS_MAX_BURST];
+	uint8_t index[CIRRUS_MAX_BURST];
+	Bit_List regs[CIRRUS_MAX_BURST];
+	bool done[CIRRUS_MAX_BURST];
+	uint8_t remaining, burst_page, nb;
+	bool success = true;
+
+	if (count > CIRRUS_MAX_BURST)
+		return false;
+
+	remaining = count;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		// Unknown data : not read
+		done[i] = !data_to_register(data_list[i], &pages[i], &registers[i]);
+		if (done[i])
 		{
-			if (read_register(P16_P_SUM, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->P_SCALE);
-			break;
+			remaining--;
+			success = false;
 		}
-		case CIRRUS_Total_Reactive_Power:
+	}
+
+	while (remaining > 0)
+	{
+		// The page of the burst : the current page if needed, else the first page not done
+		burst_page = 0xFF;
+		for (uint8_t i = 0; i < count; i++)
 		{
-			if (read_register(P16_Q_SUM, PAGE16, &reg))
-				*result = (twoscompl_to_real(&reg) * Scale->P_SCALE);
-			break;
+			if (done[i])
+				continue;
+			if (pages[i] == current_selected_page)
+			{
+				burst_page = current_selected_page;
+				break;
+			}
+			if (burst_page == 0xFF)
+				burst_page = pages[i];
 		}
-		case CIRRUS_Total_Apparent_Power:
+
+		nb = 0;
+		for (uint8_t i = 0; i < count; i++)
 		{
-			if (read_register(P16_S_SUM, PAGE16, &reg))
-				*result = (fabs(twoscompl_to_real(&reg)) * Scale->P_SCALE);
-			break;
+			if ((!done[i]) && (pages[i] == burst_page))
+			{
+				index[nb] = i;
+				burst[nb] = registers[i];
+				done[i] = true;
+				nb++;
+			}
 		}
-		case CIRRUS_Frequency:
+		remaining -= nb;
+
+		if (read_registers(burst_page, burst, nb, regs))
 		{
-			if (read_register(P16_Epsilon, PAGE16, &reg))
-				*result = (fabs(twoscompl_to_real(&reg)) * 4000);
-			break;
+			for (uint8_t j = 0; j < nb; j++)
+				results[index[j]] = register_to_data(data_list[index[j]], &regs[j]);
 		}
+		else
+			success = false;
 	}
-	return *result;
+	return success;
 }
 
 //Special quantities
@@ -506,6 +506,72 @@ CIRRUS_State_typedef CIRRUS_Communication::Receive(Bit_List *pResult, uint8_t Si
 #endif
 }
 
+/**
+ * Burst read : send all the commands in one transaction then get all the answers
+ * pCommand : list of Size commands. The Count last commands must be register read commands,
+ * the firsts may be a page select command.
+ * pResult : array of Count Bit_List (3 bytes, no checksum)
+ * The Cirrus process the commands in the order they are received, so the answers come back
+ * in the same order.
+ */
+CIRRUS_State_typedef CIRRUS_Communication::Receive_Burst(const uint8_t *pCommand, uint8_t Size,
+		Bit_List *pResult, uint8_t Count)
+{
+	if ((Count == 0) || (Count > Size))
+		return CIRRUS_ERROR;
+
+#ifdef CIRRUS_USE_UART
+	uint32_t timeout;
+	uint16_t wanted = Count * 3;
+
+	Cirrus_UART->write(pCommand, Size);
+
+	// The timeout is for one register, we have Count registers
+	timeout = millis();
+	while ((Cirrus_UART->available() < wanted) && ((millis() - timeout) < Cirrus_TimeOut * Count))
+#ifdef ESP8266
+		yield();
+#else
+		taskYIELD();
+#endif
+	if (Cirrus_UART->available() < wanted)
+		return CIRRUS_TIMEOUT;
+
+	for (uint8_t i = 0; i < Count; i++)
+	{
+		pResult[i].Bit32 = 0;
+		Cirrus_UART->readBytes(pResult[i].tab, 3);
+	}
+	return CIRRUS_OK;
+#else
+	uint8_t prefix = Size - Count;
+
+	SPI_BEGIN_TRANSACTION();
+	// Page select
+	for (uint8_t i = 0; i < prefix; i++)
+	{
+		Cirrus_SPI->transfer(pCommand[i]);
+		delayMicroseconds(DELAY_SPI);
+	}
+	// Register read, HSB first
+	for (uint8_t i = 0; i < Count; i++)
+	{
+		Cirrus_SPI->transfer(pCommand[prefix + i]);
+		delayMicroseconds(DELAY_SPI);
+		pResult[i].CHECK = 0;
+		pResult[i].HSB = Cirrus_SPI->transfer(0xFF);
+		delayMicroseconds(DELAY_SPI);
+		pResult[i].MSB = Cirrus_SPI->transfer(0xFF);
+		delayMicroseconds(DELAY_SPI);
+		pResult[i].LSB = Cirrus_SPI->transfer(0xFF);
+		delayMicroseconds(DELAY_SPI);
+	}
+	SPI_END_TRANSACTION();
+	delayMicroseconds(DELAY_SPI);
+	return CIRRUS_OK;
+#endif
+}
+
 void CIRRUS_DO_Pin_Callback()
 {
 //  Zero_Cirrus++;
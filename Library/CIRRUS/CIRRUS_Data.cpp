@@ -39,29 +39,59 @@ bool CIRRUS_RMSData::GetData(bool reset_ready)
 
 	if (Cirrus->wait_for_data_ready(reset_ready))
 	{
-		Cirrus->get_data(CIRRUS_RMS_Voltage, &_inst_data.Voltage);
+		// Build the list of data to read in one burst
+		CIRRUS_Data data_list[8];
+		float *data_dest[8];
+		float data_val[8];
+		uint8_t nb = 0;
+
+		data_list[nb] = CIRRUS_RMS_Voltage;
+		data_dest[nb++] = &_inst_data.Voltage;
 #ifdef CIRRUS_RMS_FULL
-		Cirrus->get_data(CIRRUS_RMS_Current, &_inst_data.Current);
+		data_list[nb] = CIRRUS_RMS_Current;
+		data_dest[nb++] = &_inst_data.Current;
 #endif
-		Cirrus->get_data(CIRRUS_Active_Power, &_inst_data.ActivePower);
-		if (_temperature)
-			_inst_data.Temperature = Cirrus->get_temperature();
+		data_list[nb] = CIRRUS_Active_Power;
+		data_dest[nb++] = &_inst_data.ActivePower;
 
 		// Extra
 #ifdef CIRRUS_RMS_FULL
 		if (_ExtraData > 0)
 		{
 			if ((_ExtraData & exd_PApparent) == exd_PApparent)
-				Cirrus->get_data(CIRRUS_Apparent_Power, &_inst_data.ApparentPower);
+			{
+				data_list[nb] = CIRRUS_Apparent_Power;
+				data_dest[nb++] = &_inst_data.ApparentPower;
+			}
 			if ((_ExtraData & exd_PReactive) == exd_PReactive)
-				Cirrus->get_data(CIRRUS_Reactive_Power, &_inst_data.ReactivePower);
+			{
+				data_list[nb] = CIRRUS_Reactive_Power;
+				data_dest[nb++] = &_inst_data.ReactivePower;
+			}
 			if ((_ExtraData & exd_PF) == exd_PF)
-				Cirrus->get_data(CIRRUS_Power_Factor, &_inst_data.PowerFactor);
+			{
+				data_list[nb] = CIRRUS_Power_Factor;
+				data_dest[nb++] = &_inst_data.PowerFactor;
+			}
 			if ((_ExtraData & exd_Frequency) == exd_Frequency)
-				Cirrus->get_data(CIRRUS_Frequency, &_inst_data.Frequency);
+			{
+				data_list[nb] = CIRRUS_Frequency;
+				data_dest[nb++] = &_inst_data.Frequency;
+			}
 		}
 #endif
 
+		// Keep the old values if the read failed
+		for (uint8_t i = 0; i < nb; i++)
+			data_val[i] = *data_dest[i];
+		if (!Cirrus->get_data_multi(data_list, nb, data_val))
+			_error_count++;
+		for (uint8_t i = 0; i < nb; i++)
+			*data_dest[i] = data_val[i];
+
+		if (_temperature)
+			_inst_data.Temperature = Cirrus->get_temperature();
+
 		_inst_data_cumul += _inst_data;
 
 		// Gestion énergie, calcul sur la durée de la moyenne
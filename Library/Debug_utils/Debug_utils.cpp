@@ -1,5 +1,6 @@
 #include "Debug_utils.h"
 #include "Partition_utils.h"		// Some utils functions for LittleFS/SPIFFS/FatFS
+#include "Log_Ring.h"           // Lock-free buffer for the log messages
 #ifdef USE_RTCLocal
 #include "RTCLocal.h"		      // A pseudo RTC software library
 #endif
@@ -17,7 +18,7 @@
 #include "esp_task_wdt.h"
 #endif
 
-#ifdef UART_USE_TASK
+#if defined(UART_USE_TASK) || defined(LOG_DEBUG_USE_TASK)
 #include "Tasks_utils.h"
 #endif
 
@@ -33,6 +34,9 @@ const String LOG_Filename = "/log.txt";
 // Global boolean to stop the debug print
 bool GLOBAL_PRINT_DEBUG = true;
 
+// The current level for log_message()
+static Log_Level_typedef Log_Level = Log_Debug;
+
 #ifdef USE_SAVE_CRASH
 #ifdef ESP8266
 EspSaveCrash SaveCrash(0x0010, 0x0800);
@@ -53,6 +57,19 @@ esp_err_t esp_core_dump_image_erase_2();
 HardwareSerial *Serial_Info = &Serial; // Other choice Serial1
 #endif
 
+#if defined(LOG_DEBUG) && defined(LOG_DEBUG_USE_TASK)
+// Les messages en attente d'écriture
+static Log_Ring Log_Buffer;
+
+// Le fichier log est écrit par blocs de LOG_CHUNK_SIZE
+// Un bloc incomplet est écrit toutes les LOG_FLUSH_COUNT périodes de la task
+#define LOG_CHUNK_SIZE	4096
+#define LOG_FLUSH_COUNT	20
+static char log_chunk[LOG_CHUNK_SIZE + LOG_RING_MAX_MESSAGE];
+static size_t log_chunk_len = 0;
+static uint32_t log_lost = 0;
+#endif
+
 // ********************************************************************************
 // Initialization of Serial UART if directive USE_UART or SERIAL_DEBUG is defined
 // baud: default 115200, NB_BIT = 8, PARITY NONE, NB_STOP_BIT = 1
@@ -168,6 +185,10 @@ int LogMessageOutputToFile(const char *format, va_list args)
 		if ((strstr(log_buffer, "STA already disconnected") == NULL) &&
 				(strstr(log_buffer, "Reason: 201 - NO_AP_FOUND") == NULL))
 		{
+#ifdef LOG_DEBUG_USE_TASK
+			Log_Part parts[2] = {{log_buffer, strlen(log_buffer)}, {"\r\n", 2}};
+			Log_Buffer.Push(parts, 2);
+#else
 			File logFile = FS_Partition->open(LOG_Filename, "a");
 			if (logFile)
 			{
@@ -176,6 +197,7 @@ int LogMessageOutputToFile(const char *format, va_list args)
 				logFile.flush();
 				logFile.close();
 			}
+#endif
 		}
 	}
 #endif
@@ -220,29 +242,45 @@ void delete_logFile()
 // ********************************************************************************
 // Print functions
 // ********************************************************************************
-void print_debug(String mess, bool ln)
-{
-#ifdef DEBUG
-	if (ln)
-		mess += "\r\n";
 
+/**
+ * Send the message parts to the log file and/or to the UART
+ */
+static void log_output(const Log_Part *parts, uint8_t count)
+{
 #ifdef LOG_DEBUG
-	// print message to log file
-	if (!Lock_File && GLOBAL_PRINT_DEBUG)
+	if (GLOBAL_PRINT_DEBUG)
 	{
-		File temp = FS_Partition->open(LOG_Filename, "a");
-		if (temp)
+#ifdef LOG_DEBUG_USE_TASK
+		// Le message sera écrit par la task
+		Log_Buffer.Push(parts, count);
+#else
+		// print message to log file
+		if (!Lock_File)
 		{
-			temp.print(mess);
-			temp.close();
+			File temp = FS_Partition->open(LOG_Filename, "a");
+			if (temp)
+			{
+				for (uint8_t i = 0; i < count; i++)
+					temp.write((const uint8_t*) parts[i].text, parts[i].len);
+				temp.close();
+			}
 		}
+#endif
 	}
 #endif
 #ifdef SERIAL_DEBUG
-	Serial.print(mess);
+	for (uint8_t i = 0; i < count; i++)
+		Serial.write((const uint8_t*) parts[i].text, parts[i].len);
 	Serial.flush();
 #endif
+}
 
+void print_debug(const char *mess, bool ln)
+{
+#ifdef DEBUG
+	Log_Part parts[2] = {{mess, strlen(mess)}, {"\r\n", (size_t) ((ln) ? 2 : 0)}};
+	log_output(parts, 2);
 #else  // DEBUG
 	// Juste pour éviter le warning du compilateur
 	(void) mess;
@@ -250,31 +288,149 @@ void print_debug(String mess, bool ln)
 #endif
 }
 
-void print_debug(const char *mess, bool ln)
+void print_debug(String mess, bool ln)
 {
-	print_debug(String(mess), ln);
+	print_debug(mess.c_str(), ln);
 }
 
 void print_debug(char val, bool ln)
 {
-	print_debug((String) val, ln);
+	char buffer[2] = {val, 0};
+	print_debug(buffer, ln);
 }
 
 void print_debug(int val, bool ln)
 {
-	print_debug((String) val, ln);
+	char buffer[12];
+	snprintf(buffer, 12, "%d", val);
+	print_debug(buffer, ln);
 }
 
 void print_debug(float val, bool ln)
 {
-	print_debug((String) val, ln);
+	char buffer[20];
+	snprintf(buffer, 20, "%.2f", val);
+	print_debug(buffer, ln);
 }
 
 void print_millis(void)
 {
-	print_debug((String) millis());
+	char buffer[12];
+	snprintf(buffer, 12, "%lu", (unsigned long) millis());
+	print_debug(buffer);
+}
+
+/**
+ * Message with a level and a tag, formated as "I [tag] message"
+ * The message is ignored if its level is higher than the level defined with Log_Set_Level()
+ */
+void log_message(Log_Level_typedef level, const char *tag, const char *mess)
+{
+#ifdef DEBUG
+	static const char levels[] = "EWID";
+	if (level > Log_Level)
+		return;
+
+	char prefix[24];
+	int len = snprintf(prefix, 24, "%c [%s] ", levels[level], (tag) ? tag : "");
+	if (len >= 24)
+		len = 23;
+	Log_Part parts[3] = {{prefix, (size_t) len}, {mess, strlen(mess)}, {"\r\n", 2}};
+	log_output(parts, 3);
+#else
+	(void) level;
+	(void) tag;
+	(void) mess;
+#endif
+}
+
+void Log_Set_Level(Log_Level_typedef level)
+{
+	Log_Level = level;
+}
+
+/**
+ * The number of messages lost because the log buffer was full
+ */
+uint32_t Log_Get_Overflow(void)
+{
+#if defined(LOG_DEBUG) && defined(LOG_DEBUG_USE_TASK)
+	return log_lost + Log_Buffer.GetOverflow();
+#else
+	return 0;
+#endif
+}
+
+#if defined(LOG_DEBUG) && defined(LOG_DEBUG_USE_TASK)
+/**
+ * Write len bytes of the chunk in the log file and keep the rest
+ */
+static bool log_write_chunk(size_t len)
+{
+	if (Lock_File)
+		return false;
+
+	File temp = FS_Partition->open(LOG_Filename, "a");
+	if (!temp)
+		return false;
+	temp.write((const uint8_t*) log_chunk, len);
+	temp.close();
+
+	log_chunk_len -= len;
+	if (log_chunk_len > 0)
+		memmove(log_chunk, &log_chunk[len], log_chunk_len);
+	return true;
 }
 
+/**
+ * Move the messages of the buffer to the log file by blocks of LOG_CHUNK_SIZE.
+ * force : also write the last incomplete block
+ * Must be called only by the LOG_DEBUG_Task (or when the task is not running)
+ */
+void Log_Debug_Flush(bool force)
+{
+	size_t count;
+	do
+	{
+		count = Log_Buffer.Pop(&log_chunk[log_chunk_len],
+				LOG_CHUNK_SIZE + LOG_RING_MAX_MESSAGE - log_chunk_len);
+		log_chunk_len += count;
+		if ((log_chunk_len >= LOG_CHUNK_SIZE) && !log_write_chunk(LOG_CHUNK_SIZE))
+			break;
+	} while (count > 0);
+
+	// Signal the lost messages
+	uint32_t lost = Log_Buffer.GetOverflow(true);
+	if (lost > 0)
+	{
+		log_lost += lost;
+		if (log_chunk_len < LOG_CHUNK_SIZE)
+			log_chunk_len += snprintf(&log_chunk[log_chunk_len], LOG_RING_MAX_MESSAGE,
+					"*** Log overflow: %d messages lost ***\r\n", (int) lost);
+	}
+
+	if (force && (log_chunk_len > 0))
+		log_write_chunk(log_chunk_len);
+}
+
+/**
+ * Task to write the debug messages in the log file
+ */
+void Log_Debug_Task_code(void *parameter)
+{
+	BEGIN_TASK_CODE("LOG_DEBUG_Task");
+	uint8_t count = 0;
+	for (EVER)
+	{
+		count++;
+		Log_Debug_Flush(count == LOG_FLUSH_COUNT);
+		if (count == LOG_FLUSH_COUNT)
+			count = 0;
+		END_TASK_CODE(false);
+	}
+}
+#endif
+
 // Crash functions
 #ifdef USE_SAVE_CRASH
 void init_and_print_crash(void)
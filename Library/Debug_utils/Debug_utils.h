@@ -4,6 +4,8 @@
  * Define de debug
  * SERIAL_DEBUG	: Message de debug sur le port série (baud 115200)
  * LOG_DEBUG	: Enregistre le debug dans un fichier log
+ * LOG_DEBUG_USE_TASK : Les messages du log sont mis dans un buffer circulaire et écrits
+ * par blocs de 4 ko par la task LOG_DEBUG_Task (ESP32)
  *
  * Analyse de messages reçus par UART
  */
@@ -40,6 +42,24 @@ extern volatile char UART_Message_Buffer[];
 // Global boolean to stop debug message in log file
 extern bool GLOBAL_PRINT_DEBUG;
 
+// Task to write the debug log file, see LOG_DEBUG_USE_TASK
+#if defined(LOG_DEBUG) && defined(LOG_DEBUG_USE_TASK)
+#define LOG_DEBUG_TASK	{condCreate, "LOG_DEBUG_Task", 4096, 1, 500, CoreAny, Log_Debug_Task_code}
+void Log_Debug_Task_code(void *parameter);
+void Log_Debug_Flush(bool force = true);
+#else
+#define LOG_DEBUG_TASK {}
+#endif
+
+// Log level for log_message()
+typedef enum
+{
+	Log_Error = 0,
+	Log_Warning,
+	Log_Info,
+	Log_Debug
+} Log_Level_typedef;
+
 // To create a basic task to analyse UART message
 #ifdef UART_USE_TASK
 #define UART_DATA_TASK	{condCreate, "UART_Task", 4096, 8, 10, Core1, UART_Task_code}
@@ -68,6 +88,9 @@ void print_debug(char val, bool ln = true);
 void print_debug(int val, bool ln = true);
 void print_debug(float val, bool ln = true);
 void print_millis(void);
+void log_message(Log_Level_typedef level, const char *tag, const char *mess);
+void Log_Set_Level(Log_Level_typedef level);
+uint32_t Log_Get_Overflow(void);
 #ifdef USE_SAVE_CRASH
 void init_and_print_crash(void);
 void print_crash(void);
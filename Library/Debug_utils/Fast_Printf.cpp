@@ -1,15 +1,13 @@
 #include "Fast_Printf.h"
 #include <string.h>
-#include <math.h>
 #include <cstdarg>
 
-// Permet d'afficher un entier de 19 chiffres (uint64_t = 18 446 744 073 509 551 615)
-// Avec un uint32_t, on peut faire 9 chiffres (uint32_t = 4 294 967 295)
-#define UINT_SIZE  uint32_t
-//#define UINT_SIZE  uint64_t
-
+// Le séparateur de l'API historique
 static char DECIMAL_SEPARATOR = ',';
 
+static const uint32_t Pow10[FAST_MAX_PREC + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000,
+		100000000, 1000000000};
+
 /**
  * Défini le séparateur décimal à utiliser. Par défaut, c'est la virgule.
  */
@@ -67,119 +65,334 @@ char* Fast_Pos_Buffer(char *buffer, const char *string, Buffer_Pos_Def pos_def,
 	return buffer;
 }
 
+// ********************************************************************************
+// Conversion d'un float
+// ********************************************************************************
+
+/**
+ * Ecrit les chiffres de number en partant de la fin (pend), sur au moins min_digits chiffres
+ * Renvoie le pointeur sur le premier chiffre
+ */
+static char* Write_Digits(char *pend, uint32_t number, uint8_t min_digits)
+{
+	uint8_t count = 0;
+	do
+	{
+		*--pend = (char) ('0' + (number % 10));
+		number /= 10;
+		count++;
+	} while ((number != 0) || (count < min_digits));
+	return pend;
+}
+
+/**
+ * Partie entière >= 2^64 : mantisse * 2^exp calculé en base 10^9
+ */
+static char* Write_Big_Integer(char *pend, uint32_t mant, int16_t exp)
+{
+	uint32_t limbs[5] = {mant % 1000000000, mant / 1000000000, 0, 0, 0};
+	uint8_t count = (limbs[1] != 0) ? 2 : 1;
+
+	while (exp > 0)
+	{
+		uint8_t shift = (exp > 32) ? 32 : exp;
+		uint64_t carry = 0;
+		for (uint8_t i = 0; i < count; i++)
+		{
+			uint64_t v = ((uint64_t) limbs[i] << shift) + carry;
+			limbs[i] = v % 1000000000;
+			carry = v / 1000000000;
+		}
+		while (carry != 0)
+		{
+			limbs[count++] = carry % 1000000000;
+			carry /= 1000000000;
+		}
+		exp -= shift;
+	}
+
+	for (uint8_t i = 0; i < count - 1; i++)
+		pend = Write_Digits(pend, limbs[i], 9);
+	return Write_Digits(pend, limbs[count - 1], 1);
+}
+
 /**
  * Fonction de conversion d'un float en string
- * buffer : buffer pour le résultat
- * value : la valeur à convertir
- * prec : la précision souhaitée. ATTENTION, on est limité à 9 caractères pour la partie entière + décimale (voir define UINT_SIZE)
- * firststring, laststring : chaine de caractères à rajouter avant et après le nombre
- * pos_def : indique si le résultat de la fonction doit pointer sur le début (premier caractère) ou la fin de la chaine (le 0).
- *           Permet de faire rapidement des concaténations
- * end_len : retourne la longueur de la chaine finale (doit être initialisé à zéro, sinon cumule le résultat)
- * ATTENTION : aucune vérification d'espace mémoire n'est faite
- * DECIMAL_SEPARATOR définie le séparateur décimal
- * La chaine est terminée par 0.
- * Exemple :
- * pbuffer = Fast_Printf(dest, value, prec, "", "", Buffer_End, &len);
+ * buffer : buffer pour le résultat, size : sa taille (0 final compris)
+ * format : séparateur décimal et précision (limitée à FAST_MAX_PREC)
+ * Le nombre est converti avec des entiers à partir de la mantisse et de l'exposant du float.
+ * Un NaN est écrit 0, l'infini inf.
+ * Renvoie la longueur écrite, 0 si le buffer est trop petit (rien n'est écrit).
  */
-char* Fast_Printf(char *buffer, float value, uint8_t prec, const char *firststring,
-		const char *laststring, Buffer_Pos_Def pos_def, uint16_t *end_len)
+uint16_t Fast_Float(char *buffer, uint16_t size, float value, const Fast_Format &format)
 {
-	static const double pow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000}; // Les puissances de 10
-//  static const char *chiffre = "0123456789";  // Les chiffres
-	float f_tmp;
-	double d_tmp;  // Double pour la précision
-	uint8_t entier = 0, len = 0, pos = 0;
-	UINT_SIZE number;
-	char *pbuffer_origine = buffer;  // Le début du buffer initial
+	char digits[FAST_FLOAT_SIZE];
+	char *pend = &digits[FAST_FLOAT_SIZE];
 	char *pbuffer;
-	char ch;
+	uint8_t prec = (format.prec > FAST_MAX_PREC) ? FAST_MAX_PREC : format.prec;
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(uint32_t));
 
-	// Première chaine
-	if (strlen(firststring) != 0)
+	bool negative = ((bits & 0x7FFFFFFF) != 0) && (bits >> 31); // Pas de -0
+	int16_t exp = (bits >> 23) & 0xFF;
+	uint32_t mant = bits & 0x7FFFFF;
+
+	if (exp == 0xFF)
 	{
-		while ((ch = *firststring++) != 0)
+		if (mant != 0)
 		{
-			*buffer++ = ch;
+			mant = exp = 0; // NaN, pour simplifier on met 0
+			negative = false;
+		}
+		else
+		{
+			pbuffer = pend - 3;
+			memcpy(pbuffer, "inf", 3);
+			goto copy;
 		}
 	}
 
-	// Le test NaN
-	// Pour simplifier, on met 0
-	if (isnan(value))
+	// value = mant * 2^exp
+	if (exp == 0)
+		exp = 1; // Dénormalisé
+	else
+		mant |= 0x800000;
+	exp -= 150;
+
 	{
-		value = 0.0;
+		uint64_t integer;
+		uint32_t frac = 0;
+
+		if (exp >= 0)
+		{
+			if (prec != 0)
+			{
+				pend = Write_Digits(pend, 0, prec);
+				*--pend = format.decimal;
+			}
+			if (exp > 39)
+			{
+				pbuffer = Write_Big_Integer(pend, mant, exp);
+				goto sign;
+			}
+			integer = (uint64_t) mant << exp;
+		}
+		else
+		{
+			uint8_t shift = -exp; // 1 à 149
+			uint32_t rem = mant;
+			integer = 0;
+			if (shift < 32)
+			{
+				integer = mant >> shift;
+				rem = mant & ((1UL << shift) - 1);
+			}
+
+			// Partie décimale * 10^prec, arrondie au plus proche (au pair si égalité)
+			uint64_t scaled = (uint64_t) rem * Pow10[prec];
+			if (shift < 64)
+			{
+				uint64_t mask = ((uint64_t) 1 << shift) - 1;
+				uint64_t half = (uint64_t) 1 << (shift - 1);
+				uint64_t r = scaled & mask;
+				frac = scaled >> shift;
+				if ((r > half) || ((r == half) && ((prec != 0) ? (frac & 1) : (integer & 1))))
+					frac++;
+			}
+			if (frac == Pow10[prec])
+			{
+				frac = 0;
+				integer++;
+			}
+			if (prec != 0)
+			{
+				pend = Write_Digits(pend, frac, prec);
+				*--pend = format.decimal;
+			}
+		}
+
+		// Partie entière, en 32 bits si possible (plus rapide)
+		if ((integer >> 32) == 0)
+			pbuffer = Write_Digits(pend, (uint32_t) integer, 1);
+		else
+		{
+			pbuffer = Write_Digits(pend, (uint32_t) (integer % 1000000000), 9);
+			integer /= 1000000000;
+			if (integer >= 1000000000)
+			{
+				pbuffer = Write_Digits(pbuffer, (uint32_t) (integer % 1000000000), 9);
+				integer /= 1000000000;
+			}
+			pbuffer = Write_Digits(pbuffer, (uint32_t) integer, 1);
+		}
 	}
 
-	// Test nombre négatif
-	if (value < 0.0)
+	sign:
+	if (negative)
+		*--pbuffer = '-';
+
+	copy:
+	uint16_t len = &digits[FAST_FLOAT_SIZE] - pbuffer;
+	if (len >= size)
 	{
-		value = 0.0 - value;
-		// On met le '-'
-		*buffer++ = '-';
+		if (size != 0)
+			*buffer = 0;
+		return 0;
 	}
+	memcpy(buffer, pbuffer, len);
+	buffer[len] = 0;
+	return len;
+}
+
+// ********************************************************************************
+// Fast_Writer
+// ********************************************************************************
+
+Fast_Writer::Fast_Writer(char *buffer, uint16_t size, const Fast_Format &format)
+{
+	_buffer = buffer;
+	_size = size;
+	_len = 0;
+	_overflow = (size == 0);
+	this->format = format;
+	if (size != 0)
+		*buffer = 0;
+}
 
-	// Détermine la longueur de la partie entière
-	f_tmp = value;
-	if (f_tmp < 1.0)
-		entier = 1;  // on veut écrire 0.xx et pas .xx
+/**
+ * Ajoute une chaine, rien n'est ajouté si elle est trop longue
+ */
+Fast_Writer& Fast_Writer::Add(const char *str)
+{
+	size_t len = strlen(str);
+	if (_len + len >= _size)
+		_overflow = true;
 	else
-		while (f_tmp >= 1.0)  // entier déjà initialisé
-		{
-			entier++;
-			f_tmp /= 10.0;
-		}
+	{
+		memcpy(&_buffer[_len], str, len + 1);
+		_len += len;
+	}
+	return *this;
+}
 
-	// On transforme en un entier
-	d_tmp = value * pow10[prec];
-	number = (UINT_SIZE) (d_tmp);
-	if ((d_tmp - number) >= 0.5)
-		number++;  // On arrondi la dernière décimale
+Fast_Writer& Fast_Writer::Add(char ch)
+{
+	if (_len + 1 >= _size)
+		_overflow = true;
+	else
+	{
+		_buffer[_len++] = ch;
+		_buffer[_len] = 0;
+	}
+	return *this;
+}
 
-	// Longueur de la chaine finale : partie entière + '.' + precision partie décimale
-	// Le '-' si nécessaire est déjà en place
-	// Si la précision est de 1 on évite d'avoir des xx.0
-	if ((prec == 1) && (number % 10 == 0))
+Fast_Writer& Fast_Writer::Add(float value)
+{
+	if (!_overflow)
 	{
-		prec = 0;
-		number /= 10;
+		uint16_t len = Fast_Float(&_buffer[_len], _size - _len, value, format);
+		if (len == 0)
+			_overflow = true;
+		_len += len;
 	}
+	return *this;
+}
+
+Fast_Writer& Fast_Writer::Add(float value, uint8_t prec)
+{
+	uint8_t old_prec = format.prec;
+	format.prec = prec;
+	Add(value);
+	format.prec = old_prec;
+	return *this;
+}
 
-	len = entier + prec + (uint8_t) (prec != 0);
+Fast_Writer& Fast_Writer::AddInt(int32_t value)
+{
+	char digits[12];
+	char *pend = &digits[11];
+	*pend = 0;
+	uint32_t number = (value < 0) ? 0 - (uint32_t) value : value;
+	char *pbuffer = Write_Digits(pend, number, 1);
+	if (value < 0)
+		*--pbuffer = '-';
+	return Add(pbuffer);
+}
 
-	// On se positionne en bout de la chaine
-	pbuffer = buffer + len - 1;
+/**
+ * Ajoute une série de float séparés par separator (version list)
+ * keep_last_separator : conserve le separateur en fin de chaîne
+ */
+Fast_Writer& Fast_Writer::Add(std::initializer_list<float> values, const char *separator, bool keep_last_separator)
+{
+	return Add(values.begin(), values.size(), separator, keep_last_separator);
+}
 
-	while (pos < len)  // pos déjà initialisé
+/**
+ * Ajoute une série de float séparés par separator (version tableau)
+ * keep_last_separator : conserve le separateur en fin de chaîne
+ */
+Fast_Writer& Fast_Writer::Add(const float *values, uint8_t count, const char *separator, bool keep_last_separator)
+{
+	for (uint8_t i = 0; i < count; i++)
 	{
-		if ((pos == prec) && (prec != 0))  // le point décimal
-		{
-			*pbuffer = DECIMAL_SEPARATOR;
-		}
-		else
-		{
-			if (number == 0)
-				*pbuffer = '0';
-			else
-			{
-				*pbuffer = (char) (48 + (number % 10)); // ou chiffre[number % 10];
-				number /= 10;
-			}
-		}
-		pos++;
-		pbuffer--;
+		Add(values[i]);
+		if (keep_last_separator || (i != count - 1))
+			Add(separator);
 	}
+	return *this;
+}
 
-	// Dernière chaine
+/**
+ * Ajoute \r\n
+ */
+Fast_Writer& Fast_Writer::EndLine(void)
+{
+	return Add("\r\n");
+}
+
+// ********************************************************************************
+// API historique
+// ********************************************************************************
+
+/**
+ * Fonction de conversion d'un float en string
+ * buffer : buffer pour le résultat
+ * value : la valeur à convertir
+ * prec : la précision souhaitée (FAST_MAX_PREC au maximum)
+ * firststring, laststring : chaine de caractères à rajouter avant et après le nombre
+ * pos_def : indique si le résultat de la fonction doit pointer sur le début (premier caractère) ou la fin de la chaine (le 0).
+ *           Permet de faire rapidement des concaténations
+ * end_len : retourne la longueur de la chaine finale (doit être initialisé à zéro, sinon cumule le résultat)
+ * ATTENTION : aucune vérification d'espace mémoire n'est faite, utiliser Fast_Writer
+ * DECIMAL_SEPARATOR définie le séparateur décimal
+ * La chaine est terminée par 0.
+ * Exemple :
+ * pbuffer = Fast_Printf(dest, value, prec, "", "", Buffer_End, &len);
+ */
+char* Fast_Printf(char *buffer, float value, uint8_t prec, const char *firststring,
+		const char *laststring, Buffer_Pos_Def pos_def, uint16_t *end_len)
+{
+	char *pbuffer_origine = buffer;  // Le début du buffer initial
+	char *pbuffer;
+	Fast_Format format = {DECIMAL_SEPARATOR, prec};
+
+	// Première chaine
+	size_t len = strlen(firststring);
+	memcpy(buffer, firststring, len);
 	pbuffer = buffer + len;
-	if (strlen(laststring) != 0)
-	{
-		while ((ch = *laststring++) != 0)
-		{
-			*pbuffer++ = ch;
-		}
-	}
-	*pbuffer = 0;  // fini la chaine
+
+	pbuffer += Fast_Float(pbuffer, FAST_FLOAT_SIZE, value, format);
+
+	// Si la précision est de 1 on évite d'avoir des xx.0
+	if ((prec == 1) && (*(pbuffer - 1) == '0') && (*(pbuffer - 2) == DECIMAL_SEPARATOR))
+		pbuffer -= 2;
+
+	// Dernière chaine
+	len = strlen(laststring);
+	memcpy(pbuffer, laststring, len + 1);
+	pbuffer += len;
 
 	// Longueur de la chaine final
 	*end_len += (pbuffer - pbuffer_origine);
@@ -5,6 +5,22 @@
 
 /**
  * Une librairie minimaliste pour formater des réels
+ *
+ * La conversion est faite uniquement avec des entiers à partir de la représentation binaire
+ * du float (mantisse, exposant) : le résultat est exact, arrondi au plus proche (au pair en cas
+ * d'égalité, comme printf), quelle que soit la valeur.
+ *
+ * Deux API :
+ * - Fast_Printf() : l'API historique, sans vérification de la taille du buffer. Le séparateur
+ * décimal est global (Fast_Set_Decimal_Separator()).
+ * - Fast_Writer : le buffer et sa taille, le format (séparateur, précision) est propre à chaque
+ * appel. Rien n'est écrit au-delà de la taille du buffer (voir overflow()).
+ *
+ * Exemple :
+ * char buffer[100];
+ * Fast_Writer writer(buffer, 100, {'.', 2});
+ * writer.Add("Time").Add('\t').Add({data.voltage, data.power}, "\t", false).EndLine();
+ * if (!writer.overflow()) file.print(buffer);
  */
 
 #include <stdint.h>
@@ -16,6 +32,64 @@ typedef enum {
   Buffer_End
 } Buffer_Pos_Def;
 
+// Nombre maximum de décimales
+#define FAST_MAX_PREC	9
+
+// Taille maximum d'un float formaté : signe + 39 chiffres + séparateur + décimales + 0 final
+#define FAST_FLOAT_SIZE	(1 + 39 + 1 + FAST_MAX_PREC + 1)
+
+/**
+ * Le format d'un nombre : séparateur décimal et nombre de décimales
+ */
+typedef struct
+{
+	char decimal;
+	uint8_t prec;
+} Fast_Format;
+
+uint16_t Fast_Float(char *buffer, uint16_t size, float value, const Fast_Format &format);
+
+/**
+ * Concaténation dans un buffer de taille fixe
+ */
+class Fast_Writer
+{
+	public:
+		Fast_Writer(char *buffer, uint16_t size, const Fast_Format &format = {',', 2});
+
+		Fast_Writer& Add(const char *str);
+		Fast_Writer& Add(char ch);
+		Fast_Writer& Add(float value);
+		Fast_Writer& Add(float value, uint8_t prec);
+		Fast_Writer& AddInt(int32_t value);
+		Fast_Writer& Add(std::initializer_list<float> values, const char *separator, bool keep_last_separator);
+		Fast_Writer& Add(const float *values, uint8_t count, const char *separator, bool keep_last_separator);
+		Fast_Writer& EndLine(void);
+
+		// Le format utilisé par Add(float), peut être modifié entre deux appels
+		Fast_Format format;
+
+		uint16_t length(void) const
+		{
+			return _len;
+		}
+		// true si une donnée n'a pas pu être ajoutée faute de place
+		bool overflow(void) const
+		{
+			return _overflow;
+		}
+		const char* c_str(void) const
+		{
+			return _buffer;
+		}
+
+	private:
+		char *_buffer;
+		uint16_t _size;
+		uint16_t _len;
+		bool _overflow;
+};
+
 void Fast_Set_Decimal_Separator(char decimal);
 char *Fast_Pos_Buffer(char *buffer, Buffer_Pos_Def pos_def, uint16_t *buffer_len);
 char *Fast_Pos_Buffer(char *buffer, const char *string, Buffer_Pos_Def pos_def, uint16_t *buffer_len);
@@ -0,0 +1,186 @@
+/**
+ * A lock-free ring buffer for log messages : several writers (tasks or ISR), one reader
+ *
+ * A writer reserve its place in the buffer with a compare and swap on the write index,
+ * copy its message, then validate the record. No allocation, no mutex.
+ * The reader (the log task) copy the validated records in order and free the place.
+ * If the buffer is full, the message is lost and the overflow counter is incremented.
+ *
+ * Each record is : a 4 bytes header (length | LOG_RECORD_READY) then the message padded to 4 bytes.
+ * The reader clears the whole record before freeing it, so that a future header never see
+ * an old message byte with the LOG_RECORD_READY bit.
+ * LOG_RING_SIZE must be a power of 2.
+ *
+ * Only std C++ is used, so the class can be compiled on a PC (for example with a FILE* output).
+ *
+ * Exemple :
+ *
+ * Log_Ring Ring;
+ *
+ * // Writer
+ * Log_Part parts[2] = {{"Hello", 5}, {"\r\n", 2}};
+ * Ring.Push(parts, 2);
+ *
+ * // Reader
+ * char chunk[1024];
+ * size_t len = Ring.Pop(chunk, 1024);
+ * fwrite(chunk, 1, len, file);
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE	4096
+#endif
+
+// The max size of one message, the rest is truncated
+// The buffer given to Pop() must be at least of this size
+#define LOG_RING_MAX_MESSAGE	512
+
+#define LOG_RECORD_READY	0x80000000
+
+/**
+ * A part of a message, to push a message in several parts without concatenation
+ */
+typedef struct
+{
+		const char *text;
+		size_t len;
+} Log_Part;
+
+class Log_Ring
+{
+	public:
+		Log_Ring()
+		{
+		}
+
+		/**
+		 * Push a message composed of count parts. Can be called from any task or ISR.
+		 * Return false if the buffer is full (message lost).
+		 */
+		bool Push(const Log_Part *parts, uint8_t count)
+		{
+			size_t len = 0;
+			for (uint8_t i = 0; i < count; i++)
+				len += parts[i].len;
+			if (len > LOG_RING_MAX_MESSAGE)
+				len = LOG_RING_MAX_MESSAGE;
+			uint32_t total = 4 + ((len + 3) & ~3U);
+
+			// Reserve the place
+			uint32_t write = _write.load(std::memory_order_relaxed);
+			do
+			{
+				if (write + total - _read.load(std::memory_order_acquire) > LOG_RING_SIZE)
+				{
+					_overflow.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+			} while (!_write.compare_exchange_weak(write, write + total, std::memory_order_acq_rel,
+					std::memory_order_relaxed));
+
+			// Copy the message
+			uint32_t pos = write + 4;
+			size_t remain = len;
+			for (uint8_t i = 0; (i < count) && (remain > 0); i++)
+			{
+				size_t n = (parts[i].len < remain) ? parts[i].len : remain;
+				copy_in(pos, parts[i].text, n);
+				pos += n;
+				remain -= n;
+			}
+
+			// Validate the record
+			__atomic_store_n(&_buffer[(write & (LOG_RING_SIZE - 1)) / 4], len | LOG_RECORD_READY,
+					__ATOMIC_RELEASE);
+			return true;
+		}
+
+		/**
+		 * Copy the validated records in dest (without the header). Only one reader.
+		 * Stop at the first record not yet validated or if dest is full.
+		 * Return the number of bytes copied.
+		 */
+		size_t Pop(char *dest, size_t size)
+		{
+			uint32_t read = _read.load(std::memory_order_relaxed);
+			size_t count = 0;
+
+			while (read != _write.load(std::memory_order_acquire))
+			{
+				uint32_t *header = &_buffer[(read & (LOG_RING_SIZE - 1)) / 4];
+				uint32_t value = __atomic_load_n(header, __ATOMIC_ACQUIRE);
+				if ((value & LOG_RECORD_READY) == 0)
+					break;
+
+				size_t len = value & ~LOG_RECORD_READY;
+				if (count + len > size)
+					break;
+
+				copy_out(read + 4, &dest[count], len);
+				count += len;
+
+				// Clear the header and the message, the release on _read publish the zeros to the writers
+				uint32_t total = 4 + ((len + 3) & ~3U);
+				clear(read, total);
+				read += total;
+				_read.store(read, std::memory_order_release);
+			}
+			return count;
+		}
+
+		/**
+		 * Return true if there is no message in the buffer
+		 */
+		bool IsEmpty(void) const
+		{
+			return (_read.load(std::memory_order_acquire) == _write.load(std::memory_order_acquire));
+		}
+
+		/**
+		 * Return the number of lost messages
+		 */
+		uint32_t GetOverflow(bool reset = false)
+		{
+			if (reset)
+				return _overflow.exchange(0, std::memory_order_relaxed);
+			return _overflow.load(std::memory_order_relaxed);
+		}
+
+	private:
+		uint32_t _buffer[LOG_RING_SIZE / 4] = {0};
+		std::atomic<uint32_t> _write = {0};
+		std::atomic<uint32_t> _read = {0};
+		std::atomic<uint32_t> _overflow = {0};
+
+		void copy_in(uint32_t pos, const char *src, size_t n)
+		{
+			uint8_t *buffer = (uint8_t*) _buffer;
+			uint32_t index = pos & (LOG_RING_SIZE - 1);
+			size_t first = ((LOG_RING_SIZE - index) < n) ? (LOG_RING_SIZE - index) : n;
+			memcpy(&buffer[index], src, first);
+			memcpy(buffer, &src[first], n - first);
+		}
+
+		void copy_out(uint32_t pos, char *dest, size_t n)
+		{
+			uint8_t *buffer = (uint8_t*) _buffer;
+			uint32_t index = pos & (LOG_RING_SIZE - 1);
+			size_t first = ((LOG_RING_SIZE - index) < n) ? (LOG_RING_SIZE - index) : n;
+			memcpy(dest, &buffer[index], first);
+			memcpy(&dest[first], buffer, n - first);
+		}
+
+		void clear(uint32_t pos, size_t n)
+		{
+			uint8_t *buffer = (uint8_t*) _buffer;
+			uint32_t index = pos & (LOG_RING_SIZE - 1);
+			size_t first = ((LOG_RING_SIZE - index) < n) ? (LOG_RING_SIZE - index) : n;
+			memset(&buffer[index], 0, first);
+			memset(buffer, 0, n - first);
+		}
+};
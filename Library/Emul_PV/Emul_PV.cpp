@@ -1,7 +1,10 @@
 #include "Emul_PV.h"
 #include <stdio.h>
 #include <math.h>
+#include <time.h>
 #include "rayonnement.h"
+#include "Partition_utils.h"
+#include "Line_Reader.h"
 //#include "Debug_utils.h"
 
 EmulPV_Class::EmulPV_Class()
@@ -15,6 +18,12 @@ EmulPV_Class::EmulPV_Class()
 	SetRendement();
 }
 
+EmulPV_Class::~EmulPV_Class()
+{
+	free(Forecast);
+	free(Forecast_Day);
+}
+
 /**
  * Initialisation à partir d'un fichier de type ini.
  * Si le fichier n'existe pas, il est créé.
@@ -54,6 +63,19 @@ void EmulPV_Class::Init_From_IniData(IniFiles &init_file)
 	dataPV.Mask_Soir = init_file.ReadFloat("MASK", "Mask_Soir", 0);
 
 	Init_From_Array(dataPV);
+
+	// Profil d'horizon : liste de points dans l'ini ou fichier csv sur la partition data
+	char *profile = init_file.ReadString("MASK", "Horizon", "");
+	char *profile_file = init_file.ReadString("MASK", "Horizon_File", "");
+	if ((profile != NULL) && (profile[0] != 0))
+		Horizon_From_String(profile);
+	else
+		if ((profile_file != NULL) && (profile_file[0] != 0))
+			Horizon_From_File(profile_file);
+		else
+			Horizon_Remove();
+	free(profile);
+	free(profile_file);
 }
 
 void EmulPV_Class::Save_To_File(IniFiles &init_file)
@@ -101,7 +123,7 @@ void EmulPV_Class::Init_From_Array(const PVSite_Struct &data)
 	PV_Site.GPS = PV_GPS;
 	PV_Site.MaskMatin = DoubleToDateTime(data.Tab[6]);
 	PV_Site.MaskSoir = DoubleToDateTime(data.Tab[7]);
-	PV_Site.UseMask = false;
+	PV_Site.UseMask = (Horizon_Count() > 0);
 	PV_Site.Temperature = 25;
 	PV_Site.HR = 0.75;
 	PV_Site.Angstrom = acBleuPur;
@@ -117,6 +139,9 @@ void EmulPV_Class::Init_From_Array(const PVSite_Struct &data)
 	Ond_Rendement = data.Tab[11];
 
 	SetRendement();
+
+	// La table du jour n'est plus valide pour ce site
+	Today.Sun_Last = -1;
 }
 
 /**
@@ -139,24 +164,212 @@ void EmulPV_Class::Set_DayParameters(TAngstromCoeff ang, double temp, double hr)
 }
 
 /**
- * Initialise les données du jour commune (mask, énergie solaire)
+ * Lecture d'un point (azimut, hauteur) : deux nombres séparés par un des caractères de sep
+ * Renvoie la fin du point ou NULL si ce n'est pas un point (entête d'un csv par exemple)
  */
-void EmulPV_Class::Day_Init()
+static const char* Parse_Horizon_Point(const char *str, const char *sep, TMaskPoint *point)
+{
+	char *end;
+
+	while ((*str == ' ') || (*str == '\t'))
+		str++;
+	point->Azimut = strtod(str, &end);
+	if (end == str)
+		return NULL;
+	str = end;
+	while ((*str != 0) && (strchr(sep, *str) != NULL))
+		str++;
+	point->Hauteur = strtod(str, &end);
+	if (end == str)
+		return NULL;
+	return end;
+}
+
+/**
+ * Profil d'horizon à partir d'une chaine de points "azimut:hauteur" séparés par des ';'
+ * Exemple : Horizon=-180:0;-90:2.5;-45:12;0:8;45:3;90:0
+ * Les azimuts sont comptés à partir du sud, positifs vers l'ouest, en degré.
+ */
+bool EmulPV_Class::Horizon_From_String(const char *profile)
+{
+	TMaskPoint *points;
+	uint16_t count = 0;
+	bool result = false;
+
+	points = (TMaskPoint*) malloc(HORIZON_MAX_POINTS * sizeof(TMaskPoint));
+	if (points == NULL)
+		return false;
+
+	while ((profile != NULL) && (*profile != 0) && (count < HORIZON_MAX_POINTS))
+	{
+		profile = Parse_Horizon_Point(profile, " \t:,", &points[count]);
+		if (profile == NULL)
+			break;
+		count++;
+		while ((*profile == ' ') || (*profile == ';'))
+			profile++;
+	}
+
+	if ((profile != NULL) && (*profile == 0))
+		result = Horizon_Set(points, count);
+	free(points);
+	Mask_Update();
+	return result;
+}
+
+/**
+ * Profil d'horizon à partir d'un fichier csv de la partition data (par exemple "/horizon.csv")
+ * Une ligne par point : azimut puis hauteur en degré, séparés par une tabulation, un espace, ';' ou ','.
+ * Les lignes qui ne commencent pas par deux nombres sont ignorées (entêtes, commentaires) :
+ * le fichier horizon de PVGIS peut être utilisé tel quel.
+ */
+bool EmulPV_Class::Horizon_From_File(const char *file)
+{
+	TMaskPoint *points;
+	uint16_t count = 0;
+	char buffer[64];
+	bool result = false;
+
+	if (Lock_File || !Data_Partition->exists(file))
+		return false;
+
+	points = (TMaskPoint*) malloc(HORIZON_MAX_POINTS * sizeof(TMaskPoint));
+	if (points == NULL)
+		return false;
+
+	Lock_File = true;
+	File csv = Data_Partition->open(file, "r");
+	if (csv)
+	{
+		Line_Reader reader(csv, buffer, sizeof(buffer));
+		while (reader.Next() && (count < HORIZON_MAX_POINTS))
+		{
+			if (Parse_Horizon_Point(reader.line(), " \t;,", &points[count]) != NULL)
+				count++;
+		}
+		csv.close();
+		result = Horizon_Set(points, count);
+	}
+	Lock_File = false;
+	free(points);
+	Mask_Update();
+	return result;
+}
+
+/**
+ * Supprime le profil d'horizon
+ */
+void EmulPV_Class::Horizon_Remove(void)
+{
+	Horizon_Clear();
+	Mask_Update();
+}
+
+/**
+ * Les masques du site : heures matin et soir et profil d'horizon
+ */
+void EmulPV_Class::Mask_Update(void)
 {
-	// Mask
+	PV_Site.UseMask = (Horizon_Count() > 0);
 	Mask = (PV_Site.MaskMatin != 0) || (PV_Site.MaskSoir != 0) || (PV_Site.UseMask);
 	if (Mask)
 	{
 		MaskMatin = frac(PV_Site.MaskMatin);
 		MaskSoir = frac(PV_Site.MaskSoir);
 	}
+}
+
+/**
+ * Initialise les données du jour commune (mask, énergie solaire)
+ */
+void EmulPV_Class::Day_Init()
+{
+	Mask_Update();
+
+	Day_Compute(Today.Day, Today);
+}
+
+/**
+ * Les données d'un jour : énergie solaire, lever et coucher du Soleil, table des positions
+ */
+void EmulPV_Class::Day_Compute(TDateTime day, PVDay_Struct &pvday)
+{
+	pvday.Day = day;
 
 	// L'énergie du jour
-	ESolarDay = ESol(DayOfTheYear(CurrentDay));
+	pvday.ESolar = ESol(DayOfTheYear(day));
 
 	// Le lever et coucher du Soleil
-	SunRise = Sun_Hour_GPS(CurrentDay, PV_GPS, sun_rise);
-	SunSet = Sun_Hour_GPS(CurrentDay, PV_GPS, sun_set);
+	pvday.SunRise = Sun_Hour_GPS(day, PV_GPS, sun_rise);
+	pvday.SunSet = Sun_Hour_GPS(day, PV_GPS, sun_set);
+
+	Sun_Table_Init(pvday);
+}
+
+/**
+ * Table des positions du Soleil du jour, du lever au coucher avec un pas de EMULPV_SUN_STEP minutes.
+ * On stocke le vecteur unitaire de direction du Soleil plutôt que hauteur et azimut :
+ * ses composantes sont régulières même quand le Soleil passe près du zénith (l'azimut y tourne très vite),
+ * l'interpolation par spline reste précise à toutes les latitudes.
+ * Chaque position demande le calcul VSOP87 complet, seuls les points du jour sont calculés.
+ */
+void EmulPV_Class::Sun_Table_Init(PVDay_Struct &pvday)
+{
+	double hauteur, azimuth, sin_h, cos_h, sin_a, cos_a;
+
+	pvday.Sun_First = 0;
+	pvday.Sun_Last = -1;
+	// Pas de lever ou de coucher (jour ou nuit polaire)
+	if ((pvday.SunRise == 0) || (pvday.SunSet == 0))
+		return;
+
+	// Un point de plus de chaque côté pour l'interpolation
+	int16_t first = (int16_t) floor((pvday.SunRise - pvday.Day) * 1440.0 / EMULPV_SUN_STEP) - 1;
+	int16_t last = (int16_t) ceil((pvday.SunSet - pvday.Day) * 1440.0 / EMULPV_SUN_STEP) + 1;
+	if (first < 0)
+		first = 0;
+	if (last > EMULPV_SUN_SIZE - 1)
+		last = EMULPV_SUN_SIZE - 1;
+
+	for (int16_t k = first; k <= last; k++)
+	{
+		Sun_Position_Horizontal(pvday.Day + (double) (k * EMULPV_SUN_STEP) / 1440.0, PV_Site.GPS.Latitude,
+				PV_Site.GPS.Longitude, &hauteur, &azimuth);
+		SinCos_D(hauteur, &sin_h, &cos_h);
+		SinCos_D(azimuth, &sin_a, &cos_a);
+		pvday.Sun_Table[k][0] = cos_h * sin_a;
+		pvday.Sun_Table[k][1] = cos_h * cos_a;
+		pvday.Sun_Table[k][2] = sin_h;
+	}
+	pvday.Sun_First = first;
+	pvday.Sun_Last = last;
+}
+
+/**
+ * Position du Soleil pour la date-heure donnée à l'heure solaire
+ * Interpolation (spline de Catmull-Rom) dans la table du jour, sinon calcul complet
+ */
+void EmulPV_Class::Sun_Position(const PVDay_Struct &pvday, TDateTime aDateSun, double *hauteur, double *azimuth)
+{
+	double x = (aDateSun - pvday.Day) * 1440.0 / EMULPV_SUN_STEP;
+	int16_t k = (int16_t) floor(x);
+	double t, v[3];
+
+	if ((x < 0) || (k - 1 < pvday.Sun_First) || (k + 2 > pvday.Sun_Last))
+	{
+		Sun_Position_Horizontal(aDateSun, PV_Site.GPS.Latitude, PV_Site.GPS.Longitude, hauteur, azimuth);
+		return;
+	}
+
+	t = x - k;
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		double p0 = pvday.Sun_Table[k - 1][i], p1 = pvday.Sun_Table[k][i];
+		double p2 = pvday.Sun_Table[k + 1][i], p3 = pvday.Sun_Table[k + 2][i];
+		v[i] = p1 + 0.5 * t * (p2 - p0 + t * (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3 + t * (3.0 * (p1 - p2) + p3 - p0)));
+	}
+	*hauteur = ArcTan2_D(v[2], sqrt(v[0] * v[0] + v[1] * v[1]));
+	*azimuth = ArcTan2_D(v[0], v[1]);
 }
 
 /**
@@ -164,7 +377,7 @@ void EmulPV_Class::Day_Init()
  */
 TDateTime EmulPV_Class::getSunRise(bool toLocalTime)
 {
-	TDateTime dt = SunRise;
+	TDateTime dt = Today.SunRise;
 	if (toLocalTime)
 		SunHourToLocalTime(&dt);
 	return dt;
@@ -175,7 +388,7 @@ TDateTime EmulPV_Class::getSunRise(bool toLocalTime)
  */
 int EmulPV_Class::getSunRise_int(bool toLocalTime)
 {
-	TDateTime dt = SunRise;
+	TDateTime dt = Today.SunRise;
 	uint16_t hour, min, sec, msec;
 	if (toLocalTime)
 		SunHourToLocalTime(&dt);
@@ -188,7 +401,7 @@ int EmulPV_Class::getSunRise_int(bool toLocalTime)
  */
 TDateTime EmulPV_Class::getSunSet(bool toLocalTime)
 {
-	TDateTime dt = SunSet;
+	TDateTime dt = Today.SunSet;
 	if (toLocalTime)
 		SunHourToLocalTime(&dt);
 	return dt;
@@ -199,7 +412,7 @@ TDateTime EmulPV_Class::getSunSet(bool toLocalTime)
  */
 int EmulPV_Class::getSunSet_int(bool toLocalTime)
 {
-	TDateTime dt = SunSet;
+	TDateTime dt = Today.SunSet;
 	uint16_t hour, min, sec, msec;
 	if (toLocalTime)
 		SunHourToLocalTime(&dt);
@@ -260,16 +473,33 @@ void EmulPV_Class::setDateTime(uint8_t day, uint8_t month, uint8_t year)
 	TDateTime Date;
 
 	EncodeDate(2000 + year, month, day, &Date);
-	CurrentDay = Date;
+	Today.Day = Date;
 	Day_Init();
 }
 
+/**
+ * Défini la date du jour à partir de l'heure système
+ */
+void EmulPV_Class::setDateTime(void)
+{
+	time_t now = time(NULL);
+	struct tm timeinfo;
+
+	localtime_r(&now, &timeinfo);
+	setDateTime(timeinfo.tm_mday, timeinfo.tm_mon + 1, timeinfo.tm_year - 100);
+}
+
 /**
  * Calcul de l'irradiance dans le plan du capteur pour la date-heure donnée à l'heure solaire
  * Les données du jour doivent être initialisées avant (appel de PV_Day_Init)
  * Si on a une heure locale, on doit d'abord la convertir en heure solaire (appel de LocalTimeToSunHour)
  */
 double EmulPV_Class::Irradiance(TDateTime aDateSun)
+{
+	return Irradiance(Today, aDateSun);
+}
+
+double EmulPV_Class::Irradiance(const PVDay_Struct &pvday, TDateTime aDateSun)
 {
 	double hauteur, azimuth;
 	double lRSDirect;
@@ -277,10 +507,10 @@ double EmulPV_Class::Irradiance(TDateTime aDateSun)
 	double lMaskTime;
 	double result = 0.0;
 
-	if ((aDateSun <= SunRise) || (aDateSun >= SunSet))
+	if ((aDateSun <= pvday.SunRise) || (aDateSun >= pvday.SunSet))
 		return 0.0;
 
-	Sun_Position_Horizontal(aDateSun, PV_Site.GPS.Latitude, PV_Site.GPS.Longitude, &hauteur, &azimuth);
+	Sun_Position(pvday, aDateSun, &hauteur, &azimuth);
 	if (hauteur > 0)
 	{
 		// Calcul du diffus
@@ -290,7 +520,7 @@ double EmulPV_Class::Irradiance(TDateTime aDateSun)
 		if (Mask)
 		{
 			lMaskTime = frac(aDateSun);
-			if ((lMaskTime < MaskMatin) || (lMaskTime > MaskSoir))
+			if ((lMaskTime < MaskMatin) || ((MaskSoir != 0) && (lMaskTime > MaskSoir)))
 				masked = true;
 
 			if (PV_Site.UseMask && (!masked) && (GetHauteurMask(azimuth) > hauteur))
@@ -298,7 +528,7 @@ double EmulPV_Class::Irradiance(TDateTime aDateSun)
 		}
 		if (!masked)
 		{
-			lRSDirect = RSDirect(ESolarDay, hauteur, PV_Site.GPS.Altitude, PV_Site.Angstrom, PV_Site.Temperature, PV_Site.HR);
+			lRSDirect = RSDirect(pvday.ESolar, hauteur, PV_Site.GPS.Altitude, PV_Site.Angstrom, PV_Site.Temperature, PV_Site.HR);
 			result += lRSDirect
 					* Coefficient_Incidence(hauteur, azimuth, PV_Site.GPS.Inclinaison,
 							PV_Site.GPS.Orientation);
@@ -340,10 +570,15 @@ double EmulPV_Class::ComputeCellTemperature(double aTAmbiante, double aIrradianc
  * Si on a une heure locale, on doit d'abord la convertir en heure solaire (appel de LocalTimeToSunHour)
  */
 double EmulPV_Class::Power(TDateTime aDateSun)
+{
+	return Power(Today, aDateSun);
+}
+
+double EmulPV_Class::Power(const PVDay_Struct &pvday, TDateTime aDateSun)
 {
 	double _Irradiance, TempCoeff, Puissance;
 
-	_Irradiance = Irradiance(aDateSun);
+	_Irradiance = Irradiance(pvday, aDateSun);
 	if (_Irradiance == 0.0)
 		return 0.0;
 
@@ -364,14 +599,14 @@ double EmulPV_Class::Compute_Power_TH(uint32_t daytime_s)
 	int32_t time_s = daytime_s;
 	double power = last_power;
 
-	if (daytime_s != last_daytime_s)
+	if ((int32_t) daytime_s != last_daytime_s)
 	{
 		// Décalage heure solaire d'été
 		time_s -= 3600 * GLOBAL_SUMMER_HOUR;
 
 		if (time_s > 0)
 		{
-			dt = IncSecond(CurrentDay, time_s);
+			dt = IncSecond(Today.Day, time_s);
 			power = Power(dt);
 		}
 		else
@@ -383,6 +618,278 @@ double EmulPV_Class::Compute_Power_TH(uint32_t daytime_s)
 	return power;
 }
 
+// ********************************************************************************
+// Prévision de production de l'année
+// ********************************************************************************
+
+// En-tête du fichier cache
+typedef struct
+{
+		uint32_t Magic;
+		uint32_t Key;
+		uint16_t Year;
+		uint16_t Days;
+} PVForecast_Header;
+
+#define FORECAST_MAGIC	0x31465650  // "PVF1"
+
+/**
+ * Minute du jour d'un TDateTime
+ */
+static uint16_t DayMinute(TDateTime dt)
+{
+	uint16_t hour, min, sec, msec;
+	DecodeTime(dt, &hour, &min, &sec, &msec);
+	return hour * 60 + min;
+}
+
+/**
+ * Energie produite dans la journée en Wh (intégration de la puissance avec un pas de EMULPV_FORECAST_STEP minutes)
+ */
+double EmulPV_Class::Energy(const PVDay_Struct &pvday)
+{
+	const double step = EMULPV_FORECAST_STEP / 1440.0;
+	double energy = 0.0;
+
+	// Pas de lever ou de coucher (jour ou nuit polaire)
+	if ((pvday.SunRise == 0) || (pvday.SunSet == 0))
+		return 0.0;
+
+	// La puissance est nulle au lever et au coucher
+	for (TDateTime t = pvday.SunRise + step; t < pvday.SunSet; t += step)
+		energy += Power(pvday, t);
+	return energy * EMULPV_FORECAST_STEP / 60.0;
+}
+
+/**
+ * La clé du cache : FNV-1a des données du site, des paramètres du jour et de l'année
+ */
+uint32_t EmulPV_Class::Forecast_Hash(uint16_t year)
+{
+	struct
+	{
+			PVSite_Struct data;
+			double temperature, hr;
+			int32_t angstrom;
+			uint32_t horizon;
+			uint16_t year, step;
+	} key;
+	uint32_t hash = 2166136261u;
+
+	memset(&key, 0, sizeof(key));
+	key.data = PV_Data;
+	key.temperature = PV_Site.Temperature;
+	key.hr = PV_Site.HR;
+	key.angstrom = PV_Site.Angstrom;
+	key.horizon = Horizon_Hash();
+	key.year = year;
+	key.step = EMULPV_FORECAST_STEP;
+
+	const uint8_t *p = (const uint8_t*) &key;
+	for (size_t i = 0; i < sizeof(key); i++)
+	{
+		hash ^= p[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+bool EmulPV_Class::Forecast_Load(void)
+{
+	PVForecast_Header header;
+	bool result = false;
+
+	if ((Forecast_File == NULL) || Lock_File || !Data_Partition->exists(Forecast_File))
+		return false;
+
+	Lock_File = true;
+	File file = Data_Partition->open(Forecast_File, "r");
+	if (file)
+	{
+		size_t size = Forecast_Days * sizeof(PVForecast_Struct);
+		if ((file.read((uint8_t*) &header, sizeof(header)) == sizeof(header)) && (header.Magic == FORECAST_MAGIC)
+				&& (header.Key == Forecast_Key) && (header.Year == Forecast_Year) && (header.Days == Forecast_Days))
+			result = (file.read((uint8_t*) Forecast, size) == size);
+		file.close();
+	}
+	Lock_File = false;
+	return result;
+}
+
+bool EmulPV_Class::Forecast_Save(void)
+{
+	PVForecast_Header header = {FORECAST_MAGIC, Forecast_Key, Forecast_Year, Forecast_Days};
+	bool result = false;
+
+	if (Forecast_File == NULL)
+		return true;
+	if (Lock_File)
+		return false;
+
+	Lock_File = true;
+	File file = Data_Partition->open(Forecast_File, "w");
+	if (file)
+	{
+		size_t size = Forecast_Days * sizeof(PVForecast_Struct);
+		result = (file.write((const uint8_t*) &header, sizeof(header)) == sizeof(header))
+				&& (file.write((const uint8_t*) Forecast, size) == size);
+		file.close();
+	}
+	Lock_File = false;
+	return result;
+}
+
+/**
+ * Prévision de production de l'année du jour courant (setDateTime doit avoir été appelé)
+ * Calcule au plus max_days jours par appel pour ne pas bloquer : à appeler régulièrement (tâche).
+ * Le résultat est lu dans le fichier cache de la partition data s'il correspond au site,
+ * aux paramètres du jour et à l'année, sinon il est calculé puis sauvegardé.
+ * Un changement du site ou des paramètres du jour relance le calcul.
+ * Renvoie true quand la prévision de l'année est disponible.
+ */
+bool EmulPV_Class::Forecast_Update(uint16_t max_days)
+{
+	TDateTime first;
+
+	if (Today.Day == 0)
+		return false;
+
+	uint16_t year = YearOf(Today.Day);
+	uint32_t key = Forecast_Hash(year);
+	if ((Forecast == NULL) || (key != Forecast_Key) || (year != Forecast_Year))
+	{
+		if (Forecast == NULL)
+		{
+			Forecast = (PVForecast_Struct*) malloc(366 * sizeof(PVForecast_Struct));
+			if (Forecast == NULL)
+				return false;
+		}
+		Forecast_Done = 0;
+		Forecast_Key = key;
+		Forecast_Year = year;
+		Forecast_Days = (IsLeapYear(year)) ? 366 : 365;
+		Forecast_Saved = Forecast_Load();
+		if (Forecast_Saved)
+			Forecast_Done = Forecast_Days;
+	}
+
+	if (Forecast_Done < Forecast_Days)
+	{
+		if (Forecast_Day == NULL)
+		{
+			Forecast_Day = (PVDay_Struct*) malloc(sizeof(PVDay_Struct));
+			if (Forecast_Day == NULL)
+				return false;
+		}
+
+		EncodeDate(year, 1, 1, &first);
+		while ((Forecast_Done < Forecast_Days) && (max_days > 0))
+		{
+			PVForecast_Struct *day = &Forecast[Forecast_Done];
+			Day_Compute(first + Forecast_Done, *Forecast_Day);
+			day->Energy = Energy(*Forecast_Day);
+			day->SunRise = DayMinute(Forecast_Day->SunRise);
+			day->SunSet = DayMinute(Forecast_Day->SunSet);
+			Forecast_Done = Forecast_Done + 1;
+			max_days--;
+		}
+
+		if (Forecast_Done == Forecast_Days)
+		{
+			free(Forecast_Day);
+			Forecast_Day = NULL;
+		}
+	}
+
+	// Nouvel essai au prochain appel si la partition est occupée
+	if ((Forecast_Done == Forecast_Days) && !Forecast_Saved)
+	{
+		// Le site a pu changer pendant le calcul (page web) : pas de sauvegarde sous l'ancienne clé,
+		// le calcul est relancé au prochain appel
+		if (Forecast_Hash(Forecast_Year) != Forecast_Key)
+			return false;
+		Forecast_Saved = Forecast_Save();
+	}
+
+	return (Forecast_Done == Forecast_Days);
+}
+
+/**
+ * Energie prévue en Wh pour le jour de l'année (1 pour le 1er janvier)
+ * Renvoie -1 si ce jour n'est pas encore calculé
+ */
+double EmulPV_Class::getDayEnergy(uint16_t day_of_year)
+{
+	if ((day_of_year == 0) || (day_of_year > Forecast_Done))
+		return -1;
+	return Forecast[day_of_year - 1].Energy;
+}
+
+/**
+ * Energie prévue en Wh pour aujourd'hui (offset_day = 0), demain (1), ...
+ * Lue dans la prévision si elle est disponible, sinon calculée
+ */
+double EmulPV_Class::getEnergy(uint8_t offset_day)
+{
+	TDateTime day = Today.Day + offset_day;
+	double energy;
+
+	if (Today.Day == 0)
+		return 0.0;
+
+	if (YearOf(day) == Forecast_Year)
+	{
+		energy = getDayEnergy(DayOfTheYear(day));
+		if (energy >= 0)
+			return energy;
+	}
+
+	if (offset_day == 0)
+		return Energy(Today);
+
+	PVDay_Struct *pvday = (PVDay_Struct*) malloc(sizeof(PVDay_Struct));
+	if (pvday == NULL)
+		return 0.0;
+	Day_Compute(day, *pvday);
+	energy = Energy(*pvday);
+	free(pvday);
+	return energy;
+}
+
+/**
+ * Décalage en minutes de l'heure locale pour le jour de l'année de la prévision
+ * L'heure d'été est celle de ce jour (SummerHourOf), pas celle d'aujourd'hui
+ */
+int EmulPV_Class::Forecast_LocalOffset(uint16_t day_of_year)
+{
+	TDateTime first;
+
+	EncodeDate(Forecast_Year, 1, 1, &first);
+	return SummerHourOf(first + day_of_year - 1) * 60;
+}
+
+/**
+ * Heure du lever du Soleil en minute du jour de l'année, à l'heure solaire ou locale
+ * L'heure locale tient compte de l'heure d'été du jour demandé
+ * Renvoie -1 si ce jour n'est pas encore calculé
+ */
+int EmulPV_Class::getDaySunRise_int(uint16_t day_of_year, bool toLocalTime)
+{
+	if ((day_of_year == 0) || (day_of_year > Forecast_Done))
+		return -1;
+	return Forecast[day_of_year - 1].SunRise + ((toLocalTime) ? Forecast_LocalOffset(day_of_year) : 0);
+}
+
+/**
+ * Heure du coucher du Soleil en minute du jour de l'année, à l'heure solaire ou locale
+ */
+int EmulPV_Class::getDaySunSet_int(uint16_t day_of_year, bool toLocalTime)
+{
+	if ((day_of_year == 0) || (day_of_year > Forecast_Done))
+		return -1;
+	return Forecast[day_of_year - 1].SunSet + ((toLocalTime) ? Forecast_LocalOffset(day_of_year) : 0);
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
@@ -16,6 +16,18 @@
 
 #define PVDATA_MAX   12
 
+// Pas en minute de la table des positions du Soleil du jour (voir Sun_Table_Init)
+#ifndef EMULPV_SUN_STEP
+#define EMULPV_SUN_STEP   10
+#endif
+#define EMULPV_SUN_SIZE   (1440 / EMULPV_SUN_STEP + 1)
+
+// Prévision de production : pas d'intégration en minute et fichier cache sur la partition data
+#ifndef EMULPV_FORECAST_STEP
+#define EMULPV_FORECAST_STEP   5
+#endif
+#define EMULPV_FORECAST_FILE   "/PV_Forecast.bin"
+
 typedef union
 {
 		float Tab[PVDATA_MAX];
@@ -72,10 +84,34 @@ typedef enum
 	pvMAXDATA
 } PVData_Enum;
 
+/**
+ * Les données d'un jour : lever et coucher du Soleil, énergie solaire,
+ * table des positions du Soleil (vecteur direction) de lever à coucher
+ */
+typedef struct
+{
+		TDateTime Day;
+		TDateTime SunRise, SunSet;
+		double ESolar;
+		float Sun_Table[EMULPV_SUN_SIZE][3];
+		int16_t Sun_First, Sun_Last;
+} PVDay_Struct;
+
+/**
+ * Prévision d'un jour : énergie produite en Wh, lever et coucher du Soleil en minute (heure solaire)
+ */
+typedef struct
+{
+		float Energy;
+		uint16_t SunRise;
+		uint16_t SunSet;
+} PVForecast_Struct;
+
 class EmulPV_Class
 {
 	public:
 		EmulPV_Class();
+		~EmulPV_Class();
 
 		void Init_From_Array(const PVSite_Struct &data);
 		void Init_From_File(const char *file);
@@ -83,6 +119,11 @@ class EmulPV_Class
 		void Save_To_File(IniFiles &init_file);
 		void Set_DayParameters(TAngstromCoeff ang, double temp, double hr);
 
+		// Profil d'horizon (voir Horizon_Set() de rayonnement)
+		bool Horizon_From_String(const char *profile);
+		bool Horizon_From_File(const char *file);
+		void Horizon_Remove(void);
+
 		TDateTime getSunRise(bool toLocalTime);
 		int getSunRise_int(bool toLocalTime);
 		TDateTime getSunSet(bool toLocalTime);
@@ -90,6 +131,7 @@ class EmulPV_Class
 		TDateTime getSunTransit(TDateTime day, bool toLocalTime);
 		char *SunRise_SunSet(void);
 		void setDateTime(uint8_t day, uint8_t month, uint8_t year);
+		void setDateTime(void);
 		void setSummerTime(bool summer)
 		{
 			GLOBAL_SUMMER_HOUR = (summer) ? 2 : 1;
@@ -112,6 +154,27 @@ class EmulPV_Class
 
 		template <typename T> void Fill_Power_Day(uint32_t daytime_minute, uint32_t nb_data, T *data);
 
+		// Prévision de production de l'année du jour courant
+		// Le lever et le coucher du Soleil sont en minute du jour, le format des plages d'Alarm_Minute.
+		// La programmation des alarmes (relais, boost) à partir de la prévision est laissée à l'appelant.
+		void setForecastFile(const char *file)
+		{
+			Forecast_File = file;
+		}
+		bool Forecast_Update(uint16_t max_days = 366);
+		bool Forecast_Ready(void) const
+		{
+			return (Forecast_Days != 0) && (Forecast_Done == Forecast_Days);
+		}
+		uint16_t Forecast_Count(void) const
+		{
+			return Forecast_Done;
+		}
+		double getDayEnergy(uint16_t day_of_year);
+		double getEnergy(uint8_t offset_day = 0);
+		int getDaySunRise_int(uint16_t day_of_year, bool toLocalTime);
+		int getDaySunSet_int(uint16_t day_of_year, bool toLocalTime);
+
 	private:
 		TGPSPosition PV_GPS;
 		TSite PV_Site;
@@ -120,10 +183,6 @@ class EmulPV_Class
 		double MaskMatin = 0, MaskSoir = 0;
 		bool Mask = false;
 
-		// Energie solaire du jour
-		double ESolarDay = 0;
-		TDateTime SunRise = 0, SunSet = 0;
-
 		double PV_Puissance;
 
 		double PV_NOCT, PV_TempCoeffPuissance;
@@ -132,14 +191,36 @@ class EmulPV_Class
 		double Rendement;
 		bool UsePOnduleurACMax = false;
 
-		TDateTime CurrentDay = 0;
+		// Le jour courant
+		PVDay_Struct Today = { };
 		char Sun_Rise_Sun_Set[20] = {0};
 
 		// Compute_Power_TH computation
 		int32_t last_daytime_s= 0;
 		double last_power = 0.0;
 
+		// Prévision de l'année (voir Forecast_Update)
+		PVForecast_Struct *Forecast = NULL;
+		PVDay_Struct *Forecast_Day = NULL;  // Le jour en cours de calcul
+		const char *Forecast_File = EMULPV_FORECAST_FILE;
+		uint32_t Forecast_Key = 0;
+		uint16_t Forecast_Year = 0;
+		uint16_t Forecast_Days = 0;
+		volatile uint16_t Forecast_Done = 0;
+		bool Forecast_Saved = false;
+
 		void Day_Init();
+		void Mask_Update(void);
+		void Day_Compute(TDateTime day, PVDay_Struct &pvday);
+		void Sun_Table_Init(PVDay_Struct &pvday);
+		void Sun_Position(const PVDay_Struct &pvday, TDateTime aDateSun, double *hauteur, double *azimuth);
+		double Irradiance(const PVDay_Struct &pvday, TDateTime aDateSun);
+		double Power(const PVDay_Struct &pvday, TDateTime aDateSun);
+		double Energy(const PVDay_Struct &pvday);
+		uint32_t Forecast_Hash(uint16_t year);
+		int Forecast_LocalOffset(uint16_t day_of_year);
+		bool Forecast_Load(void);
+		bool Forecast_Save(void);
 		void SetRendement(void);
 		double ComputeCellTemperature(double aTAmbiante, double aIrradiance);
 };
@@ -346,6 +346,25 @@ void LocalTimeToSunHour(TDateTime *localHour)
   *localHour = IncHour(dt, -(GLOBAL_SUMMER_HOUR));
 }
 
+/**
+ * Décalage de l'heure locale (GMT +1) pour un jour donné, règle européenne :
+ * 2 du dernier dimanche de mars au samedi précédant le dernier dimanche d'octobre, sinon 1
+ * Le changement a lieu la nuit, avant le lever du Soleil
+ */
+uint8_t SummerHourOf(const TDateTime AValue)
+{
+  uint16_t year = YearOf(AValue);
+  TDateTime march = 0, october = 0;
+  int32_t day = (int32_t) trunc(AValue);
+
+  if (!EncodeDate(year, 3, 31, &march) || !EncodeDate(year, 10, 31, &october))
+    return 1;
+  // Le jour 1 (31/12/1899) est un dimanche
+  int32_t start = (int32_t) march - (((int32_t) march - 1) % 7);
+  int32_t end = (int32_t) october - (((int32_t) october - 1) % 7);
+  return ((day >= start) && (day < end)) ? 2 : 1;
+}
+
 void DecodeDMS(const double val, int16_t *Deg, uint16_t *Min, uint16_t *Sec)
 {
   double MinCount;
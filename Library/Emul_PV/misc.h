@@ -52,6 +52,7 @@ char *DoubleToDMS(const double val, char *str);
 // Heure solaire
 void SunHourToLocalTime(TDateTime *sunHour);
 void LocalTimeToSunHour(TDateTime *localHour);
+uint8_t SummerHourOf(const TDateTime AValue);
 
 
 #endif /* __MISC_H */
@@ -1,5 +1,7 @@
 #include "rayonnement.h"
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 const char *cAngstromString[TAngstromCoeff_Size] = {"Bleu profond (B = 0,01)",
 		"Bleu foncé (B = 0,02)", "Bleu pur (B = 0,035)", "Bleu (B = 0,05)", "Bleu délavé (B = 0,07)",
@@ -8,7 +10,21 @@ const char *cAngstromShortString[TAngstromCoeff_Size] = {"Bleu profond", "Bleu f
 		"Bleu", "Bleu délavé", "Bleu laiteux", "Bleu voilé", "Bleu blanc"};
 const double cAngstromCoeff[TAngstromCoeff_Size] = {0.01, 0.02, 0.035, 0.05, 0.07, 0.15, 0.25, 0.50};
 
-TMaskPoint GlobalMask[37] = {0, 0};
+/**
+ * Le profil d'horizon, trié par azimut.
+ * Step est le pas en degré quand les points sont régulièrement espacés : le segment
+ * est alors trouvé directement par index, sinon par recherche dichotomique.
+ */
+typedef struct
+{
+		float *Azimut;
+		float *Hauteur;
+		uint16_t Count;
+		double Step;
+		uint32_t Hash;
+} THorizon;
+
+static THorizon Horizon = {NULL, NULL, 0, 0, 0};
 
 // ********************************************
 // Fonctions locales
@@ -131,7 +147,7 @@ double Coefficient_Incidence(double aHauteurSoleil, double aAzimut, double aIncl
 // ESol = 1367 x (1 + 0,0334 x cos(360 x (j - 2,7206) / 365,25)), en W/m²
 // j étant le numéro d'ordre du jour dans l'année (1 pour le 1er janvier)
 
-inline double ESol(int aJour)
+double ESol(int aJour)
 {
 	return 1367 * (1.0 + 0.0334 * cos(2 * M_PI * (aJour - 2.7206) / 365.25));
 }
@@ -140,38 +156,196 @@ inline double ESol(int aJour)
 // Fonctions publiées
 // ********************************************
 
+/**
+ * Définit le profil d'horizon à partir de aCount points (azimut, hauteur) dans un ordre quelconque.
+ * Les azimuts sont ramenés entre -180 et 180, pour un même azimut on garde la hauteur la plus grande.
+ * Renvoie false si le nombre de points est incorrect ou en cas de manque de mémoire
+ * (le profil précédent est alors conservé).
+ */
+bool Horizon_Set(const TMaskPoint *aPoints, uint16_t aCount)
+{
+	float *lAzimut, *lHauteur;
+	float a, h;
+	uint16_t i, j, n;
+
+	if ((aCount == 0) || (aCount > HORIZON_MAX_POINTS))
+		return false;
+
+	lAzimut = (float*) malloc(2 * aCount * sizeof(float));
+	if (lAzimut == NULL)
+		return false;
+	lHauteur = &lAzimut[aCount];
+
+	// Tri par insertion : les profils sont en général déjà triés
+	n = 0;
+	for (i = 0; i < aCount; i++)
+	{
+		a = fmod(aPoints[i].Azimut + 180.0, 360.0);
+		if (a < 0)
+			a += 360;
+		a -= 180;
+		h = aPoints[i].Hauteur;
+
+		j = n;
+		while ((j > 0) && (lAzimut[j - 1] > a))
+			j--;
+		if ((j > 0) && (fabs(lAzimut[j - 1] - a) < 1E-4))
+		{
+			if (h > lHauteur[j - 1])
+				lHauteur[j - 1] = h;
+			continue;
+		}
+		memmove(&lAzimut[j + 1], &lAzimut[j], (n - j) * sizeof(float));
+		memmove(&lHauteur[j + 1], &lHauteur[j], (n - j) * sizeof(float));
+		lAzimut[j] = a;
+		lHauteur[j] = h;
+		n++;
+	}
+	// Les hauteurs sont après les n azimuts
+	if (n < aCount)
+		memmove(&lAzimut[n], lHauteur, n * sizeof(float));
+	lHauteur = &lAzimut[n];
+
+	free(Horizon.Azimut);
+	Horizon.Azimut = lAzimut;
+	Horizon.Hauteur = lHauteur;
+	Horizon.Count = n;
+
+	// Pas constant ?
+	Horizon.Step = 0;
+	if (n > 2)
+	{
+		double step = (lAzimut[n - 1] - lAzimut[0]) / (n - 1);
+		for (i = 1; i < n; i++)
+			if (fabs(lAzimut[i] - (lAzimut[0] + i * step)) > 1E-3)
+				break;
+		if (i == n)
+			Horizon.Step = step;
+	}
+
+	// Empreinte du profil (FNV-1a)
+	Horizon.Hash = 2166136261u;
+	const uint8_t *p = (const uint8_t*) lAzimut;
+	for (i = 0; i < 2 * n * sizeof(float); i++)
+	{
+		Horizon.Hash ^= p[i];
+		Horizon.Hash *= 16777619u;
+	}
+	return true;
+}
+
+/**
+ * Supprime le profil d'horizon
+ */
+void Horizon_Clear(void)
+{
+	free(Horizon.Azimut);
+	Horizon.Azimut = NULL;
+	Horizon.Hauteur = NULL;
+	Horizon.Count = 0;
+	Horizon.Step = 0;
+	Horizon.Hash = 0;
+}
+
+/**
+ * Nombre de points du profil d'horizon, 0 si pas de profil
+ */
+uint16_t Horizon_Count(void)
+{
+	return Horizon.Count;
+}
+
+/**
+ * Empreinte du profil d'horizon (pour savoir si un calcul dépendant du profil est à refaire)
+ */
+uint32_t Horizon_Hash(void)
+{
+	return Horizon.Hash;
+}
+
+/**
+ * Un exemple de profil : une colline de 63° au sud-est (pas de 10°)
+ */
 void FillSampleMask(void)
 {
+	TMaskPoint lMask[37];
 	int i;
 
 	for (i = 0; i <= 36; i++)
 	{
-		GlobalMask[i].Azimut = -180 + i * 10;
-		GlobalMask[i].Hauteur = 0;
+		lMask[i].Azimut = -180 + i * 10;
+		lMask[i].Hauteur = 0;
 	}
 	for (i = 9; i <= 18; i++)
-		GlobalMask[i].Hauteur = (i - 9) * 7;
+		lMask[i].Hauteur = (i - 9) * 7;
 	for (i = 19; i <= 27; i++)
-		GlobalMask[i].Hauteur = (27 - i) * 7;
+		lMask[i].Hauteur = (27 - i) * 7;
+	Horizon_Set(lMask, 37);
 }
 
+/**
+ * Hauteur de l'horizon (degré) pour l'azimut donné (degré), 0 si pas de profil
+ */
 double GetHauteurMask(double aAzimut)
 {
-	int i;
-	double a;
-
-//  if (! Assigned(GlobalMask)) || (High(GlobalMask) < 2))
-//    return 0.0;
-//  else
+	const float *lAzimut = Horizon.Azimut;
+	const float *lHauteur = Horizon.Hauteur;
+	int n = Horizon.Count;
+	double a0, a1, h0, h1;
+	int i, lo, hi;
+
+	if (n == 0)
+		return 0.0;
+	if (n == 1)
+		return lHauteur[0];
+
+	if (aAzimut < -180)
+		aAzimut += 360;
+	else
+		if (aAzimut >= 180)
+			aAzimut -= 360;
+
+	if ((aAzimut < lAzimut[0]) || (aAzimut >= lAzimut[n - 1]))
 	{
-		i = 1;
-		while ((i < sizeof(GlobalMask)) && (GlobalMask[i].Azimut < aAzimut))
-			i++;
-		// Interpolation linéaire : y = ax + b;  Hauteur = a.Azimut + b
-		a = (GlobalMask[i].Hauteur - GlobalMask[i - 1].Hauteur)
-				/ (GlobalMask[i].Azimut - GlobalMask[i - 1].Azimut);
-		return a * (aAzimut - GlobalMask[i].Azimut) + GlobalMask[i].Hauteur;
+		// Entre le dernier point et le premier (passage par le nord)
+		a0 = lAzimut[n - 1];
+		h0 = lHauteur[n - 1];
+		a1 = lAzimut[0] + 360.0;
+		h1 = lHauteur[0];
+		if (aAzimut < lAzimut[0])
+			aAzimut += 360;
+	}
+	else
+	{
+		if (Horizon.Step != 0)
+		{
+			i = (int) ((aAzimut - lAzimut[0]) / Horizon.Step);
+			if (i > n - 2)
+				i = n - 2;
+		}
+		else
+		{
+			// lAzimut[lo] <= aAzimut < lAzimut[hi]
+			lo = 0;
+			hi = n - 1;
+			while (hi - lo > 1)
+			{
+				i = (lo + hi) >> 1;
+				if (lAzimut[i] <= aAzimut)
+					lo = i;
+				else
+					hi = i;
+			}
+			i = lo;
+		}
+		a0 = lAzimut[i];
+		h0 = lHauteur[i];
+		a1 = lAzimut[i + 1];
+		h1 = lHauteur[i + 1];
 	}
+
+	// Interpolation linéaire
+	return h0 + (h1 - h0) * (aAzimut - a0) / (a1 - a0);
 }
 
 /**
@@ -201,7 +375,7 @@ double Irradiance(TDateTime aDateSun, TSite aSite)
 		lMaskMatin = frac(aSite.MaskMatin);
 		lMaskSoir = frac(aSite.MaskSoir);
 		lMaskTime = frac(aDateSun);
-		if ((lMaskTime < lMaskMatin) || (lMaskTime > lMaskSoir))
+		if ((lMaskTime < lMaskMatin) || ((lMaskSoir != 0) && (lMaskTime > lMaskSoir)))
 			masked = true;
 	}
 
@@ -288,7 +462,7 @@ void Sun_Irradiance_Day(TDateTime aDateSun, TSite aSite, double *aIrr)
 			if (mask)
 			{
 				lMaskTime = frac(lTime);
-				if ((lMaskTime < lMaskMatin) || (lMaskTime > lMaskSoir))
+				if ((lMaskTime < lMaskMatin) || ((lMaskSoir != 0) && (lMaskTime > lMaskSoir)))
 					masked = true;
 				if (aSite.UseMask && (GetHauteurMask(azimuth) > hauteur))
 					masked = true;
@@ -48,7 +48,7 @@ typedef struct
  * 	Name : Nom du site (facultatif)
  * 	GPS : position du site au format TGPS
  * 	MaskMatin, MaskSoir : les heures (heure solaire) des masques matin et soir
- * 	UseMask : booléen indiquant si on tient compte des masques dans le tableau GlobalMask (37 points)
+ * 	UseMask : booléen indiquant si on tient compte du profil d'horizon (voir Horizon_Set())
  * 	Temperature : Température moyenne du jour
  * 	HR : Humidité relative en pourcentage du jour
  * 	Angstrom : Coefficients d'Angström = couleur du ciel
@@ -81,6 +81,21 @@ double Time_Equation(TDateTime aDate);
 TDateTime DateTimeToSunTime(TDateTime aDate, double aLongitude, int aDecalage);
 TDateTime SunTimeToDateTime(TDateTime aSunDate, double aLongitude, int aDecalage);
 
+/**
+ * Profil d'horizon (masque lointain) : hauteur de l'horizon en fonction de l'azimut, en degré.
+ * L'azimut est celui de Sun_Position_Horizontal() : 0 = sud, positif vers l'ouest (-180 à 180),
+ * c'est aussi la convention des fichiers horizon de PVGIS.
+ * Les points sont quelconques (résolution libre, HORIZON_MAX_POINTS au plus), la hauteur entre
+ * deux points est interpolée linéairement et le profil est refermé entre le dernier et le premier point.
+ */
+#ifndef HORIZON_MAX_POINTS
+#define HORIZON_MAX_POINTS	720
+#endif
+
+bool Horizon_Set(const TMaskPoint *aPoints, uint16_t aCount);
+void Horizon_Clear(void);
+uint16_t Horizon_Count(void);
+uint32_t Horizon_Hash(void);
 double GetHauteurMask(double aAzimut);
 void FillSampleMask(void);
 
@@ -8,26 +8,23 @@
 #include <math.h>
 #include "misc.h"
 
-#define meeus  //  Only use the accuracy as in the Meeus book
+// *****************************
+// Earth series (vsop87_data.cpp)
+// *****************************
 
-typedef struct
-{
-  double a;
-  double b;
-  double c;
-} TVSOPEntry;
-  
-typedef void (*TVSOPCalcFunc) (int , uint8_t, TVSOPEntry *);
+extern const TVSOPSeries vsop87_ear_r[];
+extern const uint8_t vsop87_ear_r_count;
+extern const TVSOPSeries vsop87_ear_b[];
+extern const uint8_t vsop87_ear_b_count;
+extern const TVSOPSeries vsop87_ear_l[];
+extern const uint8_t vsop87_ear_l_count;
 
 // *****************************
 // Private functions prototype
 // *****************************
 
-double TVSOP_Calc(TVSOPCalcFunc Factor, uint8_t id);
+double TVSOP_Calc(const TVSOPSeries *series, uint8_t count);
 void TVSOP_DynamicToFK5(double *longitude, double *latitude);
-static void TVSOPEarth_LongitudeFactor(int nr, uint8_t index, TVSOPEntry *result);
-static void TVSOPEarth_LatitudeFactor(int nr, uint8_t index, TVSOPEntry *result);
-static void TVSOPEarth_RadiusFactor(int nr, uint8_t index, TVSOPEntry *result);
 
 TDateTime datetime_2000_01_01 = 36526;
 static double Tau;
@@ -40,9 +37,9 @@ void earth_coord(TDateTime date, double *l, double *b, double *r)
 {
   Tau = (date-datetime_2000_01_01-0.5)/365250.0;
   
-  *r = TVSOP_Calc(TVSOPEarth_RadiusFactor, 1);
-  *l = TVSOP_Calc(TVSOPEarth_LongitudeFactor, 2);
-  *b = TVSOP_Calc(TVSOPEarth_LatitudeFactor, 3);
+  *r = TVSOP_Calc(vsop87_ear_r, vsop87_ear_r_count);
+  *l = TVSOP_Calc(vsop87_ear_l, vsop87_ear_l_count);
+  *b = TVSOP_Calc(vsop87_ear_b, vsop87_ear_b_count);
   TVSOP_DynamicToFK5(l,b);
   *l = Put_in_360(RadToDeg(*l));  // rad -> degree
   *b = RadToDeg(*b);
@@ -52,34 +49,26 @@ void earth_coord(TDateTime date, double *l, double *b, double *r)
 // Private functions
 // *****************************
 
-double TVSOP_Calc(TVSOPCalcFunc Factor, uint8_t id)
+/**
+ * Somme des séries d'une coordonnée : r0 + tau.(r1 + tau.(r2 + ...))
+ * Chaque série est parcourue sur sa taille, sans appel de fonction ni test sur les termes
+ */
+double TVSOP_Calc(const TVSOPSeries *series, uint8_t count)
 {
-  double t;
-  double current = 0;
-  double r[6];
-  int i;
-  uint8_t j;
-  TVSOPEntry result; 
+  const double t = Tau;
+  double result = 0;
 
-  t = Tau;
-  for (j = 0; j < 6; j++)
+  for (int8_t j = count - 1; j >= 0; j--)
   {
-    r[j] = 0;
-    i = 0;
-    do
-    {
-//      switch (id) {
-//	case 1: TVSOPEarth_RadiusFactor(i, j, &result); break;
-//	case 2: TVSOPEarth_LongitudeFactor(i, j, &result); break;
-//	case 3: TVSOPEarth_LatitudeFactor(i, j, &result); break;
-//      }
-      Factor(i, j, &result);
-      current = result.a*cos(result.b + result.c*t);
-      r[j] += current;
-      i++;
-    } while (current != 0);
+    const double (*term)[3] = series[j].terms;
+    const uint16_t size = series[j].size;
+    double sum = 0;
+
+    for (uint16_t i = 0; i < size; i++)
+      sum += term[i][0]*cos(term[i][1] + term[i][2]*t);
+    result = result*t + sum;
   }
-  return (r[0]+t*(r[1]+t*(r[2]+t*(r[3]+t*(r[4]+t*r[5])))))*1e-8;
+  return result*1e-8;
 }
 
 void TVSOP_DynamicToFK5(double *longitude, double *latitude)
@@ -98,135 +87,3 @@ void TVSOP_DynamicToFK5(double *longitude, double *latitude)
   *longitude += delta_l;
   *latitude += delta_b;
 }
-
-// *****************************
-// Private Earth specific functions
-// *****************************
-
-extern const uint16_t vsop87_ear_r0_size;
-extern const double vsop87_ear_r0[][3];
-extern const uint16_t vsop87_ear_r1_size;
-extern const double vsop87_ear_r1[][3];
-extern const uint16_t vsop87_ear_r2_size;
-extern const double vsop87_ear_r2[][3];
-extern const uint16_t vsop87_ear_r3_size;
-extern const double vsop87_ear_r3[][3];
-extern const uint16_t vsop87_ear_r4_size;
-extern const double vsop87_ear_r4[][3];
-extern const uint16_t vsop87_ear_r5_size;
-extern const double vsop87_ear_r5[][3];
-
-static void TVSOPEarth_RadiusFactor(int nr, uint8_t index, TVSOPEntry *result)
-{
-  result->a = 0.0; result->b = 0.0; result->c = 0.0;
-  switch (index) {
-    case 0 : if ((nr>=0) && (nr<vsop87_ear_r0_size)) {
-      result->a = vsop87_ear_r0[nr][0];  result->b = vsop87_ear_r0[nr][1];  result->c = vsop87_ear_r0[nr][2];
-      }
-      break;
-    case 1 : if ((nr>=0) && (nr<vsop87_ear_r1_size)) {
-      result->a = vsop87_ear_r1[nr][0];  result->b = vsop87_ear_r1[nr][1];  result->c = vsop87_ear_r1[nr][2];
-      }
-      break;
-    case 2 : if ((nr>=0) && (nr<vsop87_ear_r2_size)) {
-      result->a = vsop87_ear_r2[nr][0];  result->b = vsop87_ear_r2[nr][1];  result->c = vsop87_ear_r2[nr][2];
-      }
-      break;
-    case 3 : if ((nr>=0) && (nr<vsop87_ear_r3_size)) {
-      result->a = vsop87_ear_r3[nr][0];  result->b = vsop87_ear_r3[nr][1];  result->c = vsop87_ear_r3[nr][2];
-      }
-      break;
-    case 4 : if ((nr>=0) && (nr<vsop87_ear_r4_size)) {
-      result->a = vsop87_ear_r4[nr][0];  result->b = vsop87_ear_r4[nr][1];  result->c = vsop87_ear_r4[nr][2];
-      }
-      break;
-    case 5 : if ((nr>=0) && (nr<vsop87_ear_r5_size)) {
-      result->a = vsop87_ear_r5[nr][0];  result->b = vsop87_ear_r5[nr][1];  result->c = vsop87_ear_r5[nr][2];
-      }
-      break;
-    }
-}
-
-extern const uint16_t vsop87_ear_b0_size;
-extern const double vsop87_ear_b0[][3];
-extern const uint16_t vsop87_ear_b1_size;
-extern const double vsop87_ear_b1[][3];
-extern const uint16_t vsop87_ear_b2_size;
-extern const double vsop87_ear_b2[][3];
-extern const uint16_t vsop87_ear_b3_size;
-extern const double vsop87_ear_b3[][3];
-extern const uint16_t vsop87_ear_b4_size;
-extern const double vsop87_ear_b4[][3];
-
-static void TVSOPEarth_LatitudeFactor(int nr, uint8_t index, TVSOPEntry *result)
-{
-  result->a = 0.0; result->b = 0.0; result->c = 0.0;
-  switch (index) {
-    case 0 : if ((nr>=0) && (nr<vsop87_ear_b0_size)) {
-      result->a = vsop87_ear_b0[nr][0];  result->b = vsop87_ear_b0[nr][1];  result->c = vsop87_ear_b0[nr][2];
-      }
-      break;
-    case 1 : if ((nr>=0) && (nr<vsop87_ear_b1_size)) {
-      result->a = vsop87_ear_b1[nr][0];  result->b = vsop87_ear_b1[nr][1];  result->c = vsop87_ear_b1[nr][2];
-      }
-      break;
-    case 2 : if ((nr>=0) && (nr<vsop87_ear_b2_size)) {
-      result->a = vsop87_ear_b2[nr][0];  result->b = vsop87_ear_b2[nr][1];  result->c = vsop87_ear_b2[nr][2];
-      }
-      break;
-    case 3 : if ((nr>=0) && (nr<vsop87_ear_b3_size)) {
-      result->a = vsop87_ear_b3[nr][0];  result->b = vsop87_ear_b3[nr][1];  result->c = vsop87_ear_b3[nr][2];
-      }
-      break;
-    case 4 : if ((nr>=0) && (nr<vsop87_ear_b4_size)) {
-      result->a = vsop87_ear_b4[nr][0];  result->b = vsop87_ear_b4[nr][1];  result->c = vsop87_ear_b4[nr][2];
-      }
-      break;
-    }
-}
-
-extern const uint16_t vsop87_ear_l0_size;
-extern const double vsop87_ear_l0[][3];
-extern const uint16_t vsop87_ear_l1_size;
-extern const double vsop87_ear_l1[][3];
-extern const uint16_t vsop87_ear_l2_size;
-extern const double vsop87_ear_l2[][3];
-extern const uint16_t vsop87_ear_l3_size;
-extern const double vsop87_ear_l3[][3];
-extern const uint16_t vsop87_ear_l4_size;
-extern const double vsop87_ear_l4[][3];
-extern const uint16_t vsop87_ear_l5_size;
-extern const double vsop87_ear_l5[][3];
-
-static void TVSOPEarth_LongitudeFactor(int nr, uint8_t index, TVSOPEntry *result)
-{
-  result->a = 0.0; result->b = 0.0; result->c = 0.0;
-  switch (index) {
-    case 0 : if ((nr>=0) && (nr<vsop87_ear_l0_size)) {
-      result->a = vsop87_ear_l0[nr][0];  result->b = vsop87_ear_l0[nr][1];  result->c = vsop87_ear_l0[nr][2];
-      }
-      break;
-    case 1 : if ((nr>=0) && (nr<vsop87_ear_l1_size)) {
-      result->a = vsop87_ear_l1[nr][0];  result->b = vsop87_ear_l1[nr][1];  result->c = vsop87_ear_l1[nr][2];
-      }
-      break;
-    case 2 : if ((nr>=0) && (nr<vsop87_ear_l2_size)) {
-      result->a = vsop87_ear_l2[nr][0];  result->b = vsop87_ear_l2[nr][1];  result->c = vsop87_ear_l2[nr][2];
-      }
-      break;
-    case 3 : if ((nr>=0) && (nr<vsop87_ear_l3_size)) {
-      result->a = vsop87_ear_l3[nr][0];  result->b = vsop87_ear_l3[nr][1];  result->c = vsop87_ear_l3[nr][2];
-      }
-      break;
-    case 4 : if ((nr>=0) && (nr<vsop87_ear_l4_size)) {
-      result->a = vsop87_ear_l4[nr][0];  result->b = vsop87_ear_l4[nr][1];  result->c = vsop87_ear_l4[nr][2];
-      }
-      break;
-    case 5 : if ((nr>=0) && (nr<vsop87_ear_l5_size)) {
-      result->a = vsop87_ear_l5[nr][0];  result->b = vsop87_ear_l5[nr][1];  result->c = vsop87_ear_l5[nr][2];
-      }
-      break;
-    }
-}
-
-
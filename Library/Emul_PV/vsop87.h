@@ -2,11 +2,31 @@
 #ifndef __VSOP87_H
 #define __VSOP87_H
 
+#ifdef USE_CONFIG_LIB_FILE
+#include "config_lib.h"
+#endif
+
 #include <stdint.h>
 #include <stdbool.h>
 
 #include "misc.h"
 
+// Précision des séries : celle du livre de Meeus (195 termes) par défaut,
+// définir VSOP87_FULL pour les séries complètes (2429 termes)
+#ifndef VSOP87_FULL
+#define VSOP87_MEEUS
+#endif
+
+/**
+ * Une série VSOP87 : size termes a.cos(b + c.tau), chaque terme est une ligne {a, b, c}
+ * Les séries d'une coordonnée sont rangées par puissance de tau (voir vsop87_data.cpp)
+ */
+typedef struct
+{
+  const double (*terms)[3];
+  uint16_t size;
+} TVSOPSeries;
+
 void earth_coord(TDateTime date, double *l, double *b, double *r);
 
 #endif /* __VSOP87_H */
@@ -1,13 +1,12 @@
 
 #include <stdint.h>
-
-#define meeus  //  Only use the accuracy as in the Meeus book
+#include "vsop87.h"
 
 // *****************************
 // Earth_Radius Factor
 // *****************************
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_r0_size = 40;
 #else
   extern const uint16_t vsop87_ear_r0_size = 526;
@@ -52,12 +51,12 @@
   /* 4330   37 */  {        36.957, 4.90107591914,  12139.55350910680 },
   /* 4330   38 */  {        34.537, 1.84270693282,   2942.46342329160 },
   /* 4330   39 */  {        26.275, 4.58896850401,  10447.38783960440 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4330   40 */  {        24.596, 3.78660875483,   8429.24126646660 },
   /* 4330   41 */  {        23.587, 0.26866117066,    796.29800681640 },
 #endif
   /* 4330   42 */  {        27.793, 1.89934330904,   6279.55273164240 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4330   43 */  {        23.927, 4.99598548138,   5856.47765911540 },
   /* 4330   44 */  {        20.349, 4.65267995431,   2146.16541647520 },
   /* 4330   45 */  {        23.287, 2.80783650928,  14143.49524243060 },
@@ -545,7 +544,7 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_r1_size = 10;
 #else
   extern const uint16_t vsop87_ear_r1_size = 292;
@@ -561,7 +560,7 @@
   /* 4331    8 */  {        10.078, 5.91378194648,  10977.07880469900 },
   /* 4331    9 */  {         8.634, 0.27146150602,   5486.77784317500 },
   /* 4331   10 */  {         8.654, 1.42046854427,   6275.96230299060 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4331   11 */  {         5.069, 1.68613426734,   5088.62883976680 },
   /* 4331   12 */  {         4.985, 6.01401770704,   6286.59896834040 },
   /* 4331   13 */  {         4.669, 5.98724494073,    529.69096509460 },
@@ -847,7 +846,7 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_r2_size = 6;
 #else
   extern const uint16_t vsop87_ear_r2_size = 139;
@@ -859,7 +858,7 @@
   /* 4332    4 */  {         8.792, 3.62777733395,  77713.77146812050 },
   /* 4332    5 */  {         5.689, 1.86958905084,   5573.14280143310 },
   /* 4332    6 */  {         3.301, 5.47027913302,  18849.22754997420 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4332    7 */  {         1.471, 4.48028885617,   5507.55323866740 },
   /* 4332    8 */  {         1.013, 2.81456417694,   5223.69391980220 },
   /* 4332    9 */  {         0.854, 3.10878241236,   1577.34354244780 },
@@ -996,7 +995,7 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_r3_size = 2;
 #else
   extern const uint16_t vsop87_ear_r3_size = 27;
@@ -1004,7 +1003,7 @@
   extern const double vsop87_ear_r3[vsop87_ear_r3_size][3] = {
   /* 4333    1 */  {       144.595, 4.27319435148,   6283.07584999140 },
   /* 4333    2 */  {         6.729, 3.91697608662,  12566.15169998280 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4333    3 */  {         0.774, 0.00000000000,      0.00000000000 },
   /* 4333    4 */  {         0.247, 3.73019298781,  18849.22754997420 },
   /* 4333    5 */  {         0.036, 2.80081409050,   6286.59896834040 },
@@ -1033,14 +1032,14 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_r4_size = 1;
 #else
   extern const uint16_t vsop87_ear_r4_size = 10;
 #endif
   extern const double vsop87_ear_r4[vsop87_ear_r4_size][3] = {
   /* 4334    1 */  {         3.858, 2.56384387339,   6283.07584999140 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4334    2 */  {         0.306, 2.26769501230,  12566.15169998280 },
   /* 4334    3 */  {         0.053, 3.44031471924,   5573.14280143310 },
   /* 4334    4 */  {         0.015, 2.04794573436,  18849.22754997420 },
@@ -1053,13 +1052,13 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_r5_size = 1;
 #else
   extern const uint16_t vsop87_ear_r5_size = 3;
 #endif
   extern const double vsop87_ear_r5[vsop87_ear_r5_size][3] = {
-#ifdef meeus
+#ifdef VSOP87_MEEUS
                    {         0.000, 0.00000000000,      0.00000000000 },
 #else
   /* 4335    1 */  {         0.086, 1.21579741687,   6283.07584999140 },
@@ -1073,7 +1072,7 @@
 // Earth_Latitude Factor
 // *****************************
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_b0_size = 5;
 #else
   extern const uint16_t vsop87_ear_b0_size = 184;
@@ -1084,7 +1083,7 @@
   /* 4320    3 */  {        80.445, 3.88013204458,   5223.69391980220 },
   /* 4320    4 */  {        43.806, 3.70444689758,   2352.86615377180 },
   /* 4320    5 */  {        31.933, 4.00026369781,   1577.34354244780 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4320    6 */  {        22.724, 3.98473831560,   1047.74731175470 },
   /* 4320    7 */  {        16.392, 3.56456119782,   5856.47765911540 },
   /* 4320    8 */  {        18.141, 4.98367470263,   6283.07584999140 },
@@ -1267,7 +1266,7 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_b1_size = 2;
 #else
   extern const uint16_t vsop87_ear_b1_size = 99;
@@ -1275,7 +1274,7 @@
   extern const double vsop87_ear_b1[vsop87_ear_b1_size][3] = {
   /* 4321    1 */  {         9.030, 3.89729061890,   5507.55323866740 },
   /* 4321    2 */  {         6.177, 1.73038850355,   5223.69391980220 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4321    3 */  {         3.800, 5.24404145734,   2352.86615377180 },
   /* 4321    4 */  {         2.834, 2.47345037450,   1577.34354244780 },
   /* 4321    5 */  {         1.817, 0.41874743765,   6283.07584999140 },
@@ -1376,13 +1375,13 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_b2_size = 1;
 #else
   extern const uint16_t vsop87_ear_b2_size = 49;
 #endif
   extern const double vsop87_ear_b2[vsop87_ear_b2_size][3] = {
-#ifdef meeus
+#ifdef VSOP87_MEEUS
                    {         0.000, 0.00000000000,      0.00000000000 },
 #else
   /* 4322    1 */  {         1.662, 1.62703209173,  84334.66158130829 },
@@ -1437,13 +1436,13 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_b3_size = 1;
 #else
   extern const uint16_t vsop87_ear_b3_size = 11;
 #endif
   extern const double vsop87_ear_b3[vsop87_ear_b3_size][3] = {
-#ifdef meeus
+#ifdef VSOP87_MEEUS
                    {         0.000, 0.00000000000,      0.00000000000 },
 #else
   /* 4323    1 */  {         0.011, 0.23877262399,   7860.41939243920 },
@@ -1460,14 +1459,14 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_b4_size = 1;
   extern const double vsop87_ear_b4[1][3] = {
 #else
   extern const uint16_t vsop87_ear_b4_size = 5;
   extern const double vsop87_ear_b4[5][3] = {
 #endif
-#ifdef meeus
+#ifdef VSOP87_MEEUS
                    {         0.000, 0.00000000000,      0.00000000000 },
 #else
   /* 4324    1 */  { 000000000.004, 0.79662198849,   6438.49624942560 },
@@ -1482,7 +1481,7 @@
 // Earth_Longitude Factor
 // *****************************
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_l0_size = 64;
 #else
   extern const uint16_t vsop87_ear_l0_size = 559;
@@ -1551,14 +1550,14 @@
   /* 4310   61 */  {        40.938, 2.39850881707,  19651.04848109800 },
   /* 4310   62 */  {        30.047, 2.73975123935,   1349.86740965880 },
   /* 4310   63 */  {        30.412, 0.44294464135,  83996.84731811189 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4310   64 */  {        23.663, 0.48473567763,   8031.09226305840 },
   /* 4310   65 */  {        23.574, 2.06527720049,   3340.61242669980 },
   /* 4310   66 */  {        21.089, 4.14825464101,    951.71840625060 },
   /* 4310   67 */  {        24.738, 0.21484762138,      3.59042865180 },
 #endif
   /* 4310   68 */  {        25.352, 3.16470953405,   4690.47983635860 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4310   69 */  {        22.820, 5.22197888032,   4705.73230754360 },
   /* 4310   70 */  {        21.419, 1.42563735525,  16730.46368959580 },
   /* 4310   71 */  {        21.891, 5.55594302562,    553.56940284240 },
@@ -2053,7 +2052,7 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_l1_size = 34;
 #else
   extern const uint16_t vsop87_ear_l1_size = 341;
@@ -2091,16 +2090,16 @@
   /* 4311   30 */  {         8.577, 5.64475868067,    951.71840625060 },
   /* 4311   31 */  {        10.641, 0.76614199202,    553.56940284240 },
   /* 4311   32 */  {         7.576, 5.30062664886,   2352.86615377180 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4311   33 */  {         5.834, 1.76649917904,   1059.38193018920 },
 #endif
   /* 4311   34 */  {         6.385, 2.65033984967,   9437.76293488700 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4311   35 */  {         5.223, 5.66135767624,  71430.69561812909 },
   /* 4311   36 */  {         5.305, 0.90857521574,   3154.68708489560 },
 #endif
   /* 4311   37 */  {         6.101, 4.66632584188,   4690.47983635860 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4311   38 */  {         4.330, 0.24102555403,   6812.76681508600 },
   /* 4311   39 */  {         5.041, 1.42490103709,   6438.49624942560 },
   /* 4311   40 */  {         4.259, 0.77355900599,  10447.38783960440 },
@@ -2408,7 +2407,7 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_l2_size = 20;
 #else
   extern const uint16_t vsop87_ear_l2_size = 142;
@@ -2434,7 +2433,7 @@
   /* 4312   18 */  {         2.371, 4.38118838167,   5223.69391980220 },
   /* 4312   19 */  {         2.538, 2.27992810679,    553.56940284240 },
   /* 4312   20 */  {         2.079, 3.75435330484,      0.98032106820 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4312   21 */  {         1.675, 0.90216407959,    951.71840625060 },
   /* 4312   22 */  {         1.534, 5.75900462759,   1349.86740965880 },
   /* 4312   23 */  {         1.224, 2.97328088405,   2146.16541647520 },
@@ -2560,7 +2559,7 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_l3_size = 7;
 #else
   extern const uint16_t vsop87_ear_l3_size = 22;
@@ -2573,7 +2572,7 @@
   /* 4313    5 */  {         1.288, 4.72200252235,      3.52311834900 },
   /* 4313    6 */  {         0.635, 5.96925937141,    242.72860397400 },
   /* 4313    7 */  {         0.714, 5.30045809128,  18849.22754997420 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4313    8 */  {         0.402, 3.78682982419,    553.56940284240 },
   /* 4313    9 */  {         0.072, 4.29768126180,   6286.59896834040 },
   /* 4313   10 */  {         0.067, 0.90721687647,   6127.65545055720 },
@@ -2592,7 +2591,7 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_l4_size = 3;
 #else
   extern const uint16_t vsop87_ear_l4_size = 11;
@@ -2601,7 +2600,7 @@
   /* 4314    1 */  {       114.084, 3.14159265359,      0.00000000000 },
   /* 4314    2 */  {         7.717, 4.13446589358,   6283.07584999140 },
   /* 4314    3 */  {         0.765, 3.83803776214,  12566.15169998280 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4314    4 */  {         0.420, 0.41925861858,    155.42039943420 },
   /* 4314    5 */  {         0.040, 3.59847585840,  18849.22754997420 },
   /* 4314    6 */  {         0.041, 3.14398414077,      3.52311834900 },
@@ -2613,14 +2612,14 @@
 #endif
       };
 
-#ifdef meeus
+#ifdef VSOP87_MEEUS
   extern const uint16_t vsop87_ear_l5_size = 1;
 #else
   extern const uint16_t vsop87_ear_l5_size = 5;
 #endif
   extern const double vsop87_ear_l5[vsop87_ear_l5_size][3] = {
   /* 4315    1 */  {         0.878, 3.14159265359,      0.00000000000 },
-#ifndef meeus
+#ifndef VSOP87_MEEUS
   /* 4315    2 */  {         0.172, 2.76579069510,   6283.07584999140 },
   /* 4315    3 */  {         0.050, 2.01353298182,    155.42039943420 },
   /* 4315    4 */  {         0.028, 2.21496423926,  12566.15169998280 },
@@ -2628,5 +2627,32 @@
 #endif
       };
 
+// *****************************
+// Earth series by power of tau
+// With Meeus accuracy, r5, b2, b3 and b4 are empty (one null term)
+// *****************************
 
+  extern const TVSOPSeries vsop87_ear_r[] = {
+    { vsop87_ear_r0, vsop87_ear_r0_size }, { vsop87_ear_r1, vsop87_ear_r1_size },
+    { vsop87_ear_r2, vsop87_ear_r2_size }, { vsop87_ear_r3, vsop87_ear_r3_size },
+    { vsop87_ear_r4, vsop87_ear_r4_size }, { vsop87_ear_r5, vsop87_ear_r5_size }
+  };
+  extern const TVSOPSeries vsop87_ear_b[] = {
+    { vsop87_ear_b0, vsop87_ear_b0_size }, { vsop87_ear_b1, vsop87_ear_b1_size },
+    { vsop87_ear_b2, vsop87_ear_b2_size }, { vsop87_ear_b3, vsop87_ear_b3_size },
+    { vsop87_ear_b4, vsop87_ear_b4_size }
+  };
+  extern const TVSOPSeries vsop87_ear_l[] = {
+    { vsop87_ear_l0, vsop87_ear_l0_size }, { vsop87_ear_l1, vsop87_ear_l1_size },
+    { vsop87_ear_l2, vsop87_ear_l2_size }, { vsop87_ear_l3, vsop87_ear_l3_size },
+    { vsop87_ear_l4, vsop87_ear_l4_size }, { vsop87_ear_l5, vsop87_ear_l5_size }
+  };
 
+#ifdef VSOP87_MEEUS
+  extern const uint8_t vsop87_ear_r_count = 5;
+  extern const uint8_t vsop87_ear_b_count = 2;
+#else
+  extern const uint8_t vsop87_ear_r_count = 6;
+  extern const uint8_t vsop87_ear_b_count = 5;
+#endif
+  extern const uint8_t vsop87_ear_l_count = 6;
@@ -182,7 +182,7 @@ void IHM_Print0(const char *text)
 #endif
 #ifdef OLED_SSD1327
 	SSD1327_String({0, 0}, text, &Font12, FONT_BACKGROUND, SSD1327_WHITE);
-	SSD1327_DisplayUpdated();
+	SSD1327_Flush();
 #endif
 #ifdef OLED_SH1107
 	SH1107_Fill(0x0, 0);
@@ -222,7 +222,7 @@ void IHM_Print(uint8_t line, const char *text, bool update_screen)
 #ifdef OLED_SSD1327
   SSD1327_String(TPoint(0, 12*line), text, &Font12, FONT_BACKGROUND, SSD1327_WHITE);
   if (update_screen)
-  	SSD1327_Display();
+  	SSD1327_Flush();
 #endif
 #ifdef OLED_SH1107
 	SH1107_WriteString(0, 0, line, (char*) text, FONT_SMALL, 0, 0);
@@ -261,7 +261,7 @@ void IHM_Print(uint8_t line, uint8_t col, const char *text, bool update_screen)
 #ifdef OLED_SSD1327
   SSD1327_String(TPoint(7*col, 12*line), text, &Font12, FONT_BACKGROUND, SSD1327_WHITE);
   if (update_screen)
-  	SSD1327_Display();
+  	SSD1327_Flush();
 #endif
 #ifdef OLED_SH1107
 	SH1107_WriteString(0, 6*col, line, (char*) text, FONT_SMALL, 0, 0);
@@ -283,7 +283,7 @@ void IHM_Display(void)
   SSD1306_UpdateScreen();
 #endif
 #ifdef OLED_SSD1327
-  SSD1327_Display();
+  SSD1327_Flush();
 #endif
 #ifdef OLED_SH1107
 	SH1107_DumpBuffer();
@@ -433,12 +433,12 @@ void IHM_IPAddress(const char *ip, uint16_t waitAndClear_ms)
 #endif
 #ifdef OLED_SSD1327
 	SSD1327_String({0, 12}, ip, &Font12, FONT_BACKGROUND, SSD1327_WHITE);
-	SSD1327_DisplayUpdated();
+	SSD1327_Flush();
 	if (waitAndClear_ms > 0)
 	{
 		delay(waitAndClear_ms);
 		SSD1327_Clear(SSD1327_BACKGROUND);
-		SSD1327_Display();
+		SSD1327_Flush();
 	}
 #endif
 #ifdef OLED_SH1107
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "Partition_utils.h"
+#include "Line_Reader.h"
 
 #define ALLOC_CHAR(field)	(char *) malloc((strlen(field) + 1) * sizeof(char))
 #define ALLOC_CHAR_SIZE(size)	(char *) malloc((size) * sizeof(char))
@@ -26,8 +27,109 @@
  * data3=un texte  ; troisiéme donnée une chaine de caractére
  * [AUTRE]
  * val1=True  ; une donnée booléenne dans une autre section
+ *
+ * Organisation mémoire :
+ * - les chaines (sections, clés, valeurs, commentaires) sont dans une arena (quelques gros blocs)
+ * libérée en une fois. Une valeur modifiée est réécrite sur place si elle n'est pas plus longue.
+ * - les enregistrements de toutes les sections sont dans un seul tableau, chaînés par section.
+ * - les sections et les clés sont retrouvées par un hash (FNV-1a) : recherche en O(1).
+ * Sauvegarde : chaque enregistrement connait la position de sa valeur dans le fichier. Si seules
+ * des valeurs ont été modifiées et qu'elles tiennent à leur place, seules ces valeurs sont réécrites
+ * (complétées par des blancs), sinon tout le fichier est réécrit.
+ * Le fichier ne doit pas avoir été modifié par ailleurs (upload de la même taille, ...) : la taille
+ * et le hash du contenu sont vérifiés avant de réécrire les valeurs sur place.
  */
 
+//---------------------------------------------------------------------------
+/* ================================================================== */
+/*                          Hash                                      */
+/* ================================================================== */
+
+#define FNV_OFFSET	2166136261UL
+#define FNV_PRIME	16777619UL
+
+static inline uint32_t Ini_Hash(const char *str, uint32_t hash = FNV_OFFSET)
+{
+	while (*str)
+		hash = (hash ^ (uint8_t) *str++) * FNV_PRIME;
+	return hash;
+}
+
+static inline uint32_t Ini_HashBuffer(const char *buf, uint16_t len, uint32_t hash)
+{
+	while (len--)
+		hash = (hash ^ (uint8_t) *buf++) * FNV_PRIME;
+	return hash;
+}
+
+/**
+ * Hash du contenu du fichier, lu par blocs dans aBuffer depuis le début
+ */
+static uint32_t Ini_FileHash(File &stream, char *aBuffer, uint16_t aSize)
+{
+	uint32_t hash = FNV_OFFSET;
+	int len;
+
+	stream.seek(0);
+	while ((len = stream.read((uint8_t*) aBuffer, aSize)) > 0)
+		hash = Ini_HashBuffer(aBuffer, len, hash);
+	return hash;
+}
+
+// Ecriture d'une chaine : la position et le hash du fichier écrit suivent
+static inline void Ini_Print(File &stream, const char *str, uint32_t &aPos, uint32_t &aHash)
+{
+	aPos += stream.print(str);
+	aHash = Ini_Hash(str, aHash);
+}
+
+// Le hash d'une clé dépend de sa section
+static inline uint32_t Ini_RecordHash(uint16_t aSection, const char *aKey)
+{
+	return Ini_Hash(aKey, (FNV_OFFSET ^ aSection) * FNV_PRIME);
+}
+
+//---------------------------------------------------------------------------
+/* ================================================================== */
+/*                          Lock                                      */
+/* ================================================================== */
+
+/**
+ * Les fonctions publiques prennent le verrou : le même fichier ini peut être lu et écrit
+ * depuis plusieurs tasks (serveur web, loop, ...) sans corrompre l'arena ni le fichier.
+ * Le verrou est récursif car les fonctions indexées appellent les fonctions simples.
+ */
+class IniLock
+{
+	public:
+		IniLock(void *aLock) :
+				FLock(aLock)
+		{
+#ifdef ESP32
+			if (FLock != NULL)
+				xSemaphoreTakeRecursive((SemaphoreHandle_t) FLock, portMAX_DELAY);
+#endif
+		}
+		~IniLock()
+		{
+#ifdef ESP32
+			if (FLock != NULL)
+				xSemaphoreGiveRecursive((SemaphoreHandle_t) FLock);
+#endif
+		}
+	private:
+		void *FLock;
+};
+
+#define INI_LOCK()	IniLock lLock(FLock)
+
+void IniFiles::InitLock(void)
+{
+#ifdef ESP32
+	FLock = (void*) xSemaphoreCreateRecursiveMutex();
+#endif
+}
+
 //---------------------------------------------------------------------------
 /* ================================================================== */
 /*                          Constructor/Destructor                    */
@@ -41,6 +143,7 @@
  */
 IniFiles::IniFiles(const char *aFileName, char aComment)
 {
+	InitLock();
 	SetFileName(aFileName);
 
 	FNbSection = 0;
@@ -62,6 +165,10 @@ IniFiles::~IniFiles(void)
 		SaveFile("");
 	FreeMemory();
 	FREE_AND_NULL(FFileName);
+#ifdef ESP32
+	if (FLock != NULL)
+		vSemaphoreDelete((SemaphoreHandle_t) FLock);
+#endif
 }
 
 /**
@@ -71,6 +178,7 @@ IniFiles::~IniFiles(void)
  */
 bool IniFiles::Begin(bool autosave)
 {
+	INI_LOCK();
 	FAutoSave = autosave;
 	return ReadFile();
 }
@@ -110,29 +218,20 @@ void IniFiles::SetFloatFormat(const char *aFormat)
 //---------------------------------------------------------------------------
 void IniFiles::FreeMemory()
 {
-	uint16_t i, j;
-	TRecord *lRecord;
-	TSection *lSection;
-
-	for (i = 0; i < GetNbSections(); i++)
+	while (FArena != NULL)
 	{
-		lSection = &FSections[i];
-		FREE_AND_NULL(lSection->Section);
-		if (lSection->Comment != NULL)
-			FREE_AND_NULL(lSection->Comment);
-		for (j = 0; j < lSection->NbRecord; j++)
-		{
-			lRecord = &FSections[i].Record[j];
-			FREE_AND_NULL(lRecord->Key);
-			if (lRecord->Value != NULL)
-				FREE_AND_NULL(lRecord->Value);
-			if (lRecord->Comment != NULL)
-				FREE_AND_NULL(lRecord->Comment);
-		}
-		if (lSection->Record != NULL)
-			FREE_AND_NULL(lSection->Record);
+		TArenaBlock *lNext = FArena->Next;
+		free(FArena);
+		FArena = lNext;
 	}
+	FREE_AND_NULL(FRecords);
+	FREE_AND_NULL(FRecordIndex);
+	FNbRecord = 0;
+	FRecordCapacity = 0;
+	FRecordIndexSize = 0;
+	memset(FSectionIndex, 0, sizeof(FSectionIndex));
 	FNbSection = 0;
+	FLayoutChanged = true;
 }
 
 //---------------------------------------------------------------------------
@@ -142,75 +241,237 @@ void IniFiles::FreeMemory()
  */
 void IniFiles::SaveFile(const char *aFileName)
 {
+	INI_LOCK();
 	WriteFile(aFileName);
 }
 
 //---------------------------------------------------------------------------
-void IniFiles::AllocateRecord(TSection *aSection)
+/* ================================================================== */
+/*                          Memory                                    */
+/* ================================================================== */
+
+/**
+ * S'assure que l'arena a size caractères de libre, ajoute un bloc sinon
+ */
+bool IniFiles::ArenaReserve(uint32_t size)
 {
-	TRecord *lRecord;
+	if ((FArena != NULL) && (FArena->Used + size <= FArena->Size))
+		return true;
 
-	if ((aSection->Capacity - aSection->NbRecord) <= 0)
+	uint32_t lSize = (size > INI_ARENA_BLOCK) ? size : INI_ARENA_BLOCK;
+	TArenaBlock *lBlock = (TArenaBlock*) malloc(sizeof(TArenaBlock) + lSize);
+	if (lBlock == NULL)
+		return false;
+	lBlock->Next = FArena;
+	lBlock->Size = lSize;
+	lBlock->Used = 0;
+	FArena = lBlock;
+	return true;
+}
+
+/**
+ * Copie len caractères de str dans l'arena (plus le 0 final)
+ */
+char* IniFiles::ArenaString(const char *str, uint32_t len)
+{
+	if (!ArenaReserve(len + 1))
+		return NULL;
+
+	char *lResult = (char*) (FArena + 1) + FArena->Used;
+	memcpy(lResult, str, len);
+	lResult[len] = '\0';
+	FArena->Used += len + 1;
+	return lResult;
+}
+
+/**
+ * Change une chaine : sur place si la nouvelle n'est pas plus longue, sinon dans l'arena
+ */
+void IniFiles::SetString(char *&aField, const char *aValue)
+{
+	size_t lLen = strlen(aValue);
+	if ((aField != NULL) && (strlen(aField) >= lLen))
+		memcpy(aField, aValue, lLen + 1);
+	else
+		aField = ArenaString(aValue, lLen);
+}
+
+//---------------------------------------------------------------------------
+/* ================================================================== */
+/*                          Index                                     */
+/* ================================================================== */
+
+int16_t IniFiles::FindSection(const char *aSection)
+{
+	uint8_t lSlot = Ini_Hash(aSection) & (INI_SECTION_SLOTS - 1);
+
+	while (FSectionIndex[lSlot] != 0)
 	{
-		aSection->Capacity += INI_CAPACITY_STEP;
-		lRecord = (TRecord*) malloc(aSection->Capacity * sizeof(TRecord));
-		// Transfert des records existant
-		if (aSection->Record != NULL)
-		{
-			for (int i = 0; i < aSection->NbRecord; i++)
-				lRecord[i] = aSection->Record[i];
-			FREE_AND_NULL(aSection->Record);
-		}
-		aSection->Record = lRecord;
+		uint8_t i = FSectionIndex[lSlot] - 1;
+		if (strcmp(FSections[i].Section, aSection) == 0)
+			return i;
+		lSlot = (lSlot + 1) & (INI_SECTION_SLOTS - 1);
+	}
+	return -1;
+}
+
+uint16_t IniFiles::FindRecord(uint16_t aSection, const char *aKey)
+{
+	if (FRecordIndexSize == 0)
+		return INI_NONE;
+
+	uint16_t lSlot = Ini_RecordHash(aSection, aKey) & (FRecordIndexSize - 1);
+	while (FRecordIndex[lSlot] != 0)
+	{
+		uint16_t id = FRecordIndex[lSlot] - 1;
+		if ((FRecords[id].SectionID == aSection) && (strcmp(FRecords[id].Key, aKey) == 0))
+			return id;
+		lSlot = (lSlot + 1) & (FRecordIndexSize - 1);
 	}
+	return INI_NONE;
+}
+
+void IniFiles::IndexRecord(uint16_t id)
+{
+	uint16_t lSlot = Ini_RecordHash(FRecords[id].SectionID, FRecords[id].Key) & (FRecordIndexSize - 1);
+	while (FRecordIndex[lSlot] != 0)
+		lSlot = (lSlot + 1) & (FRecordIndexSize - 1);
+	FRecordIndex[lSlot] = id + 1;
+}
+
+/**
+ * L'index a toujours au moins deux fois plus de places que d'enregistrements
+ */
+bool IniFiles::GrowRecordIndex(void)
+{
+	uint16_t lSize = (FRecordIndexSize == 0) ? 2 * INI_CAPACITY_STEP : 2 * FRecordIndexSize;
+	uint16_t *lIndex = (uint16_t*) calloc(lSize, sizeof(uint16_t));
+	if (lIndex == NULL)
+		return false;
+
+	FREE_AND_NULL(FRecordIndex);
+	FRecordIndex = lIndex;
+	FRecordIndexSize = lSize;
+
+	for (uint16_t id = 0; id < FNbRecord; id++)
+		IndexRecord(id);
+	return true;
 }
 
 //---------------------------------------------------------------------------
-void IniFiles::AllocateRecord_ByID(int aSection)
+TSection* IniFiles::AddSection(const char *aSection)
 {
-	AllocateRecord(&FSections[aSection]);
+	if (FNbSection == INI_MAX_SECTION)
+		return NULL;
+
+	TSection *lSection = &FSections[FNbSection];
+	lSection->Section = ArenaString(aSection, strlen(aSection));
+	if (lSection->Section == NULL)
+		return NULL;
+	lSection->Comment = NULL;
+	lSection->NbRecord = 0;
+	lSection->First = INI_NONE;
+	lSection->Last = INI_NONE;
+
+	uint8_t lSlot = Ini_Hash(aSection) & (INI_SECTION_SLOTS - 1);
+	while (FSectionIndex[lSlot] != 0)
+		lSlot = (lSlot + 1) & (INI_SECTION_SLOTS - 1);
+	FSectionIndex[lSlot] = FNbSection + 1;
+
+	FNbSection++;
+	FLayoutChanged = true;
+	return lSection;
+}
+
+//---------------------------------------------------------------------------
+TRecord* IniFiles::AddRecord(uint16_t aSection, const char *aKey)
+{
+	if (FNbRecord == FRecordCapacity)
+	{
+		TRecord *lRecords = (TRecord*) realloc(FRecords, (FRecordCapacity + INI_CAPACITY_STEP) * sizeof(TRecord));
+		if (lRecords == NULL)
+			return NULL;
+		FRecords = lRecords;
+		FRecordCapacity += INI_CAPACITY_STEP;
+	}
+	if ((2 * (FNbRecord + 1) > FRecordIndexSize) && !GrowRecordIndex())
+		return NULL;
+
+	uint16_t id = FNbRecord;
+	TRecord *lRecord = &FRecords[id];
+	lRecord->Key = ArenaString(aKey, strlen(aKey));
+	if (lRecord->Key == NULL)
+		return NULL;
+	lRecord->Value = NULL;
+	lRecord->Comment = NULL;
+	lRecord->Next = INI_NONE;
+	lRecord->Offset = 0;
+	lRecord->Size = 0;
+	lRecord->SectionID = aSection;
+	lRecord->Dirty = false;
+	FNbRecord++;
+
+	// Ajout à la fin de la section
+	TSection *lSection = &FSections[aSection];
+	if (lSection->Last == INI_NONE)
+		lSection->First = id;
+	else
+		FRecords[lSection->Last].Next = id;
+	lSection->Last = id;
+	lSection->NbRecord++;
+
+	IndexRecord(id);
+	FLayoutChanged = true;
+	return lRecord;
 }
 
 //---------------------------------------------------------------------------
 char* IniFiles::GetComment(char *str)
 {
-	char *strDeb = str; // Conserve le début
+	char *lCom = str;
+	char *lEnd;
 
 	// On cherche l'indice d'un commentaire
-	while ((strlen(str) != 0) && ((*str != '#') && (*str != FComment)))
-		str++;
+	while ((*lCom != '\0') && (*lCom != '#') && (*lCom != FComment))
+		lCom++;
 
-	if (strlen(str) != 0)
+	// On supprime les blancs pouvant se trouver avant le commentaire
+	lEnd = lCom;
+	while ((lEnd > str) && (lEnd[-1] == ' '))
+		lEnd--;
+	if (*lCom == '\0')
 	{
-		*str = '\0';
-		str++;
-		// Supprime les blancs devant
-		while ((strlen(str) != 0) && (*str == ' '))
-			str++;
-		// Supprime les blancs à la fin
-		while (str[strlen(str) - 1] == ' ')
-			str[strlen(str) - 1] = '\0';
+		*lEnd = '\0';
+		return NULL;
 	}
+	*lEnd = '\0';
 
-	// On supprime les blancs pouvant se trouver avant le commentaire
-	while (strDeb[strlen(strDeb) - 1] == ' ')
-		strDeb[strlen(strDeb) - 1] = '\0';
-
-	if (strlen(str) != 0)
-		return str;
-	else
+	// Supprime les blancs devant et à la fin du commentaire
+	lCom++;
+	while (*lCom == ' ')
+		lCom++;
+	if (*lCom == '\0')
 		return NULL;
+	lEnd = lCom + strlen(lCom);
+	while (lEnd[-1] == ' ')
+		lEnd--;
+	*lEnd = '\0';
+	return lCom;
 }
 
 //---------------------------------------------------------------------------
+/**
+ * Lecture du fichier par blocs avec Line_Reader : les lignes sont découpées dans le buffer,
+ * sans String ni allocation. Une ligne sans ']' ou sans '=' ne fait pas sortir du buffer.
+ */
 bool IniFiles::ReadFile(void)
 {
-	char lCarry[] = "\n\r";
-	char *ptrDeb, *ptrFin, *ptrCom;
-	uint16_t lRecordID = 0;
+	char *line, *ptrDeb, *ptrFin, *ptrCom;
 	bool lSectionOpen = false;
+	TSection *lSection = NULL;
 	TRecord *lRecord;
-	char line[INI_MAX_LINESIZE];
+	char lBuffer[INI_MAX_LINESIZE];
+	uint16_t lLineLen;
 
 	if ((FFileName == NULL) || (!FS_Partition->exists(FFileName)))
 		return false;
@@ -221,95 +482,150 @@ bool IniFiles::ReadFile(void)
 	if (!stream)
 		return false;
 
-	while (stream.available())
+	FreeMemory();
+
+	// Le premier bloc de l'arena contient toutes les chaines du fichier
+	FFileSize = stream.size();
+	ArenaReserve(FFileSize + 1);
+	FFileHash = Ini_FileHash(stream, lBuffer, INI_MAX_LINESIZE);
+	stream.seek(0);
+
+	Line_Reader reader(stream, lBuffer, INI_MAX_LINESIZE);
+	while (reader.Next())
 	{
-		stream.readStringUntil('\n').toCharArray(line, INI_MAX_LINESIZE);
-		while (line[strlen(line) - 1] == lCarry[0])
-			line[strlen(line) - 1] = '\0';
-#ifdef LINUX
-    while (line[strlen(line)-1] == lCarry[1]) line[strlen(line)-1] = '\0';
-#endif
-		if (strlen(line) == 0)
+		line = reader.line();
+		lLineLen = reader.length();
+		if (lLineLen == 0)
 			continue;                      // Saute les lignes vides
 		if ((line[0] == '#') || (line[0] == ';') || (line[0] == FComment))
 			continue;   // Saute les lignes de commentaires
 		if (line[0] == '[')                                        // Début de section
 		{
-			lRecordID = 0;
-			FSections[FNbSection].NbRecord = 0;
-			FSections[FNbSection].Capacity = 0;
-			FSections[FNbSection].Record = NULL;
-			lSectionOpen = true;
-			ptrDeb = &line[0];
-			ptrFin = ptrDeb++;
-			while (*ptrFin != ']')
-				ptrFin++;   // Cherche la fin de la section
-			*ptrFin = '\0';
-			FSections[FNbSection].Section = ALLOC_CHAR(ptrDeb);
-			strcpy(FSections[FNbSection].Section, ptrDeb);
-			// Cherche si on a des commentaires
-			if ((ptrFin = GetComment(++ptrFin)) != NULL)
-			{
-				FSections[FNbSection].Comment = ALLOC_CHAR(ptrFin);
-				strcpy(FSections[FNbSection].Comment, ptrFin);
-			}
+			ptrDeb = &line[1];
+			// Sans ']', toute la ligne est le nom de la section
+			if ((ptrFin = (char*) memchr(ptrDeb, ']', lLineLen - 1)) == NULL)
+				ptrFin = &line[lLineLen];
 			else
-				FSections[FNbSection].Comment = NULL;
-			FNbSection++;
+				*ptrFin++ = '\0';
+			lSection = AddSection(ptrDeb);
+			lSectionOpen = (lSection != NULL);
+			// Cherche si on a des commentaires
+			if (lSectionOpen && ((ptrFin = GetComment(ptrFin)) != NULL))
+				lSection->Comment = ArenaString(ptrFin, strlen(ptrFin));
 			continue;
 		}
 		// Reste maintenant uniquement les couples clé=valeur
 		if (!lSectionOpen)
 			continue;  // On ne fait rien si aucune section n'est ouverte
-		AllocateRecord_ByID(FNbSection - 1);
-		FSections[FNbSection - 1].NbRecord++;
-		lRecord = &FSections[FNbSection - 1].Record[lRecordID];
-		lRecordID++;
 		ptrDeb = &line[0];
-		ptrFin = ptrDeb;
-		while (*ptrFin != '=')
-			ptrFin++; // Cherche la fin de la clé
-		*ptrFin = '\0';
-		ptrCom = ++ptrFin;
-		lRecord->Key = ALLOC_CHAR(ptrDeb);
-		strcpy(lRecord->Key, ptrDeb);
-		if ((ptrCom = GetComment(ptrCom)) != NULL)
-		{
-			lRecord->Comment = ALLOC_CHAR(ptrCom);
-			strcpy(lRecord->Comment, ptrCom);
-		}
-		else
-			lRecord->Comment = NULL;
-		if (strlen(ptrFin) != 0)
+		if ((ptrFin = (char*) memchr(ptrDeb, '=', lLineLen)) == NULL)
+			continue;  // Pas un couple clé=valeur
+		*ptrFin++ = '\0';
+		if ((lRecord = AddRecord(FNbSection - 1, ptrDeb)) == NULL)
+			continue;
+		// Place de la valeur et du commentaire dans le fichier
+		// Une ligne tronquée ne peut pas être réécrite sur place (Offset = 0)
+		if (!reader.truncated())
 		{
-			lRecord->Value = ALLOC_CHAR(ptrFin);
-			strcpy(lRecord->Value, ptrFin);
+			lRecord->Offset = reader.position() + (ptrFin - line);
+			lRecord->Size = lLineLen - (ptrFin - line);
 		}
-		else
-			lRecord->Value = NULL;
-
+		if ((ptrCom = GetComment(ptrFin)) != NULL)
+			lRecord->Comment = ArenaString(ptrCom, strlen(ptrCom));
+		if (*ptrFin != '\0')
+			lRecord->Value = ArenaString(ptrFin, strlen(ptrFin));
 	}
 
 	stream.close();
+	FLayoutChanged = false;
 
 	return true;
 }
 
+//---------------------------------------------------------------------------
+/**
+ * Formate la valeur et le commentaire d'un enregistrement
+ */
+uint16_t IniFiles::FormatRecord(TRecord *aRecord, char *aLine, uint16_t aSize)
+{
+	const char *lValue = (aRecord->Value != NULL) ? aRecord->Value : "";
+	int lLen;
+	if (aRecord->Comment != NULL)
+		lLen = snprintf(aLine, aSize, "%s %c %s", lValue, FComment, aRecord->Comment);
+	else
+		lLen = snprintf(aLine, aSize, "%s", lValue);
+	return (lLen < aSize) ? lLen : aSize - 1;
+}
+
+/**
+ * Réécrit sur place les valeurs modifiées.
+ * Renvoie false s'il faut réécrire tout le fichier (ajout, valeur plus longue)
+ */
+bool IniFiles::UpdateFile(void)
+{
+	char line[INI_MAX_LINESIZE];
+
+	if (FLayoutChanged || (FFileName == NULL))
+		return false;
+
+	// Toutes les valeurs modifiées doivent tenir à leur place
+	for (uint16_t id = 0; id < FNbRecord; id++)
+		if (FRecords[id].Dirty && ((FRecords[id].Offset == 0) || (FormatRecord(&FRecords[id], line,
+				INI_MAX_LINESIZE) > FRecords[id].Size)))
+			return false;
+
+	File stream = FS_Partition->open(FFileName, "r+");
+	if (!stream)
+		return false;
+	// Le fichier a été modifié par ailleurs (upload, même de la même taille) : les positions ne sont plus valables
+	if ((stream.size() != FFileSize) || (Ini_FileHash(stream, line, INI_MAX_LINESIZE) != FFileHash))
+	{
+		stream.close();
+		return false;
+	}
+
+	for (uint16_t id = 0; id < FNbRecord; id++)
+	{
+		TRecord *lRecord = &FRecords[id];
+		if (!lRecord->Dirty)
+			continue;
+		uint16_t lLen = FormatRecord(lRecord, line, INI_MAX_LINESIZE);
+		// Les blancs à la fin sont supprimés à la lecture
+		memset(&line[lLen], ' ', lRecord->Size - lLen);
+		stream.seek(lRecord->Offset);
+		stream.write((const uint8_t*) line, lRecord->Size);
+		lRecord->Dirty = false;
+	}
+	FFileHash = Ini_FileHash(stream, line, INI_MAX_LINESIZE);
+	stream.close();
+	return true;
+}
+
 //---------------------------------------------------------------------------
 bool IniFiles::WriteFile(const char *aFileName)
 {
 	uint16_t i, j;
 	TRecord *lRecord;
 	char line[INI_MAX_LINESIZE];
+	uint32_t lPos = 0;
+	uint32_t lHash = FNV_OFFSET;
 
 	if (strlen(aFileName) != 0)
 	{
 		SetFileName(aFileName);
+		FLayoutChanged = true;
 	}
 
 	if (FFileName == NULL)
 		return false;
 
+	// Seules des valeurs ont changé
+	if (UpdateFile())
+	{
+		FSaved = true;
+		return true;
+	}
+
 	File stream = FS_Partition->open(FFileName, "w");
 
 	if (!stream)
@@ -317,25 +633,37 @@ bool IniFiles::WriteFile(const char *aFileName)
 
 	for (i = 0; i < GetNbSections(); i++)
 	{
-		if (GetSection_ByID(i)->Comment != NULL)
-			sprintf(line, "\n[%s] %c %s\n", FSections[i].Section, FComment, FSections[i].Comment);
+		// Le nom et le commentaire peuvent chacun faire presque une ligne
+		Ini_Print(stream, "\n[", lPos, lHash);
+		Ini_Print(stream, FSections[i].Section, lPos, lHash);
+		if (FSections[i].Comment != NULL)
+		{
+			sprintf(line, "] %c ", FComment);
+			Ini_Print(stream, line, lPos, lHash);
+			Ini_Print(stream, FSections[i].Comment, lPos, lHash);
+			Ini_Print(stream, "\n", lPos, lHash);
+		}
 		else
-			sprintf(line, "\n[%s]\n", FSections[i].Section);
-		stream.print(line);
+			Ini_Print(stream, "]\n", lPos, lHash);
 
-		for (j = 0; j < FSections[i].NbRecord; j++)
+		for (j = FSections[i].First; j != INI_NONE; j = lRecord->Next)
 		{
-			lRecord = &FSections[i].Record[j];
-			if (lRecord->Comment != NULL)
-				sprintf(line, "%s=%s %c %s\n", lRecord->Key, lRecord->Value, FComment, lRecord->Comment);
-			else
-				sprintf(line, "%s=%s\n", lRecord->Key, lRecord->Value);
-			stream.print(line);
+			lRecord = &FRecords[j];
+			Ini_Print(stream, lRecord->Key, lPos, lHash);
+			Ini_Print(stream, "=", lPos, lHash);
+			lRecord->Size = FormatRecord(lRecord, line, INI_MAX_LINESIZE - 1);
+			lRecord->Offset = lPos;
+			lRecord->Dirty = false;
+			strcpy(&line[lRecord->Size], "\n");
+			Ini_Print(stream, line, lPos, lHash);
 		}
 	}
 	stream.close();
 
 	FSaved = true;
+	FLayoutChanged = false;
+	FFileSize = lPos;
+	FFileHash = lHash;
 
 	return true;
 }
@@ -350,29 +678,26 @@ TSection* IniFiles::GetSection_ByID(uint16_t i)
 }
 
 //---------------------------------------------------------------------------
-TSection* IniFiles::GetSection(const char *aSection, bool aCreate)
+/**
+ * Les enregistrements d'une section : de TSection.First à INI_NONE par TRecord.Next
+ */
+TRecord* IniFiles::GetRecord_ByID(uint16_t id)
 {
-	uint16_t i;
-	TSection *lSection;
+	if (id < FNbRecord)
+		return &FRecords[id];
+	else
+		return NULL;
+}
 
-	i = 0;
-	while ((i < FNbSection) && (strcmp(FSections[i].Section, aSection) != 0))
-		i++;
+//---------------------------------------------------------------------------
+TSection* IniFiles::GetSection(const char *aSection, bool aCreate)
+{
+	int16_t i = FindSection(aSection);
 
-	if (i == FNbSection)
+	if (i < 0)
 	{
 		if (aCreate)
-		{
-			lSection = &FSections[FNbSection];
-			lSection->Section = ALLOC_CHAR(aSection);
-			strcpy(lSection->Section, aSection);
-			lSection->NbRecord = 0;
-			lSection->Capacity = 0;
-			lSection->Record = NULL;
-			lSection->Comment = NULL;
-			FNbSection++;
-			return lSection;
-		}
+			return AddSection(aSection);
 		else
 			return NULL;
 	}
@@ -383,34 +708,22 @@ TSection* IniFiles::GetSection(const char *aSection, bool aCreate)
 //---------------------------------------------------------------------------
 TRecord* IniFiles::GetRecord(const char *aSection, const char *aKey, bool aCreate)
 {
-	uint16_t i;
 	TSection *lSection;
-	TRecord *lRecord;
 
 	if ((lSection = GetSection(aSection, aCreate)) != NULL)
 	{
-		i = 0;
-		while ((i < lSection->NbRecord) && (strcmp(lSection->Record[i].Key, aKey) != 0))
-			i++;
+		uint16_t lSectionID = lSection - FSections;
+		uint16_t id = FindRecord(lSectionID, aKey);
 
-		if (i == lSection->NbRecord)
+		if (id == INI_NONE)
 		{
 			if (aCreate)
-			{
-				AllocateRecord(lSection);
-				lRecord = &lSection->Record[lSection->NbRecord];
-				lRecord->Key = ALLOC_CHAR(aKey);
-				strcpy(lRecord->Key, aKey);
-				lRecord->Value = NULL;
-				lRecord->Comment = NULL;
-				lSection->NbRecord++;
-				return lRecord;
-			}
+				return AddRecord(lSectionID, aKey);
 			else
 				return NULL;
 		}
 		else
-			return &lSection->Record[i];
+			return &FRecords[id];
 	}
 	else
 		return NULL;
@@ -424,19 +737,12 @@ void IniFiles::SetValue(const char *aSection, const char *aKey, const char *aVal
 
 	if ((lRecord = GetRecord(aSection, aKey, true)) != NULL)
 	{
-		if (lRecord->Value != NULL)
-			FREE_AND_NULL(lRecord->Value);
-		lRecord->Value = ALLOC_CHAR(aValue);
-		strcpy(lRecord->Value, aValue);
-		if (lRecord->Comment != NULL)
-			FREE_AND_NULL(lRecord->Comment);
+		SetString(lRecord->Value, aValue);
 		if (strlen(aComment) != 0)
-		{
-			lRecord->Comment = ALLOC_CHAR(aComment);
-			strcpy(lRecord->Comment, aComment);
-		}
+			SetString(lRecord->Comment, aComment);
 		else
 			lRecord->Comment = NULL;
+		lRecord->Dirty = true;
 	}
 	FSaved = false;
 	if (FAutoSave)
@@ -461,12 +767,11 @@ char* IniFiles::GetValue_Default(const char *aSection, const char *aKey, const c
 {
 	TRecord *lRecord = GetRecord(aSection, aKey, true);
 
+	if (lRecord == NULL)
+		return (char*) aDefault;
 	if (lRecord->Value == NULL)
-	{
-		lRecord->Value = ALLOC_CHAR(aDefault);
-		strcpy(lRecord->Value, aDefault);
-	}
-	return lRecord->Value;
+		SetString(lRecord->Value, aDefault);
+	return (lRecord->Value != NULL) ? lRecord->Value : (char*) aDefault;
 }
 
 //---------------------------------------------------------------------------
@@ -477,6 +782,7 @@ char* IniFiles::GetValue_Default(const char *aSection, const char *aKey, const c
  */
 char* IniFiles::ReadString(const char *Section, const char *Name, const char *Default)
 {
+	INI_LOCK();
 	char *lvalue = GetValue_Default(Section, Name, Default);
 
 	char *lresult = ALLOC_CHAR(lvalue);
@@ -493,15 +799,15 @@ char* IniFiles::ReadString(const char *Section, const char *Name, const char *De
 void IniFiles::ReadString_Dest(const char *Section, const char *Name, const char *Default,
 		char *Dest)
 {
-	char *str = ReadString(Section, Name, Default);
-	strcpy(Dest, str);
-	FREE_AND_NULL(str);
+	INI_LOCK();
+	strcpy(Dest, GetValue_Default(Section, Name, Default));
 }
 
 //---------------------------------------------------------------------------
 void IniFiles::WriteString(const char *Section, const char *Name, const char *Value,
 		const char *Comment)
 {
+	INI_LOCK();
 	if (Value)
 		SetValue(Section, Name, Value, Comment);
 	else
@@ -515,24 +821,26 @@ void IniFiles::WriteString(const char *Section, const char *Name, const char *Va
  */
 int IniFiles::ReadInteger(const char *Section, const char *Name, int Default)
 {
-	char *lvalue = GetValue(Section, Name);
+	INI_LOCK();
+	TRecord *lRecord = GetRecord(Section, Name, true);
 
-	if (lvalue == NULL)
+	if (lRecord == NULL)
+		return Default;
+	if (lRecord->Value == NULL)
 	{
-		TRecord *lRecord = GetRecord(Section, Name, true);
 		char Temp[20];
 		sprintf(Temp, "%d", Default);
-		lRecord->Value = ALLOC_CHAR(Temp);
-		strcpy(lRecord->Value, Temp);
+		SetString(lRecord->Value, Temp);
 		return Default;
 	}
 	else
-		return strtol(lvalue, NULL, 10);
+		return strtol(lRecord->Value, NULL, 10);
 }
 
 //---------------------------------------------------------------------------
 void IniFiles::WriteInteger(const char *Section, const char *Name, int Value, const char *Comment)
 {
+	INI_LOCK();
 	char lInt[20];
 	sprintf(lInt, "%d", Value);
 
@@ -547,26 +855,25 @@ void IniFiles::WriteInteger(const char *Section, const char *Name, int Value, co
  */
 bool IniFiles::ReadBool(const char *Section, const char *Name, bool Default)
 {
-	char *lvalue = GetValue(Section, Name);
+	INI_LOCK();
+	TRecord *lRecord = GetRecord(Section, Name, true);
 
-	if (lvalue == NULL)
+	if (lRecord == NULL)
+		return Default;
+	if (lRecord->Value == NULL)
 	{
-		TRecord *lRecord = GetRecord(Section, Name, true);
-		lRecord->Value = ALLOC_CHAR_SIZE(6);
-		if (Default)
-			strcpy(lRecord->Value, "True");
-		else
-			strcpy(lRecord->Value, "False");
+		SetString(lRecord->Value, (Default) ? "True" : "False");
 		return Default;
 	}
 	else
-		return ((strcmp(lvalue, "True") == 0) || (strcmp(lvalue, "true") == 0)
-				|| (strcmp(lvalue, "1") == 0));
+		return ((strcmp(lRecord->Value, "True") == 0) || (strcmp(lRecord->Value, "true") == 0)
+				|| (strcmp(lRecord->Value, "1") == 0));
 }
 
 //---------------------------------------------------------------------------
 void IniFiles::WriteBool(const char *Section, const char *Name, bool Value, const char *Comment)
 {
+	INI_LOCK();
 	if (Value)
 		SetValue(Section, Name, "True", Comment);
 	else
@@ -580,26 +887,28 @@ void IniFiles::WriteBool(const char *Section, const char *Name, bool Value, cons
  */
 double IniFiles::ReadFloat(const char *Section, const char *Name, double Default)
 {
-	char *lvalue = GetValue(Section, Name);
+	INI_LOCK();
+	TRecord *lRecord = GetRecord(Section, Name, true);
 
-	if (lvalue == NULL)
+	if (lRecord == NULL)
+		return Default;
+	if (lRecord->Value == NULL)
 	{
-		TRecord *lRecord = GetRecord(Section, Name, true);
 		char Temp[20];
-		sprintf(Temp, FFloatFormat, Default);
-		lRecord->Value = ALLOC_CHAR(Temp);
-		strcpy(lRecord->Value, Temp);
+		snprintf(Temp, 20, FFloatFormat, Default);
+		SetString(lRecord->Value, Temp);
 		return Default;
 	}
 	else
-		return strtod(lvalue, NULL);
+		return strtod(lRecord->Value, NULL);
 }
 
 //---------------------------------------------------------------------------
 void IniFiles::WriteFloat(const char *Section, const char *Name, double Value, const char *Comment)
 {
+	INI_LOCK();
 	char lFloat[20];
-	sprintf(lFloat, FFloatFormat, Value);
+	snprintf(lFloat, 20, FFloatFormat, Value);
 
 	SetValue(Section, Name, lFloat, Comment);
 }
@@ -611,22 +920,18 @@ void IniFiles::WriteFloat(const char *Section, const char *Name, double Value, c
  */
 bool IniFiles::ReadBoolIndex(uint16_t id, const char *Section, const char *Name, bool Default)
 {
-	char *IdentId = ALLOC_CHAR_SIZE(strlen(Name) + 3);
-	sprintf(IdentId, "%s%d", Name, id);
-
-	bool result = ReadBool(Section, IdentId, Default);
-	FREE_AND_NULL(IdentId);
-	return result;
+	char IdentId[INI_MAX_KEYSIZE];
+	snprintf(IdentId, INI_MAX_KEYSIZE, "%s%d", Name, id);
+	return ReadBool(Section, IdentId, Default);
 }
 
 //---------------------------------------------------------------------------
 void IniFiles::WriteBoolIndex(uint16_t id, const char *Section, const char *Name, bool Value,
 		const char *Comment)
 {
-	char *IdentId = ALLOC_CHAR_SIZE(strlen(Name) + 3);
-	sprintf(IdentId, "%s%d", Name, id);
+	char IdentId[INI_MAX_KEYSIZE];
+	snprintf(IdentId, INI_MAX_KEYSIZE, "%s%d", Name, id);
 	WriteBool(Section, IdentId, Value, Comment);
-	FREE_AND_NULL(IdentId);
 }
 
 //---------------------------------------------------------------------------
@@ -636,22 +941,18 @@ void IniFiles::WriteBoolIndex(uint16_t id, const char *Section, const char *Name
  */
 int IniFiles::ReadIntegerIndex(uint16_t id, const char *Section, const char *Name, int Default)
 {
-	char *IdentId = ALLOC_CHAR_SIZE(strlen(Name) + 3);
-	sprintf(IdentId, "%s%d", Name, id);
-
-	int result = ReadInteger(Section, IdentId, Default);
-	FREE_AND_NULL(IdentId);
-	return result;
+	char IdentId[INI_MAX_KEYSIZE];
+	snprintf(IdentId, INI_MAX_KEYSIZE, "%s%d", Name, id);
+	return ReadInteger(Section, IdentId, Default);
 }
 
 //---------------------------------------------------------------------------
 void IniFiles::WriteIntegerIndex(uint16_t id, const char *Section, const char *Name, int Value,
 		const char *Comment)
 {
-	char *IdentId = ALLOC_CHAR_SIZE(strlen(Name) + 3);
-	sprintf(IdentId, "%s%d", Name, id);
+	char IdentId[INI_MAX_KEYSIZE];
+	snprintf(IdentId, INI_MAX_KEYSIZE, "%s%d", Name, id);
 	WriteInteger(Section, IdentId, Value, Comment);
-	FREE_AND_NULL(IdentId);
 }
 
 //---------------------------------------------------------------------------
@@ -661,21 +962,18 @@ void IniFiles::WriteIntegerIndex(uint16_t id, const char *Section, const char *N
  */
 double IniFiles::ReadFloatIndex(uint16_t id, const char *Section, const char *Name, double Default)
 {
-	char *IdentId = ALLOC_CHAR_SIZE(strlen(Name) + 3);
-	sprintf(IdentId, "%s%d", Name, id);
-	double result = ReadFloat(Section, IdentId, Default);
-	FREE_AND_NULL(IdentId);
-	return result;
+	char IdentId[INI_MAX_KEYSIZE];
+	snprintf(IdentId, INI_MAX_KEYSIZE, "%s%d", Name, id);
+	return ReadFloat(Section, IdentId, Default);
 }
 
 //---------------------------------------------------------------------------
 void IniFiles::WriteFloatIndex(uint16_t id, const char *Section, const char *Name, double Value,
 		const char *Comment)
 {
-	char *IdentId = ALLOC_CHAR_SIZE(strlen(Name) + 3);
-	sprintf(IdentId, "%s%d", Name, id);
+	char IdentId[INI_MAX_KEYSIZE];
+	snprintf(IdentId, INI_MAX_KEYSIZE, "%s%d", Name, id);
 	WriteFloat(Section, IdentId, Value, Comment);
-	FREE_AND_NULL(IdentId);
 }
 
 //---------------------------------------------------------------------------
@@ -683,4 +981,3 @@ void IniFiles::WriteFloatIndex(uint16_t id, const char *Section, const char *Nam
 // ********************************************************************************
 // End of file
 // ********************************************************************************
-
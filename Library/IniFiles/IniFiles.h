@@ -10,13 +10,22 @@
 
 #define INI_MAX_LINESIZE  1024    // Longueur max d'une ligne lue dans le fichier
 #define INI_MAX_SECTION   50      // Nombre de section max
-#define INI_CAPACITY_STEP 10      // Taux d'accroissement pour le nombre d'enregistrement par section
+#define INI_CAPACITY_STEP 16      // Taux d'accroissement pour le nombre d'enregistrement
+#define INI_SECTION_SLOTS 64      // Taille de l'index des sections (puissance de 2, > INI_MAX_SECTION)
+#define INI_ARENA_BLOCK   256     // Taille minimum d'un bloc de l'arena
+#define INI_MAX_KEYSIZE   64      // Longueur max d'une clé indexée (Nameid)
+#define INI_NONE          0xFFFF  // Pas d'enregistrement
 
 typedef struct
 {
 		char *Key;
 		char *Value;
 		char *Comment;
+		uint16_t Next;      // Enregistrement suivant de la section (INI_NONE si dernier)
+		uint16_t Size;      // Place de la valeur et du commentaire dans le fichier
+		uint32_t Offset;    // Position de la valeur dans le fichier (0 si pas encore écrit)
+		uint8_t SectionID;
+		bool Dirty;         // Modifié depuis la dernière sauvegarde
 } TRecord;
 
 typedef struct
@@ -24,10 +33,18 @@ typedef struct
 		char *Section;
 		char *Comment;
 		uint16_t NbRecord;
-		uint16_t Capacity;
-		TRecord *Record;
+		uint16_t First;     // Premier et dernier enregistrement de la section
+		uint16_t Last;
 } TSection;
 
+// Bloc de mémoire pour les chaines, les données suivent la structure
+typedef struct TArenaBlock
+{
+		struct TArenaBlock *Next;
+		uint32_t Size;
+		uint32_t Used;
+} TArenaBlock;
+
 //---------------------------------------------------------------------------
 
 class IniFiles
@@ -35,7 +52,7 @@ class IniFiles
 	public:
 		IniFiles()
 		{
-			;
+			InitLock();
 		}
 		IniFiles(const char *aFileName, char aComment = ';');
 		~IniFiles();
@@ -54,6 +71,7 @@ class IniFiles
 			return FNbSection;
 		}
 		TSection* GetSection_ByID(uint16_t i);
+		TRecord* GetRecord_ByID(uint16_t id);
 		void SaveFile(const char *aFileName = "");
 		bool Saved(void)
 		{
@@ -97,12 +115,40 @@ class IniFiles
 		bool FSaved = true;
 		bool FAutoSave = false;
 
+		// Chaines : arena, libérée en une fois
+		TArenaBlock *FArena = NULL;
+		// Enregistrements : un seul tableau pour toutes les sections
+		TRecord *FRecords = NULL;
+		uint16_t FNbRecord = 0;
+		uint16_t FRecordCapacity = 0;
+		// Index (hash) des sections et des enregistrements : indice + 1, 0 si vide
+		uint8_t FSectionIndex[INI_SECTION_SLOTS] = {0};
+		uint16_t *FRecordIndex = NULL;
+		uint16_t FRecordIndexSize = 0;
+		// Une section ou un enregistrement a été ajouté, le fichier doit être réécrit entièrement
+		bool FLayoutChanged = true;
+		uint32_t FFileSize = 0;   // Taille du fichier lu ou écrit
+		uint32_t FFileHash = 0;   // Hash du contenu du fichier lu ou écrit
+		// Verrou des accès publics (ESP32), le fichier peut être utilisé par plusieurs tasks
+		void *FLock = NULL;
+
+		void InitLock(void);
+
 		bool ReadFile(void);
 		bool WriteFile(const char *aFileName);
+		bool UpdateFile(void);
 		char* GetComment(char *str);
 		void FreeMemory();
-		void AllocateRecord_ByID(int aSection);
-		void AllocateRecord(TSection *aSection);
+		bool ArenaReserve(uint32_t size);
+		char* ArenaString(const char *str, uint32_t len);
+		void SetString(char *&aField, const char *aValue);
+		int16_t FindSection(const char *aSection);
+		uint16_t FindRecord(uint16_t aSection, const char *aKey);
+		TSection* AddSection(const char *aSection);
+		TRecord* AddRecord(uint16_t aSection, const char *aKey);
+		bool GrowRecordIndex(void);
+		void IndexRecord(uint16_t id);
+		uint16_t FormatRecord(TRecord *aRecord, char *aLine, uint16_t aSize);
 };
 
 //---------------------------------------------------------------------------
@@ -0,0 +1,190 @@
+#include "Line_Reader.h"
+#include <string.h>
+
+Line_Reader::Line_Reader(File &file, char *buffer, uint16_t size) :
+		_file(file), _buffer(buffer), _size(size)
+{
+	_start = 0;
+	_end = 0;
+	_offset = file.position();
+	_eof = (size < 2);
+	_skip = false;
+	_line = buffer;
+	_length = 0;
+	_position = _offset;
+	_truncated = false;
+	if (size > 0)
+		buffer[0] = 0;
+}
+
+/**
+ * Move the data not yet returned at the beginning of the buffer and read the file after it.
+ * The last byte of the buffer is kept for the null char.
+ * @return: false if nothing can be read (end of file)
+ */
+bool Line_Reader::Fill(void)
+{
+	if (_start > 0)
+	{
+		memmove(_buffer, &_buffer[_start], _end - _start);
+		_offset += _start;
+		_end -= _start;
+		_start = 0;
+	}
+	if (_eof || (_end >= _size - 1))
+		return false;
+
+	int len = _file.read((uint8_t*) &_buffer[_end], _size - 1 - _end);
+	if (len <= 0)
+	{
+		_eof = true;
+		return false;
+	}
+	_end += len;
+	return true;
+}
+
+/**
+ * Read the next line
+ * @return: false at the end of the file
+ */
+bool Line_Reader::Next(void)
+{
+	char *eol;
+
+	// The end of the previous truncated line
+	while (_skip)
+	{
+		eol = (char*) memchr(&_buffer[_start], '\n', _end - _start);
+		if (eol != NULL)
+		{
+			_start = eol - _buffer + 1;
+			_skip = false;
+		}
+		else
+		{
+			_start = _end;
+			if (!Fill())
+				return false;
+		}
+	}
+
+	_truncated = false;
+	while ((eol = (char*) memchr(&_buffer[_start], '\n', _end - _start)) == NULL)
+	{
+		if (!Fill())
+		{
+			// End of file : the last line without end of line
+			if (_start == _end)
+				return false;
+			// Buffer full : the line is truncated
+			if (!_eof)
+			{
+				_truncated = true;
+				_skip = true;
+			}
+			eol = &_buffer[_end];
+			break;
+		}
+	}
+
+	_line = &_buffer[_start];
+	_position = _offset + _start;
+	_start = (_truncated || (eol == &_buffer[_end])) ? _end : eol - _buffer + 1;
+
+	while ((eol > _line) && (eol[-1] == '\r'))
+		eol--;
+	*eol = 0;
+	_length = eol - _line;
+	return true;
+}
+
+/**
+ * Cut the line in fields in place, the separator is replaced by a null char.
+ * If there is more than max fields, the last field contains the end of the line.
+ * @return: the number of fields (1 for an empty line)
+ */
+uint8_t Line_Reader::Split(char *line, char separator, char **fields, uint8_t max)
+{
+	if (max == 0)
+		return 0;
+
+	uint8_t count = 1;
+	fields[0] = line;
+	while ((count < max) && ((line = strchr(line, separator)) != NULL))
+	{
+		*line++ = 0;
+		fields[count++] = line;
+	}
+	return count;
+}
+
+/**
+ * Copy the last n lines of a file in buffer, without reading the whole file.
+ * The file is read backwards by blocks of TAIL_BLOCK_SIZE bytes from the end.
+ * Empty lines are not counted, the lines are in the order of the file, separated by their
+ * original end of line, the last end of line is removed. buffer is null terminated.
+ * If buffer is too small, only the last complete lines are copied.
+ * @return: the number of lines copied
+ */
+uint8_t ReadLastLines(File &file, uint8_t n, char *buffer, size_t size)
+{
+	if ((n == 0) || (size < 2))
+		return 0;
+
+	size_t pos = file.size();
+	size_t end = size - 1; // The data is read at the end of buffer, before the null char
+	size_t start = end;    // Begining of the data read
+	size_t line_start = end; // Begining of the older complete line
+	uint8_t found = 0;
+	bool in_line = false;
+
+	while ((pos > 0) && (found < n))
+	{
+		size_t chunk = (pos < TAIL_BLOCK_SIZE) ? pos : TAIL_BLOCK_SIZE;
+		if (chunk > start)
+			chunk = start;
+		if (chunk == 0)
+			break; // buffer is full
+		pos -= chunk;
+		start -= chunk;
+		file.seek(pos);
+		if (file.read((uint8_t*) &buffer[start], chunk) != chunk)
+			return 0;
+
+		for (size_t i = start + chunk; i > start; i--)
+		{
+			char c = buffer[i - 1];
+			if ((c == '\r') || (c == '\n'))
+			{
+				if (in_line)
+				{
+					line_start = i;
+					in_line = false;
+					if (++found == n)
+						break;
+				}
+			}
+			else
+				in_line = true;
+		}
+	}
+	// The first line of the file (no end of line before it)
+	if ((pos == 0) && in_line && (found < n))
+	{
+		line_start = start;
+		found++;
+	}
+	if (found == 0)
+	{
+		buffer[0] = 0;
+		return 0;
+	}
+
+	// Remove the end of line of the last line
+	while ((end > line_start) && ((buffer[end - 1] == '\r') || (buffer[end - 1] == '\n')))
+		end--;
+	memmove(buffer, &buffer[line_start], end - line_start);
+	buffer[end - line_start] = 0;
+	return found;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+/**
+ * Buffered line reader of a text file (ini, csv, ...)
+ *
+ * The file is read by blocks in a buffer given by the caller, the lines are returned in place
+ * in this buffer : no String, no allocation, no strlen.
+ * - the end of line ('\n', "\r\n" or '\r' alone before '\n') is removed, the line is null terminated,
+ * - a line longer than the buffer is truncated (truncated() is true) and the rest of the line
+ * is skipped, the next call of Next() returns the next line,
+ * - position() is the offset of the line in the file (for example to rewrite a value in place).
+ *
+ * The line can be modified by the caller (it is in the buffer) until the next call of Next().
+ * Split() cut the line in fields (csv) in place.
+ * ReadLastLines() copy the last lines of a file, read backwards from the end (last record of a csv).
+ *
+ * Exemple :
+ *
+ * char buffer[256];
+ * char *fields[8];
+ * File file = Data_Partition->open("/energy.csv", "r");
+ * Line_Reader reader(file, buffer, sizeof(buffer));
+ * while (reader.Next())
+ * {
+ *   uint8_t count = Line_Reader::Split(reader.line(), '\t', fields, 8);
+ *   ...
+ * }
+ * file.close();
+ */
+
+#ifdef USE_CONFIG_LIB_FILE
+#include "config_lib.h"
+#endif
+
+#include "Arduino.h"
+#include "FS.h"
+
+class Line_Reader
+{
+	public:
+		// buffer : at least 2 bytes, a line of size - 1 characters or more is truncated
+		Line_Reader(File &file, char *buffer, uint16_t size);
+
+		bool Next(void);
+
+		char* line(void) const
+		{
+			return _line;
+		}
+		uint16_t length(void) const
+		{
+			return _length;
+		}
+		uint32_t position(void) const
+		{
+			return _position;
+		}
+		bool truncated(void) const
+		{
+			return _truncated;
+		}
+
+		static uint8_t Split(char *line, char separator, char **fields, uint8_t max);
+
+	private:
+		File &_file;
+		char *_buffer;
+		uint16_t _size;
+		uint16_t _start;    // Beginning of the data not yet returned
+		uint16_t _end;      // End of the data read in the buffer
+		uint32_t _offset;   // Offset in the file of _buffer[0]
+		bool _eof;
+		bool _skip;         // Skip the end of a truncated line
+		char *_line;
+		uint16_t _length;
+		uint32_t _position;
+		bool _truncated;
+
+		bool Fill(void);
+};
+
+// Size of the block read backwards by ReadLastLines()
+#define TAIL_BLOCK_SIZE	256
+uint8_t ReadLastLines(File &file, uint8_t n, char *buffer, size_t size);
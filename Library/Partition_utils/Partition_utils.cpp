@@ -585,6 +585,28 @@ bool DeleteFile(const String &filename, bool data_partition)
 	return false;
 }
 
+/**
+ * ReadLastLines(File &file, ...) (see Line_Reader.cpp) with the name of the file
+ * @param data_partition: true use Data_Partition else use FS_Partition. Default false = use FS_Partition
+ */
+uint8_t ReadLastLines(const String &filename, uint8_t n, char *buffer, size_t size, bool data_partition)
+{
+	PART_TYPE *partition = FS_Partition;
+	if (data_partition)
+		partition = Data_Partition;
+
+	String path = filename;
+	CheckBeginSlash(path);
+
+	buffer[0] = 0;
+	File file = partition->open(path, "r");
+	if (!file)
+		return 0;
+	uint8_t count = ReadLastLines(file, n, buffer, size);
+	file.close();
+	return count;
+}
+
 void Partition_ListDir(void)
 {
 	Serial_Info->println("------------------------------");
@@ -41,6 +41,7 @@
 	#endif
 #endif
 #include <list>
+#include "Line_Reader.h"  // ReadLastLines(File &file, ...)
 
 // Typedef for a list of String
 typedef std::list<String> StringList_td;
@@ -77,6 +78,10 @@ void ListDirToUART(const String &dirname, bool data_partition = false);
 void SendFileToUART(const String &filename, bool data_partition = false);
 bool DeleteFile(const String &filename, bool data_partition = false);
 
+// ReadLastLines(File &file, ...) is in Line_Reader.h
+uint8_t ReadLastLines(const String &filename, uint8_t n, char *buffer, size_t size,
+		bool data_partition = false);
+
 /**
  * Get the list of the name of the files in a directory
  * @param: data_partition : true for data partition else filesystem partition
@@ -0,0 +1,390 @@
+#include "TimeSeries.h"
+#include "Debug_utils.h"
+
+#define TS_PARTITION	((_partition) ? _partition : Data_Partition)
+
+TimeSeries::TimeSeries(const String &filename, const std::initializer_list<TS_Column> &columns)
+{
+	_filename = filename;
+	CheckBeginSlash(_filename);
+
+	memset(&_header, 0, sizeof(TS_File_Header));
+	_header.magic = TS_MAGIC;
+	_header.header_size = sizeof(TS_File_Header);
+	_header.record_size = sizeof(uint32_t);
+	for (const TS_Column &column : columns)
+	{
+		if (_header.count == TS_MAX_COLUMNS)
+			break;
+		_header.columns[_header.count++] = column;
+		_header.record_size += column.type;
+	}
+}
+
+/**
+ * Add a record at the end of the file. values must contain getColumnCount() values.
+ * The file is created with its header if it does not exist.
+ * If the file exist with another format, it is replaced.
+ */
+bool TimeSeries::Append(uint32_t time, const float *values)
+{
+	uint8_t record[sizeof(uint32_t) + TS_MAX_COLUMNS * sizeof(int32_t)];
+	uint8_t *precord = record;
+
+	memcpy(precord, &time, sizeof(uint32_t));
+	precord += sizeof(uint32_t);
+	for (uint8_t i = 0; i < _header.count; i++)
+	{
+		float value = values[i] / _header.columns[i].scale;
+		if (_header.columns[i].type == TS_Int16)
+		{
+			int16_t v = (int16_t) constrain(lroundf(value), -32768L, 32767L);
+			memcpy(precord, &v, sizeof(int16_t));
+		}
+		else
+		{
+			int32_t v = lroundf(value);
+			memcpy(precord, &v, sizeof(int32_t));
+		}
+		precord += _header.columns[i].type;
+	}
+
+	PART_TYPE *partition = TS_PARTITION;
+	File file = partition->open(_filename, "r");
+	if (file)
+	{
+		// Check the format of the existing file
+		bool ok = CheckHeader(file);
+		bool partial = ok && ((file.size() - _header.header_size) % _header.record_size != 0);
+		file.close();
+		if (!ok)
+			partition->remove(_filename);
+		else
+			if (partial)
+			{
+				// A previous write was interrupted, remove the partial record
+				print_debug("TimeSeries: partial record in " + _filename);
+				if (!RemovePartial())
+					return false;
+			}
+	}
+
+	file = partition->open(_filename, "a");
+	if (!file)
+		return false;
+	if (file.size() == 0)
+		file.write((const uint8_t*) &_header, sizeof(TS_File_Header));
+
+	bool result = (file.write(record, _header.record_size) == _header.record_size);
+	file.close();
+	return result;
+}
+
+/**
+ * Return the number of records
+ */
+uint32_t TimeSeries::Count(void)
+{
+	File file = TS_PARTITION->open(_filename, "r");
+	if (!file)
+		return 0;
+	uint32_t count = (CheckHeader(file)) ? RecordCount(file) : 0;
+	file.close();
+	return count;
+}
+
+/**
+ * Read the record index. values must have place for getColumnCount() values.
+ */
+bool TimeSeries::Read(uint32_t index, uint32_t *time, float *values)
+{
+	File file = TS_PARTITION->open(_filename, "r");
+	if (!file)
+		return false;
+	bool result = CheckHeader(file) && ReadRecord(file, index, time, values);
+	file.close();
+	return result;
+}
+
+/**
+ * Read the last record (an incomplete last record is ignored)
+ */
+bool TimeSeries::ReadLast(uint32_t *time, float *values)
+{
+	File file = TS_PARTITION->open(_filename, "r");
+	if (!file)
+		return false;
+	bool result = false;
+	if (CheckHeader(file))
+	{
+		uint32_t count = RecordCount(file);
+		if (count > 0)
+			result = ReadRecord(file, count - 1, time, values);
+	}
+	file.close();
+	return result;
+}
+
+/**
+ * Return the index of the first record with a time >= time (binary search)
+ * Return -1 if there is no such record
+ */
+int32_t TimeSeries::Find(uint32_t time)
+{
+	File file = TS_PARTITION->open(_filename, "r");
+	if (!file)
+		return -1;
+
+	int32_t result = -1;
+	if (CheckHeader(file))
+	{
+		uint32_t low = 0;
+		uint32_t high = RecordCount(file);
+		uint32_t t;
+		while (low < high)
+		{
+			uint32_t mid = (low + high) / 2;
+			file.seek(_header.header_size + mid * _header.record_size);
+			if (file.read((uint8_t*) &t, sizeof(uint32_t)) != sizeof(uint32_t))
+				break;
+			if (t < time)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		if (low < RecordCount(file))
+			result = low;
+	}
+	file.close();
+	return result;
+}
+
+// ********************************************************************************
+// Export functions
+// ********************************************************************************
+
+/**
+ * Prepare the export of the records between from_time and to_time in CSV (tab separated,
+ * like the old data files) or JSON ([[time, v1, ...], ...]).
+ * Then call Export() until it return 0.
+ */
+bool TimeSeries::BeginExport(TS_Export &exp, uint32_t from_time, uint32_t to_time, bool json)
+{
+	exp.json = json;
+	exp.first = true;
+	exp.to_time = to_time;
+	exp.step = 0;
+	exp.index = 0;
+	exp.count = 0;
+
+	int32_t first = (from_time == 0) ? 0 : Find(from_time);
+	exp.file = TS_PARTITION->open(_filename, "r");
+	if (!exp.file)
+		return false;
+	if (!CheckHeader(exp.file))
+	{
+		exp.file.close();
+		return false;
+	}
+	exp.count = RecordCount(exp.file);
+	exp.index = (first < 0) ? exp.count : first;
+	return true;
+}
+
+/**
+ * Fill the buffer with complete lines. Return the size written, 0 when the export is finished.
+ * The size of the buffer should be at least TS_MAX_LINE.
+ */
+size_t TimeSeries::Export(TS_Export &exp, char *buffer, size_t size)
+{
+	size_t len = 0;
+	char line[TS_MAX_LINE];
+	float values[TS_MAX_COLUMNS];
+	uint32_t time;
+
+	if ((exp.step == 0) && exp.json)
+	{
+		buffer[len++] = '[';
+	}
+	if (exp.step == 0)
+		exp.step = 1;
+
+	while ((exp.step == 1) && (exp.index < exp.count))
+	{
+		if (!ReadRecord(exp.file, exp.index, &time, values) || (time > exp.to_time))
+		{
+			exp.index = exp.count;
+			break;
+		}
+		size_t line_len = FormatLine(line, time, values, exp.json, exp.first);
+		if (len + line_len > size)
+			break;
+		memcpy(&buffer[len], line, line_len);
+		len += line_len;
+		exp.index++;
+		exp.first = false;
+	}
+
+	if ((exp.step == 1) && (exp.index >= exp.count))
+	{
+		exp.file.close();
+		exp.step = 2;
+	}
+	// End of JSON array, maybe in the next call if the buffer is full
+	if ((exp.step == 2) && (len < size))
+	{
+		if (exp.json)
+			buffer[len++] = ']';
+		exp.step = 3;
+	}
+	return len;
+}
+
+/**
+ * Export the whole file in a CSV file (tab separated)
+ * Return false if the export is not complete (partition full, ...), the CSV file is then removed.
+ */
+bool TimeSeries::ExportToCSV(const String &csv_filename)
+{
+	TS_Export exp;
+	char buffer[1024];
+	size_t len;
+	bool result = true;
+
+	if (!BeginExport(exp))
+		return false;
+
+	File csv = TS_PARTITION->open(csv_filename, "w");
+	if (!csv)
+	{
+		exp.file.close();
+		return false;
+	}
+	while ((len = Export(exp, buffer, 1024)) > 0)
+	{
+		if (csv.write((const uint8_t*) buffer, len) != len)
+		{
+			result = false;
+			break;
+		}
+	}
+	if (exp.file)
+		exp.file.close();
+	csv.close();
+	if (!result)
+		TS_PARTITION->remove(csv_filename);
+	return result;
+}
+
+// ********************************************************************************
+// Private functions
+// ********************************************************************************
+
+/**
+ * The file must have exactly our header : same columns with the same types and scales,
+ * else the records would be decoded with a wrong quantisation.
+ * _header is cleared in the constructor, the unused columns are zero in both headers.
+ */
+bool TimeSeries::CheckHeader(File &file)
+{
+	TS_File_Header header;
+	file.seek(0);
+	if (file.read((uint8_t*) &header, sizeof(TS_File_Header)) != sizeof(TS_File_Header))
+		return false;
+	return (memcmp(&header, &_header, sizeof(TS_File_Header)) == 0);
+}
+
+/**
+ * Rewrite the file without the incomplete last record
+ */
+bool TimeSeries::RemovePartial(void)
+{
+	PART_TYPE *partition = TS_PARTITION;
+	String tmp = _filename + ".tmp";
+	uint8_t buffer[512];
+
+	File file = partition->open(_filename, "r");
+	if (!file)
+		return false;
+	File file_tmp = partition->open(tmp, "w");
+	if (!file_tmp)
+	{
+		file.close();
+		return false;
+	}
+	size_t remain = _header.header_size + RecordCount(file) * _header.record_size;
+	file.seek(0);
+	while (remain > 0)
+	{
+		size_t len = file.read(buffer, (remain < 512) ? remain : 512);
+		if (len == 0)
+			break;
+		file_tmp.write(buffer, len);
+		remain -= len;
+	}
+	file.close();
+	file_tmp.close();
+
+	partition->remove(_filename);
+	return partition->rename(tmp, _filename);
+}
+
+uint32_t TimeSeries::RecordCount(File &file)
+{
+	size_t size = file.size();
+	if (size < _header.header_size)
+		return 0;
+	return (size - _header.header_size) / _header.record_size;
+}
+
+bool TimeSeries::ReadRecord(File &file, uint32_t index, uint32_t *time, float *values)
+{
+	uint8_t record[sizeof(uint32_t) + TS_MAX_COLUMNS * sizeof(int32_t)];
+	uint8_t *precord = record;
+
+	if (!file.seek(_header.header_size + index * _header.record_size))
+		return false;
+	if (file.read(record, _header.record_size) != _header.record_size)
+		return false;
+
+	memcpy(time, precord, sizeof(uint32_t));
+	precord += sizeof(uint32_t);
+	for (uint8_t i = 0; i < _header.count; i++)
+	{
+		if (_header.columns[i].type == TS_Int16)
+		{
+			int16_t v;
+			memcpy(&v, precord, sizeof(int16_t));
+			values[i] = v * _header.columns[i].scale;
+		}
+		else
+		{
+			int32_t v;
+			memcpy(&v, precord, sizeof(int32_t));
+			values[i] = v * _header.columns[i].scale;
+		}
+		precord += _header.columns[i].type;
+	}
+	return true;
+}
+
+/**
+ * Format a record : "time\tv1\t...\r\n" or ",[time,v1,...]" in JSON (without ',' for the first)
+ */
+size_t TimeSeries::FormatLine(char *line, uint32_t time, const float *values, bool json, bool first)
+{
+	int len;
+	char sep = (json) ? ',' : '\t';
+
+	if (json)
+		len = snprintf(line, TS_MAX_LINE, "%s[%lu", (first) ? "" : ",", (unsigned long) time);
+	else
+		len = snprintf(line, TS_MAX_LINE, "%lu", (unsigned long) time);
+
+	for (uint8_t i = 0; (i < _header.count) && (len < TS_MAX_LINE); i++)
+		len += snprintf(&line[len], TS_MAX_LINE - len, "%c%.2f", sep, values[i]);
+
+	if (len < TS_MAX_LINE - 2)
+		len += snprintf(&line[len], TS_MAX_LINE - len, (json) ? "]" : "\r\n");
+	return (len < TS_MAX_LINE) ? len : TS_MAX_LINE - 1;
+}
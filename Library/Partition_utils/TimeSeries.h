@@ -0,0 +1,122 @@
+#pragma once
+
+/**
+ * Binary append-only time series file
+ *
+ * The file contains a header followed by fixed-size records :
+ * - the header : magic, header size, record size, number of columns and for each column
+ * its type (int16 or int32) and its scale,
+ * - a record : the UNIX time (uint32) then the values quantised with the scale of their column
+ * (stored value = round(value / scale)).
+ *
+ * Since the records have a fixed size :
+ * - the last record is read directly at the end of the file (no need to read the whole file),
+ * - the records are sorted by time, so a range query is a binary search on the records,
+ * - the CSV or JSON export is done on the fly by blocks (chunked response of the web server).
+ *
+ * The format (TS_File_Header, TS_Column) only use fixed size types, little endian, so the file
+ * can be read on a PC with the same structures.
+ *
+ * Exemple :
+ *
+ * TimeSeries Data_TS("/data.tsb", {{TS_Int16, 0.01}, {TS_Int16, 1.0}, {TS_Int32, 0.01}});
+ *
+ * float values[3] = {230.12, 1520.0, 12345.67};
+ * Data_TS.Append(RTC_Local.getUNIXDateTime(), values);
+ * ...
+ * uint32_t time;
+ * Data_TS.ReadLast(&time, values);
+ */
+
+#ifdef USE_CONFIG_LIB_FILE
+#include "config_lib.h"
+#endif
+
+#include "Arduino.h"
+#include "Partition_utils.h"
+#include <initializer_list>
+
+#define TS_MAGIC	0x31425354  // "TSB1"
+#define TS_MAX_COLUMNS	16
+#define TS_MAX_LINE	256         // Max size of one exported line
+
+// Type of a column, the value is the size in bytes
+typedef enum
+{
+	TS_Int16 = 2,
+	TS_Int32 = 4
+} TS_Type;
+
+typedef struct __attribute__((packed))
+{
+		uint8_t type;   // TS_Type
+		float scale;    // value = stored * scale
+} TS_Column;
+
+typedef struct __attribute__((packed))
+{
+		uint32_t magic;
+		uint16_t header_size;
+		uint16_t record_size;
+		uint8_t count;       // Number of columns
+		uint8_t reserved[3];
+		TS_Column columns[TS_MAX_COLUMNS];
+} TS_File_Header;
+
+/**
+ * State of an export in progress (see BeginExport() and Export())
+ */
+typedef struct
+{
+		File file;
+		uint32_t index;      // Current record
+		uint32_t count;      // Number of records
+		uint32_t to_time;    // Last time to export
+		bool json;
+		bool first;          // No separator before the first JSON record
+		uint8_t step;        // 0 = begin, 1 = records, 2 = end of records, 3 = finished
+} TS_Export;
+
+class TimeSeries
+{
+	public:
+		TimeSeries(const String &filename, const std::initializer_list<TS_Column> &columns);
+
+		void setPartition(PART_TYPE *partition)
+		{
+			_partition = partition;
+		}
+
+		const String& getFilename(void) const
+		{
+			return _filename;
+		}
+
+		uint8_t getColumnCount(void) const
+		{
+			return _header.count;
+		}
+
+		bool Append(uint32_t time, const float *values);
+
+		uint32_t Count(void);
+		bool Read(uint32_t index, uint32_t *time, float *values);
+		bool ReadLast(uint32_t *time, float *values);
+		int32_t Find(uint32_t time);
+
+		bool BeginExport(TS_Export &exp, uint32_t from_time = 0, uint32_t to_time = 0xFFFFFFFF,
+				bool json = false);
+		size_t Export(TS_Export &exp, char *buffer, size_t size);
+		bool ExportToCSV(const String &csv_filename);
+
+	private:
+		String _filename;
+		PART_TYPE *_partition = NULL;
+		TS_File_Header _header;
+
+		bool CheckHeader(File &file);
+		bool RemovePartial(void);
+		uint32_t RecordCount(File &file);
+		bool ReadRecord(File &file, uint32_t index, uint32_t *time, float *values);
+		size_t FormatLine(char *line, uint32_t time, const float *values, bool json, bool first);
+};
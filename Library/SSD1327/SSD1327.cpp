@@ -68,13 +68,36 @@
 #define	 ORIENTATION	SET_RIGHT_LEFT
 #endif
 
+// Max data bytes by I2C transmission (the control byte is also in the Wire buffer)
+#if defined(I2C_BUFFER_LENGTH)
+#define SSD1327_BURST	(I2C_BUFFER_LENGTH - 1)
+#elif defined(BUFFER_LENGTH)
+#define SSD1327_BURST	(BUFFER_LENGTH - 1)
+#else
+#define SSD1327_BURST	31
+#endif
+
+// Cost in bytes of a new window (one transmission of the 6 commands) for SSD1327_Flush
+#define SSD1327_WINDOW_COST	10
+
+#define SSD1327_BUFFER_SIZE	((SSD1327_WIDTH / 2) * SSD1327_HEIGHT)
+
 /* Private variable */
 static uint16_t SSD1327_I2C_ADDR;
 
-static COLOR Buffer[(SSD1327_WIDTH / 2) * SSD1327_HEIGHT] = { SSD1327_BACKGROUND };
+static COLOR Buffer[SSD1327_BUFFER_SIZE] = { SSD1327_BACKGROUND };
 SSD1327_DIS sSSD1327_DIS;
 static bool DisplayIsOn = true;
 
+// Modified bytes of each row of the buffer (column of the byte), clean if Dirty_First > Dirty_Last
+static uint8_t Dirty_First[SSD1327_HEIGHT];
+static uint8_t Dirty_Last[SSD1327_HEIGHT];
+
+#ifdef SSD1327_SHADOW
+// The buffer as it is in the screen
+static COLOR Shadow[SSD1327_BUFFER_SIZE];
+#endif
+
 // ********************************************************************************
 // I2C Handler function
 // ********************************************************************************
@@ -108,6 +131,32 @@ void SSD1327_WriteData(uint8_t data)
 	Wire.endTransmission();
 }
 
+// Several commands in one transmission
+void SSD1327_WriteCommands(const uint8_t *commands, uint8_t count)
+{
+	Wire.beginTransmission(SSD1327_I2C_ADDR);
+	Wire.write(SSD1327_COMMAND);
+	Wire.write(commands, count);
+	Wire.endTransmission();
+}
+
+/*******************************************************************************
+ function:	Dirty rows of the buffer
+ *******************************************************************************/
+static inline void SSD1327_SetDirty(uint8_t row, uint8_t first, uint8_t last)
+{
+	if (first < Dirty_First[row])
+		Dirty_First[row] = first;
+	if (last > Dirty_Last[row])
+		Dirty_Last[row] = last;
+}
+
+static void SSD1327_ResetDirty(void)
+{
+	memset(Dirty_First, 0xFF, SSD1327_HEIGHT);
+	memset(Dirty_Last, 0, SSD1327_HEIGHT);
+}
+
 /*******************************************************************************
  function:	Common register initialization
  *******************************************************************************/
@@ -224,13 +273,9 @@ void SSD1327_SetWindow(TPoint p_start, TPoint p_end)
 	p_start.Limit(sSSD1327_DIS.Size);
 	p_end.Limit(sSSD1327_DIS.Size);
 
-	SSD1327_WriteReg(SET_COLUMN_ADDRESS);
-	SSD1327_WriteReg(p_start.X / 2);
-	SSD1327_WriteReg(p_end.X / 2);
-
-	SSD1327_WriteReg(SET_ROW_ADDRESS);
-	SSD1327_WriteReg(p_start.Y);
-	SSD1327_WriteReg(p_end.Y);
+	uint8_t commands[6] = {SET_COLUMN_ADDRESS, (uint8_t) (p_start.X / 2), (uint8_t) (p_end.X / 2),
+			SET_ROW_ADDRESS, p_start.Y, p_end.Y};
+	SSD1327_WriteCommands(commands, 6);
 }
 
 /********************************************************************************
@@ -258,7 +303,11 @@ void SSD1327_SetColor(TPoint point, COLOR Color)
 	else
 		c = (c & 0x0F) | (Color << 4); // keep right and add color (push 4 bits to high) to left
 
-	Buffer[pos] = c;
+	if (Buffer[pos] != c)
+	{
+		Buffer[pos] = c;
+		SSD1327_SetDirty(*py, *px / 2, *px / 2);
+	}
 }
 
 /********************************************************************************
@@ -269,6 +318,8 @@ void SSD1327_Clear(COLOR Color)
 {
 	// One byte for 2 pixels. First, clean the 4 high bits.
 	memset(Buffer, ((Color & 0x0F) | (Color << 4)), sSSD1327_DIS.Row * sSSD1327_DIS.Column2);
+	memset(Dirty_First, 0, SSD1327_HEIGHT);
+	memset(Dirty_Last, SSD1327_WIDTH / 2 - 1, SSD1327_HEIGHT);
 }
 
 /********************************************************************************
@@ -303,6 +354,12 @@ void SSD1327_ClearWindow(TPoint p_start, TPoint p_end, COLOR Color)
 	COLOR *pBuf = (COLOR*) Buffer;
 	pBuf += *sy * sSSD1327_DIS.Column2 + *sx / 2;
 
+	uint8_t last = *ex / 2;
+	if (last >= sSSD1327_DIS.Column2)
+		last = sSSD1327_DIS.Column2 - 1;
+	for (page = 0; page < Ypoint; page++)
+		SSD1327_SetDirty(*sy + page, *sx / 2, last);
+
 	for (page = 0; page < Ypoint; page++)
 	{
 		if (*sx & 1) // odd
@@ -375,6 +432,11 @@ void SSD1327_Display(void)
 		SSD1327_WriteData(pBuf, sSSD1327_DIS.Column2);
 		pBuf += sSSD1327_DIS.Column2;
 	}
+
+#ifdef SSD1327_SHADOW
+	memcpy(Shadow, Buffer, SSD1327_BUFFER_SIZE);
+#endif
+	SSD1327_ResetDirty();
 }
 
 /********************************************************************************
@@ -418,10 +480,126 @@ void SSD1327_DisplayWindow(TPoint p_start, TPoint p_end)
 	for (page = 0; page < Ypoint; page++)
 	{
 		SSD1327_WriteData(pBuf, Xpoint);
+#ifdef SSD1327_SHADOW
+		memcpy(&Shadow[pBuf - Buffer], pBuf, Xpoint);
+#endif
 		pBuf += sSSD1327_DIS.Column2;
 	}
 }
 
+/********************************************************************************
+ function:	Send the bytes first to last of the rows row_start to row_end
+ The data of the rows are sent in the window by bursts of SSD1327_BURST bytes
+ ********************************************************************************/
+static void SSD1327_SendBlock(uint8_t row_start, uint8_t row_end, uint8_t first, uint8_t last)
+{
+	uint8_t burst[SSD1327_BURST];
+	uint16_t count = 0;
+	uint8_t width = last - first + 1;
+
+	SSD1327_SetWindow(TPoint(first * 2, row_start), TPoint(last * 2, row_end));
+
+	for (uint16_t row = row_start; row <= row_end; row++)
+	{
+		COLOR *pBuf = &Buffer[row * sSSD1327_DIS.Column2 + first];
+		uint8_t done = 0;
+		while (done < width)
+		{
+			uint8_t n = width - done;
+			if (n > SSD1327_BURST - count)
+				n = SSD1327_BURST - count;
+			memcpy(&burst[count], &pBuf[done], n);
+			count += n;
+			done += n;
+			if (count == SSD1327_BURST)
+			{
+				SSD1327_WriteData(burst, count);
+				count = 0;
+			}
+		}
+#ifdef SSD1327_SHADOW
+		memcpy(&Shadow[pBuf - Buffer], pBuf, width);
+#endif
+	}
+	if (count > 0)
+		SSD1327_WriteData(burst, count);
+}
+
+/********************************************************************************
+ function:	Update the modified parts of the memory to LCD
+ The modified bytes of each row are tracked by SSD1327_SetColor, SSD1327_Clear and
+ SSD1327_ClearWindow (so by all the drawing functions). With SSD1327_SHADOW, the spans
+ are reduced to the bytes that differ from the screen.
+ The spans of consecutive rows are sent in the same window when it costs less than
+ a new window.
+ ********************************************************************************/
+void SSD1327_Flush(void)
+{
+	// No need to display if screen is off
+	if (!DisplayIsOn)
+		return;
+
+	uint8_t row, end, first, last;
+	uint16_t cost, merged;
+
+#ifdef SSD1327_SHADOW
+	for (row = 0; row < sSSD1327_DIS.Row; row++)
+	{
+		first = Dirty_First[row];
+		last = Dirty_Last[row];
+		if (first > last)
+			continue;
+		COLOR *pBuf = &Buffer[row * sSSD1327_DIS.Column2];
+		COLOR *pShadow = &Shadow[row * sSSD1327_DIS.Column2];
+		while ((first <= last) && (pBuf[first] == pShadow[first]))
+			first++;
+		if (first > last)
+		{
+			Dirty_First[row] = 0xFF;
+			Dirty_Last[row] = 0;
+			continue;
+		}
+		while (pBuf[last] == pShadow[last])
+			last--;
+		Dirty_First[row] = first;
+		Dirty_Last[row] = last;
+	}
+#endif
+
+	row = 0;
+	while (row < sSSD1327_DIS.Row)
+	{
+		first = Dirty_First[row];
+		last = Dirty_Last[row];
+		if (first > last)
+		{
+			row++;
+			continue;
+		}
+
+		// Extend the window to the next rows while it is cheaper than a new window
+		cost = last - first + 1;
+		end = row + 1;
+		while ((end < sSSD1327_DIS.Row) && (Dirty_First[end] <= Dirty_Last[end]))
+		{
+			uint8_t f = (Dirty_First[end] < first) ? Dirty_First[end] : first;
+			uint8_t l = (Dirty_Last[end] > last) ? Dirty_Last[end] : last;
+			merged = (l - f + 1) * (end - row + 1);
+			if (merged > cost + (Dirty_Last[end] - Dirty_First[end] + 1) + SSD1327_WINDOW_COST)
+				break;
+			first = f;
+			last = l;
+			cost = merged;
+			end++;
+		}
+
+		SSD1327_SendBlock(row, end - 1, first, last);
+		row = end;
+	}
+
+	SSD1327_ResetDirty();
+}
+
 /********************************************************************************
  function:	Toggle display
  ********************************************************************************/
@@ -41,6 +41,12 @@
 	#endif
 #endif
 
+// Copy of the screen memory (8 KB) : SSD1327_Flush() only sends the bytes really changed.
+// Without it, SSD1327_Flush() sends the modified parts of the buffer.
+#if defined(ESP32) && !defined(SSD1327_NO_SHADOW)
+#define SSD1327_SHADOW
+#endif
+
 /********************************************************************************
  define:	Define the full screen height length of the display
  ********************************************************************************/
@@ -156,6 +162,7 @@ void SSD1327_ClearWindow(TPoint p_start, TPoint p_end, COLOR Color = SSD1327_BAC
 void SSD1327_ClearAndDisplay(COLOR Color = SSD1327_BACKGROUND);
 void SSD1327_Display(void);
 void SSD1327_DisplayWindow(TPoint p_start, TPoint p_end);
+void SSD1327_Flush(void);
 void SSD1327_ON(void);
 void SSD1327_OFF(void);
 bool SSD1327_ToggleOnOff(void);
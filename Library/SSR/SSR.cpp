@@ -16,6 +16,8 @@ TimerInterrupt Timer_SSR;
 #define TIMERMUX_ENTER()	void()
 #define TIMERMUX_EXIT()	void()
 #define TIMERMUX_SECURE(op) op
+#define PIDMUX_ENTER()	void()
+#define PIDMUX_EXIT()	void()
 #endif
 
 #ifdef ESP32
@@ -32,6 +34,10 @@ static portMUX_TYPE timerMux = portMUX_INITIALIZER_UNLOCKED;
 #define TIMERMUX_SECURE(op) portENTER_CRITICAL_ISR(&timerMux); \
 		(op); \
 		portEXIT_CRITICAL_ISR(&timerMux);
+// Les échanges avec le PID entre les tasks
+static portMUX_TYPE pidMux = portMUX_INITIALIZER_UNLOCKED;
+#define PIDMUX_ENTER()	portENTER_CRITICAL(&pidMux)
+#define PIDMUX_EXIT()	portEXIT_CRITICAL(&pidMux)
 volatile SemaphoreHandle_t topZC_Semaphore = NULL;
 #if defined(ESP_IDF_VERSION) && (ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)) // ESP32 2.0.x
 // Le channel pour la led SSR en PWM
@@ -79,6 +85,21 @@ volatile bool Top_CS_ZC_Mux = false;   // Top ZC
 #define P_MIN      0.0
 #define P_MAX    100.0
 
+// Tables des angles d'amorçage générées à la compilation, voir SSR_Curve.h
+// En RAM pour pouvoir être lues depuis une interruption
+#ifndef DRAM_ATTR
+#define DRAM_ATTR
+#endif
+static constexpr SSR_Curve_Table DRAM_ATTR Curve_Tables[] = {
+		SSR_Make_Curve_Table(SSR_Curve_Power),
+		SSR_Make_Curve_Table(SSR_Curve_Acos)};
+
+static_assert(Curve_Tables[SSR_Curve_Power].angle[0] == SSR_ANGLE_ONE, "Curve table error");
+static_assert(Curve_Tables[SSR_Curve_Acos].angle[SSR_CURVE_SIZE / 2] == SSR_ANGLE_ONE / 2, "Curve table error");
+
+// La courbe utilisée pour convertir le pourcentage en délai
+volatile SSR_Curve_typedef SSR_Curve = SSR_Curve_Power;
+
 // La puissance de la charge
 float Dump_Power = 0.0;
 // La puissance de la charge divisée par sa tension nominale (~ courant)
@@ -100,6 +121,9 @@ volatile float P_100 = 0.0;
 // On a forcé le 100% si le surplus est supérieur à la charge
 bool Forced100 = false;
 
+// Nombre de passages actif <-> inactif du SSR (pour évaluer la régulation)
+static uint32_t Toggle_Count = 0;
+
 // Timer params
 volatile bool Tim_Interrupt_Enabled = false;
 // Indique si le SSR est activé ou pas
@@ -112,12 +136,33 @@ SSR_Action_typedef current_action = SSR_Action_OFF;
 // La puissance cible en version dimmer
 float Dimme_Power = 0.0;
 
+// Mode burst (SSR_Action_Burst) : on allume des périodes complètes sans timer
+// Burst_Cycles : nombre de périodes de la fenêtre, Burst_On : nombre de périodes allumées
+volatile bool Burst_Mode = false;
+volatile uint16_t Burst_Cycles = SSR_BURST_WINDOW / 2;
+volatile uint16_t Burst_On = 0;
+static int32_t Burst_Acc = 0;
+static bool Burst_Phase = false;
+static bool Burst_Fire = false;
+static bool Burst_Next_Fire = false;
+static bool Burst_Decided = false;
+// Temps du dernier zéro-cross (us), 0 au démarrage
+static uint32_t Burst_Last_ZC = 0;
+
 // For PID
-static float Integral = 0.0;
-//	static float LastError = 0.0;
-static float TotalOutput = 0.0;
+static SSR_PID_Class PID;
 static uint8_t Over_Count = 0;
 
+// Les paramètres du PID et le démarrage de l'auto-tune sont demandés par une autre task (web).
+// Ils sont pris en compte au début du calcul du surplus (task Cirrus), seule à utiliser PID.
+// PID_Wanted est la copie des paramètres lisible par les autres tasks, toujours sous PIDMUX.
+static SSR_PID_Params PID_Wanted;
+static bool PID_Params_Request = false;
+static bool PID_AutoTune_Request = false;
+
+// La dernière tension RMS reçue du Cirrus (task Cirrus), 230 V avant la première mesure
+static volatile float Last_Voltage = 230.0;
+
 // La tension et la puissance en cours fournies par le Cirrus ou autre
 // Cette fonction devra être redéfinie ailleurs suivant la configuration du Cirrus
 bool __attribute__((weak)) CIRRUS_get_rms_data(float *uRMS, float *pRMS)
@@ -152,12 +197,14 @@ void SSR_Stop_Timer(void);
 inline void Restart_PID(void)
 {
 	// Reset parameters
-	Integral = 0.0;
-//	LastError = 0.0;
-	TotalOutput = 0.0;
+	PID.Reset();
 	Over_Count = 0;
 }
 
+#ifdef ADC_USE_DMA
+extern void ADC_ZC_Top(void);
+#endif
+
 // Fonction de DEBUG_SSR
 extern void PrintTerminal(const char *text);
 void PrintVal(const char *text, float val, bool integer)
@@ -310,6 +357,10 @@ void IRAM_ATTR onCirrusZC(void)
   // Give a semaphore that we can used to synchronise with ZC cirrus
 	if (topZC_Semaphore)
 		xSemaphoreGiveFromISR(topZC_Semaphore, NULL);
+#ifdef ADC_USE_DMA
+	// Time of the zero cross for the ADC frames
+	ADC_ZC_Top();
+#endif
 #endif
 
 	TIMERMUX_ENTER();
@@ -322,6 +373,66 @@ void IRAM_ATTR onCirrusZC(void)
 #endif
 
 	bool SSR_TIM_Enabled = Is_SSR_enabled_Mux && Tim_Interrupt_Enabled;
+
+	// Mode burst : distribution des périodes allumées (sigma-delta) dans la fenêtre
+	// Une période est toujours complète pour ne pas avoir de composante continue :
+	// - la décision pour la période suivante est prise au zéro-cross du milieu de la période,
+	// - l'arrêt est fait à ce zéro-cross : le triac conduit jusqu'à la fin de la période,
+	// - le démarrage est fait au zéro-cross du début de la période.
+	// La polarité de la demi-période est suivie avec le temps écoulé depuis le dernier zéro-cross :
+	// un zéro-cross manqué (nombre pair de demi-périodes) ne décale pas le début des périodes.
+	if (Is_SSR_enabled_Mux && Burst_Mode)
+	{
+		uint32_t now = micros();
+		uint32_t half = 1;
+		if (Burst_Last_ZC != 0)
+			half = (now - Burst_Last_ZC + HALF_PERIOD_us / 2) / HALF_PERIOD_us;
+		Burst_Last_ZC = (now != 0) ? now : 1;
+		if (half & 1)
+			Burst_Phase = !Burst_Phase;
+
+		// half = 0 : rebond du zéro-cross, rien à faire
+		if (half != 0)
+		{
+			if (Burst_Phase)
+			{
+				// Début de période. Si le milieu a été manqué, la période continue comme la précédente
+				// et elle est comptée dans le sigma-delta
+				if (Burst_Decided)
+					Burst_Fire = Burst_Next_Fire;
+				else
+				{
+					Burst_Acc += Burst_On;
+					if (Burst_Fire)
+						Burst_Acc -= Burst_Cycles;
+				}
+				Burst_Decided = false;
+				if (Burst_Fire)
+					SET_PIN_HIGH(SSR_PIN);
+			}
+			else
+			{
+				// Milieu de période. Si le début a été manqué, le SSR n'a été démarré que s'il l'était déjà :
+				// une période prévue allumée et pas faite est rendue au sigma-delta
+				if (Burst_Decided)
+				{
+					if (Burst_Next_Fire && !Burst_Fire)
+						Burst_Acc += Burst_Cycles;
+					Burst_Fire = Burst_Fire && Burst_Next_Fire;
+				}
+				Burst_Acc += Burst_On;
+				Burst_Next_Fire = (Burst_Acc >= Burst_Cycles);
+				if (Burst_Next_Fire)
+					Burst_Acc -= Burst_Cycles;
+				Burst_Decided = true;
+				if (!Burst_Next_Fire)
+					SET_PIN_LOW(SSR_PIN);
+			}
+		}
+		TIMERMUX_EXIT();
+		SetLedPinValue((Burst_Fire) ? 1023 : 0);
+		return;
+	}
 	TIMERMUX_EXIT();
 
 	if (SSR_TIM_Enabled)
@@ -538,6 +649,7 @@ float SSR_Compute_Dump_power(float default_Power)
  * 	- SSR_Action_Percent: SSR à un certain pourcentage quelque soit la puissance de la charge
  * 	- SSR_Action_Surplus: SSR afin d'avoir zéro surplus
  * 	- SSR_Action_Dimme: SSR de façon à avoir seulement un pourcentage de la charge
+ * 	- SSR_Action_Burst: comme SSR_Action_Surplus mais par périodes complètes (pas de découpage de phase)
  * Arrête le SSR s'il est actif.
  * Appeler SSR_Enable() pour (re)démarrer le SSR ou mettre restart à true
  */
@@ -545,6 +657,7 @@ void SSR_Set_Action(SSR_Action_typedef do_action, bool restart)
 {
 	current_action = do_action;
 	SSR_Disable();
+	TIMERMUX_SECURE(Burst_Mode = (current_action == SSR_Action_Burst));
 
 	switch (current_action)
 	{
@@ -556,6 +669,7 @@ void SSR_Set_Action(SSR_Action_typedef do_action, bool restart)
 			break;
 		}
 		case SSR_Action_Surplus:
+		case SSR_Action_Burst:
 		{
 			Gestion_SSR_CallBack = &SSR_Update_Surplus_Timer;
 			break;
@@ -599,7 +713,7 @@ SSR_State_typedef SSR_Get_State(void)
 		return SSR_OFF;
 	else
 	{
-		if (Tim_Interrupt_Enabled)
+		if (Tim_Interrupt_Enabled || (Burst_Mode && (Burst_On > 0)))
 			return SSR_ON_ACTIF;
 		else
 			return SSR_ON;
@@ -630,6 +744,7 @@ void SSR_Enable(void)
 			break;
 		}
 		case SSR_Action_Surplus:
+		case SSR_Action_Burst:
 		{
 			Restart_PID();
 			// On démarre à zéro pourcent
@@ -641,7 +756,7 @@ void SSR_Enable(void)
 			float pourcent;
 			// Détermine le pourcentage de démarrage
 			if (Dump_Power_Relatif > 0.0)
-				pourcent = 100 * (Dimme_Power / (Dump_Power_Relatif * 230.0));
+				pourcent = 100 * (Dimme_Power / (Dump_Power_Relatif * Last_Voltage));
 			else
 				pourcent = 0.0;
 			Set_Percent(pourcent);
@@ -659,6 +774,13 @@ void SSR_Disable(void)
 	TIMERMUX_ENTER();
 	Is_SSR_enabled_Mux = Is_SSR_enabled;
 	Top_CS_ZC_Mux = false;
+	Burst_On = 0;
+	Burst_Acc = 0;
+	Burst_Phase = false;
+	Burst_Fire = false;
+	Burst_Next_Fire = false;
+	Burst_Decided = false;
+	Burst_Last_ZC = 0;
 	TIMERMUX_EXIT();
 	P_100 = 0;
 	delay(10);
@@ -733,6 +855,18 @@ float SSR_Get_Current_Percent(void)
 	return P_100;
 }
 
+/**
+ * Nombre de fois où le SSR est passé de inactif à actif ou l'inverse
+ * depuis le démarrage ou le dernier reset
+ */
+uint32_t SSR_Get_Toggle_Count(bool reset)
+{
+	uint32_t count = Toggle_Count;
+	if (reset)
+		Toggle_Count = 0;
+	return count;
+}
+
 // Fonction pour dimmer une puissance cible
 void SSR_Set_Dimme_Target(float target)
 {
@@ -749,6 +883,70 @@ float SSR_Get_Dimme_Target(void)
 	return Dimme_Power;
 }
 
+/**
+ * Fenêtre du mode burst en nombre de demi-périodes (arrondi à une période complète)
+ * La résolution est de 200 / half_cycles %, soit 2% pour la fenêtre par défaut de 100
+ */
+void SSR_Set_Burst_Window(uint16_t half_cycles)
+{
+	if (half_cycles < 2)
+		half_cycles = 2;
+	bool isrunning = !(SSR_Get_State() == SSR_OFF);
+	SSR_Disable();
+	Burst_Cycles = half_cycles / 2;
+
+	if (isrunning)
+		SSR_Enable();
+}
+
+uint16_t SSR_Get_Burst_Window(void)
+{
+	return Burst_Cycles * 2;
+}
+
+/**
+ * Défini la courbe pourcentage -> délai suivant le type de charge
+ * - SSR_Curve_Power : puissance linéaire, pour une charge résistive (défaut)
+ * - SSR_Curve_Acos : ancienne courbe acos, linéaire en tension moyenne
+ */
+void SSR_Set_Curve(SSR_Curve_typedef curve)
+{
+	bool isrunning = !(SSR_Get_State() == SSR_OFF);
+	SSR_Disable();
+	SSR_Curve = curve;
+
+	if (isrunning)
+		SSR_Enable();
+}
+
+SSR_Curve_typedef SSR_Get_Curve(void)
+{
+	return SSR_Curve;
+}
+
+/**
+ * Conversion d'une fraction de puissance en délai (us) depuis le zéro-cross
+ * fraction_q16 : la fraction en Q16, 65536 = 100%
+ * Interpolation linéaire en virgule fixe dans la table de la courbe en cours.
+ * Pas de calcul flottant, peut être appelée depuis une interruption.
+ */
+uint32_t IRAM_ATTR SSR_Percent_To_Delay(uint32_t fraction_q16)
+{
+	const uint16_t *table = Curve_Tables[SSR_Curve].angle;
+	uint32_t index = fraction_q16 >> (16 - SSR_CURVE_BITS);
+	uint32_t angle;
+
+	if (index >= SSR_CURVE_SIZE)
+		angle = table[SSR_CURVE_SIZE];
+	else
+	{
+		uint32_t rest = fraction_q16 & ((1 << (16 - SSR_CURVE_BITS)) - 1);
+		// La table est décroissante
+		angle = table[index] - (((table[index] - table[index + 1]) * rest) >> (16 - SSR_CURVE_BITS));
+	}
+	return (angle * HALF_PERIOD_us + SSR_ANGLE_ONE / 2) / SSR_ANGLE_ONE;
+}
+
 // ********************************************************************************
 // Private action
 // ********************************************************************************
@@ -777,6 +975,7 @@ void SSR_Stop_Timer(void)
 /**
  * Compute SSR_COUNT
  * Enable or disable timer according SSR_COUNT
+ * In burst mode, compute the number of cycles on in the window, the timer is not used
  * return true if percent has changed
  */
 bool Set_Percent(float percent, bool start_timer)
@@ -790,10 +989,24 @@ bool Set_Percent(float percent, bool start_timer)
 	// On change seulement si on a une différence supérieure à 1%
 	if (fabs(P_100 - percent) > 0.01)
 	{
+		if (Burst_Mode)
+		{
+			uint16_t on = (uint16_t) lroundf(percent * Burst_Cycles / 100.0f);
+			if ((on > 0) != (Burst_On > 0))
+				Toggle_Count++;
+			TIMERMUX_SECURE(Burst_On = on);
+			P_100 = percent;
+			return true;
+		}
+
 		// Calcul du delais en us
-		uint32_t delay = lround(fabs(acos(percent / 50.0 - 1.0)) / M_PI * HALF_PERIOD_us);
+		uint32_t delay = SSR_Percent_To_Delay((uint32_t) (percent * 655.36f + 0.5f));
 		if (start_timer)
+		{
+			if ((delay < DELAY_MAX) != Tim_Interrupt_Enabled)
+				Toggle_Count++;
 			SSR_Enable_Timer_Interrupt((bool) (delay < DELAY_MAX));
+		}
 
 		if (delay < DELAY_MIN)
 			delay = DELAY_MIN;
@@ -816,6 +1029,8 @@ void SSR_Update_Dimme_Timer(const float Cirrus_voltage, const float Cirrus_power
 #define DELTA_TARGET   2
 #define EPSILON        0.2
 
+	Last_Voltage = Cirrus_voltage;
+
 	// Aucun calcul si le SSR n'est pas actif
 	if (!Is_SSR_enabled)
 		return;
@@ -831,24 +1046,50 @@ void SSR_Update_Dimme_Timer(const float Cirrus_voltage, const float Cirrus_power
 		{
 			Set_Percent(P_100 - EPSILON);
 		}
-
-	(void) Cirrus_voltage; // For compiler
 }
 
 /**
  * PID controler to control the surplus allowed
- * Don't use derivative part (Kd = 0)
+ * See SSR_PID_Class, feed-forward from the current dump power and real dt
  */
 void SSR_Update_Surplus_Timer(const float Cirrus_voltage, const float Cirrus_power_signed)
 {
+	Last_Voltage = Cirrus_voltage;
+
 	// Aucun calcul si le SSR n'est pas actif
 	if (!Is_SSR_enabled)
 		return;
 
+	// The power of the dump according the current voltage
+	float New_Dump_Power = Cirrus_voltage * Dump_Power_Relatif;
+	if (New_Dump_Power <= 0.0)
+		return;
+
+	// Les demandes des autres tasks
+	SSR_PID_Params params;
+	bool new_params, start_tune;
+	PIDMUX_ENTER();
+	params = PID_Wanted;
+	new_params = PID_Params_Request;
+	start_tune = PID_AutoTune_Request;
+	PID_Params_Request = PID_AutoTune_Request = false;
+	PIDMUX_EXIT();
+	if (new_params)
+	{
+		PID.setParams(params);
+		Over_Count = 0;
+	}
+	if (start_tune)
+	{
+		Forced100 = false;
+		PID.StartAutoTune(New_Dump_Power);
+	}
+	bool tuning = PID.IsAutoTune();
+
 	// Si le surplus est supérieur à la charge, on passe direct à 100%
 	// Si on est en mode 100%, on vérifie qu'on a toujours du surplus
 	float delta = Cirrus_power_signed + Dump_Power;
-	if ((delta < 0) || Forced100)
+	if (((delta < 0) || Forced100) && !PID.IsAutoTune())
 	{
 		// On passe en mode 100%
 		if (!Forced100)
@@ -864,61 +1105,84 @@ void SSR_Update_Surplus_Timer(const float Cirrus_voltage, const float Cirrus_pow
 		else
 		{
 			Forced100 = false;
+			Restart_PID();
 		}
 	}
 
-//  const float Kp = 0.2, Ki = 0.0001, Kd = 0.0;  // Bon Kd 0 ou 1
-	const float Kp = 0.2, Ki = 0.0001;  // Kd = 0.0;
-	// Timer interval: need to be adjusted ?
-	const float Dt = 100.0;
-	// Desired value: here we want zero to have zero surplus
-	float SetPoint = SSR_Target;
-	// The power of the dump according the current voltage
-	float New_Dump_Power = Cirrus_voltage * Dump_Power_Relatif;
+	// La puissance actuellement dissipée dans la charge
+	float Current_Dump_Power = P_100 * New_Dump_Power / 100.0;
+	float Output = PID.Compute(SSR_Target, Cirrus_power_signed, Current_Dump_Power, New_Dump_Power);
 
-	// calculate the difference between the desired value and the actual value
-	float Error = SetPoint - Cirrus_power_signed;
-	// track error over time, scaled to the timer interval
-	Integral += (Error * Dt);
-	// determine the amount of change from the last time checked
-//  float Derivative = (Error - LastError) / Dt;
-	// calculate how much drive the output in order to get to the
-	// desired setpoint.
-	float Output = (Kp * Error) + (Ki * Integral); // + (Kd * Derivative);
-	// remember the error for the next time around.
-//  LastError = Error;
-
-	TotalOutput += (Output / 2);
-
-	if (TotalOutput < 0)
+	// Fin de l'auto-tune : les nouveaux paramètres sont publiés, sauf si d'autres ont été demandés
+	if (tuning && !PID.IsAutoTune())
 	{
-		TotalOutput = 0.0;
-		Over_Count++;
+		PIDMUX_ENTER();
+		if (!PID_Params_Request)
+			PID_Wanted = PID.getParams();
+		PIDMUX_EXIT();
 	}
-	else
+
+	// On a toujours du surplus à 100%, donc on bloque à 100%
+	if ((Output >= New_Dump_Power) && !PID.IsAutoTune())
 	{
-		if (TotalOutput > New_Dump_Power)
+		if (++Over_Count > TRY_MAX)
 		{
-			TotalOutput = New_Dump_Power;
-			Over_Count++;
-			// On a toujours du surplus, donc on bloque à 100%
-			if (Over_Count > TRY_MAX)
-			{
-				Restart_PID();
-				Forced100 = true;
-				Set_Percent(100.0);
-				return;
-			}
+			Restart_PID();
+			Forced100 = true;
+			Set_Percent(100.0);
+			return;
 		}
-		else
-			Over_Count = 0;
 	}
+	else
+		Over_Count = 0;
+
+	Set_Percent(100.0 * Output / New_Dump_Power);
+}
 
-	// On est toujours en erreur, on réinitialise
-	if (Over_Count > TRY_MAX)
-		Restart_PID();
+/**
+ * Paramètres du régulateur du mode surplus
+ * Appelable depuis n'importe quelle task, pris en compte au prochain calcul du surplus
+ */
+void SSR_Set_PID_Params(const SSR_PID_Params &params)
+{
+	PIDMUX_ENTER();
+	PID_Wanted = params;
+	PID_Params_Request = true;
+	PIDMUX_EXIT();
+}
+
+SSR_PID_Params SSR_Get_PID_Params(void)
+{
+	SSR_PID_Params params;
+	PIDMUX_ENTER();
+	params = PID_Wanted;
+	PIDMUX_EXIT();
+	return params;
+}
 
-	Set_Percent(100.0 * TotalOutput / New_Dump_Power);
+/**
+ * Auto-tune du régulateur (méthode du relais) en mode surplus
+ * La puissance de la charge doit avoir été déterminée avant (SSR_Compute_Dump_power())
+ * Démarré au prochain calcul du surplus, avec la puissance de la charge à la tension mesurée
+ * A la fin, SSR_onAutoTuneDone() est appelée avec les nouveaux paramètres (task Cirrus)
+ */
+bool SSR_Start_AutoTune(void)
+{
+	if ((current_action != SSR_Action_Surplus) && (current_action != SSR_Action_Burst))
+		return false;
+	PIDMUX_ENTER();
+	PID_AutoTune_Request = true;
+	PIDMUX_EXIT();
+	return true;
+}
+
+bool SSR_Is_AutoTune(void)
+{
+	bool request;
+	PIDMUX_ENTER();
+	request = PID_AutoTune_Request;
+	PIDMUX_EXIT();
+	return request || PID.IsAutoTune();
 }
 
 // ********************************************************************************
@@ -931,6 +1195,9 @@ static int alarmID;
 
 void AlarmEndBoost_cb(size_t idAlarm, bool state, int param)
 {
+	(void) idAlarm; // For compiler
+	(void) state;
+	(void) param;
 	print_debug("Alarm cb : End boost.");
 	SSR_Set_Action(lastActionBeforeBoost, (lastStateBeforeBoost != SSR_OFF));
 }
@@ -5,6 +5,8 @@
 #endif
 
 #include <Arduino.h>
+#include "SSR_Curve.h"
+#include "SSR_PID.h"
 
 typedef enum
 {
@@ -25,9 +27,13 @@ typedef enum
 	SSR_Action_FULL,
 	SSR_Action_Percent,
 	SSR_Action_Surplus,
-	SSR_Action_Dimme
+	SSR_Action_Dimme,
+	SSR_Action_Burst
 } SSR_Action_typedef;
 
+// Fenêtre par défaut du mode SSR_Action_Burst en demi-périodes (1 s à 50 Hz)
+#define SSR_BURST_WINDOW	100
+
 /**
  * Definition of task for Boost and Dump operations
  */
@@ -79,10 +85,23 @@ float SSR_Get_Target(void);
 void SSR_Set_Percent(float percent);
 float SSR_Get_Percent(void);
 float SSR_Get_Current_Percent(void);
+uint32_t SSR_Get_Toggle_Count(bool reset = false);
+
+void SSR_Set_PID_Params(const SSR_PID_Params &params);
+SSR_PID_Params SSR_Get_PID_Params(void);
+bool SSR_Start_AutoTune(void);
+bool SSR_Is_AutoTune(void);
 
 void SSR_Set_Dimme_Target(float target);
 float SSR_Get_Dimme_Target(void);
 
+void SSR_Set_Burst_Window(uint16_t half_cycles);
+uint16_t SSR_Get_Burst_Window(void);
+
+void SSR_Set_Curve(SSR_Curve_typedef curve);
+SSR_Curve_typedef SSR_Get_Curve(void);
+uint32_t SSR_Percent_To_Delay(uint32_t fraction_q16);
+
 void SSR_Kill_Boost_With_Alarm(void);
 void SSR_Start_Boost_With_Alarm(int minute = 60);
 #ifdef SSR_USE_TASK
@@ -0,0 +1,109 @@
+/**
+ * Tables des angles d'amorçage du SSR en fonction du pourcentage demandé
+ *
+ * Les tables sont générées à la compilation (constexpr), il n'y a donc plus de calcul
+ * trigonométrique en double à chaque mise à jour du PID.
+ * Chaque table contient SSR_CURVE_SIZE + 1 points, de 0% à 100%. L'angle est codé en Q15 :
+ * 32768 correspond à une demi-période (angle PI).
+ *
+ * Deux courbes sont disponibles :
+ * - SSR_Curve_Power : puissance linéaire (equal-energy). Pour une charge résistive (chauffe-eau),
+ * la puissance délivrée avec un angle a est proportionnelle à l'intégrale de sin² entre a et PI :
+ * P(a) = 1 - a/PI + sin(2a)/(2PI). La table est l'inverse de cette fonction.
+ * - SSR_Curve_Acos : l'ancienne formule a = acos(2p - 1), linéaire en tension moyenne redressée.
+ *
+ * Le code doit rester compatible C++11 (ESP32 2.0.x) : fonctions constexpr récursives uniquement.
+ */
+#pragma once
+
+#include <stdint.h>
+
+typedef enum
+{
+	SSR_Curve_Power = 0,
+	SSR_Curve_Acos = 1
+} SSR_Curve_typedef;
+
+#define SSR_CURVE_BITS	8
+#define SSR_CURVE_SIZE	(1 << SSR_CURVE_BITS)   // Nombre d'intervalles de la table
+#define SSR_ANGLE_ONE		32768                   // Angle PI en Q15
+
+typedef struct
+{
+	uint16_t angle[SSR_CURVE_SIZE + 1];
+} SSR_Curve_Table;
+
+namespace SSR_Curve_Gen
+{
+	constexpr double CX_PI = 3.14159265358979323846;
+
+	// Série de Taylor de sin pour x dans [0, PI/2], term = x^n/n!
+	constexpr double sin_serie(double x2, double term, int n)
+	{
+		return (n > 21) ? term : term + sin_serie(x2, -term * x2 / ((n + 1) * (n + 2)), n + 2);
+	}
+
+	constexpr double cx_sin(double x)
+	{
+		return (x < 0) ? -cx_sin(-x) :
+				(x > CX_PI) ? -cx_sin(x - CX_PI) :
+				(x > CX_PI / 2) ? cx_sin(CX_PI - x) : sin_serie(x * x, x, 1);
+	}
+
+	constexpr double cx_cos(double x)
+	{
+		return cx_sin(x + CX_PI / 2);
+	}
+
+	// Fraction de la puissance (ou de la tension moyenne) délivrée pour un angle d'amorçage a
+	// Les deux fonctions sont décroissantes de 1 (a = 0) à 0 (a = PI)
+	constexpr double fraction(int curve, double a)
+	{
+		return (curve == SSR_Curve_Power) ? 1.0 - a / CX_PI + cx_sin(2.0 * a) / (2.0 * CX_PI) :
+				(1.0 + cx_cos(a)) / 2.0;
+	}
+
+	// Inversion de la fraction par dichotomie
+	constexpr double invert(int curve, double f, double lo, double hi, int n)
+	{
+		return (n == 0) ? (lo + hi) / 2.0 :
+				(fraction(curve, (lo + hi) / 2.0) > f) ? invert(curve, f, (lo + hi) / 2.0, hi, n - 1) :
+						invert(curve, f, lo, (lo + hi) / 2.0, n - 1);
+	}
+
+	constexpr uint16_t angle_q15(int curve, unsigned i)
+	{
+		return (uint16_t) (invert(curve, (double) i / SSR_CURVE_SIZE, 0.0, CX_PI, 40) / CX_PI * SSR_ANGLE_ONE + 0.5);
+	}
+
+	// Séquence d'index 0 .. N-1 (std::index_sequence n'existe pas en C++11)
+	template<unsigned ... I>
+	struct Index
+	{
+	};
+
+	template<unsigned N, unsigned ... I>
+	struct Make_Index: Make_Index<N - 1, N - 1, I...>
+	{
+	};
+
+	template<unsigned ... I>
+	struct Make_Index<0, I...>
+	{
+		typedef Index<I...> type;
+	};
+
+	template<unsigned ... I>
+	constexpr SSR_Curve_Table make_table(int curve, Index<I...>)
+	{
+		return {{angle_q15(curve, I)...}};
+	}
+}
+
+/**
+ * Génère la table de la courbe à la compilation
+ */
+constexpr SSR_Curve_Table SSR_Make_Curve_Table(SSR_Curve_typedef curve)
+{
+	return SSR_Curve_Gen::make_table(curve, SSR_Curve_Gen::Make_Index<SSR_CURVE_SIZE + 1>::type());
+}
@@ -0,0 +1,166 @@
+#include "SSR_PID.h"
+
+// Pas de temps min et max en s (premier appel ou régulation suspendue)
+#define DT_MIN	0.01
+#define DT_MAX	2.0
+
+// Auto-tune
+#define AT_HYSTERESIS	20.0       // Hystérésis du relais en W
+#define AT_CYCLES		4           // Nombre de périodes mesurées
+#define AT_TIMEOUT_MS	180000     // Abandon si pas d'oscillation après 3 minutes
+
+// Defined in SSR.cpp (weak), may be redefined elsewhere
+extern void print_debug(const char *mess, bool ln);
+
+void __attribute__((weak)) SSR_onAutoTuneDone(const SSR_PID_Params &params)
+{
+	(void) params;
+}
+
+/**
+ * Calcul de la nouvelle puissance à envoyer dans la charge
+ * setpoint : le surplus cible (puissance réseau désirée)
+ * grid_power : la puissance réseau mesurée (positive en soutirage, négative en injection)
+ * dump_now : la puissance actuellement dissipée par la charge
+ * dump_max : la puissance de la charge à 100% pour la tension en cours
+ * Retourne la puissance dans [0, dump_max]
+ */
+float SSR_PID_Class::Compute(float setpoint, float grid_power, float dump_now, float dump_max)
+{
+	uint32_t now = millis();
+	float dt = (now - _last_time) / 1000.0;
+	_last_time = now;
+
+	if (_at_state != atIdle)
+		return AutoTune(setpoint, grid_power, dump_max);
+
+	float error = setpoint - grid_power;
+	if (_first)
+	{
+		_last_error = error;
+		dt = DT_MIN;
+		_first = false;
+	}
+	if (dt < DT_MIN)
+		dt = DT_MIN;
+	else
+		if (dt > DT_MAX)
+			dt = DT_MAX;
+
+	// Gain scheduling : une grande variation de l'erreur est un changement de charge
+	// dans la maison, on compense directement une fraction Kff de l'erreur
+	float delta = error - _last_error;
+	_last_error = error;
+
+	float output = dump_now + _params.Ki * error * dt;
+	if (fabs(delta) > _params.Band)
+		output += _params.Kff * error;
+	else
+		output += _params.Kp * delta;
+
+	if (output < 0.0)
+		output = 0.0;
+	else
+		if (output > dump_max)
+			output = dump_max;
+	return output;
+}
+
+/**
+ * Démarre l'auto-tune par la méthode du relais
+ * dump_max : la puissance de la charge à 100%
+ */
+bool SSR_PID_Class::StartAutoTune(float dump_max)
+{
+	if (dump_max <= 0.0)
+		return false;
+
+	_at_state = atFirstCycle;
+	_at_high = false;
+	_at_start = millis();
+	_at_cycles = 0;
+	print_debug("Auto-tune PID start", true);
+	return true;
+}
+
+void SSR_PID_Class::StopAutoTune(void)
+{
+	_at_state = atIdle;
+	Reset();
+}
+
+float SSR_PID_Class::AutoTune(float setpoint, float grid_power, float dump_max)
+{
+	uint32_t now = millis();
+
+	if (now - _at_start > AT_TIMEOUT_MS)
+	{
+		print_debug("Auto-tune PID timeout", true);
+		StopAutoTune();
+		return 0.0;
+	}
+
+	float error = setpoint - grid_power;
+	bool high = _at_high;
+	if (!_at_high && (error > AT_HYSTERESIS))
+		high = true;
+	else
+		if (_at_high && (error < -AT_HYSTERESIS))
+			high = false;
+
+	if (_at_state == atMeasure)
+	{
+		if (grid_power < _at_min)
+			_at_min = grid_power;
+		if (grid_power > _at_max)
+			_at_max = grid_power;
+	}
+
+	// Une période complète à chaque passage bas -> haut
+	if (high && !_at_high)
+	{
+		_at_cycles++;
+		if (_at_state == atFirstCycle)
+		{
+			// On ignore la première période
+			if (_at_cycles == 2)
+			{
+				_at_state = atMeasure;
+				_at_cycles = 0;
+				_at_period = 0.0;
+				_at_min = _at_max = grid_power;
+			}
+		}
+		else
+		{
+			_at_period += (now - _at_last_switch) / 1000.0;
+			if (_at_cycles >= AT_CYCLES)
+			{
+				float amplitude = (_at_max - _at_min) / 2.0;
+				float Tu = _at_period / _at_cycles;
+				StopAutoTune();
+				if ((amplitude < 1.0) || (Tu < DT_MIN))
+				{
+					print_debug("Auto-tune PID failed", true);
+					return 0.0;
+				}
+
+				// Gain critique pour un relais d'amplitude dump_max / 2
+				float Ku = 2.0 * dump_max / (PI * amplitude);
+				// Ziegler-Nichols PI : Kp = 0.45 Ku, Ti = Tu / 1.2
+				_params.Kp = constrain(0.45 * Ku, 0.01, 2.0);
+				_params.Ki = constrain(0.54 * Ku / Tu, 0.001, 10.0);
+
+				char buffer[60];
+				sprintf(buffer, "Auto-tune PID: Kp=%.3f, Ki=%.3f", _params.Kp, _params.Ki);
+				print_debug(buffer, true);
+				SSR_onAutoTuneDone(_params);
+				return 0.0;
+			}
+		}
+		_at_last_switch = now;
+	}
+	_at_high = high;
+
+	return (_at_high) ? dump_max : 0.0;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#ifdef USE_CONFIG_LIB_FILE
+#include "config_lib.h"
+#endif
+
+#include "Arduino.h"
+#include <stdint.h>
+
+/**
+ * Paramètres du régulateur de surplus
+ * Kp : gain proportionnel (sur la variation de l'erreur)
+ * Ki : gain intégral en 1/s
+ * Kff : fraction de l'erreur compensée directement quand l'erreur varie de plus de Band
+ * (démarrage d'une charge), à la place du terme proportionnel
+ * Band : seuil en W de la variation de l'erreur pour passer sur le gain Kff
+ */
+typedef struct
+{
+		float Kp = 0.2;
+		float Ki = 0.5;
+		float Kff = 0.8;
+		float Band = 300.0;
+} SSR_PID_Params;
+
+/**
+ * Régulateur PI du surplus, forme incrémentale (vitesse)
+ *
+ * La sortie est la puissance à envoyer dans la charge. Elle part de la puissance réellement
+ * dissipée par la charge (pourcentage en cours x tension mesurée x Dump_Power_Relatif) puis
+ * on ajoute la correction. Comme la sortie est reconstruite à chaque appel à partir de la mesure
+ * et bornée à [0, puissance max], il n'y a pas d'emballement de l'intégrale (anti-windup).
+ * Le pas de temps est le temps réel entre deux appels (millis()).
+ *
+ * Auto-tune : méthode du relais (Åström-Hägglund). La charge est mise à 0 ou 100% suivant le signe
+ * de l'erreur, on mesure la période et l'amplitude des oscillations du réseau, puis on applique
+ * les gains de Ziegler-Nichols pour un PI. La puissance de la charge doit être connue avant
+ * (SSR_Compute_Dump_power() ou task SSR_DUMP_Task) et il faut du surplus pendant le test.
+ */
+class SSR_PID_Class
+{
+	public:
+		SSR_PID_Class()
+		{
+		}
+
+		void setParams(const SSR_PID_Params &params)
+		{
+			_params = params;
+			Reset();
+		}
+
+		const SSR_PID_Params& getParams(void) const
+		{
+			return _params;
+		}
+
+		void Reset(void)
+		{
+			_first = true;
+		}
+
+		float Compute(float setpoint, float grid_power, float dump_now, float dump_max);
+
+		bool StartAutoTune(float dump_max);
+		void StopAutoTune(void);
+		bool IsAutoTune(void) const
+		{
+			return (_at_state != atIdle);
+		}
+
+	private:
+		typedef enum
+		{
+			atIdle,
+			atFirstCycle,
+			atMeasure
+		} AutoTune_State;
+
+		SSR_PID_Params _params;
+		bool _first = true;
+		float _last_error = 0.0;
+		uint32_t _last_time = 0;
+
+		// Auto-tune
+		AutoTune_State _at_state = atIdle;
+		bool _at_high = false;
+		uint32_t _at_start = 0;
+		uint32_t _at_last_switch = 0;
+		uint8_t _at_cycles = 0;
+		float _at_period = 0.0;
+		float _at_min = 0.0;
+		float _at_max = 0.0;
+
+		float AutoTune(float setpoint, float grid_power, float dump_max);
+};
+
+// Appelée à la fin de l'auto-tune avec les nouveaux paramètres, à redéfinir pour les sauvegarder
+void SSR_onAutoTuneDone(const SSR_PID_Params &params);
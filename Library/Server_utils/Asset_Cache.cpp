@@ -0,0 +1,170 @@
+#include "Asset_Cache.h"
+
+#ifdef USE_ASSET_CACHE
+
+#include "Server_utils.h"
+#include "Partition_utils.h"
+
+Asset_Cache AssetCache;
+
+/**
+ * Only the static files of the web site, the others (csv, txt, ...) can be modified by the application
+ */
+bool Asset_Cache::Cacheable(const String &path) const
+{
+	return path.endsWith(".html") || path.endsWith(".htm") || path.endsWith(".js") || path.endsWith(".css")
+			|| path.endsWith(".ico") || path.endsWith(".png") || path.endsWith(".jpg") || path.endsWith(".gif")
+			|| path.endsWith(".svg");
+}
+
+/**
+ * Return the entry of the requested uri. path is the file to send (index.html for "/" for example),
+ * the compressed version path.gz is used if it exist (USE_GZ_FILE).
+ * The entry is created if it is not in the cache (the least recently used is replaced).
+ */
+const Asset_Entry* Asset_Cache::Lookup(const String &uri, const String &path)
+{
+	Asset_Entry *lru = NULL;
+
+	for (uint8_t i = 0; i < _count; i++)
+	{
+		if (_entries[i].uri.equals(uri))
+		{
+			_entries[i].last_use = ++_use_counter;
+			if (_entries[i].data)
+				_hits++;
+			else
+				_misses++;
+			return &_entries[i];
+		}
+		if ((lru == NULL) || (_entries[i].last_use < lru->last_use))
+			lru = &_entries[i];
+	}
+
+	_misses++;
+	if (_count < ASSET_CACHE_ENTRIES)
+		lru = &_entries[_count++];
+	else
+		FreeData(*lru);
+
+	Fill(*lru, uri, path);
+	return lru;
+}
+
+void Asset_Cache::Clear(void)
+{
+	for (uint8_t i = 0; i < _count; i++)
+	{
+		FreeData(_entries[i]);
+		_entries[i].uri = "";
+		_entries[i].path = "";
+	}
+	_count = 0;
+}
+
+/**
+ * For the diagnostic
+ */
+String Asset_Cache::Info(void) const
+{
+	return "Cache: " + String(_count) + " entries, " + String(_used) + " bytes, hits=" + String(_hits) + ", misses="
+			+ String(_misses) + ", 304=" + String(_not_modified);
+}
+
+void Asset_Cache::Fill(Asset_Entry &entry, const String &uri, const String &path)
+{
+	entry.uri = uri;
+	entry.path = path;
+	entry.mime = getMIMEType(path.c_str());
+	entry.gz = false;
+	entry.exists = false;
+	entry.size = 0;
+	entry.etag[0] = 0;
+	entry.last_use = ++_use_counter;
+
+#ifdef USE_GZ_FILE
+	File file = FS_Partition->open(path + ".gz", "r");
+	if (file)
+	{
+		entry.path += ".gz";
+		entry.gz = true;
+	}
+	else
+		file = FS_Partition->open(path, "r");
+#else
+	File file = FS_Partition->open(path, "r");
+#endif
+	if (!file || file.isDirectory())
+	{
+		if (file)
+			file.close();
+		return;
+	}
+
+	entry.exists = true;
+	entry.size = file.size();
+	snprintf(entry.etag, sizeof(entry.etag), "\"%x-%lx\"", (unsigned int) entry.size,
+			(unsigned long) file.getLastWrite());
+	file.close();
+
+	LoadData(entry);
+}
+
+/**
+ * Load the content of the file if it is small enough.
+ * Remove the content of the least recently used entries if necessary.
+ */
+bool Asset_Cache::LoadData(Asset_Entry &entry)
+{
+	if ((entry.size == 0) || (entry.size > ASSET_CACHE_MAX_FILE) || (entry.size > ASSET_CACHE_SIZE))
+		return false;
+
+	while (_used + entry.size > ASSET_CACHE_SIZE)
+	{
+		Asset_Entry *lru = NULL;
+		for (uint8_t i = 0; i < _count; i++)
+		{
+			if ((&_entries[i] != &entry) && _entries[i].data && ((lru == NULL) || (_entries[i].last_use < lru->last_use)))
+				lru = &_entries[i];
+		}
+		if (lru == NULL)
+			return false;
+		FreeData(*lru);
+	}
+
+	uint8_t *data = NULL;
+#ifdef ESP32
+	if (psramFound())
+		data = (uint8_t*) ps_malloc(entry.size);
+#endif
+	if (data == NULL)
+		data = (uint8_t*) malloc(entry.size);
+	if (data == NULL)
+		return false;
+
+	File file = FS_Partition->open(entry.path, "r");
+	if (!file || (file.read(data, entry.size) != entry.size))
+	{
+		if (file)
+			file.close();
+		free(data);
+		return false;
+	}
+	file.close();
+
+	// The content is freed when the last response that use it is finished
+	entry.data = std::shared_ptr<uint8_t>(data, free);
+	_used += entry.size;
+	return true;
+}
+
+void Asset_Cache::FreeData(Asset_Entry &entry)
+{
+	if (entry.data)
+	{
+		entry.data.reset();
+		_used -= entry.size;
+	}
+}
+
+#endif // USE_ASSET_CACHE
@@ -0,0 +1,106 @@
+#pragma once
+
+/**
+ * Cache of the static web assets (html, js, css, ...) of the FS partition
+ *
+ * For each requested path, the cache keep :
+ * - the real file (path or path.gz) or that the file does not exist,
+ * - the MIME type,
+ * - a strong ETag from the size and the last write time of the file,
+ * - the content of the file if it is small enough (ASSET_CACHE_MAX_FILE) and if there is place
+ * (ASSET_CACHE_SIZE bytes for all the contents). The content is in PSRAM if available.
+ * So a page load don't touch the filesystem : the content is sent from the memory and the
+ * request with If-None-Match equal to the ETag is answered with 304.
+ *
+ * The least recently used entry is removed when the cache is full.
+ * The cache must be cleared when a file of the FS partition is modified (upload, delete, ...).
+ * Only the static files are cached (see Cacheable()), not the data files written by the application.
+ *
+ * Use the directive USE_ASSET_CACHE.
+ */
+
+#ifdef USE_CONFIG_LIB_FILE
+#include "config_lib.h"
+#endif
+
+#include "Arduino.h"
+#include <memory>
+
+// Number of entries (paths)
+#ifndef ASSET_CACHE_ENTRIES
+#define ASSET_CACHE_ENTRIES	24
+#endif
+
+// Total size of the content in memory
+#ifndef ASSET_CACHE_SIZE
+#define ASSET_CACHE_SIZE	(96 * 1024)
+#endif
+
+// Max size of a file to keep its content
+#ifndef ASSET_CACHE_MAX_FILE
+#define ASSET_CACHE_MAX_FILE	(48 * 1024)
+#endif
+
+typedef struct
+{
+		String uri;         // The requested path (the key)
+		String path;        // The real file
+		const char *mime;   // From the MIME table, no allocation
+		bool exists;
+		bool gz;
+		size_t size;
+		char etag[24];
+		std::shared_ptr<uint8_t> data; // The content or NULL
+		uint32_t last_use;
+} Asset_Entry;
+
+class Asset_Cache
+{
+	public:
+		Asset_Cache()
+		{
+		}
+
+		bool Cacheable(const String &path) const;
+		const Asset_Entry* Lookup(const String &uri, const String &path);
+		void Clear(void);
+
+		uint32_t getHits(void) const
+		{
+			return _hits;
+		}
+		uint32_t getMisses(void) const
+		{
+			return _misses;
+		}
+		uint32_t getNotModified(void) const
+		{
+			return _not_modified;
+		}
+		void addNotModified(void)
+		{
+			_not_modified++;
+		}
+		size_t getUsed(void) const
+		{
+			return _used;
+		}
+		String Info(void) const;
+
+	private:
+		Asset_Entry _entries[ASSET_CACHE_ENTRIES];
+		uint8_t _count = 0;
+		uint32_t _use_counter = 0;
+		size_t _used = 0;
+		uint32_t _hits = 0;
+		uint32_t _misses = 0;
+		uint32_t _not_modified = 0;
+
+		void Fill(Asset_Entry &entry, const String &uri, const String &path);
+		bool LoadData(Asset_Entry &entry);
+		void FreeData(Asset_Entry &entry);
+};
+
+#ifdef USE_ASSET_CACHE
+extern Asset_Cache AssetCache;
+#endif
@@ -0,0 +1,280 @@
+#include "Server_Push.h"
+
+#ifdef USE_SERVER_PUSH
+
+#include "Server_utils.h"
+#include "Debug_utils.h"
+#ifndef USE_ASYNC_WEBSERVER
+#include <lwip/sockets.h>
+#endif
+
+// The last published frame
+static char Push_Frame[PUSH_MAX_FRAME];
+static size_t Push_Frame_Len = 0;
+static uint32_t Push_Seq = 0;
+static volatile uint32_t Push_Dropped = 0;
+static portMUX_TYPE Push_Mux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Publish the frame, can be called from any task
+ * The frame is sent by Server_Push_Loop()
+ */
+bool Server_Push_Publish(const char *frame, size_t len)
+{
+	if (len > PUSH_MAX_FRAME)
+		return false;
+
+	taskENTER_CRITICAL(&Push_Mux);
+	memcpy(Push_Frame, frame, len);
+	Push_Frame_Len = len;
+	Push_Seq++;
+	taskEXIT_CRITICAL(&Push_Mux);
+	return true;
+}
+
+#ifdef USE_ASYNC_WEBSERVER
+
+// ********************************************************************************
+// WebSocket (async web server)
+// ********************************************************************************
+
+static AsyncWebSocket Push_WS(PUSH_WS_PATH);
+static uint32_t Push_Clients[PUSH_MAX_CLIENTS] = {0};
+static volatile uint8_t Push_Count = 0;
+
+static void onPushEvent(AsyncWebSocket *ws, AsyncWebSocketClient *client, AwsEventType type, void *arg,
+		uint8_t *data, size_t len)
+{
+	(void) ws;
+	(void) arg;
+	(void) data;
+	(void) len;
+	bool accepted = false;
+
+	switch (type)
+	{
+		case WS_EVT_CONNECT:
+			taskENTER_CRITICAL(&Push_Mux);
+			for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++)
+			{
+				if (Push_Clients[i] == 0)
+				{
+					Push_Clients[i] = client->id();
+					Push_Count++;
+					accepted = true;
+					break;
+				}
+			}
+			taskEXIT_CRITICAL(&Push_Mux);
+			if (!accepted)
+				client->close();
+			break;
+		case WS_EVT_DISCONNECT:
+			taskENTER_CRITICAL(&Push_Mux);
+			for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++)
+			{
+				if (Push_Clients[i] == client->id())
+				{
+					Push_Clients[i] = 0;
+					Push_Count--;
+					break;
+				}
+			}
+			taskEXIT_CRITICAL(&Push_Mux);
+			break;
+		default:
+			;
+	}
+}
+
+void Server_Push_Begin(void)
+{
+	Push_WS.onEvent(onPushEvent);
+	server.addHandler(&Push_WS);
+}
+
+/**
+ * Send the last frame to all the clients, to call in the loop
+ * The frame is not sent to a client that has its queue full
+ */
+void Server_Push_Loop(void)
+{
+	static char frame[PUSH_MAX_FRAME];
+	static uint32_t sent_seq = 0;
+	uint32_t clients[PUSH_MAX_CLIENTS];
+	size_t len = 0;
+	bool new_frame = false;
+
+	taskENTER_CRITICAL(&Push_Mux);
+	if (Push_Seq != sent_seq)
+	{
+		memcpy(frame, Push_Frame, Push_Frame_Len);
+		len = Push_Frame_Len;
+		// The frames published between two loops are lost
+		Push_Dropped += Push_Seq - sent_seq - 1;
+		sent_seq = Push_Seq;
+		memcpy(clients, Push_Clients, sizeof(clients));
+		new_frame = true;
+	}
+	taskEXIT_CRITICAL(&Push_Mux);
+
+	if (new_frame)
+	{
+		for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++)
+		{
+			if (clients[i] == 0)
+				continue;
+			AsyncWebSocketClient *client = Push_WS.client(clients[i]);
+			if ((client != NULL) && client->canSend())
+				client->text(frame, len);
+			else
+				Push_Dropped++;
+		}
+	}
+	Push_WS.cleanupClients(PUSH_MAX_CLIENTS);
+}
+
+uint8_t Server_Push_Count(void)
+{
+	return Push_Count;
+}
+
+#else
+
+// ********************************************************************************
+// Server-Sent Events (sync web server)
+// ********************************************************************************
+
+#define SSE_HEADER_SIZE	6    // "data: "
+#define SSE_FOOTER_SIZE	2    // "\n\n"
+
+typedef struct
+{
+		WiFiClient client;
+		bool active;
+		uint32_t seq;       // Sequence of the frame in pending
+		uint16_t len;       // Length of the pending frame
+		uint16_t offset;    // Already sent
+		char pending[SSE_HEADER_SIZE + PUSH_MAX_FRAME + SSE_FOOTER_SIZE];
+} Push_Client_Struct;
+
+static Push_Client_Struct Push_Clients[PUSH_MAX_CLIENTS];
+
+/**
+ * Handle of the event stream : the client is kept open and added to the list
+ */
+static void handlePushEvents(void)
+{
+	for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++)
+	{
+		if (!Push_Clients[i].active)
+		{
+			Push_Client_Struct *push = &Push_Clients[i];
+			push->client = server.client();
+			push->client.setNoDelay(true);
+			push->client.print(F("HTTP/1.1 200 OK\r\n"
+					"Content-Type: text/event-stream\r\n"
+					"Cache-Control: no-cache\r\n"
+					"Connection: keep-alive\r\n"
+					"Access-Control-Allow-Origin: *\r\n\r\n"
+					"retry: 2000\n\n"));
+			push->len = 0;
+			push->offset = 0;
+			push->seq = Push_Seq;
+			push->active = true;
+			return;
+		}
+	}
+	server.send(503, "text/plain", "Too many clients");
+}
+
+void Server_Push_Begin(void)
+{
+	server.on(PUSH_SSE_PATH, HTTP_GET, handlePushEvents);
+}
+
+/**
+ * Send without blocking. Return false if the connexion is lost.
+ */
+static bool Push_Send(Push_Client_Struct *push)
+{
+	int sent = send(push->client.fd(), &push->pending[push->offset], push->len - push->offset, MSG_DONTWAIT);
+	if (sent < 0)
+		return ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+	push->offset += sent;
+	return true;
+}
+
+/**
+ * Send the last frame to the clients, to call in the loop of the web server
+ */
+void Server_Push_Loop(void)
+{
+	for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++)
+	{
+		Push_Client_Struct *push = &Push_Clients[i];
+		if (!push->active)
+			continue;
+
+		if (!push->client.connected())
+		{
+			push->client.stop();
+			push->active = false;
+			continue;
+		}
+
+		// A new frame and the previous one is completely sent
+		if ((push->offset == push->len) && (push->seq != Push_Seq))
+		{
+			memcpy(push->pending, "data: ", SSE_HEADER_SIZE);
+			taskENTER_CRITICAL(&Push_Mux);
+			memcpy(&push->pending[SSE_HEADER_SIZE], Push_Frame, Push_Frame_Len);
+			push->len = SSE_HEADER_SIZE + Push_Frame_Len;
+			// The frames published while the client was busy are lost
+			Push_Dropped += Push_Seq - push->seq - 1;
+			push->seq = Push_Seq;
+			taskEXIT_CRITICAL(&Push_Mux);
+			memcpy(&push->pending[push->len], "\n\n", SSE_FOOTER_SIZE);
+			push->len += SSE_FOOTER_SIZE;
+			push->offset = 0;
+		}
+
+		if ((push->offset < push->len) && !Push_Send(push))
+		{
+			push->client.stop();
+			push->active = false;
+		}
+	}
+}
+
+uint8_t Server_Push_Count(void)
+{
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < PUSH_MAX_CLIENTS; i++)
+		if (Push_Clients[i].active)
+			count++;
+	return count;
+}
+
+#endif // USE_ASYNC_WEBSERVER
+
+/**
+ * Number of frames not sent to a client because it was busy
+ */
+uint32_t Server_Push_Dropped(bool reset)
+{
+	uint32_t dropped = Push_Dropped;
+	if (reset)
+		Push_Dropped = 0;
+	return dropped;
+}
+
+/**
+ * For the diagnostic, the number of clients and the number of frames dropped
+ */
+String Server_Push_Info(void)
+{
+	return "Push: " + String(Server_Push_Count()) + " cl, " + String(Server_Push_Dropped()) + " drop";
+}
+
+#endif // USE_SERVER_PUSH
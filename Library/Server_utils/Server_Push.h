@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+ * Push channel for live data : the server send the data to the clients instead of a polling
+ * - Sync web server : Server-Sent Events on PUSH_SSE_PATH (EventSource in the browser)
+ * - Async web server (USE_ASYNC_WEBSERVER) : WebSocket on PUSH_WS_PATH
+ *
+ * The producer (for example the acquisition task) publish one frame by cycle with Server_Push_Publish().
+ * The frame is only copied, it is serialised once and broadcast to all the clients by Server_Push_Loop()
+ * called in the loop (for the two web servers, the producer never touch the clients).
+ * A slow client never block the producer :
+ * - SSE : each client has its pending frame. When the client is ready, it receive the last
+ * published frame, the intermediate frames are dropped.
+ * - WebSocket : the frame is not queued if the queue of the client is full.
+ * The dropped frames are counted (see Server_Push_Dropped()).
+ *
+ * ESP32 only. Use the directive USE_SERVER_PUSH.
+ *
+ * Exemple :
+ * In OnAfterConnexion() :
+ * 	Server_Push_Begin();
+ * In the loop :
+ * 	server.handleClient(); // Sync web server only
+ * 	Server_Push_Loop();
+ * In the acquisition task :
+ * 	if (Server_Push_Count() > 0)
+ * 	  Server_Push_Publish(buffer, strlen(buffer));
+ * In the browser (SSE) :
+ *  var source = new EventSource("/events");
+ *  source.onmessage = function(event) { console.log(event.data); };
+ */
+
+#ifdef USE_CONFIG_LIB_FILE
+#include "config_lib.h"
+#endif
+
+#include "Arduino.h"
+
+// Max size of a frame
+#ifndef PUSH_MAX_FRAME
+#define PUSH_MAX_FRAME	512
+#endif
+
+// Max number of clients
+#ifndef PUSH_MAX_CLIENTS
+#define PUSH_MAX_CLIENTS	4
+#endif
+
+#define PUSH_SSE_PATH	"/events"
+#define PUSH_WS_PATH	"/ws"
+
+void Server_Push_Begin(void);
+bool Server_Push_Publish(const char *frame, size_t len);
+void Server_Push_Loop(void);
+
+uint8_t Server_Push_Count(void);
+uint32_t Server_Push_Dropped(bool reset = false);
+String Server_Push_Info(void);
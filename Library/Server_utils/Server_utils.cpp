@@ -1,5 +1,6 @@
 #include "server_utils.h"
 #include <FS.h>               // For File
+#include <memory>             // For shared_ptr (stream state)
 #include "Partition_utils.h"	// Some utils functions for LittleFS/SPIFFS/FatFS
 #if defined(USE_RTCLocal)
 #include "RTCLocal.h"		      // A pseudo RTC software library
@@ -10,6 +11,10 @@
 #include "Tasks_utils.h"
 #endif
 
+#ifdef USE_ASSET_CACHE
+#include "Asset_Cache.h"
+#endif
+
 // Print SSID/pwd in debug log file
 //#define SSID_PRINT_DEBUG
 
@@ -518,6 +523,11 @@ bool ServerConnexion::Connexion(bool toUART)
 		_onAfterConnexion();
 
 	// Start the server
+#if defined(USE_ASSET_CACHE) && !defined(USE_ASYNC_WEBSERVER)
+	// The sync web server keep only the headers asked
+	const char *headers[] = {"If-None-Match"};
+	server.collectHeaders(headers, 1);
+#endif
 	server.begin();
 #ifdef USE_MDNS
 		MDNS.addService("http", "tcp", SERVER_PORT);
@@ -1120,6 +1130,18 @@ void Server_CommonEvent(uint32_t event)
 	// xmlHttp.send(null);
 	if ((event & Ev_GetESPMACAddress) == Ev_GetESPMACAddress)
 		server.on("/getESPMACAddress", HTTP_GET, handleGetESPMACAddress);
+
+#ifdef USE_ASSET_CACHE
+	// get the statistics of the cache of the web page
+	// Server side :
+	// xmlHttp.open("GET","/getCacheInfo",true);
+	// xmlHttp.send(null);
+	if ((event & Ev_CacheInfo) == Ev_CacheInfo)
+		server.on("/getCacheInfo", HTTP_GET, [](CB_SERVER_PARAM)
+		{
+			pserver->send(200, "text/plain", AssetCache.Info());
+		});
+#endif
 }
 
 /**
@@ -1156,7 +1178,8 @@ void send_html(AsyncWebServerRequest *request, String filefs, String format, boo
 	if (zipped)
 	{
 		response->addHeader("Content-Encoding", "gzip");
-		response->addHeader("Cache-Control", "max-age=604800");
+		// No ETag here : a short cache so a new version of the UI is loaded after an update
+		response->addHeader("Cache-Control", "max-age=300");
 	}
 	request->send(response);
 }
@@ -1169,6 +1192,70 @@ void send_html(String filefs, String format, PART_TYPE &partition)
 }
 #endif
 
+// ********************************************************************************
+// Streaming response
+// ********************************************************************************
+
+// Max heap used by a stream response (heap at the begining - heap during the response)
+static size_t Stream_PeakHeap = 0;
+
+static inline void Stream_UpdatePeak(uint32_t heap_start)
+{
+	uint32_t heap = ESP.getFreeHeap();
+	if ((heap_start > heap) && (heap_start - heap > Stream_PeakHeap))
+		Stream_PeakHeap = heap_start - heap;
+}
+
+#ifdef USE_ASYNC_WEBSERVER
+void SendStream(AsyncWebServerRequest *request, const String &contentType, const onStreamFill &fill)
+{
+	uint32_t heap_start = ESP.getFreeHeap();
+	request->send(request->beginChunkedResponse(contentType,
+			[fill, heap_start](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+			{
+				(void) index;
+				size_t len = fill((char*) buffer, maxLen);
+				Stream_UpdatePeak(heap_start);
+				return (len == STREAM_TRY_AGAIN) ? RESPONSE_TRY_AGAIN : len;
+			}));
+}
+#else
+void SendStream(const String &contentType, const onStreamFill &fill)
+{
+	static char Stream_Buffer[STREAM_BUFFER_SIZE];
+	uint32_t heap_start = ESP.getFreeHeap();
+	size_t len;
+
+	server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+	server.send(200, contentType, "");
+	while ((len = fill(Stream_Buffer, STREAM_BUFFER_SIZE)) > 0)
+	{
+		// With a buffer of STREAM_BUFFER_SIZE, STREAM_TRY_AGAIN is an error (item too big).
+		// The connexion is closed without the last chunk : the client see an incomplete response.
+		if (len == STREAM_TRY_AGAIN)
+		{
+			print_debug(F("SendStream: item too big, response aborted"));
+			server.client().stop();
+			return;
+		}
+		server.sendContent(Stream_Buffer, len);
+		Stream_UpdatePeak(heap_start);
+	}
+	server.sendContent("");
+}
+#endif
+
+/**
+ * Return the max heap used by a stream response since the last reset
+ */
+size_t SendStream_PeakHeap(bool reset)
+{
+	size_t peak = Stream_PeakHeap;
+	if (reset)
+		Stream_PeakHeap = 0;
+	return peak;
+}
+
 /**
  * handle the default AP configuration
  * When the SSID is stored in file and when the file is not found or
@@ -1213,6 +1300,84 @@ void handleNotFound(CB_SERVER_PARAM)
 	pserver->send(404, "text/plain", "404: Not found for " + path);
 }
 
+#ifdef USE_ASSET_CACHE
+/**
+ * Send the file from the asset cache :
+ * - 304 if the client has the same version (If-None-Match equal to the ETag)
+ * - the content in memory if it is in the cache
+ * - else the file, with the ETag
+ * Return false if the file does not exist
+ */
+#ifdef USE_ASYNC_WEBSERVER
+static bool handleCachedFile(AsyncWebServerRequest *pserver, const String &uri, const String &path)
+#else
+static bool handleCachedFile(const String &uri, const String &path)
+#endif
+{
+	const Asset_Entry *entry = AssetCache.Lookup(uri, path);
+	if (!entry->exists)
+	{
+		print_debug(F("\tFile Not Found"));
+		return false;
+	}
+
+	// Always checked with the ETag (a 304 if not modified) : after an update of the file system,
+	// the browser must not keep the old JS/CSS
+	const char *cache_control = "no-cache";
+
+#ifdef USE_ASYNC_WEBSERVER
+	AsyncWebServerResponse *response;
+	if (pserver->hasHeader("If-None-Match") && pserver->getHeader("If-None-Match")->value().equals(entry->etag))
+	{
+		AssetCache.addNotModified();
+		response = pserver->beginResponse(304);
+	}
+	else
+	{
+		if (entry->data)
+		{
+			// The response keep the content until the end, even if it is removed from the cache
+			std::shared_ptr<uint8_t> data = entry->data;
+			size_t size = entry->size;
+			response = pserver->beginResponse(entry->mime, size,
+					[data, size](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+					{
+						size_t len = (size - index < maxLen) ? size - index : maxLen;
+						memcpy(buffer, data.get() + index, len);
+						return len;
+					});
+		}
+		else
+			response = pserver->beginResponse(*FS_Partition, entry->path, entry->mime);
+		if (entry->gz)
+			response->addHeader("Content-Encoding", "gzip");
+	}
+	response->addHeader("ETag", entry->etag);
+	response->addHeader("Cache-Control", cache_control);
+	pserver->send(response);
+#else
+	server.sendHeader("ETag", entry->etag);
+	server.sendHeader("Cache-Control", cache_control);
+	if (server.header("If-None-Match").equals(entry->etag))
+	{
+		AssetCache.addNotModified();
+		server.send(304);
+	}
+	else
+		if (entry->data)
+		{
+			if (entry->gz)
+				server.sendHeader("Content-Encoding", "gzip");
+			server.send_P(200, entry->mime, (const char*) entry->data.get(), entry->size);
+		}
+		else
+			send_html(entry->path, entry->mime, *FS_Partition); // streamFile add the gzip header
+#endif
+	return true;
+}
+#endif
+
+
 /**
  * Handle the basic read file with HTTP_GET method :
  * JavaScript side :
@@ -1249,11 +1414,20 @@ bool handleReadFile(CB_SERVER_PARAM)
 	if (_path.equals("/index.html"))
 	_path = "/default.html";
 #endif
+#ifdef USE_ASSET_CACHE
+	if (!pserver->hasArg("download") && AssetCache.Cacheable(_path))
+#ifdef USE_ASYNC_WEBSERVER
+		return handleCachedFile(pserver, path, _path);
+#else
+		return handleCachedFile(path, _path);
+#endif
+#endif
+
 	String contentType;
 	if (pserver->hasArg("download"))
 		contentType = "application/octet-stream";
 	else
-		contentType = getContentType(_path);	// Get the MIME type
+		contentType = getMIMEType(_path.c_str());	// Get the MIME type
 	bool pathWithGz = false;
 #ifdef USE_GZ_FILE
 	if (FS_Partition->exists(_path + ".gz")) // If there's a compressed version available, use it
@@ -1318,6 +1492,9 @@ void handleDeleteFile(CB_SERVER_PARAM)
 
 	if (!DeleteFile(path, pserver->hasArg("DATA_PART")))
 		return pserver->send(404, "text/plain", "404: Not found for " + path);
+#ifdef USE_ASSET_CACHE
+	AssetCache.Clear();
+#endif
 
 	print_debug("handleDeleteFile: " + path);
 	pserver->send(204);
@@ -1449,6 +1626,9 @@ void handleUploadFile(AsyncWebServerRequest *request, String thefile, size_t ind
 		{
 			// close the file handle as the upload is now done
 			request->_tempFile.close();
+#ifdef USE_ASSET_CACHE
+			AssetCache.Clear();
+#endif
 			logmessage = "Upload Complete: " + String(filename) + ", size: " + String(index + len);
 			print_debug(logmessage);
 			delay(10);
@@ -1511,6 +1691,9 @@ void handleUploadFile(CB_SERVER_PARAM)
 			if (fsUploadFile)
 			{
 				fsUploadFile.close();              // Close the file
+#ifdef USE_ASSET_CACHE
+				AssetCache.Clear();
+#endif
 				print_debug("handleFileUpload Size: " + String(upload.totalSize));
 				if (ReloadPage)
 				{
@@ -1566,6 +1749,101 @@ void handleUploadFile(CB_SERVER_PARAM)
  * Server side :
  * 	server.on("/listFile", HTTP_GET, handleListFile);
  */
+typedef struct
+{
+#ifdef ESP8266
+		Dir dir;
+#else
+		File root;
+#endif
+		uint8_t step;      // 0 = begin, 1 = entries, 2 = end
+		bool first;
+		size_t entry_len;  // Length of the entry not yet sent
+		char entry[STREAM_ENTRY_SIZE];
+} ListFile_State;
+
+/**
+ * Format the next entry of the directory in state.entry
+ * Return false if there is no more entry
+ */
+static bool ListFile_NextEntry(ListFile_State &state)
+{
+	const char *sep = (state.first) ? "" : ",\r\n";
+	int len = -1;
+#ifdef ESP8266
+	while ((len < 0) && state.dir.next())
+	{
+		if (state.dir.isFile())
+			len = snprintf(state.entry, STREAM_ENTRY_SIZE,
+					"%s{\"type\":\"file\", \"name\":\"%s\", \"size\":\"%s\", \"time\":%ld}", sep,
+					state.dir.fileName().c_str(), formatBytes(state.dir.fileSize(), 0).c_str(),
+					(long) state.dir.fileTime());
+		else
+			if (state.dir.isDirectory())
+				len = snprintf(state.entry, STREAM_ENTRY_SIZE, "%s{\"type\":\"dir\", \"name\":\"%s\"}", sep,
+						state.dir.fileName().c_str());
+	}
+#endif
+#ifdef ESP32
+	if (state.root && state.root.isDirectory())
+	{
+		File file = state.root.openNextFile();
+		if (file)
+		{
+			if (file.isDirectory())
+				len = snprintf(state.entry, STREAM_ENTRY_SIZE, "%s{\"type\":\"dir\", \"name\":\"%s\"}", sep,
+						file.name());
+			else
+				len = snprintf(state.entry, STREAM_ENTRY_SIZE,
+						"%s{\"type\":\"file\", \"name\":\"%s\", \"size\":\"%s\", \"time\":%ld}", sep,
+						file.name(), formatBytes(file.size(), 0).c_str(), (long) file.getLastWrite());
+			file.close();
+		}
+	}
+#endif
+	if (len < 0)
+		return false;
+	state.entry_len = (len < STREAM_ENTRY_SIZE) ? len : STREAM_ENTRY_SIZE - 1;
+	state.first = false;
+	return true;
+}
+
+/**
+ * Fill the buffer with the JSON list : [entry,\r\n entry ...]
+ */
+static size_t ListFile_Fill(ListFile_State &state, char *buffer, size_t size)
+{
+	size_t len = 0;
+
+	if (state.step == 0)
+	{
+		buffer[len++] = '[';
+		state.step = 1;
+	}
+	while (state.step == 1)
+	{
+		if ((state.entry_len == 0) && !ListFile_NextEntry(state))
+		{
+#ifdef ESP32
+			state.root.close();
+#endif
+			state.step = 2;
+			break;
+		}
+		if (len + state.entry_len > size)
+			return (len == 0) ? STREAM_TRY_AGAIN : len;
+		memcpy(&buffer[len], state.entry, state.entry_len);
+		len += state.entry_len;
+		state.entry_len = 0;
+	}
+	if ((state.step == 2) && (len < size))
+	{
+		buffer[len++] = ']';
+		state.step = 3;
+	}
+	return len;
+}
+
 void handleListFile(CB_SERVER_PARAM)
 {
 	// DIR arg not found
@@ -1581,74 +1859,28 @@ void handleListFile(CB_SERVER_PARAM)
 		return pserver->send(404, "text/plain", "404: Not found for " + path);
 #endif
 
-	String output = "[";
+	// The list is sent by chunks, one entry at a time, no String of the whole list
+	std::shared_ptr<ListFile_State> state = std::make_shared<ListFile_State>();
+	state->step = 0;
+	state->first = true;
+	state->entry_len = 0;
 #ifdef ESP8266
-	Dir dir = FS_Partition->openDir(path);
-	while (dir.next())
-	{
-		String fileName = dir.fileName();
-		size_t fileSize = dir.fileSize();
-		if (output != "[")
-			output += ",\r\n";
-		if (dir.isFile())
-		{
-			time_t time = dir.fileTime();
-			output += "{\"type\":\"file\"";
-			output += ", \"name\":\"";
-			output += fileName;
-			output += "\", \"size\":\"";
-			output += formatBytes(fileSize, 0);
-			output += "\", \"time\":";
-			output += time;
-			output += "}";
-		}
-		else
-		{
-			if (dir.isDirectory())
-			{
-				output += "{\"type\":\"dir\"";
-				output += ", \"name\":\"";
-				output += fileName;
-				output += "\"}";
-			}
-		}
-	}
+	state->dir = FS_Partition->openDir(path);
+#else
+	state->root = FS_Partition->open(path);
 #endif
-#ifdef ESP32
-	File root = FS_Partition->open(path);
-	if (root.isDirectory())
+
+#ifdef USE_ASYNC_WEBSERVER
+	SendStream(pserver, "text/json", [state](char *buffer, size_t size) -> size_t
 	{
-		File file = root.openNextFile();
-		while (file)
-		{
-			if (file.isDirectory())
-			{
-				output += "{\"type\":\"dir\"";
-				output += ", \"name\":\"";
-				output += file.name();
-				output += "\"}";
-			}
-			else
-			{
-				time_t time = file.getLastWrite();
-				output += "{\"type\":\"file\"";
-				output += ", \"name\":\"";
-				output += file.name();
-				output += "\", \"size\":\"";
-				output += formatBytes(file.size(), 0);
-				output += "\", \"time\":";
-				output += time;
-				output += "}";
-			}
-			file = root.openNextFile();
-			if (file)
-				output += ",\r\n";
-		}
-	}
+		return ListFile_Fill(*state, buffer, size);
+	});
+#else
+	SendStream("text/json", [state](char *buffer, size_t size) -> size_t
+	{
+		return ListFile_Fill(*state, buffer, size);
+	});
 #endif
-	output += "]";
-	print_debug(output);
-	pserver->send(200, "text/json", output);
 }
 
 /**
@@ -1678,6 +1910,9 @@ void handleCreateFile(CB_SERVER_PARAM)
 		file.close();
 	else
 		return pserver->send(500, "text/plain", "CREATE FAILED");
+#ifdef USE_ASSET_CACHE
+	AssetCache.Clear();
+#endif
 
 	pserver->send(200, "text/plain", "OK");
 }
@@ -1810,44 +2045,96 @@ void handleGetESPMACAddress(CB_SERVER_PARAM)
 		pserver->send(200, "text/plain", F("Fail to get ESP MAC address"));
 }
 
+// ********************************************************************************
+// MIME types
+// ********************************************************************************
+
+/**
+ * The extensions are found with a perfect hash (no collision in the MIME_SLOTS slots),
+ * the index of the slots is computed and checked at compile time.
+ * If an extension is added, it may be necessary to change MIME_SEED (a static_assert fail).
+ */
+typedef struct
+{
+		const char *ext;
+		const char *mime;
+} MIME_Entry;
+
+static constexpr MIME_Entry MIME_Table[] = {
+		{"html", "text/html"},
+		{"htm", "text/html"},
+		{"gz", "application/x-gzip"},
+		{"css", "text/css"},
+		{"js", "application/javascript"},
+		{"png", "image/png"},
+		{"gif", "image/gif"},
+		{"jpg", "image/jpeg"},
+		{"ico", "image/x-icon"},
+		{"svg", "image/svg+xml"},
+		{"xml", "text/xml"},
+		{"json", "application/json"},
+		{"pdf", "application/x-pdf"},
+		{"zip", "application/x-zip"}};
+
+#define MIME_DEFAULT	"text/plain"
+#define MIME_COUNT	(sizeof(MIME_Table) / sizeof(MIME_Entry))
+#define MIME_MAX_EXT	4
+#define MIME_SLOTS_BITS	5
+#define MIME_SLOTS	(1 << MIME_SLOTS_BITS)
+#define MIME_SEED	26
+
+// FNV-1a, the slot is given by the high bits
+static constexpr uint32_t MIME_Hash(const char *ext, uint32_t h = MIME_SEED)
+{
+	return (*ext == 0) ? h : MIME_Hash(ext + 1, (h ^ (uint8_t) *ext) * 16777619UL);
+}
+
+static constexpr uint8_t MIME_Slot(const char *ext)
+{
+	return MIME_Hash(ext) >> (32 - MIME_SLOTS_BITS);
+}
+
+// Index in MIME_Table of the extension of the slot, MIME_COUNT if the slot is empty
+static constexpr uint8_t MIME_Find(uint8_t slot, uint8_t i = 0)
+{
+	return (i == MIME_COUNT) ? MIME_COUNT : ((MIME_Slot(MIME_Table[i].ext) == slot) ? i : MIME_Find(slot, i + 1));
+}
+
+// Check that the extension i is the only one in its slot
+static constexpr bool MIME_Perfect(uint8_t i = 0)
+{
+	return (i == MIME_COUNT) ? true : ((MIME_Find(MIME_Slot(MIME_Table[i].ext)) == i) && MIME_Perfect(i + 1));
+}
+
+static_assert(MIME_Perfect(), "MIME_Table: collision in the hash, change MIME_SEED");
+static_assert(MIME_COUNT < MIME_SLOTS, "MIME_Table: too many extensions, increase MIME_SLOTS_BITS");
+
+#define MIME_FIND4(n)	MIME_Find(n), MIME_Find(n + 1), MIME_Find(n + 2), MIME_Find(n + 3)
+static constexpr uint8_t MIME_Index[MIME_SLOTS] = {
+		MIME_FIND4(0), MIME_FIND4(4), MIME_FIND4(8), MIME_FIND4(12),
+		MIME_FIND4(16), MIME_FIND4(20), MIME_FIND4(24), MIME_FIND4(28)};
+
+/**
+ * Get the content type of the requested document, without String allocation
+ */
+const char* getMIMEType(const char *filename)
+{
+	const char *ext = strrchr(filename, '.');
+	if ((ext == NULL) || (strlen(++ext) > MIME_MAX_EXT))
+		return MIME_DEFAULT;
+
+	uint8_t index = MIME_Index[MIME_Slot(ext)];
+	if ((index < MIME_COUNT) && (strcmp(MIME_Table[index].ext, ext) == 0))
+		return MIME_Table[index].mime;
+	return MIME_DEFAULT;
+}
+
 /**
  * Get the content type of the requested document
  */
 const String getContentType(const String &filename)
 {
-	if (filename.endsWith(".html") || filename.endsWith(".htm"))
-		return "text/html";
-	else
-		if (filename.endsWith(".gz"))
-			return "application/x-gzip";
-		else
-			if (filename.endsWith(".css"))
-				return "text/css";
-			else
-				if (filename.endsWith(".js"))
-					return "application/javascript";
-				else
-					if (filename.endsWith(".png"))
-						return "image/png";
-					else
-						if (filename.endsWith(".gif"))
-							return "image/gif";
-						else
-							if (filename.endsWith(".jpg"))
-								return "image/jpeg";
-							else
-								if (filename.endsWith(".ico"))
-									return "image/x-icon";
-								else
-									if (filename.endsWith(".xml"))
-										return "text/xml";
-									else
-										if (filename.endsWith(".pdf"))
-											return "application/x-pdf";
-										else
-											if (filename.endsWith(".zip"))
-												return "application/x-zip";
-	return "text/plain";
+	return String(getMIMEType(filename.c_str()));
 }
 
 // ********************************************************************************
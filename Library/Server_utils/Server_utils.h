@@ -101,6 +101,7 @@
 #endif
 
 #include <Preferences.h> // For EEPROM access
+#include <functional>
 
 // The port for the server, default 80
 #ifndef SERVER_PORT
@@ -117,8 +118,10 @@
 #define DEFAULT_SOFTAP	"DefaultAP"
 #endif
 
-// For StreamUARTMessage
+// For StreamUARTMessage and SendStream
 #define STREAM_BUFFER_SIZE	1024
+// Max size of one item (line, JSON object) of a stream
+#define STREAM_ENTRY_SIZE	300
 // Default TimeOut for the stream
 #define STREAM_TIMEOUT		2000
 
@@ -160,7 +163,8 @@ typedef enum
 	Ev_ResetSSID = 1024,
 	Ev_SetDHCP = 2048,
 	Ev_GetMACAddress = 4096,
-	Ev_GetESPMACAddress = 8192
+	Ev_GetESPMACAddress = 8192,
+	Ev_CacheInfo = 16384      // With USE_ASSET_CACHE
 } Event_typedef;
 
 // Default events
@@ -393,8 +397,31 @@ void Server_CommonEvent(uint32_t event = default_Events);
 void SSIDToFile(const String &filename, const String &ssidpwd);
 void SSIDToEEPROM(const String &ssid, const String &pwd);
 void DeleteSSID(void);
+const char* getMIMEType(const char *filename);
 const String getContentType(const String &filename);
 
+/**
+ * Streaming response (chunked transfer) from a fill callback, no String and no copy of the whole response.
+ * The callback fill the buffer with at most size bytes (only complete items) and return :
+ * - the number of bytes written,
+ * - STREAM_TRY_AGAIN if the buffer is too small for the next item (async server),
+ * - 0 when the response is complete.
+ * The callback keep its state between calls (captured by the lambda, use a shared_ptr for
+ * the async server because the response is sent after the handler return).
+ * Sync server : the buffer is a static buffer of STREAM_BUFFER_SIZE bytes. STREAM_TRY_AGAIN
+ * (an item bigger than the buffer) is an error : the connexion is closed without the last chunk.
+ * Async server : the buffer is the buffer of the TCP chunk.
+ */
+#define STREAM_TRY_AGAIN	((size_t) -1)
+typedef std::function<size_t(char *buffer, size_t size)> onStreamFill;
+
+#ifdef USE_ASYNC_WEBSERVER
+void SendStream(AsyncWebServerRequest *request, const String &contentType, const onStreamFill &fill);
+#else
+void SendStream(const String &contentType, const onStreamFill &fill);
+#endif
+size_t SendStream_PeakHeap(bool reset = false);
+
 // Only for ElegantOTA
 void ElegantOTAloop(void);
 
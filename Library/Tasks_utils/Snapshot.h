@@ -0,0 +1,115 @@
+/**
+ * A lock-free snapshot of a data structure : one writer (producer), several readers (consumers)
+ *
+ * The producer (for example the CIRRUS task) fill its own working copy of the data then
+ * publish it once per cycle. The consumers (web server, display, MQTT, log, ...) read a
+ * consistent copy from any task without mutex.
+ *
+ * We use a sequence counter (seqlock) and a double buffer :
+ * - the producer always write in the buffer not read by the consumers, then switch the buffers,
+ * - the consumer copy the current buffer and check with the sequence counter that the producer
+ * has not started to write in it during the copy. If so, the copy is done again.
+ * So a consumer with a higher priority than the producer (on the same core) is never blocked
+ * by a publication in progress.
+ *
+ * Exemple :
+ *
+ * Snapshot<Data_Struct> Data_Snapshot;
+ *
+ * // Producer
+ * Data_Struct Current_Data;
+ * ... fill Current_Data
+ * Data_Snapshot.Publish(Current_Data);
+ *
+ * // Consumer
+ * Data_Struct data = Data_Snapshot.Get();
+ *
+ * T must be copyable and must not contain pointer to itself.
+ * Only ONE task must publish.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+template<typename T>
+class Snapshot
+{
+	public:
+		Snapshot()
+		{
+		}
+
+		Snapshot(const T &data)
+		{
+			_buffer[0] = data;
+			_buffer[1] = data;
+		}
+
+		/**
+		 * Publish a new data. Only the producer task call this function.
+		 * The sequence is odd while the data is written in the free buffer.
+		 */
+		void Publish(const T &data)
+		{
+			uint32_t seq = _seq.load(std::memory_order_relaxed);
+			uint8_t next = ((seq >> 1) + 1) & 1;
+
+			_seq.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			_buffer[next] = data;
+			_seq.store(seq + 2, std::memory_order_release);
+		}
+
+		/**
+		 * Read a consistent copy of the last published data
+		 * Return false if the copy failed max_retry times (producer too fast)
+		 * In this case, data is not modified (keep the previous value).
+		 */
+		bool Read(T &data, uint8_t max_retry = 10) const
+		{
+			uint32_t seq1, seq2;
+			T copy;
+
+			do
+			{
+				seq1 = _seq.load(std::memory_order_acquire);
+				copy = _buffer[(seq1 >> 1) & 1];
+				std::atomic_thread_fence(std::memory_order_acquire);
+				seq2 = _seq.load(std::memory_order_relaxed);
+
+				// The producer start to write in our buffer at sequence (seq1 & ~1) + 3
+				if (seq2 - (seq1 & ~1U) < 3)
+				{
+					data = copy;
+					return true;
+				}
+			} while (max_retry-- > 0);
+			return false;
+		}
+
+		/**
+		 * Return a consistent copy of the last published data
+		 * Retry until the copy succeed : the producer publish once per cycle, so a reader
+		 * is only delayed while the producer publish faster than the copy.
+		 */
+		T Get(void) const
+		{
+			T data;
+			while (!Read(data))
+				;
+			return data;
+		}
+
+		/**
+		 * Return the number of publication. Usefull to know if we have a new data.
+		 */
+		uint32_t GetCount(void) const
+		{
+			return _seq.load(std::memory_order_acquire) >> 1;
+		}
+
+	private:
+		T _buffer[2];
+		std::atomic<uint32_t> _seq = {0};
+};
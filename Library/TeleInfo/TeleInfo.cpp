@@ -15,6 +15,7 @@
 #define TI_LF   	0x0A // Line Feed
 #define TI_CR   	0x0D // Carriage Return
 #define TI_SP   	0x20 // Space
+#define TI_HT   	0x09 // Tabulation (mode standard)
 #define TI_6LB  	0x3F // 6 bits de poids faible
 #define TI_7LB  	0x7F // 7 bits de poids faible
 
@@ -25,7 +26,6 @@ static uint32_t conf_delay = 0; // le temps pour la configuration
 
 #ifdef TI_DEBUG
 void printc(char c);
-void printval(uint32_t v);
 #endif
 
 // Function for debug message, may be redefined elsewhere
@@ -42,11 +42,25 @@ void __attribute__((weak)) print_debug(const char *mess, bool ln = true)
  * refresh_ms : le délai entre deux rafraichissements.
  * La réception d'une trame prend au moins 1 seconde, donc inutile de faire moins.
  * Par défaut, refresh_ms = 10000 ms
- * La vitesse baud est par défaut de 1200 (ancien compteur)
+ * baud : TI_BAUD_HISTORIC (1200, ancien compteur), TI_BAUD_STANDARD (9600, Linky en mode standard)
+ * ou TI_BAUD_AUTO (par défaut) : on commence à 1200 et on change de vitesse tant qu'aucune trame
+ * n'est valide. Le mode (historique ou standard) est détecté par le séparateur des groupes.
  * Pour ESP32, on utilise UART1 remapé sur GPIO 14 (RX) et 12 (TX non utilisé)
  */
 TeleInfo::TeleInfo(uint8_t rxPin, uint32_t refresh_ms, uint32_t baud)
 {
+	_autoBaud = (baud == TI_BAUD_AUTO);
+	if (_autoBaud)
+		baud = TI_BAUD_HISTORIC;
+	_baud = baud;
+	memset(_index, 0, sizeof(_index));
+	memset(_groups, 0, sizeof(_groups));
+	for (uint8_t i = 0; i < TI_MAX_SUBSCRIBE; i++)
+	{
+		_subscribers[i].label[0] = '\0';
+		_subscribers[i].callback = NULL;
+		_subscribers[i].slot = -1;
+	}
 #ifdef ESP8266
 	tiSerial = new SoftwareSerial(rxPin);
 	tiSerial->begin(baud);
@@ -58,6 +72,7 @@ TeleInfo::TeleInfo(uint8_t rxPin, uint32_t refresh_ms, uint32_t baud)
 #endif
 	TI_tick = refresh_ms;
 	_timeCounter = millis();
+	_lastGroup = _timeCounter;
 	_tiRunning = true;
 }
 
@@ -79,9 +94,13 @@ TeleInfo::~TeleInfo()
  * Configure la trame pour accéder directement aux infos
  * timeout : temps d'attente maximum en ms
  * Note : l'acquisition d'une trame prend au moins 1 s, donc timeout >> 1000
+ * En vitesse automatique, le timeout est au moins TI_CONFIGURE_MS pour essayer les deux vitesses
  */
 bool TeleInfo::Configure(uint32_t timeout)
 {
+	if (_autoBaud && (timeout < TI_CONFIGURE_MS))
+		timeout = TI_CONFIGURE_MS;
+
 	// On écoute le port
 	Resume();
 
@@ -107,17 +126,10 @@ bool TeleInfo::Configure(uint32_t timeout)
 			}
 			yield();
 		}
+		checkBaud();
 		waiting = ((conf_delay = millis() - dt) < timeout);
 	}
 
-	// On a recu une trame dans les temps.
-	// On construit la structure correspondant au compteur
-	if (waiting)
-	{
-		build_Structure();
-		use_structure = true;
-	}
-
 	// Si la configuration a échoué, on arrête d'écouter
 	if (!waiting)
 		Pause();
@@ -125,43 +137,96 @@ bool TeleInfo::Configure(uint32_t timeout)
 	return waiting;
 }
 
+/**
+ * Recherche de l'étiquette par l'index : O(1)
+ */
 const char* TeleInfo::getStringVal(const char *label)
 {
-	int i = 0;
-	char *res = NULL;
+	int id;
 
-	if (_isAvailable)
-	{
-		while ((i < _labelCount) && (strcmp(label, _label[i]) != 0))
-		{
-			i++;
-		}
-		if (i < _labelCount)
-			res = _data[i];
-	}
-	return res;
+	if (_isAvailable && ((id = findValue(label)) >= 0))
+		return _groups[id].data;
+	return NULL;
 }
 
+const char* TeleInfo::getDateVal(const char *label)
+{
+	int id;
+
+	if (_isAvailable && ((id = findValue(label)) >= 0))
+		return _groups[id].date;
+	return NULL;
+}
+
+/**
+ * La valeur est décodée à la réception du groupe
+ */
 int32_t TeleInfo::getLongVal(const char *label)
 {
-	const char *stringVal = getStringVal(label);
-	long res = -1;
+	int id;
 
-	if (stringVal != NULL)
-	{
-		res = strtol(stringVal, NULL, 10);
-	}
-	return res;
+	if (_isAvailable && ((id = findValue(label)) >= 0))
+		return _groups[id].value;
+	return -1;
 }
 
 uint32_t TeleInfo::getPowerVA()
 {
-	return strtol(TI_PowerVA_str, NULL, 10);
+	return _powerVA;
 }
 
+/**
+ * La somme des index de l'option tarifaire (BASE, HCHC + HCHP, EJP, tempo) ou EAST
+ */
 uint32_t TeleInfo::getIndexWh()
 {
-	return strtol(TI_IndexWh_str, NULL, 10);
+	return _indexWh;
+}
+
+/**
+ * Surveille une étiquette, voir TI_Callback
+ */
+bool TeleInfo::Subscribe(const char *label, TI_Callback callback)
+{
+	int8_t free_id = -1;
+
+	if ((callback == NULL) || (strlen(label) >= LABEL_MAX_SIZE))
+		return false;
+
+	for (int8_t i = 0; i < TI_MAX_SUBSCRIBE; i++)
+	{
+		if (strcmp(_subscribers[i].label, label) == 0)
+		{
+			free_id = i;
+			break;
+		}
+		if ((free_id < 0) && (_subscribers[i].callback == NULL))
+			free_id = i;
+	}
+	if (free_id < 0)
+		return false;
+
+	TI_Subscriber *sub = &_subscribers[free_id];
+	strcpy(sub->label, label);
+	sub->callback = callback;
+	sub->slot = (_structured) ? findLabel(label) : -1;
+	// Première notification avec la valeur actuelle
+	if (sub->slot >= 0)
+		_groups[sub->slot].changed = true;
+	return true;
+}
+
+void TeleInfo::Unsubscribe(const char *label)
+{
+	for (uint8_t i = 0; i < TI_MAX_SUBSCRIBE; i++)
+	{
+		if (strcmp(_subscribers[i].label, label) == 0)
+		{
+			_subscribers[i].label[0] = '\0';
+			_subscribers[i].callback = NULL;
+			_subscribers[i].slot = -1;
+		}
+	}
 }
 
 void TeleInfo::PrintAllToSerial()
@@ -173,12 +238,19 @@ void TeleInfo::PrintAllToSerial()
 	{
 		for (i = 0; i < _labelCount; i++)
 		{
-			sprintf((char*) buffer, "%s => %s", _label[i], _data[i]);
+			if (_groups[i].frame != _frameNumber)
+				continue;
+			if (_groups[i].date[0] != 0)
+				snprintf((char*) buffer, 50, "%s => %s (%s)", _groups[i].label, _groups[i].data, _groups[i].date);
+			else
+				snprintf((char*) buffer, 50, "%s => %s", _groups[i].label, _groups[i].data);
 			print_debug((char*) buffer);
 		}
 		sprintf((char*) buffer, "Label numbers => %d", _labelCount);
 		print_debug((char*) buffer);
-		sprintf((char*) buffer, "Trame length => %d", strlen(_frame));
+		sprintf((char*) buffer, "Mode => %s", (_mode == TI_Standard) ? "standard" : "historique");
+		print_debug((char*) buffer);
+		sprintf((char*) buffer, "Trame length => %d", _frameSize);
 		print_debug((char*) buffer);
 		sprintf((char*) buffer, "Temps de configuration : %d ms", (unsigned int)conf_delay);
 		print_debug((char*) buffer);
@@ -198,17 +270,19 @@ void TeleInfo::Test()
 
 		print_debug("------ \r\n");
 
-		periodTarif = getStringVal("PTEC");
+		bool standard = (_mode == TI_Standard);
+
+		periodTarif = getStringVal(standard ? "LTARF" : "PTEC");
 		print_debug("Period Tarifaire = ");
 		periodTarif == NULL ? print_debug("unknown") : print_debug(periodTarif);
 		print_debug("\r\n");
 
-		opTarif = getStringVal("OPTARIF");
+		opTarif = getStringVal(standard ? "NGTF" : "OPTARIF");
 		print_debug("Option Tarifaire = ");
 		opTarif == NULL ? print_debug("unknown") : print_debug(opTarif);
 		print_debug("\r\n");
 
-		power = getLongVal("PAPP");
+		power = getLongVal(standard ? "SINSTS" : "PAPP");
 		if (power < 0)
 			print_debug("Power = unknown\r\n");
 		else
@@ -261,6 +335,7 @@ void TeleInfo::Process()
 		}
 		yield();
 	}
+	checkBaud();
 }
 
 void TeleInfo::Pause()
@@ -282,89 +357,110 @@ void TeleInfo::Resume()
 	  tiSerial->listen();
 #endif
 		delay(100);
+		// La vitesse automatique compte à partir de la reprise de l'écoute
+		_lastGroup = millis();
 		_tiRunning = true;
 	}
 }
 
 // *************** Private part
 
+/**
+ * Réception d'un caractère : machine à états, la trame n'est pas mémorisée.
+ * Chaque groupe (LF ... CR) est vérifié dès sa fin et rangé dans _groups.
+ */
 uint16_t TeleInfo::DataReceived(uint8_t ch)
 {
 	char caractereRecu = '\0';
-#ifdef TI_DEBUG
-	static uint32_t _timeElapsed;
-#endif
 
-	if (!_isAvailable)
-	{
-		caractereRecu = ch & TI_7LB;
+	if (_isAvailable)
+		return _frameSize;
+
+	caractereRecu = ch & TI_7LB;
 
 #ifdef TI_DEBUG
-		if (caractereRecu == TI_SP || caractereRecu == TI_LF || caractereRecu == TI_CR
-				|| caractereRecu == TI_ETX)
-			print_debug("");
-		else
-		{
-			printc(caractereRecu);
-			print_debug(" ", false);
-		}
+	if (caractereRecu == TI_SP || caractereRecu == TI_HT || caractereRecu == TI_LF
+			|| caractereRecu == TI_CR || caractereRecu == TI_ETX)
+		print_debug("");
+	else
+	{
+		printc(caractereRecu);
+		print_debug(" ", false);
+	}
 #endif
+
+	switch (caractereRecu)
+	{
 		//"Start Text 0x02" - frame start
-		if (caractereRecu == TI_STX)
-		{
-			_frameIndex = 0;
-			_frameBegin = true;
-#ifdef TI_DEBUG
-			print_debug("*** START frame ***");
-			_timeElapsed = _timeCounter;
-#endif
-		}
-		if (_frameBegin)
-		{
-			// La frame a été interrompue
-			if (caractereRecu == TI_EOT)
-				resetAll();
+		case TI_STX:
+			beginFrame();
+			return _frameSize;
 
-			// TODO check _ frame overflow !!!
-			if (_frameIndex >= FRAME_MAX_SIZE)
-				_frameIndex = 0;
+		// La frame a été interrompue
+		case TI_EOT:
+			resetAll();
+			return _frameSize;
 
-			// Build the frame char by char
-			_frame[_frameIndex++] = caractereRecu;
+		default:
+			break;
+	}
 
-			//  "EndText 0x03" - frame end
-			if (caractereRecu == TI_ETX)
-			{
-				// Termine la string
-				_frame[_frameIndex++] = '\0';
+	if (!_frameBegin)
+		return _frameSize;
+	_frameSize++;
 
+	switch (caractereRecu)
+	{
+		// Début d'un groupe
+		case TI_LF:
+			if (_inGroup)
+				_frameOk = false;
+			_inGroup = true;
+			_groupIndex = 0;
+			_groupSum = 0;
+			break;
+
+		// Fin d'un groupe
+		case TI_CR:
+			if (!_inGroup || !decodeGroup())
+				_frameOk = false;
+			_inGroup = false;
+			break;
+
+		//  "EndText 0x03" - frame end
+		case TI_ETX:
+			if (_inGroup)
+				_frameOk = false;
 #ifdef TI_DEBUG
-				print_debug("*** END frame ***");
-				printval(_timeCounter - _timeElapsed);
-				print_debug("*** will try to decode a new frame");
+			print_debug("*** END frame ***");
 #endif
-
-				// Analyse de la frame et extraction des données pertinentes
-				if (use_structure)
-				{
-					get_Structure_Data(ID_IndexWh, TI_IndexWh_str);
-					_isAvailable = get_Structure_Data(ID_PowerVA, TI_PowerVA_str);
-				}
-				else
-					_isAvailable = decodeFrame();
+			_isAvailable = endFrame();
 #ifdef TI_DEBUG
-				if (_isAvailable)
-					print_debug("*** Decode frame OK ***");
-				else
-					print_debug("*** Decode frame not OK, we restart ***");
+			if (_isAvailable)
+				print_debug("*** Decode frame OK ***");
+			else
+				print_debug("*** Decode frame not OK, we restart ***");
 #endif
-				// La frame est incorrecte, on réinitialise
-				if (!_isAvailable)
-					resetAll();
+			// La frame est incorrecte, on réinitialise
+			if (!_isAvailable)
+				resetAll();
+			break;
+
+		default:
+			if (_inGroup && (_groupIndex < GROUP_MAX_SIZE))
+			{
+				_group[_groupIndex++] = caractereRecu;
+				_groupSum += caractereRecu;
 			}
-		}
+			else
+			{
+				// Caractère hors groupe ou groupe trop long
+				_frameOk = false;
+				_inGroup = false;
+			}
+			break;
 	}
-	return _frameIndex;
+	return _frameSize;
 }
 
 #ifdef TI_DEBUG
@@ -374,251 +470,323 @@ void printc(char c)
 	sprintf(buf_char, "%c", c);
 	print_debug(buf_char, false);
 }
-
-void printval(uint32_t v)
-{
-	char buf_char[20];
-	sprintf(buf_char, "Elapsed time %ld", v);
-	print_debug(buf_char);
-}
 #endif
 
 void TeleInfo::resetAll()
 {
-	_frame[0] = '\0';
-	_frameIndex = 0;
+	_frameSize = 0;
 	_frameBegin = false;
-	_labelCount = 0;
+	_frameOk = false;
+	_inGroup = false;
 	_isAvailable = false;
 	_timeCounter = millis();
 }
 
-int TeleInfo::decode(int beginIndex, char *field, unsigned char *sum, uint8_t max_size)
+void TeleInfo::beginFrame()
 {
-	int i = beginIndex;
-	int j = 0;
-
-	while ((_frame[i] != TI_SP) && (j < max_size))
-	{
-		*sum += (field[j++] = _frame[i++]);
-		// Code équivalent pour y voir clair !
-		//    field[j] = _frame[i];
-		//    *sum += field[j];
-		//    i++;
-		//    j++;
-	}
-	if (j == max_size + 1)
-	{
-		return -1;
-	}
-	else
+#ifdef TI_DEBUG
+	print_debug("*** START frame ***");
+#endif
+	_frameSize = 1;
+	_frameBegin = true;
+	_frameOk = true;
+	_inGroup = false;
+	_frameMode = TI_Unknown;
+	if (++_frameNumber == 0)
+		_frameNumber = 1;
+	// Tant que la structure n'est pas construite, chaque trame repart de zéro
+	if (!_structured)
 	{
-		field[j] = '\0'; // end string
-		return (++i);
+		_labelCount = 0;
+		memset(_index, 0, sizeof(_index));
 	}
 }
 
 /**
- * Décodage d'une frame. La structure est la suivante :
- * 0x02 (start byte)
- * 0x0A label 0x20 value 0x20 checksum 0x0D
- * séquence précédente répétée autant de fois qu'il y a de label
- * 0x03 (end byte)
+ * Copie len caractères dans un champ de taille size, tronque si nécessaire
  */
-bool TeleInfo::decodeFrame()
+static void copy_field(char *field, uint8_t size, const char *src, int len)
 {
-	int i = 1, lineIndex = 0;
-	bool frameOk = true;
-	char checksum;
-	unsigned char sum = TI_SP;
-	char *_power = NULL;
-	char *_index = NULL;
+	if (len >= size)
+		len = size - 1;
+	memcpy(field, src, len);
+	field[len] = '\0';
+}
 
-	// start i at 1 to skip first char 0x02 (start byte)
-	while (_frame[i] != TI_ETX)
+/**
+ * Valeur entière d'une donnée, comme strtol (espaces et signe)
+ */
+static int32_t parse_value(const char *data)
+{
+	int64_t value = 0;
+	bool negative = false;
+
+	while (*data == ' ')
+		data++;
+	if ((*data == '-') || (*data == '+'))
+		negative = (*data++ == '-');
+	while ((*data >= '0') && (*data <= '9'))
 	{
-		// Test qu'on dépasse pas le nombre de lignes MAX
-		if (lineIndex >= LINE_MAX_COUNT)
-		{
-#ifdef TI_DEBUG
-			print_debug("frame KO LINE_MAX_COUNT");
-#endif
-			frameOk = false;
-			break;
-		}
-
-		// Début d'une ligne d'info et avancement dans la frame
-		if (_frame[i++] != TI_LF)
-		{
-#ifdef TI_DEBUG
-			printc(_frame[i]);
-			print_debug("frame KO 0A -- ");
-#endif
-			frameOk = false;
-			break;
-		}
-
-		sum = TI_SP;
-		// Décodage du label
-		i = decode(i, _label[lineIndex], &sum, LABEL_MAX_SIZE);
-		if (i < 0)
-		{
-			frameOk = false;
-			break;
-		}
+		value = value * 10 + (*data++ - '0');
+		if (value > INT32_MAX)
+			return negative ? INT32_MIN : INT32_MAX;
+	}
+	return (int32_t) (negative ? -value : value);
+}
 
-		// Décodage de la donnée
-		i = decode(i, _data[lineIndex], &sum, DATA_MAX_SIZE);
-		if (i < 0)
+/**
+ * Décodage d'un groupe, _group contient les caractères entre LF et CR :
+ * historique : label SP data SP checksum
+ * standard : label HT [horodate HT] data HT checksum
+ * Le séparateur avant le checksum donne le mode.
+ */
+bool TeleInfo::decodeGroup()
+{
+	uint8_t len = _groupIndex;
+	char sep, checksum;
+	unsigned char sum;
+	const char *pLabel, *pSep, *pData, *pEnd;
+	char label[LABEL_MAX_SIZE];
+	TI_Mode mode;
+
+	if (len < 4)
+		return false;
+
+	checksum = _group[len - 1];
+	sep = _group[len - 2];
+	sum = _groupSum - checksum;
+	if (sep == TI_HT)
+		mode = TI_Standard;
+	else
+		if (sep == TI_SP)
 		{
-			frameOk = false;
-			break;
+			mode = TI_Historic;
+			sum -= TI_SP; // L'espace avant le checksum n'est pas compté
 		}
+		else
+			return false;
 
-		// Valeur du checksum et avancement dans la frame
-		checksum = _frame[i++];
+	// On conserve les 6 bits de poids faible + 0x20
+	if (((sum & TI_6LB) + TI_SP) != checksum)
+	{
 #ifdef TI_DEBUG
-		print_debug("checksum is ", false);
-		printc(checksum);
-		print_debug("");
+		print_debug("checksum KO");
 #endif
+		return false;
+	}
+	// Tous les groupes d'une trame sont dans le même mode, celui du compteur
+	if (((_mode != TI_Unknown) && (mode != _mode)) || ((_frameMode != TI_Unknown) && (mode != _frameMode)))
+		return false;
+	_frameMode = mode;
+	_lastGroup = millis();
+
+	pLabel = _group;
+	pEnd = &_group[len - 2];
+	if ((pSep = (const char*) memchr(pLabel, sep, pEnd - pLabel)) == NULL)
+		return false;
+	if ((pSep == pLabel) || (pSep - pLabel >= LABEL_MAX_SIZE))
+		return false;
+	copy_field(label, LABEL_MAX_SIZE, pLabel, pSep - pLabel);
+
+	// La place de l'étiquette, une nouvelle étiquette prend la place suivante
+	int id = findLabel(label);
+	if (id < 0)
+	{
+		// Trop de groupes : le groupe est valide mais ignoré
+		if (_labelCount >= LINE_MAX_COUNT)
+			return true;
+		id = _labelCount;
+		strcpy(_groups[id].label, label);
+		_groups[id].data[0] = '\0';
+		_groups[id].value = 0;
+		_groups[id].changed = true;
+		addIndex(id);
+		_labelCount++;
+		_newLabel = true;
+	}
+	TI_Group *group = &_groups[id];
+	// Seule la première occurrence d'une étiquette est prise
+	if (group->frame == _frameNumber)
+		return true;
+	group->frame = _frameNumber;
 
-		// Fin de la ligne d'info et avancement dans la frame
-		if (_frame[i++] != TI_CR)
-		{
-			frameOk = false;
-			break;
-		}
+	pData = pSep + 1;
+	group->date[0] = '\0';
+	// Une horodate est présente si il reste un séparateur (mode standard)
+	if ((mode == TI_Standard) && ((pSep = (const char*) memchr(pData, TI_HT, pEnd - pData)) != NULL))
+	{
+		copy_field(group->date, DATE_MAX_SIZE, pData, pSep - pData);
+		pData = pSep + 1;
+	}
+	len = pEnd - pData;
+	if (len >= DATA_MAX_SIZE)
+		len = DATA_MAX_SIZE - 1;
+	if ((strncmp(group->data, pData, len) != 0) || (group->data[len] != '\0'))
+	{
+		copy_field(group->data, DATA_MAX_SIZE, pData, len);
+		group->value = parse_value(group->data);
+		group->changed = true;
+	}
+	return true;
+}
 
-		// Vérification du checkum
-		// On conserve les 6 bits de poids faible + 0x20
-		if (((sum & TI_6LB) + TI_SP) != checksum)
-		{
-			frameOk = false;
-			break;
-		}
+/**
+ * Fin de la trame : tous les groupes doivent être valides et on doit avoir
+ * la puissance apparente et au moins un index
+ */
+bool TeleInfo::endFrame()
+{
+	if (!_frameOk || (_labelCount == 0))
+		return false;
 
-		// Extraction de la puissance et de l'index
-		if ((_power == NULL) && (strcmp("PAPP", _label[lineIndex]) == 0))
-		{
-			_power = _data[lineIndex];
-		}
+	if (!_structured || _newLabel)
+		build_Structure();
 
-		if ((_index == NULL) && (strcmp("BASE", _label[lineIndex]) == 0))
+	if ((_idPower < 0) || (_groups[_idPower].frame != _frameNumber))
+		return false;
+
+	uint32_t index = 0;
+	bool found = false;
+	for (uint8_t i = 0; i < _indexCount; i++)
+	{
+		if (_groups[_idIndex[i]].frame == _frameNumber)
 		{
-			_index = _data[lineIndex];
+			index += _groups[_idIndex[i]].value;
+			found = true;
 		}
-
-		// Passage à la ligne d'info suivante
-		lineIndex++;
 	}
+	if (!found)
+		return false;
+
+	_powerVA = _groups[_idPower].value;
+	_indexWh = index;
+	copy_field(TI_PowerVA_str, sizeof(TI_PowerVA_str), _groups[_idPower].data, strlen(_groups[_idPower].data));
+	snprintf(TI_IndexWh_str, sizeof(TI_IndexWh_str), "%09lu", (unsigned long) index);
+
+	// Après la première trame valide, le mode, la vitesse et la structure sont figés
+	_mode = _frameMode;
+	_autoBaud = false;
+	_structured = true;
+	// La trame est disponible pour les fonctions appelées
+	_isAvailable = true;
+	notify();
+	return true;
+}
+
+/**
+ * Les places de la puissance, des index et des étiquettes surveillées.
+ * Appelé à la fin de la première trame puis à chaque nouvelle étiquette (changement de période tempo, ...)
+ */
+void TeleInfo::build_Structure()
+{
+	int id;
 
-	if (frameOk && (lineIndex > 0) && (_power != NULL) && (_index != NULL))
+	if (_frameMode == TI_Standard)
 	{
-		_labelCount = lineIndex;
-		strcpy(TI_PowerVA_str, _power);
-		strcpy(TI_IndexWh_str, _index);
+		_idPower = findLabel("SINSTS");
+		_indexCount = 0;
+		if ((id = findLabel("EAST")) >= 0)
+			_idIndex[_indexCount++] = id;
 	}
 	else
 	{
-		frameOk = false;
-		_labelCount = 0;
+		const char *index_labels[TI_MAX_INDEX] = {"BASE", "HCHC", "HCHP", "EJPHN", "EJPHPM", "BBRHCJB",
+				"BBRHPJB", "BBRHCJW", "BBRHPJW", "BBRHCJR", "BBRHPJR"};
+		_idPower = findLabel("PAPP");
+		_indexCount = 0;
+		for (uint8_t i = 0; i < TI_MAX_INDEX; i++)
+			if ((id = findLabel(index_labels[i])) >= 0)
+				_idIndex[_indexCount++] = id;
 	}
 
-	return frameOk;
+	for (uint8_t i = 0; i < TI_MAX_SUBSCRIBE; i++)
+		if (_subscribers[i].callback != NULL)
+			_subscribers[i].slot = findLabel(_subscribers[i].label);
+	_newLabel = false;
 }
 
-void TeleInfo::build_Structure()
+/**
+ * Appel des fonctions des étiquettes surveillées qui ont changé
+ */
+void TeleInfo::notify()
 {
-	uint8_t i, j;
-	unsigned char sum = TI_SP;
-	char *pindex;
-
-	if (_isAvailable)
+	for (uint8_t i = 0; i < TI_MAX_SUBSCRIBE; i++)
 	{
-		pindex = &_frame[2]; // 0x02 0x0A
-		for (i = 0; i < _labelCount; i++)
-		{
-			_structure[i].label = pindex;
-			sum = TI_SP;
-			for (j = 0; j < strlen(_label[i]); j++)
-				sum += _label[i][j];
-			_structure[i].checkLabel = sum;
-			pindex += strlen(_label[i]);
-			pindex++; // L'espace
-			_structure[i].data = pindex;
-			_structure[i].lenData = strlen(_data[i]);
-			pindex += strlen(_data[i]);
-			pindex++; // L'espace
-			_structure[i].checksum = pindex;
-			pindex += 3; // Checksum + 0x0D + 0x0A
-		}
-
-		// Recherche des ID power et index (HP dans le cas où on n'est pas en BASE
-		for (i = 0; i < _labelCount; i++)
+		TI_Subscriber *sub = &_subscribers[i];
+		if ((sub->callback == NULL) || (sub->slot < 0))
+			continue;
+		TI_Group *group = &_groups[sub->slot];
+		if ((group->frame == _frameNumber) && group->changed)
 		{
-			if ((strcmp(_label[i], "BASE") == 0) || (strcmp(_label[i], "HCHP") == 0)
-					|| (strcmp(_label[i], "BBRHPJB") == 0))
-			{
-				ID_IndexWh = i;
-				break;
-			}
-		}
-		if (i == _labelCount)
-			i = 0;
-		for (; i < _labelCount; i++)
-		{
-			if (strcmp(_label[i], "PAPP") == 0)
-			{
-				ID_PowerVA = i;
-				break;
-			}
+			group->changed = false;
+			sub->callback(group->label, group->data, group->value);
 		}
 	}
 }
 
-bool TeleInfo::get_Structure_Data(uint8_t id, char *result)
-{
-	// Energie index : 3  BASE
-	// Power index : 7  PAPP
-	TI_TypeDef *record;
-	uint8_t i;
-	unsigned char sum;
-	char value[DATA_MAX_SIZE + 1];
-#ifdef TI_DEBUG
-	char tmp[10];
-#endif
-
-	record = &_structure[id];
+//---------------------------------------------------------------------------
+// Index des étiquettes : hash FNV-1a, adressage ouvert
 
-#ifdef TI_DEBUG
-	strncpy(tmp, record->label, 9);
-	tmp[9] = 0;
-	print_debug(tmp);
+static inline uint8_t TI_Hash(const char *label)
+{
+	uint32_t hash = 2166136261UL;
+	while (*label)
+		hash = (hash ^ (uint8_t) *label++) * 16777619UL;
+	return (hash >> 24) & (TI_INDEX_SIZE - 1);
+}
 
-	strncpy(tmp, record->data, record->lenData);
-	tmp[record->lenData] = 0;
-	print_debug(tmp);
+void TeleInfo::addIndex(uint8_t id)
+{
+	uint8_t slot = TI_Hash(_groups[id].label);
+	while (_index[slot] != 0)
+		slot = (slot + 1) & (TI_INDEX_SIZE - 1);
+	_index[slot] = id + 1;
+}
 
-	strncpy(tmp, record->checksum, 1);
-	tmp[1] = 0;
-	print_debug(tmp);
-#endif
+/**
+ * L'étiquette doit être dans la dernière trame
+ */
+int TeleInfo::findValue(const char *label) const
+{
+	int id = findLabel(label);
+	if ((id >= 0) && (_groups[id].frame == _frameNumber))
+		return id;
+	return -1;
+}
 
-	// Récupérer la data et vérifier le checksum
-	sum = record->checkLabel;
-	for (i = 0; i < record->lenData; i++)
+int TeleInfo::findLabel(const char *label) const
+{
+	uint8_t slot = TI_Hash(label);
+	while (_index[slot] != 0)
 	{
-		sum += (value[i] = record->data[i]);
+		if (strcmp(_groups[_index[slot] - 1].label, label) == 0)
+			return _index[slot] - 1;
+		slot = (slot + 1) & (TI_INDEX_SIZE - 1);
 	}
+	return -1;
+}
 
-	if (((sum & TI_6LB) + TI_SP) == record->checksum[0])
-	{
-		value[record->lenData] = 0;  // Finir la chaine !
-		strcpy(result, value);
-		return true;
-	}
-	return false;
+/**
+ * En vitesse automatique, change de vitesse (1200 <-> 9600) si aucun groupe
+ * valide n'a été reçu depuis TI_AUTO_BAUD_MS
+ */
+void TeleInfo::checkBaud()
+{
+	if (!_autoBaud || ((millis() - _lastGroup) < TI_AUTO_BAUD_MS))
+		return;
+
+	_baud = (_baud == TI_BAUD_HISTORIC) ? TI_BAUD_STANDARD : TI_BAUD_HISTORIC;
+#ifdef ESP8266
+	tiSerial->begin(_baud);
+#endif
+#ifdef ESP32
+	tiSerial->updateBaudRate(_baud);
+#endif
+	resetAll();
+	_lastGroup = millis();
+#ifdef TI_DEBUG
+	print_debug(String("TeleInfo baud " + String(_baud)).c_str());
+#endif
 }
 
 // ********************************************************************************
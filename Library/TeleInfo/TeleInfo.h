@@ -20,11 +20,33 @@ void TELEINFO_Task_code(void *parameter);
 #define TELEINFO_DATA_TASK(start)	{}
 #endif
 
-#define LABEL_MAX_SIZE     9  // Maximum 8 caractères pour MOTDETAT
-#define DATA_MAX_SIZE     13  // Maximum 12 caractères pour ADCO
-#define LINE_MAX_COUNT    30  // Avec les options tempo et en tri
-#define FRAME_MAX_SIZE   350  // Buffer trame complète
+// Vitesse du port, TI_BAUD_AUTO essaye 1200 puis 9600 tant qu'aucune trame n'est valide
+#define TI_BAUD_HISTORIC	1200
+#define TI_BAUD_STANDARD	9600
+#define TI_BAUD_AUTO	0
+#define TI_AUTO_BAUD_MS	3000  // Change de vitesse après 3 s sans groupe valide
+// Délai minimum de Configure() en vitesse automatique : un essai à chaque vitesse puis une trame
+// historique complète à 1200 bauds (jusqu'à 6 s en attendant le début de trame)
+#define TI_CONFIGURE_MS	(2 * TI_AUTO_BAUD_MS + 6000)
+
+#ifndef LABEL_MAX_SIZE
+#define LABEL_MAX_SIZE     9  // Maximum 8 caractères pour MOTDETAT, SINSTS1, NJOURF+1
+#endif
+#ifndef DATA_MAX_SIZE
+#define DATA_MAX_SIZE     33  // 32 caractères pour MSG1, les données plus longues (PJOURF+1) sont tronquées
+#endif
+#define DATE_MAX_SIZE     14  // Horodate du mode standard : saison + AAMMJJhhmmss
+#ifndef LINE_MAX_COUNT
+#define LINE_MAX_COUNT    48  // Avec les options tempo et en tri, les groupes en plus sont ignorés
+#endif
+#define GROUP_MAX_SIZE   128  // Un groupe complet (étiquette, horodate, donnée, checksum)
+#define TI_INDEX_SIZE    128  // Table de hash des étiquettes, puissance de 2 > 2 * LINE_MAX_COUNT
+#define TI_MAX_INDEX      11  // Nombre max d'index d'énergie (BASE, HC, EJP, 6 index tempo)
+#ifndef TI_MAX_SUBSCRIBE
+#define TI_MAX_SUBSCRIBE   8  // Nombre max d'étiquettes surveillées
+#endif
 
+// Mode historique : 1200 bauds, séparateur espace
 // La longueur de la trame de base est 141, reçue en 1180 ms
 // Exemple :
 //ADCO 040622146651 <
@@ -36,15 +58,49 @@ void TELEINFO_Task_code(void *parameter);
 //IMAX 003 B
 //PAPP 00000 !
 //MOTDETAT 000000 B
+//
+// Mode standard (Linky) : 9600 bauds, séparateur tabulation, horodate optionnelle
+// Exemple :
+//ADSC	041876097353	B
+//DATE	E230415101523		9
+//EAST	001234567	+
+//SINSTS	01234	P
+//SMAXSN	E230415063012	04512	1
+// Le checksum porte sur l'étiquette jusqu'à la tabulation avant le checksum (incluse),
+// en historique jusqu'à la donnée (l'espace avant le checksum est exclu).
+
+typedef enum
+{
+	TI_Unknown,
+	TI_Historic,
+	TI_Standard
+} TI_Mode;
+
+/**
+ * Un groupe de la trame. La place (slot) d'une étiquette est fixée à sa première réception,
+ * la valeur entière est décodée une seule fois par trame.
+ */
+typedef struct
+{
+	char label[LABEL_MAX_SIZE];
+	char data[DATA_MAX_SIZE];
+	char date[DATE_MAX_SIZE];   // Horodate (mode standard), vide sinon
+	int32_t value;              // Valeur entière de data (comme strtol)
+	uint8_t frame;              // Numéro de la dernière trame contenant l'étiquette
+	bool changed;               // La donnée a changé depuis la dernière notification
+} TI_Group;
+
+/**
+ * Fonction appelée quand une étiquette surveillée change (voir Subscribe())
+ */
+typedef void (*TI_Callback)(const char *label, const char *data, int32_t value);
 
 typedef struct
 {
-	char *label;          // Pointeur sur le label
-	char checkLabel;			// Checksum du label
-	char *data;						// Pointeur sur la data
-	uint8_t lenData;			// Longueur de la data
-	char *checksum;				// Pointeur sur le checksum complet
-} TI_TypeDef;
+	char label[LABEL_MAX_SIZE];
+	TI_Callback callback;
+	int8_t slot;                // Place de l'étiquette, -1 si pas encore reçue
+} TI_Subscriber;
 
 class TeleInfo
 {
@@ -58,34 +114,56 @@ class TeleInfo
 		bool _tiRunning = false;
 
 		bool _frameBegin = false;
+		bool _frameOk = false;
 		volatile bool _isAvailable = false;
+		uint16_t _frameSize = 0;
 
-		char _frame[FRAME_MAX_SIZE + 1];
-		uint16_t _frameIndex = 0;
+		// Le groupe en cours de réception (entre LF et CR) et la somme de ses caractères
+		char _group[GROUP_MAX_SIZE];
+		uint8_t _groupIndex = 0;
+		bool _inGroup = false;
+		uint8_t _groupSum = 0;
 
-		char _label[LINE_MAX_COUNT][LABEL_MAX_SIZE];
-		char _data[LINE_MAX_COUNT][DATA_MAX_SIZE];
+		// Les groupes reçus et l'index étiquette -> groupe, construits par la première trame
+		TI_Group _groups[LINE_MAX_COUNT];
 		volatile int _labelCount = 0;
-
-		// Structure complète de la frame
-		TI_TypeDef _structure[LINE_MAX_COUNT];
-		bool use_structure = false;
-
+		uint8_t _index[TI_INDEX_SIZE]; // Numéro du groupe + 1, 0 = vide
+		bool _structured = false;
+		bool _newLabel = false;
+		uint8_t _frameNumber = 0;
+
+		// Les groupes de la puissance et des index d'énergie
+		int8_t _idPower = -1;
+		int8_t _idIndex[TI_MAX_INDEX];
+		uint8_t _indexCount = 0;
+
+		TI_Subscriber _subscribers[TI_MAX_SUBSCRIBE];
+
+		TI_Mode _mode = TI_Unknown;      // Figé par la première trame valide
+		TI_Mode _frameMode = TI_Unknown; // Mode des groupes de la trame en cours
+		bool _autoBaud = false;
+		uint32_t _baud;
+		uint32_t _lastGroup = 0;
+
+		uint32_t _powerVA = 0;
+		uint32_t _indexWh = 0;
 		char TI_PowerVA_str[6] = {0}; // 5 caractères
-		char TI_IndexWh_str[10] = {0}; // 9 caractères
-
-		uint8_t ID_PowerVA = 7;
-		uint8_t ID_IndexWh = 3;
+		char TI_IndexWh_str[11] = {0}; // 10 caractères, somme des index
 
 		void resetAll();
+		void beginFrame();
 		uint16_t DataReceived(uint8_t ch);
-		int decode(int beginIndex, char *field, unsigned char *sum, uint8_t max_size);
-		bool decodeFrame();
+		bool decodeGroup();
+		bool endFrame();
+		void addIndex(uint8_t id);
+		int findLabel(const char *label) const;
+		int findValue(const char *label) const;
+		void checkBaud();
 		void build_Structure();
-		bool get_Structure_Data(uint8_t id, char *result);
+		void notify();
 
 	public:
-		TeleInfo(uint8_t rxPin, uint32_t refresh_ms = 10000, uint32_t baud = 1200);
+		TeleInfo(uint8_t rxPin, uint32_t refresh_ms = 10000, uint32_t baud = TI_BAUD_AUTO);
 		~TeleInfo();
 
 		void Process();
@@ -102,12 +180,30 @@ class TeleInfo
 		 */
 		const char* getStringVal(const char *label);
 
+		/**
+		 * return the horodate of a label (standard mode)
+		 * return NULL if this label is not found, an empty string if it has no horodate
+		 */
+		const char* getDateVal(const char *label);
+
 		/**
 		 * return the long value of a label
 		 * return a negative value if this label is not found or value is not a long
 		 */
 		int32_t getLongVal(const char *label);
 
+		/**
+		 * callback is called (in Process()) at the end of a valid frame when the data
+		 * of label has changed, and for the first frame after the subscription
+		 * return false if there is no more place (TI_MAX_SUBSCRIBE)
+		 */
+		bool Subscribe(const char *label, TI_Callback callback);
+		void Unsubscribe(const char *label);
+
+		TI_Mode getMode()
+		{
+			return _mode;
+		}
 		uint32_t getPowerVA();
 		uint32_t getIndexWh();
 		char *getPowerVA_str()
@@ -144,6 +144,7 @@
 //#define KEYBOARD_WITH_ADC // Use ADC library
 //#define ADC_USE_ARDUINO   // To use Arduino function
 //#define ADC_USE_TASK      // To use task in place of timer in oneshot mode or callback in continuous mode
+//#define ADC_USE_DMA       // ESP32 only : continuous mode with DMA, clamps computed by frames (ADC_Initialize_DMA)
 
 /**********************************************************
  * Cirrus define
@@ -345,8 +345,7 @@ void append_data(void)
 		return;
 
 	char buffer[255] = {0};
-	char *pbuffer = &buffer[0];
-	uint16_t len;
+	Fast_Writer writer(buffer, 255, {'.', 2});
 
 	// Ouvre le fichier en append, le crée s'il n'existe pas
 	Lock_File = true;
@@ -354,20 +353,16 @@ void append_data(void)
 	if (temp)
 	{
 		// Time, Pconso_rms, Pprod_rms, PTalema, Pth, U_rms, Tcs
-		sprintf(buffer, "%ld", RTC_Local.getUNIXDateTime()); // Copie la date
-		Fast_Set_Decimal_Separator('.');
-		pbuffer = Fast_Pos_Buffer(buffer, "\t", Buffer_End, &len); // On se positionne en fin de chaine
-		pbuffer = Fast_Printf(pbuffer, 2, "\t", Buffer_End, true,
-				{log_cumul.Power_ch1, log_cumul.Power_ch2, Current_Data.Talema_Power, log_cumul.Voltage});
+		writer.AddInt(RTC_Local.getUNIXDateTime()).Add('\t'); // Copie la date
+		writer.Add({log_cumul.Power_ch1, log_cumul.Power_ch2, Current_Data.Talema_Power, log_cumul.Voltage}, "\t",
+				true);
 
 		// Temperatures, Energy
-		pbuffer = Fast_Printf(pbuffer, 2, "\t", Buffer_End, false,
-				{log_cumul.Temp, Current_Data.DS18B20_Int, Current_Data.DS18B20_Ext, Current_Data.energy_day_conso,
-						Current_Data.energy_day_surplus, Current_Data.energy_day_prod, Current_Data.Talema_Energy});
+		writer.Add({log_cumul.Temp, Current_Data.DS18B20_Int, Current_Data.DS18B20_Ext, Current_Data.energy_day_conso,
+				Current_Data.energy_day_surplus, Current_Data.energy_day_prod, Current_Data.Talema_Energy}, "\t", false);
 
 		// End line
-		Fast_Add_EndLine(pbuffer, Buffer_End);
-		Fast_Set_Decimal_Separator(',');
+		writer.EndLine();
 		temp.print(buffer);
 		temp.close();
 	}
@@ -382,49 +377,34 @@ void reboot_energy(void)
 	if (Lock_File)
 		return;
 
-	// Ouvre le fichier en read
+	// Lecture de la dernière ligne en partant de la fin du fichier
 	Lock_File = true;
-	if (Data_Partition->exists(CSV_Filename))
+	char line[MAX_LINESIZE] = {0};
+	if (ReadLastLines(CSV_Filename, 1, line, MAX_LINESIZE, true) == 1)
 	{
-		File temp = Data_Partition->open(CSV_Filename, "r");
-		if (temp)
+		char *pbuffer;
+		float data[20]; // to be large
+		int i = 0;
+
+//		print_debug(line);
+
+		// split last line
+		pbuffer = strtok(line, "\t");
+		while ((pbuffer != NULL) && (i < 20))
 		{
-			String strLine = "";
-			char line[MAX_LINESIZE] = {0};
-			char *pbuffer;
-			float data[20]; // to be large
-			int i = 0;
-			// Read until last line
-			while (temp.available())
-			{
-				strLine = temp.readStringUntil('\n');
-			}
-			temp.close();
-
-//			print_debug(strLine);
-
-			// split last line
-			if (!strLine.isEmpty())
-			{
-				strLine.toCharArray(line, MAX_LINESIZE);
-				pbuffer = strtok((char*) line, "\t");
-				while (pbuffer != NULL)
-				{
-					data[i] = strtof(pbuffer, NULL);
-//					print_debug(String(data[i]));
-					pbuffer = strtok(NULL, "\t");
-					i++;
-				}
-			}
-			// The last 4 data is energy
-			if (i > 3)
-			{
-				// energy_day_conso, energy_day_surplus
-				CS5480.RestartEnergy(Channel_1, data[i - 4], data[i - 3]);
-				// energy_day_prod
-				CS5480.RestartEnergy(Channel_2, data[i - 2]);
-				Current_Data.Talema_Energy = data[i - 1];
-			}
+			data[i] = strtof(pbuffer, NULL);
+//			print_debug(String(data[i]));
+			pbuffer = strtok(NULL, "\t");
+			i++;
+		}
+		// The last 4 data is energy
+		if (i > 3)
+		{
+			// energy_day_conso, energy_day_surplus
+			CS5480.RestartEnergy(Channel_1, data[i - 4], data[i - 3]);
+			// energy_day_prod
+			CS5480.RestartEnergy(Channel_2, data[i - 2]);
+			Current_Data.Talema_Energy = data[i - 1];
 		}
 	}
 
@@ -438,14 +418,24 @@ void append_energy(uint8_t year, bool restart)
 		return;
 
 	char buffer[255] = {0};
-	char *pbuffer = &buffer[0];
 	uint16_t len;
 
 	Energy_Filename = "/energy_20" + (String) year + ".csv";
 	// Ouvre le fichier en append, le crée s'il n'existe pas
 	Lock_File = true;
 	bool Exist = Data_Partition->exists(Energy_Filename);
-	File temp = Data_Partition->open(Energy_Filename, "a");
+
+	// On regarde la dernière ligne : si le jour est déjà enregistré (double appel au
+	// changement de jour), on ne l'ajoute pas une deuxième fois
+	char last_line[255] = {0};
+	RTC_Local.getShortDate(buffer); // Copie la date
+	len = strlen(buffer);
+	bool Already_Saved = Exist && (ReadLastLines(Energy_Filename, 1, last_line, 255, true) == 1)
+			&& (strncmp(last_line, buffer, len) == 0) && (last_line[len] == '\t');
+
+	File temp;
+	if (!Already_Saved)
+		temp = Data_Partition->open(Energy_Filename, "a");
 	if (temp)
 	{
 		// Le fichier n'existait pas (nouvelle année), on ajoute la première ligne
@@ -453,16 +443,9 @@ void append_energy(uint8_t year, bool restart)
 			temp.print(Energy_Heading);
 
 		// Time, Econso, Esurplus, Eprod, ETalema
-		RTC_Local.getShortDate(buffer); // Copie la date
-		Fast_Set_Decimal_Separator('.');
-		pbuffer = Fast_Pos_Buffer(buffer, "\t", Buffer_End, &len); // On se positionne en fin de chaine
-		pbuffer = Fast_Printf(pbuffer, 2, "\t", Buffer_End, false,
-				{Current_Data.energy_day_conso, Current_Data.energy_day_surplus, Current_Data.energy_day_prod,
-						Current_Data.Talema_Energy});
-
-		// End line
-		Fast_Add_EndLine(pbuffer, Buffer_End);
-		Fast_Set_Decimal_Separator(',');
+		Fast_Writer writer(&buffer[len], 255 - len, {'.', 2});
+		writer.Add('\t').Add({Current_Data.energy_day_conso, Current_Data.energy_day_surplus,
+				Current_Data.energy_day_prod, Current_Data.Talema_Energy}, "\t", false).EndLine();
 
 		temp.print(buffer);
 		temp.close();
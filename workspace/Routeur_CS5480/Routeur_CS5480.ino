@@ -413,7 +413,7 @@ void setup()
 #ifdef USE_TI
 	IHM_Print0("Test TI");
 
-	if (TI.Configure(10000))
+	if (TI.Configure(TI_CONFIGURE_MS))
 	{
 		print_debug(F("Configuration TeleInfo OK"));
 		TI.PrintAllToSerial();
@@ -443,6 +443,10 @@ void setup()
 		// Pour le channel 2, on ne veut pas la temprérature, ni le PF ni la fréquence
 		CS5480.GetRMSData(Channel_2)->SetTemperature(false); // Normalement déjà false
 		CS5480.GetRMSData(Channel_2)->SetWantData(exd_PF);
+#ifdef CIRRUS_INT_GPIO
+		// Attente des données sur la pin INT, le polling reste en secours
+		CS5480.DataReady_Initialize(CIRRUS_INT_GPIO);
+#endif
 	}
 
 	// **** 7- Initialisation SSR avec Zero-Cross ****
@@ -763,47 +767,38 @@ void handleInitPVData(CB_SERVER_PARAM)
 void handleLastData(CB_SERVER_PARAM)
 {
 	char buffer[255] = {0};
-	char *pbuffer = &buffer[0];
-	uint16_t len = 0;
 	float Energy, Surplus, Prod;
 	bool graphe = Get_Last_Data(&Energy, &Surplus, &Prod);
+	Fast_Writer writer(buffer, 255, {',', 2});
 
-	strcpy(buffer, RTC_Local.the_time()); // Copie la date
-	pbuffer = Fast_Pos_Buffer(buffer, "#", Buffer_End, &len); // On se positionne en fin de chaine
-	pbuffer = Fast_Printf(pbuffer, 2, "#", Buffer_End, true, {Current_Data.Cirrus_ch1.ActivePower,
-			Current_Data.Cirrus_ch1.Voltage, Energy, Surplus, Current_Data.Cirrus_ch1.PowerFactor,
-			Current_Data.Cirrus_ch2.ActivePower, Prod});
+	writer.Add(RTC_Local.the_time()).Add('#'); // Copie la date
+	writer.Add({Current_Data.Cirrus_ch1.ActivePower, Current_Data.Cirrus_ch1.Voltage, Energy, Surplus,
+			Current_Data.Cirrus_ch1.PowerFactor, Current_Data.Cirrus_ch2.ActivePower, Prod}, "#", true);
 
-	pbuffer = Fast_Printf(pbuffer, Current_Data.TI_Power, 0, "", "#", Buffer_End, &len);
-	pbuffer = Fast_Printf(pbuffer, Current_Data.TI_Energy, 0, "", "#", Buffer_End, &len);
+	writer.Add(Current_Data.TI_Power, 0).Add('#').Add(Current_Data.TI_Energy, 0).Add('#');
 
 	// Talema, Prod théorique, Cirrus puissance apparente
-	pbuffer = Fast_Printf(pbuffer, 2, "#", Buffer_End, true,
-			{Current_Data.Talema_Power, Current_Data.Talema_Energy, Current_Data.Prod_Th,
-					Current_Data.Cirrus_ch1.ApparentPower});
+	writer.Add({Current_Data.Talema_Power, Current_Data.Talema_Energy, Current_Data.Prod_Th,
+			Current_Data.Cirrus_ch1.ApparentPower}, "#", true);
 
 	// Températures
-	pbuffer = Fast_Printf(pbuffer, 2, "#", Buffer_End, true, {Current_Data.Cirrus_ch1.Temperature,
-			Current_Data.DS18B20_Int, Current_Data.DS18B20_Ext});
+	writer.Add({Current_Data.Cirrus_ch1.Temperature, Current_Data.DS18B20_Int, Current_Data.DS18B20_Ext}, "#", true);
 
 	// Etat du SSR
-	pbuffer = Fast_Printf(pbuffer, (int) SSR_Get_State(), 0, "SSR=", "#", Buffer_End, &len);
+	writer.Add("SSR=").AddInt((int) SSR_Get_State()).Add('#');
 
 	// Etat des relais
 #ifdef USE_RELAY
-	pbuffer = Fast_Pos_Buffer(buffer, Relay.getAllState().c_str(), Buffer_End, &len);
+	writer.Add(Relay.getAllState().c_str());
 #else
-	pbuffer = Fast_Pos_Buffer(buffer, "OFF,OFF,OFF,OFF", Buffer_End, &len);
+	writer.Add("OFF,OFF,OFF,OFF");
 #endif
 
 	// On a de nouvelles données pour le graphe
 	if (graphe)
 	{
-		Fast_Set_Decimal_Separator('.');
-		pbuffer = Fast_Pos_Buffer(pbuffer, "#", Buffer_End, &len); // On se positionne en fin de chaine
-		pbuffer = Fast_Printf(pbuffer, 2, "#", Buffer_End, false,
-				{log_cumul.Power_ch1, log_cumul.Power_ch2, log_cumul.Voltage, log_cumul.Temp});
-		Fast_Set_Decimal_Separator(',');
+		writer.format.decimal = '.';
+		writer.Add('#').Add({log_cumul.Power_ch1, log_cumul.Power_ch2, log_cumul.Voltage, log_cumul.Temp}, "#", false);
 	}
 
 //	print_debug(buffer);
@@ -136,6 +136,9 @@
 #define CIRRUS_TX_GPIO	GPIO_NUM_17  // UART2
 #define CIRRUS_CS1_GPIO	GPIO_NUM_18
 #define CIRRUS_CS2_GPIO	GPIO_NUM_19
+// Pin INT du Cirrus (DRDY) si elle est câblée : attente des données sur interruption.
+// Sinon, le registre Status0 est lu en boucle (polling)
+//#define CIRRUS_INT_GPIO	GPIO_NUM_25
 
 #define CIRRUS_USE_UART // If not defined then SPI is used
 #ifdef CIRRUS_USE_UART
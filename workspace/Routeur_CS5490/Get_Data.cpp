@@ -267,12 +267,23 @@ void append_energy(void)
 	if (Lock_File)
 		return;
 
-	// Ouvre le fichier en append, le crée s'il n'existe pas
+	// On regarde la dernière ligne : si le jour est déjà enregistré (double appel au
+	// changement de jour), on ne l'ajoute pas une deuxième fois
 	Lock_File = true;
+	char last_line[100] = {0};
+	uint32_t now = RTC_Local.getUNIXDateTime();
+	if ((ReadLastLines(Energy_Filename, 1, last_line, 100, true) == 1)
+			&& (strtoul(last_line, NULL, 10) / 86400 == now / 86400))
+	{
+		Lock_File = false;
+		return;
+	}
+
+	// Ouvre le fichier en append, le crée s'il n'existe pas
 	File temp = Data_Partition->open(Energy_Filename, "a");
 	if (temp)
 	{
-		String data = String(RTC_Local.getUNIXDateTime()) + '\t' + (String) energy_day_conso + '\t'
+		String data = String(now) + '\t' + (String) energy_day_conso + '\t'
 				+ (String) energy_day_surplus + "\r\n";
 		temp.print(data);
 		temp.close();
@@ -332,7 +332,7 @@ void setup()
 #ifdef USE_TI
 	IHM_Print0("Test TI");
 
-	if (TI.Configure(10000))
+	if (TI.Configure(TI_CONFIGURE_MS))
 	{
 		print_debug(F("Configuration TeleInfo OK"));
 		TI.PrintAllToSerial();
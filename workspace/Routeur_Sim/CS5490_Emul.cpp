@@ -0,0 +1,341 @@
+#include "CS5490_Emul.h"
+#include "CIRRUS.h"
+
+#define MCLK	4096000  // Hz clock rate: 4.096 MHz
+#define OWR	4000     // Output word rate en Hz
+
+// Le registre de température est mis à jour toutes les 2240 OWR
+#define TEMP_UPDATE_us	560000
+#define TEMPERATURE	25.0
+
+// Index des pages dans Regs
+static int8_t Page_Index(uint8_t page)
+{
+	switch (page)
+	{
+		case PAGE0: return 0;
+		case PAGE16: return 1;
+		case PAGE17: return 2;
+		case PAGE18: return 3;
+	}
+	return -1;
+}
+
+// Nombre en [-1, 1[ au format complément à 2 sur 24 bits
+static uint32_t To_Twos(double val)
+{
+	int32_t num = (int32_t) lround(val * 8388608.0);
+	if (num > 0x7FFFFF)
+		num = 0x7FFFFF;
+	if (num < -0x800000)
+		num = -0x800000;
+	return ((uint32_t) num) & 0xFFFFFF;
+}
+
+// Nombre en [0, 1[ au format non signé sur 24 bits
+static uint32_t To_Unsigned(double val)
+{
+	if (val <= 0.0)
+		return 0;
+	uint32_t num = (uint32_t) lround(val * 16777216.0);
+	return (num > 0xFFFFFF) ? 0xFFFFFF : num;
+}
+
+CS5490_Emul::CS5490_Emul()
+{
+	Reset();
+}
+
+/**
+ * Valeurs des registres au reset (datasheet CS5490)
+ */
+void CS5490_Emul::Reset(void)
+{
+	memset(Regs, 0, sizeof(Regs));
+	*Reg(PAGE0, P0_Config0) = 0xC02000;
+	*Reg(PAGE0, P0_Config1) = 0x00EEEE;
+	*Reg(PAGE0, P0_SerialCtrl) = 0x02004D;
+	*Reg(PAGE0, P0_PulseWidth) = 0x000001;
+	*Reg(PAGE0, P0_Status0) = 0x800000;
+	*Reg(PAGE0, P0_Status1) = 0x801800;
+	*Reg(PAGE0, P0_ZX_NUM) = 0x000064;
+	*Reg(PAGE16, P16_Config2) = 0x000200;
+	*Reg(PAGE16, P16_I1_GAIN) = 0x400000;
+	*Reg(PAGE16, P16_V1_GAIN) = 0x400000;
+	*Reg(PAGE16, P16_Epsilon) = 0x01999A;
+	*Reg(PAGE16, P16_Ichan_LEVEL) = 0x828F5C;
+	*Reg(PAGE16, P16_SampleCount) = 0x000FA0;
+	*Reg(PAGE16, P16_T_GAIN) = 0x06B716;
+	*Reg(PAGE16, P16_T_OFF) = 0xD53998;
+	*Reg(PAGE16, P16_P_MIN_IRMS) = 0x00624D;
+	*Reg(PAGE16, P16_T_SETTLE) = 0x00001E;
+	*Reg(PAGE16, P16_VF_RMS) = 0x5A8279;
+	*Reg(PAGE16, P16_SYS_GAIN) = 0x500000;
+	*Reg(PAGE17, P17_I1Over_LEVEL) = 0x7FFFFF;
+	*Reg(PAGE18, P18_PulseRate) = 0x800000;
+
+	Page = PAGE0;
+	Write_Count = 0;
+	Rx_Head = Rx_Tail = 0;
+	Running = false;
+	Sum_U2 = Sum_P = 0.0;
+	Sum_Count = 0;
+	Update_INT();
+}
+
+/**
+ * Echelle des mesures, au format de CIRRUS_Base::GetScale() : U calib, I max
+ */
+void CS5490_Emul::Set_Scale(const float *scale)
+{
+	V_Scale = scale[0] / 0.6;
+	I_Scale = scale[1] / 0.6;
+}
+
+/**
+ * La pin INT du Cirrus, au repos à HIGH
+ */
+void CS5490_Emul::Set_INT_Pin(int8_t pin)
+{
+	INT_Pin = pin;
+	if (INT_Pin >= 0)
+	{
+		Sim_Set_Pin(INT_Pin, HIGH);
+		Update_INT();
+	}
+}
+
+// INT est active (LOW) tant qu'un évènement autorisé par Mask est présent dans Status0
+void CS5490_Emul::Update_INT(void)
+{
+	if (INT_Pin < 0)
+		return;
+	bool active = ((*Reg(PAGE0, P0_Status0) & *Reg(PAGE0, P0_Mask)) != 0);
+	Sim_Set_Pin(INT_Pin, (active) ? LOW : HIGH);
+}
+
+uint32_t* CS5490_Emul::Reg(uint8_t page, uint8_t reg)
+{
+	int8_t index = Page_Index(page);
+	if ((index < 0) || (reg >= 64))
+		return NULL;
+	return &Regs[index][reg];
+}
+
+/**
+ * Baud rate du Cirrus : br[15:0] = baud * 524288 / MCLK - 1
+ */
+uint32_t CS5490_Emul::Chip_Baud(void)
+{
+	uint32_t br = *Reg(PAGE0, P0_SerialCtrl) & 0xFFFF;
+	return (uint32_t) (((uint64_t) (br + 1) * MCLK) / 524288);
+}
+
+uint64_t CS5490_Emul::Period_us(void)
+{
+	uint32_t count = *Reg(PAGE16, P16_SampleCount);
+	if (count == 0)
+		count = 1;
+	return ((uint64_t) count * 1000000) / OWR;
+}
+
+/**
+ * Temps de transmission de count octets (start + 8 bits + stop)
+ */
+void CS5490_Emul::Byte_Time(uint8_t count)
+{
+	Sim_Advance_us(((uint64_t) count * 10000000) / Host_Baud);
+}
+
+// ********************************************************************************
+// HardwareSerial
+// ********************************************************************************
+
+void CS5490_Emul::begin(unsigned long baud)
+{
+	Host_Baud = baud;
+	Rx_Head = Rx_Tail = 0;
+}
+
+void CS5490_Emul::updateBaudRate(unsigned long baud)
+{
+	Host_Baud = baud;
+}
+
+int CS5490_Emul::available(void)
+{
+	return Rx_Tail - Rx_Head;
+}
+
+int CS5490_Emul::read(void)
+{
+	if (Rx_Head == Rx_Tail)
+		return -1;
+	uint8_t c = Rx[Rx_Head++];
+	if (Rx_Head == Rx_Tail)
+		Rx_Head = Rx_Tail = 0;
+	return c;
+}
+
+size_t CS5490_Emul::write(uint8_t c)
+{
+	Byte_Time(1);
+
+	// Octet illisible si les baud rates ne correspondent pas (5%)
+	uint32_t chip = Chip_Baud();
+	uint32_t delta = (chip > Host_Baud) ? chip - Host_Baud : Host_Baud - chip;
+	if (delta * 20 > Host_Baud)
+		return 1;
+
+	if (Write_Count > 0)
+	{
+		// Donnée d'une écriture, LSB en premier
+		Write_Data |= ((uint32_t) c) << (8 * (3 - Write_Count));
+		if (--Write_Count == 0)
+			Register_Write(Write_Reg, Write_Data);
+	}
+	else
+		Command(c);
+	return 1;
+}
+
+// ********************************************************************************
+// Protocole
+// ********************************************************************************
+
+void CS5490_Emul::Command(uint8_t c)
+{
+	switch (c & 0xC0)
+	{
+		case REGISTER_READ:
+		{
+			uint32_t *reg = Reg(Page, c & 0x3F);
+			uint32_t value = (reg != NULL) ? *reg : 0;
+			Read_Count++;
+			if (Rx_Tail + 3 <= (uint16_t) sizeof(Rx))
+			{
+				Rx[Rx_Tail++] = value & 0xFF;
+				Rx[Rx_Tail++] = (value >> 8) & 0xFF;
+				Rx[Rx_Tail++] = (value >> 16) & 0xFF;
+			}
+			Byte_Time(3);
+			break;
+		}
+		case REGISTER_WRITE:
+			Write_Reg = c & 0x3F;
+			Write_Data = 0;
+			Write_Count = 3;
+			break;
+		case PAGE_SELECT:
+			Page = c & 0x3F;
+			break;
+		default:
+			Instruction(c & 0x3F);
+	}
+}
+
+void CS5490_Emul::Register_Write(uint8_t reg, uint32_t value)
+{
+	uint32_t *dest = Reg(Page, reg);
+	if (dest == NULL)
+		return;
+
+	// Les status sont effacés en écrivant 1
+	if ((Page == PAGE0) && ((reg == P0_Status0) || (reg == P0_Status1) || (reg == P0_Status2)))
+		*dest &= ~value;
+	else
+		*dest = value & 0xFFFFFF;
+
+	if (Page == PAGE0)
+		Update_INT();
+}
+
+void CS5490_Emul::Instruction(uint8_t instruction)
+{
+	switch (instruction)
+	{
+		case SOFT_RESET:
+			Reset();
+			break;
+		case CONT_CONV:
+		case SINGLE_CONV:
+			Running = true;
+			Next_Ready_us = Sim_Now_us() + Period_us();
+			Sum_U2 = Sum_P = 0.0;
+			Sum_Count = 0;
+			break;
+		case HALT_CONV:
+			Running = false;
+			break;
+		default:
+			// Calibrations, standby : sans effet
+			break;
+	}
+}
+
+// ********************************************************************************
+// Mesures
+// ********************************************************************************
+
+/**
+ * Cumul d'une demi-période du réseau. Les registres sont mis à jour à la fin de la période
+ * d'échantillonnage (à la demi-période près).
+ */
+void CS5490_Emul::Add_HalfPeriod(const Sim_HalfPeriod &half)
+{
+	if (!Running)
+		return;
+
+	Sum_U2 += half.Voltage * half.Voltage;
+	Sum_P += half.Grid;
+	Sum_Count++;
+
+	uint64_t now = Sim_Now_us();
+	if (now >= Next_Ready_us)
+	{
+		Conversion_Ready();
+		Next_Ready_us += Period_us();
+		if (Next_Ready_us <= now)
+			Next_Ready_us = now + Period_us();
+	}
+}
+
+void CS5490_Emul::Conversion_Ready(void)
+{
+	if (Sum_Count == 0)
+		return;
+
+	double urms = sqrt(Sum_U2 / Sum_Count);
+	double pavg = Sum_P / Sum_Count;
+	// Charges résistives : facteur de puissance de 1 au signe près
+	double irms = (urms > 0.0) ? fabs(pavg) / urms : 0.0;
+	double p_scale = V_Scale * I_Scale;
+
+	*Reg(PAGE16, P16_V1_RMS) = To_Unsigned(urms / V_Scale);
+	*Reg(PAGE16, P16_I1_RMS) = To_Unsigned(irms / I_Scale);
+	*Reg(PAGE16, P16_P1_AVG) = To_Twos(pavg / p_scale);
+	*Reg(PAGE16, P16_Q1_AVG) = 0;
+	*Reg(PAGE16, P16_S1) = To_Twos(fabs(pavg) / p_scale);
+	*Reg(PAGE16, P16_PF1) = To_Twos((pavg < 0.0) ? -0.999999 : 0.999999);
+	*Reg(PAGE16, P16_P_SUM) = *Reg(PAGE16, P16_P1_AVG);
+
+	// Signe de P1 dans Status2, DRDY dans Status0
+	if (pavg < 0.0)
+		*Reg(PAGE0, P0_Status2) |= 0x000001;
+	else
+		*Reg(PAGE0, P0_Status2) &= ~0x000001;
+	*Reg(PAGE0, P0_Status0) |= 0x800000;
+
+	// Température
+	Temp_Count += Period_us();
+	if (Temp_Count >= TEMP_UPDATE_us)
+	{
+		Temp_Count = 0;
+		*Reg(PAGE16, P16_T) = To_Twos(TEMPERATURE / 128.0);
+		*Reg(PAGE0, P0_Status0) |= 0x000020;
+	}
+	Update_INT();
+
+	Sum_U2 = Sum_P = 0.0;
+	Sum_Count = 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+ * Emulation d'un CS5490 sur la liaison UART pour la simulation du routeur
+ *
+ * La librairie CIRRUS (CIRRUS_Communication, CIRRUS_Base, CIRRUS_RMSData) est utilisée telle quelle :
+ * elle dialogue avec cette classe comme avec le port série du Cirrus.
+ * - Protocole UART du CS5490 : sélection de page, lecture (réponse 3 octets LSB en premier),
+ * écriture (3 octets LSB en premier) et instructions.
+ * - Chaque octet prend 10 bits au baud rate en cours : le temps simulé avance d'autant.
+ * Si le baud rate du Cirrus (registre SerialCtrl) et celui de l'UART diffèrent, les octets sont perdus.
+ * - Conversion continue : toutes les SampleCount / 4000 s, les registres U RMS, I RMS, P moyen, ...
+ * sont mis à jour à partir des demi-périodes du réseau (Add_HalfPeriod) et DRDY est mis à 1.
+ * - Les registres de calibration sont mémorisés mais sans effet : les mesures sont exactes
+ * avec l'échelle donnée par Set_Scale() (celle de CIRRUS_Base::GetScale()).
+ * - La pin INT (Set_INT_Pin) est à LOW tant qu'un bit de Status0 autorisé par le registre Mask est à 1,
+ * comme sur le CS5490 : le front descendant déclenche l'interruption attachée (mode DRDY de CIRRUS_Base).
+ */
+
+#include "Arduino.h"
+#include "Sim_Core.h"
+
+class CS5490_Emul: public HardwareSerial
+{
+	public:
+		CS5490_Emul();
+
+		// HardwareSerial
+		void begin(unsigned long baud);
+		void updateBaudRate(unsigned long baud);
+		int available(void);
+		int read(void);
+		size_t write(uint8_t c);
+		using HardwareSerial::write;
+
+		// Reset hard (pin reset à LOW)
+		void Reset(void);
+		void Set_Scale(const float *scale);
+		void Set_INT_Pin(int8_t pin);
+		void Add_HalfPeriod(const Sim_HalfPeriod &half);
+
+		uint32_t Get_Read_Count(void) const
+		{
+			return Read_Count;
+		}
+
+	private:
+		uint32_t Regs[4][64];
+		uint8_t Page = 0;
+		uint8_t Write_Reg = 0xFF;
+		uint8_t Write_Count = 0;
+		uint32_t Write_Data = 0;
+		uint8_t Rx[3 * 64];
+		uint16_t Rx_Head = 0;
+		uint16_t Rx_Tail = 0;
+
+		uint32_t Host_Baud = 600;
+		uint32_t Read_Count = 0;
+		int8_t INT_Pin = -1;
+
+		float V_Scale = 1.0;
+		float I_Scale = 1.0;
+
+		// Conversion
+		bool Running = false;
+		uint64_t Next_Ready_us = 0;
+		uint32_t Temp_Count = 0;
+		double Sum_U2 = 0.0;
+		double Sum_P = 0.0;
+		uint32_t Sum_Count = 0;
+
+		uint32_t* Reg(uint8_t page, uint8_t reg);
+		uint32_t Chip_Baud(void);
+		uint64_t Period_us(void);
+		void Byte_Time(uint8_t count);
+		void Command(uint8_t c);
+		void Register_Write(uint8_t reg, uint32_t value);
+		void Instruction(uint8_t instruction);
+		void Conversion_Ready(void);
+		void Update_INT(void);
+};
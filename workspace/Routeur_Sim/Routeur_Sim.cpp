@@ -0,0 +1,569 @@
+/**
+ * Simulation sur PC de la boucle de routage du surplus
+ *
+ * Les librairies du routeur sont compilées telles quelles pour le PC :
+ * - CIRRUS (Base, Communication, RMSData) dialogue avec l'émulation UART d'un CS5490 (CS5490_Emul),
+ * - SSR (zéro-cross, timer, PID, burst) pilote le triac simulé (Sim_Core),
+ * - Emul_PV fournit la production théorique du jour (Sim_Scenario).
+ * La boucle reproduit celle de Routeur_CS5490 : Get_Data() toutes les 200 ms (ZC_Top_Xms) puis
+ * Gestion_SSR_CallBack(U, P).
+ *
+ * Bilan en fin de simulation :
+ * - énergies importée et exportée (réelles et mesurées par le Cirrus),
+ * - temps de stabilisation après chaque échelon de production ou de consommation,
+ * - nombre de basculements du triac (SSR_Get_Toggle_Count et conduction réelle).
+ *
+ * Critères de réussite (options -R, -I, -T), le programme renvoie 1 si l'un d'eux n'est pas respecté :
+ * - énergie routée proche du surplus disponible (surplus borné par la puissance de la charge),
+ * - import réseau dû au routage (import - import sans routage) borné en % de l'énergie routée,
+ * - nombre de basculements du SSR par heure borné,
+ * - en burst, conduction moyenne égale à la consigne et autant d'alternances positives que négatives.
+ *
+ * Usage : Routeur_Sim -h
+ */
+
+#include "Arduino.h"
+#include "config_lib.h"
+#include "CIRRUS.h"
+#include "SSR.h"
+#include "FS.h"
+#include "Partition_utils.h"
+#include "Sim_Core.h"
+#include "Sim_Scenario.h"
+#include "CS5490_Emul.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Echelon de la puissance nette (maison - PV) qui démarre une mesure de stabilisation
+#define STEP_W	100.0
+// Durée de stabilité pour considérer la régulation stabilisée
+#define SETTLED_us	1000000
+// Au-delà, l'échelon est compté comme non stabilisé
+#define SETTLE_TIMEOUT_us	60000000
+// Bloc d'évaluation de la régulation en mode surplus (en demi-périodes)
+#define SURPLUS_BLOCK	10
+
+extern volatile Gestion_SSR_TypeDef Gestion_SSR_CallBack;
+
+// Le Cirrus simulé
+CS5490_Emul Cirrus_UART;
+CIRRUS_Communication CS_Com = CIRRUS_Communication(&Cirrus_UART, CIRRUS_RESET_GPIO);
+CIRRUS_CS5490 CS5490 = CIRRUS_CS5490(CS_Com);
+
+// Pour Emul_PV (horizon et prévision) : répertoire courant
+fs::FS Partition;
+fs::FS *Data_Partition = &Partition;
+volatile bool Lock_File = false;
+
+typedef struct
+{
+		Sim_Scenario_Params Scenario;
+		const char *Trace;
+		const char *Output;
+		bool Burst;
+		float Target;
+		float Dump;
+		float Band;
+		uint16_t Window;
+		SSR_PID_Params PID;
+		float Speed;
+		bool DataReady;
+		bool Verbose;
+		float Routed_Tol;   // %, négatif : pas de contrôle
+		float Import_Max;   // % de l'énergie routée
+		float Toggles_Max;  // par heure
+		float Duty_Tol;     // %, burst
+		uint32_t ZC_Miss;
+} Sim_Options;
+
+static Sim_Options Options;
+
+// Bilan
+static double Energy_PV = 0.0;
+static double Energy_Load = 0.0;
+static double Energy_Dump = 0.0;
+static double Energy_Import = 0.0;
+static double Energy_Export = 0.0;
+static double Energy_Available = 0.0;
+static double Energy_Import_Base = 0.0;
+static FILE *Output = NULL;
+static uint32_t Conduction_Start = 0;
+
+// Burst : demi-périodes en conduction et consigne du SSR (SSR_Get_Current_Percent)
+static uint32_t Duty_Count = 0;
+static uint32_t Duty_On = 0;
+static uint32_t Duty_Positive = 0;
+static double Duty_Percent = 0.0;
+
+// Mesure de la stabilisation
+static float Last_Net = 0.0;
+static bool First_HalfPeriod = true;
+static bool Step_Pending = false;
+static uint64_t Step_us = 0;
+static uint64_t Stable_Start_us = 0;
+static bool Stable = false;
+static uint32_t Step_Count = 0;
+static uint32_t Step_Interrupted = 0;
+static uint32_t Step_Timeout = 0;
+static std::vector<float> Settling_ms;
+
+// Bloc d'évaluation en cours
+static uint16_t Block_Size = SURPLUS_BLOCK;
+static uint16_t Block_Count = 0;
+static uint64_t Block_Start_us = 0;
+static double Block_Grid = 0.0;
+static double Block_Dump = 0.0;
+static double Block_Full = 0.0;
+
+void PrintTerminal(const char *text)
+{
+	if (Options.Verbose)
+		printf("%s\r\n", text);
+}
+
+void print_debug(const char *mess, bool ln)
+{
+	if (Options.Verbose)
+		printf((ln) ? "%s\r\n" : "%s", mess);
+}
+
+// ********************************************************************************
+// Bilan par demi-période
+// ********************************************************************************
+
+/**
+ * Fin d'un bloc : la régulation est-elle dans la bande ou saturée (charge à 0 avec import,
+ * charge à fond avec export) ?
+ */
+static void Block_End(void)
+{
+	float grid = Block_Grid / Block_Count;
+	float dump = Block_Dump / Block_Count;
+	float full = Block_Full / Block_Count;
+	float target = Options.Target;
+
+	bool in_band = (fabs(grid - target) <= Options.Band);
+	bool saturated = ((dump < 0.01 * full) && (grid > target)) || ((dump > 0.99 * full) && (grid < target));
+
+	if (in_band || saturated)
+	{
+		if (!Stable)
+		{
+			Stable = true;
+			Stable_Start_us = Block_Start_us;
+		}
+	}
+	else
+		Stable = false;
+
+	if (Step_Pending)
+	{
+		if (Stable && (Sim_Now_us() - Stable_Start_us >= SETTLED_us))
+		{
+			uint64_t settle = (Stable_Start_us > Step_us) ? Stable_Start_us - Step_us : 0;
+			Settling_ms.push_back(settle / 1000.0);
+			Step_Pending = false;
+		}
+		else
+			if (Sim_Now_us() - Step_us > SETTLE_TIMEOUT_us)
+			{
+				Step_Timeout++;
+				Step_Pending = false;
+			}
+	}
+
+	Block_Count = 0;
+	Block_Grid = Block_Dump = Block_Full = 0.0;
+}
+
+static void onHalfPeriod(const Sim_HalfPeriod &half)
+{
+	const double hours = SIM_HALF_PERIOD_us / 3600e6;
+	float net = half.Load - half.PV;
+	float full = Options.Dump * (half.Voltage / 230.0) * (half.Voltage / 230.0);
+
+	Cirrus_UART.Add_HalfPeriod(half);
+
+	Energy_PV += half.PV * hours;
+	Energy_Load += half.Load * hours;
+	Energy_Dump += half.Dump * hours;
+	if (half.Grid > 0)
+		Energy_Import += half.Grid * hours;
+	else
+		Energy_Export -= half.Grid * hours;
+
+	// Ce que pourrait absorber une charge idéale pour atteindre la cible, et l'import sans routage
+	Energy_Available += constrain(-net + Options.Target, 0.0f, full) * hours;
+	if (net > 0)
+		Energy_Import_Base += net * hours;
+
+	if (Options.Burst)
+	{
+		Duty_Count++;
+		Duty_Percent += SSR_Get_Current_Percent();
+		if (half.Conduct)
+		{
+			Duty_On++;
+			if (half.Positive)
+				Duty_Positive++;
+		}
+	}
+
+	// Nouvel échelon
+	if (!First_HalfPeriod && (fabs(net - Last_Net) > STEP_W))
+	{
+		if (Step_Pending)
+			Step_Interrupted++;
+		Step_Pending = true;
+		Step_Count++;
+		Step_us = half.Start_us;
+		Stable = false;
+	}
+	First_HalfPeriod = false;
+	Last_Net = net;
+
+	if (Block_Count == 0)
+		Block_Start_us = half.Start_us;
+	Block_Grid += half.Grid;
+	Block_Dump += half.Dump;
+	Block_Full += full;
+	if (++Block_Count >= Block_Size)
+		Block_End();
+}
+
+// Le reset hard du Cirrus
+static void onPinWrite(uint8_t pin, uint8_t val)
+{
+	if ((pin == CIRRUS_RESET_GPIO) && (val == LOW))
+		Cirrus_UART.Reset();
+}
+
+// ********************************************************************************
+// Boucle du routeur
+// ********************************************************************************
+
+static void Get_Data(void)
+{
+	CS5490.GetData();
+
+	float voltage = CS5490.GetURMS();
+	float power = CS5490.GetPRMSSigned();
+
+	if (Gestion_SSR_CallBack != NULL)
+		Gestion_SSR_CallBack(voltage, power);
+
+	if (Output != NULL)
+	{
+		uint32_t time_s = Options.Scenario.Start_s + Sim_Now_us() / 1000000;
+		fprintf(Output, "%.3f;%02u:%02u:%02u;%.1f;%.1f;%.2f\n", Sim_Now_us() / 1e6, time_s / 3600,
+				(time_s / 60) % 60, time_s % 60, voltage, power, SSR_Get_Current_Percent());
+	}
+}
+
+static bool Routeur_Initialize(void)
+{
+	float scale[2];
+
+	Sim_Set_PinWrite(onPinWrite);
+
+	// Même séquence que Routeur_CS5490 et CIRRUS_Generic_Initialization
+	CS_Com.begin();
+	if (!CS5490.begin(CIRRUS_UART_BAUD, true) || !CS5490.TryConnexion())
+	{
+		fprintf(stderr, "Pas de communication avec le Cirrus\n");
+		return false;
+	}
+	CS5490.Calibration(NULL);
+	CS5490.GetScale(scale);
+	Cirrus_UART.Set_Scale(scale);
+	CS5490.Configuration(100, NULL, true);
+	CS5490.GetRMSData()->SetWantData(exd_Frequency | exd_PApparent | exd_PF);
+
+	// Attente des données sur la pin INT au lieu du polling de Status0
+	Cirrus_UART.Set_INT_Pin(CIRRUS_INT_GPIO);
+	if (Options.DataReady)
+		CS5490.DataReady_Initialize(CIRRUS_INT_GPIO);
+
+	SSR_Initialize(ZERO_CROSS_GPIO, SSR_COMMAND_GPIO, SSR_LED_GPIO);
+	SSR_Set_Dump_Power(Options.Dump);
+	SSR_Set_Target(Options.Target);
+	SSR_Set_PID_Params(Options.PID);
+	if (Options.Burst)
+	{
+		SSR_Set_Burst_Window(Options.Window);
+		Block_Size = SSR_Get_Burst_Window();
+		SSR_Set_Action(SSR_Action_Burst, true);
+	}
+	else
+		SSR_Set_Action(SSR_Action_Surplus, true);
+	return true;
+}
+
+// ********************************************************************************
+// Options et bilan
+// ********************************************************************************
+
+static void Usage(void)
+{
+	printf("Usage : Routeur_Sim [options]\n"
+			"  -t fichier  trace csv heure;PV;maison (PV vide = Emul_PV)\n"
+			"  -d jj/mm/aa date (21/06/25)\n"
+			"  -s hh:mm    début (10:00)\n"
+			"  -e hh:mm    fin (16:00)\n"
+			"  -p Wc       puissance crête PV (1500)\n"
+			"  -n minutes  intervalle moyen entre deux nuages, 0 = ciel clair (10)\n"
+			"  -a minutes  intervalle moyen entre deux appareils, 0 = aucun (15)\n"
+			"  -r graine   graine des tirages aléatoires (1)\n"
+			"  -m mode     surplus ou burst (surplus)\n"
+			"  -w n        fenêtre burst en demi-périodes (%d)\n"
+			"  -g W        cible réseau (0)\n"
+			"  -P W        puissance de la charge sous 230 V (1000)\n"
+			"  -k Kp,Ki,Kff,Band  paramètres du PID\n"
+			"  -b W        bande de stabilisation autour de la cible (50)\n"
+			"  -u V        tension du réseau (230)\n"
+			"  -x facteur  vitesse en temps réel accéléré, 0 = au plus vite (0)\n"
+			"  -i          attente des données du Cirrus sur la pin INT (DRDY)\n"
+			"  -z n        un zéro-cross sur n manqué, 0 = aucun (0)\n"
+			"  -o fichier  log csv des mesures (toutes les 200 ms)\n"
+			"  -v          messages des librairies\n"
+			"Critères de réussite (code de retour 1 si non respecté) :\n"
+			"  -R %%        écart max entre l'énergie routée et le surplus disponible\n"
+			"  -I %%        import dû au routage max, en %% de l'énergie routée\n"
+			"  -T n        basculements du SSR max par heure\n"
+			"  -D %%        burst : écart max entre la conduction moyenne et la consigne,\n"
+			"              alternances positives et négatives égales\n", SSR_BURST_WINDOW);
+}
+
+static bool Parse_HourMinute(const char *str, uint32_t *time_s)
+{
+	unsigned int h, m;
+	if (sscanf(str, "%u:%u", &h, &m) != 2)
+		return false;
+	*time_s = h * 3600 + m * 60;
+	return true;
+}
+
+static float Percentile(std::vector<float> &data, float p)
+{
+	if (data.empty())
+		return 0.0;
+	std::sort(data.begin(), data.end());
+	size_t index = (size_t) ceil(p * data.size());
+	return data[(index > 0) ? index - 1 : 0];
+}
+
+/**
+ * Contrôle des critères de réussite, renvoie false si l'un d'eux n'est pas respecté
+ */
+static bool Check(double sim_s)
+{
+	bool ok = true;
+	double routed = (Energy_Available > 1.0) ? 100.0 * (Energy_Dump - Energy_Available) / Energy_Available : 0.0;
+	double import = (Energy_Dump > 1.0) ? 100.0 * (Energy_Import - Energy_Import_Base) / Energy_Dump : 0.0;
+	double toggles = SSR_Get_Toggle_Count() * 3600.0 / sim_s;
+
+	printf("Routage : %.1f Wh pour %.1f Wh disponibles (%+.1f %%), import dû au routage %.1f %%, "
+			"basculements %.0f /h\n", Energy_Dump, Energy_Available, routed, import, toggles);
+	if ((Options.Routed_Tol >= 0.0) && (fabs(routed) > Options.Routed_Tol))
+	{
+		printf("ECHEC : énergie routée à %+.1f %% du surplus disponible (max %.1f %%)\n", routed, Options.Routed_Tol);
+		ok = false;
+	}
+	if ((Options.Import_Max >= 0.0) && (import > Options.Import_Max))
+	{
+		printf("ECHEC : import dû au routage %.1f %% (max %.1f %%)\n", import, Options.Import_Max);
+		ok = false;
+	}
+	if ((Options.Toggles_Max >= 0.0) && (toggles > Options.Toggles_Max))
+	{
+		printf("ECHEC : %.0f basculements par heure (max %.0f)\n", toggles, Options.Toggles_Max);
+		ok = false;
+	}
+	if (Options.Burst && (Options.Duty_Tol >= 0.0) && (Duty_Count > 0))
+	{
+		double duty = 100.0 * Duty_On / Duty_Count - Duty_Percent / Duty_Count;
+		int32_t dc = (int32_t) (2 * Duty_Positive) - (int32_t) Duty_On;
+		if (fabs(duty) > Options.Duty_Tol)
+		{
+			printf("ECHEC : conduction à %+.2f %% de la consigne (max %.2f %%)\n", duty, Options.Duty_Tol);
+			ok = false;
+		}
+		// La dernière période peut être en cours
+		if (abs(dc) > 1)
+		{
+			printf("ECHEC : composante continue, %d alternances positives en trop\n", dc);
+			ok = false;
+		}
+	}
+	if (CS5490.GetErrorCount() != 0)
+	{
+		printf("ECHEC : erreurs de communication avec le Cirrus\n");
+		ok = false;
+	}
+	return ok;
+}
+
+static void Report(double wall_s)
+{
+	float conso, surplus;
+	double sim_s = Sim_Now_us() / 1e6;
+
+	CS5490.GetEnergy(&conso, &surplus);
+
+	printf("Simulation : %.0f s en %.2f s (x%.0f)\n", sim_s, wall_s, (wall_s > 0) ? sim_s / wall_s : 0.0);
+	printf("Energie PV : %.1f Wh, maison : %.1f Wh, charge : %.1f Wh\n", Energy_PV, Energy_Load, Energy_Dump);
+	printf("Energie importée : %.1f Wh, exportée : %.1f Wh\n", Energy_Import, Energy_Export);
+	printf("Energie Cirrus : consommée %.1f Wh, surplus %.1f Wh\n", conso, surplus);
+
+	float mean = 0.0;
+	for (float t : Settling_ms)
+		mean += t;
+	if (!Settling_ms.empty())
+		mean /= Settling_ms.size();
+	printf("Echelons : %u, stabilisés : %u, interrompus : %u, non stabilisés : %u\n", Step_Count,
+			(unsigned int) Settling_ms.size(), Step_Interrupted, Step_Timeout);
+	printf("Stabilisation (ms) : moyenne %.0f, p95 %.0f, max %.0f\n", mean, Percentile(Settling_ms, 0.95),
+			Percentile(Settling_ms, 1.0));
+	printf("Basculements SSR : %u, conduction triac : %u\n", SSR_Get_Toggle_Count(),
+			Sim_Get_Conduction_Toggles() - Conduction_Start);
+	if (Options.Burst && (Duty_Count > 0))
+		printf("Burst : conduction %.2f %% pour une consigne de %.2f %%, alternances positives %u, négatives %u\n",
+				100.0 * Duty_On / Duty_Count, Duty_Percent / Duty_Count, Duty_Positive, Duty_On - Duty_Positive);
+	printf("Lectures Cirrus : %u, erreurs : %u, mode %s\n", Cirrus_UART.Get_Read_Count(), CS5490.GetErrorCount(),
+			(CS5490.IsDataReadyEvent()) ? "INT" : "polling");
+}
+
+int main(int argc, char *argv[])
+{
+	int opt;
+	unsigned int d, m, y;
+	float voltage = 230.0;
+
+	Options.Scenario = {21, 6, 25, 10 * 3600, 16 * 3600, 1500, 600, 900, 1};
+	Options.Trace = NULL;
+	Options.Output = NULL;
+	Options.Burst = false;
+	Options.Target = 0.0;
+	Options.Dump = 1000.0;
+	Options.Band = 50.0;
+	Options.Window = SSR_BURST_WINDOW;
+	Options.Speed = 0.0;
+	Options.DataReady = false;
+	Options.Verbose = false;
+	Options.Routed_Tol = -1.0;
+	Options.Import_Max = -1.0;
+	Options.Toggles_Max = -1.0;
+	Options.Duty_Tol = -1.0;
+	Options.ZC_Miss = 0;
+
+	while ((opt = getopt(argc, argv, "t:d:s:e:p:n:a:r:m:w:g:P:k:b:u:x:o:iz:vR:I:T:D:h")) != -1)
+	{
+		switch (opt)
+		{
+			case 't': Options.Trace = optarg; break;
+			case 'd':
+				if (sscanf(optarg, "%u/%u/%u", &d, &m, &y) != 3)
+				{
+					Usage();
+					return 2;
+				}
+				Options.Scenario.Day = d;
+				Options.Scenario.Month = m;
+				Options.Scenario.Year = y % 100;
+				break;
+			case 's':
+			case 'e':
+				if (!Parse_HourMinute(optarg, (opt == 's') ? &Options.Scenario.Start_s : &Options.Scenario.End_s))
+				{
+					Usage();
+					return 2;
+				}
+				break;
+			case 'p': Options.Scenario.PV_Peak = atof(optarg); break;
+			case 'n': Options.Scenario.Cloud_Interval_s = atoi(optarg) * 60; break;
+			case 'a': Options.Scenario.Appliance_Interval_s = atoi(optarg) * 60; break;
+			case 'r': Options.Scenario.Seed = strtoul(optarg, NULL, 10); break;
+			case 'm': Options.Burst = (strcmp(optarg, "burst") == 0); break;
+			case 'w': Options.Window = atoi(optarg); break;
+			case 'g': Options.Target = atof(optarg); break;
+			case 'P': Options.Dump = atof(optarg); break;
+			case 'k':
+				sscanf(optarg, "%f,%f,%f,%f", &Options.PID.Kp, &Options.PID.Ki, &Options.PID.Kff, &Options.PID.Band);
+				break;
+			case 'b': Options.Band = atof(optarg); break;
+			case 'u': voltage = atof(optarg); break;
+			case 'x': Options.Speed = atof(optarg); break;
+			case 'o': Options.Output = optarg; break;
+			case 'i': Options.DataReady = true; break;
+			case 'z': Options.ZC_Miss = atoi(optarg); break;
+			case 'v': Options.Verbose = true; break;
+			case 'R': Options.Routed_Tol = atof(optarg); break;
+			case 'I': Options.Import_Max = atof(optarg); break;
+			case 'T': Options.Toggles_Max = atof(optarg); break;
+			case 'D': Options.Duty_Tol = atof(optarg); break;
+			default:
+				Usage();
+				return (opt == 'h') ? 0 : 2;
+		}
+	}
+
+	if (Options.Scenario.End_s <= Options.Scenario.Start_s)
+	{
+		fprintf(stderr, "La fin doit être après le début\n");
+		return 2;
+	}
+	if (!Scenario_Initialize(Options.Scenario, Options.Trace))
+		return 1;
+
+	if (Options.Output != NULL)
+	{
+		Output = fopen(Options.Output, "w");
+		if (Output == NULL)
+		{
+			fprintf(stderr, "Impossible de créer %s\n", Options.Output);
+			return 1;
+		}
+		fprintf(Output, "t;heure;U;P;SSR\n");
+	}
+
+	Sim_Set_Day_Time(Options.Scenario.Start_s);
+	Sim_Set_Voltage(voltage);
+	Sim_Set_Dump(Options.Dump);
+	Sim_Set_Input(Scenario_Input);
+	Sim_Set_HalfPeriod(onHalfPeriod);
+	Sim_Set_ZC_Miss(Options.ZC_Miss);
+
+	if (!Routeur_Initialize())
+		return 1;
+
+	// La mesure commence une fois le routeur initialisé
+	uint64_t end_us = Sim_Now_us() + (uint64_t) (Options.Scenario.End_s - Options.Scenario.Start_s) * 1000000;
+	Energy_PV = Energy_Load = Energy_Dump = Energy_Import = Energy_Export = 0.0;
+	Energy_Available = Energy_Import_Base = 0.0;
+	Step_Count = Step_Interrupted = Step_Timeout = 0;
+	Step_Pending = false;
+	Duty_Count = Duty_On = Duty_Positive = 0;
+	Duty_Percent = 0.0;
+	SSR_Get_Toggle_Count(true);
+	Conduction_Start = Sim_Get_Conduction_Toggles();
+
+	auto wall_start = std::chrono::steady_clock::now();
+	Sim_Set_Speed(Options.Speed);
+	while (Sim_Now_us() < end_us)
+	{
+		if (ZC_Top_Xms())
+			Get_Data();
+		delay(1);
+	}
+	std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wall_start;
+
+	if (Output != NULL)
+		fclose(Output);
+	Report(wall.count());
+	return Check(Sim_Now_us() / 1e6) ? 0 : 1;
+}
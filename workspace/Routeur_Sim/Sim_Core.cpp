@@ -0,0 +1,421 @@
+#include "Sim_Core.h"
+#include "config_lib.h"
+#include "Arduino.h"
+#include "RTCLocal.h"
+#include "Alarm_Minute.h"
+#include <chrono>
+#include <thread>
+
+// Temps simulé en us
+static uint64_t Now_us = 0;
+
+// Temps de réponse à un yield : le temps de la boucle d'attente
+#define YIELD_us	10
+
+// Nombre de pins gérés
+#define SIM_PIN_MAX	64
+
+// Exécution en temps réel accéléré : 0 = au plus vite
+static float Speed = 0.0;
+static std::chrono::steady_clock::time_point Wall_Start;
+static uint64_t Wall_Start_us = 0;
+
+// Heure du jour au temps 0
+static uint32_t Day_Start_s = 0;
+
+// Le réseau
+static float Voltage = 230.0;
+static float Dump_R = 230.0 * 230.0 / 1000.0;
+static Sim_Input_cb Input = NULL;
+static Sim_HalfPeriod_cb HalfPeriod = NULL;
+static Sim_PinWrite_cb PinWrite = NULL;
+
+// La demi-période en cours
+static uint64_t Next_ZC_us = SIM_HALF_PERIOD_us;
+static uint64_t HP_Start_us = 0;
+static float HP_PV = 0.0;
+static float HP_Load = 0.0;
+static bool HP_Fired = false;
+static uint32_t HP_Fire_us = 0;
+static bool HP_Positive = true;
+static bool Last_Conduct = false;
+static uint32_t Conduction_Toggles = 0;
+
+// Zéro-cross manqués : un sur ZC_Miss
+static uint32_t ZC_Miss = 0;
+static uint32_t ZC_Count = 0;
+
+// Les pins
+static uint8_t Pin_State[SIM_PIN_MAX] = {0};
+static void (*Pin_ISR[SIM_PIN_MAX])(void) = {NULL};
+static void (*Pin_ISR_Arg[SIM_PIN_MAX])(void*) = {NULL};
+static void *Pin_Arg[SIM_PIN_MAX] = {NULL};
+static int Pin_Edge[SIM_PIN_MAX] = {0};
+
+// Le timer du SSR
+struct hw_timer_s
+{
+		void (*isr)(void);
+		uint64_t start_us;
+		uint64_t alarm_us;
+		bool armed;
+};
+static hw_timer_s Timer_SSR = {NULL, 0, 0, false};
+
+// Notification de tâche (mode événement DRDY du Cirrus)
+static uint32_t Task_Notify = 0;
+static int Task_Handle = 0;
+static int Semaphore = 0;
+
+RTCLocal RTC_Local;
+Alarm_Minute Alarm;
+
+// ********************************************************************************
+// Réseau et triac
+// ********************************************************************************
+
+/**
+ * Fraction de la puissance pleine onde d'une charge résistive quand le triac est amorcé
+ * à delay_us du zéro-cross : 1 - a/pi + sin(2a)/(2 pi) avec a l'angle d'amorçage
+ */
+float Sim_Conduction_Fraction(uint32_t delay_us)
+{
+	if (delay_us >= SIM_HALF_PERIOD_us)
+		return 0.0;
+	double angle = M_PI * delay_us / SIM_HALF_PERIOD_us;
+	return (float) (1.0 - angle / M_PI + sin(2.0 * angle) / (2.0 * M_PI));
+}
+
+/**
+ * Fin de la demi-période en cours : bilan des puissances
+ */
+static void Close_HalfPeriod(void)
+{
+	Sim_HalfPeriod half;
+
+	half.Start_us = HP_Start_us;
+	half.Voltage = Voltage;
+	half.PV = HP_PV;
+	half.Load = HP_Load;
+	half.Conduct = HP_Fired;
+	half.Positive = HP_Positive;
+	if (HP_Fired)
+		half.Dump = Sim_Conduction_Fraction(HP_Fire_us) * Voltage * Voltage / Dump_R;
+	else
+		half.Dump = 0.0;
+	half.Grid = half.Load + half.Dump - half.PV;
+
+	if (half.Conduct != Last_Conduct)
+		Conduction_Toggles++;
+	Last_Conduct = half.Conduct;
+
+	if (HalfPeriod)
+		HalfPeriod(half);
+}
+
+/**
+ * Zéro-cross : bilan de la demi-période, nouvelles entrées puis interruption ZC
+ */
+static void Zero_Cross(void)
+{
+	Close_HalfPeriod();
+
+	HP_Start_us = Now_us;
+	HP_Positive = !HP_Positive;
+	if (Input)
+		Input(Now_us, &HP_PV, &HP_Load);
+	// En mode burst, le pin est resté à HIGH : conduction pleine onde
+	HP_Fired = (Pin_State[SSR_COMMAND_GPIO] == HIGH);
+	HP_Fire_us = 0;
+
+	ZC_Count++;
+	bool missed = (ZC_Miss != 0) && (ZC_Count % ZC_Miss == 0);
+	if (Pin_ISR[ZERO_CROSS_GPIO] && !missed)
+		Pin_ISR[ZERO_CROSS_GPIO]();
+
+	// Temps réel accéléré
+	if (Speed > 0.0)
+	{
+		std::chrono::microseconds wall((uint64_t) ((Now_us - Wall_Start_us) / Speed));
+		std::this_thread::sleep_until(Wall_Start + wall);
+	}
+}
+
+// ********************************************************************************
+// Temps simulé
+// ********************************************************************************
+
+uint64_t Sim_Now_us(void)
+{
+	return Now_us;
+}
+
+/**
+ * Avance du temps simulé avec exécution des interruptions
+ * L'alarme du timer est exécutée avant le zéro-cross si elle tombe au même instant.
+ */
+void Sim_Advance_us(uint64_t duration_us)
+{
+	uint64_t end = Now_us + duration_us;
+
+	for (;;)
+	{
+		bool timer = Timer_SSR.armed && (Timer_SSR.alarm_us <= Next_ZC_us);
+		uint64_t next = (timer) ? Timer_SSR.alarm_us : Next_ZC_us;
+		if (next > end)
+			break;
+
+		if (next > Now_us)
+			Now_us = next;
+		if (timer)
+		{
+			Timer_SSR.armed = false;
+			if (Timer_SSR.isr)
+				Timer_SSR.isr();
+		}
+		else
+		{
+			Next_ZC_us += SIM_HALF_PERIOD_us;
+			Zero_Cross();
+		}
+	}
+	Now_us = end;
+}
+
+/**
+ * Vitesse d'exécution : factor fois le temps réel, 0 pour aller au plus vite
+ */
+void Sim_Set_Speed(float factor)
+{
+	Speed = factor;
+	Wall_Start = std::chrono::steady_clock::now();
+	Wall_Start_us = Now_us;
+}
+
+void Sim_Set_Day_Time(uint32_t second_of_day)
+{
+	Day_Start_s = second_of_day;
+}
+
+int RTCLocal::getMinuteOfTheDay(void) const
+{
+	return ((Day_Start_s + Now_us / 1000000) / 60) % MINUTESINDAY;
+}
+
+// ********************************************************************************
+// Paramètres
+// ********************************************************************************
+
+void Sim_Set_Voltage(float voltage)
+{
+	Voltage = voltage;
+}
+
+/**
+ * La charge du SSR : résistance de puissance power_230 sous 230 V
+ */
+void Sim_Set_Dump(float power_230)
+{
+	Dump_R = 230.0 * 230.0 / power_230;
+}
+
+void Sim_Set_Input(Sim_Input_cb input)
+{
+	Input = input;
+}
+
+void Sim_Set_HalfPeriod(Sim_HalfPeriod_cb half)
+{
+	HalfPeriod = half;
+}
+
+void Sim_Set_PinWrite(Sim_PinWrite_cb pin_write)
+{
+	PinWrite = pin_write;
+}
+
+void Sim_Set_ZC_Miss(uint32_t every)
+{
+	ZC_Miss = every;
+}
+
+uint32_t Sim_Get_Conduction_Toggles(void)
+{
+	return Conduction_Toggles;
+}
+
+// ********************************************************************************
+// Arduino
+// ********************************************************************************
+
+unsigned long millis(void)
+{
+	return (unsigned long) (Now_us / 1000);
+}
+
+unsigned long micros(void)
+{
+	return (unsigned long) Now_us;
+}
+
+void delay(uint32_t ms)
+{
+	Sim_Advance_us((uint64_t) ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+	Sim_Advance_us(us);
+}
+
+void yield(void)
+{
+	Sim_Advance_us(YIELD_us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	(void) pin;
+	(void) mode;
+}
+
+/**
+ * Le triac est amorcé au premier passage à HIGH du pin SSR dans la demi-période
+ */
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+	if (pin >= SIM_PIN_MAX)
+		return;
+	Pin_State[pin] = val;
+	if ((pin == SSR_COMMAND_GPIO) && (val == HIGH) && !HP_Fired)
+	{
+		HP_Fired = true;
+		HP_Fire_us = (uint32_t) (Now_us - HP_Start_us);
+	}
+	if (PinWrite)
+		PinWrite(pin, val);
+}
+
+int digitalRead(uint8_t pin)
+{
+	return (pin < SIM_PIN_MAX) ? Pin_State[pin] : LOW;
+}
+
+/**
+ * Entrée pilotée par le matériel simulé : interruption sur le front attendu
+ */
+void Sim_Set_Pin(uint8_t pin, uint8_t val)
+{
+	if ((pin >= SIM_PIN_MAX) || (Pin_State[pin] == val))
+		return;
+	Pin_State[pin] = val;
+
+	int edge = (val == HIGH) ? RISING : FALLING;
+	if ((Pin_Edge[pin] != CHANGE) && (Pin_Edge[pin] != edge))
+		return;
+	if (Pin_ISR[pin])
+		Pin_ISR[pin]();
+	if (Pin_ISR_Arg[pin])
+		Pin_ISR_Arg[pin](Pin_Arg[pin]);
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode)
+{
+	if (pin < SIM_PIN_MAX)
+	{
+		Pin_ISR[pin] = isr;
+		Pin_Edge[pin] = mode;
+	}
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void *arg, int mode)
+{
+	if (pin < SIM_PIN_MAX)
+	{
+		Pin_ISR_Arg[pin] = isr;
+		Pin_Arg[pin] = arg;
+		Pin_Edge[pin] = mode;
+	}
+}
+
+void detachInterrupt(uint8_t pin)
+{
+	if (pin < SIM_PIN_MAX)
+	{
+		Pin_ISR[pin] = NULL;
+		Pin_ISR_Arg[pin] = NULL;
+	}
+}
+
+hw_timer_t* timerBegin(uint32_t frequency)
+{
+	// Tick de 1 us seulement
+	return (frequency == 1000000) ? &Timer_SSR : NULL;
+}
+
+void timerAttachInterrupt(hw_timer_t *timer, void (*isr)(void))
+{
+	timer->isr = isr;
+}
+
+void timerRestart(hw_timer_t *timer)
+{
+	timer->start_us = Now_us;
+}
+
+void timerAlarm(hw_timer_t *timer, uint64_t alarm_value, bool autoreload, uint64_t reload_count)
+{
+	(void) autoreload;
+	(void) reload_count;
+	timer->alarm_us = timer->start_us + alarm_value;
+	timer->armed = true;
+}
+
+// ********************************************************************************
+// FreeRTOS
+// ********************************************************************************
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+	return &Semaphore;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+	(void) sem;
+	(void) woken;
+	return pdTRUE;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return &Task_Handle;
+}
+
+/**
+ * Attente d'une notification (donnée par une interruption) avec un timeout en ms
+ */
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout)
+{
+	uint64_t end = Now_us + (uint64_t) timeout * 1000;
+
+	while ((Task_Notify == 0) && (Now_us < end))
+		Sim_Advance_us(YIELD_us);
+
+	uint32_t count = Task_Notify;
+	if (count > 0)
+		Task_Notify = (clear) ? 0 : count - 1;
+	return count;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+	(void) task;
+	(void) woken;
+	Task_Notify++;
+}
+
+void taskYIELD(void)
+{
+	Sim_Advance_us(YIELD_us);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * Noyau de la simulation sur PC du routeur : temps simulé, interruptions et réseau électrique
+ *
+ * Le temps est simulé en us. Il n'avance que lorsque le code attend : delay(), delayMicroseconds(),
+ * yield(), taskYIELD() ou la transmission d'un octet sur l'UART du Cirrus (CS5490_Emul).
+ * Pendant l'avance, les évènements sont exécutés dans l'ordre :
+ * - zéro-cross toutes les 10 ms (50 Hz) : appel de l'interruption attachée au pin ZC (onCirrusZC du SSR),
+ * - alarme du timer SSR (onTimerSSR).
+ *
+ * Le réseau : la tension est fixe (Sim_Set_Voltage), la production PV et la consommation de la maison
+ * sont fournies à chaque demi-période par la fonction Sim_Input_cb.
+ * La charge du SSR est une résistance. Le triac est amorcé quand le pin SSR passe à HIGH et conduit
+ * jusqu'au zéro-cross suivant : la puissance d'une demi-période est calculée à partir de l'angle
+ * d'amorçage réel (pleine onde si le pin est HIGH au zéro-cross, mode burst).
+ * A la fin de chaque demi-période, Sim_HalfPeriod_cb reçoit le bilan (puissance réseau, charge, ...).
+ * Un zéro-cross sur n peut être manqué (Sim_Set_ZC_Miss) : l'interruption n'est pas appelée.
+ */
+
+#include <stdint.h>
+
+// Demi-période à 50 Hz en us
+#define SIM_HALF_PERIOD_us	10000
+
+/**
+ * Bilan d'une demi-période
+ * Grid : puissance réseau, positive en consommation, négative en injection (surplus)
+ */
+typedef struct
+{
+		uint64_t Start_us;
+		float Voltage;
+		float PV;
+		float Load;
+		float Dump;
+		float Grid;
+		bool Conduct;
+		bool Positive;  // Alternance positive
+} Sim_HalfPeriod;
+
+// Production PV et consommation de la maison au temps t (us)
+typedef void (*Sim_Input_cb)(uint64_t time_us, float *pv, float *load);
+typedef void (*Sim_HalfPeriod_cb)(const Sim_HalfPeriod &half);
+typedef void (*Sim_PinWrite_cb)(uint8_t pin, uint8_t val);
+
+// Temps simulé
+uint64_t Sim_Now_us(void);
+void Sim_Advance_us(uint64_t duration_us);
+void Sim_Set_Speed(float factor);
+
+// Heure du jour au démarrage de la simulation (pour RTC_Local)
+void Sim_Set_Day_Time(uint32_t second_of_day);
+
+// Réseau et charge
+void Sim_Set_Voltage(float voltage);
+void Sim_Set_Dump(float power_230);
+void Sim_Set_Input(Sim_Input_cb input);
+void Sim_Set_HalfPeriod(Sim_HalfPeriod_cb half);
+void Sim_Set_PinWrite(Sim_PinWrite_cb pin_write);
+
+// Un zéro-cross sur every n'appelle pas l'interruption, 0 = aucun manqué
+void Sim_Set_ZC_Miss(uint32_t every);
+
+// Niveau d'une entrée pilotée par le matériel simulé (pin INT du Cirrus) : exécute l'interruption attachée
+void Sim_Set_Pin(uint8_t pin, uint8_t val);
+
+// Nombre de passages conduction <-> pas de conduction du triac (par demi-période)
+uint32_t Sim_Get_Conduction_Toggles(void);
+
+// Fraction de la puissance pleine onde pour un amorçage à delay_us du zéro-cross
+float Sim_Conduction_Fraction(uint32_t delay_us);
@@ -0,0 +1,261 @@
+#include "Sim_Scenario.h"
+#include "Emul_PV.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Site par défaut : Emul_PV::Init_From_IniData
+#define SITE_LATITUDE	43.49333333
+#define SITE_LONGITUDE	-6.36166666
+#define SITE_ALTITUDE	209
+#define SITE_ORIENTATION	0
+#define SITE_INCLINAISON	30
+
+// Consommation de fond et réfrigérateur
+#define BASE_LOAD	200.0
+#define FRIDGE_LOAD	100.0
+#define FRIDGE_PERIOD_s	1800
+#define FRIDGE_ON_s	600
+
+typedef struct
+{
+		const char *Name;
+		float Power;
+		uint16_t Min_s;
+		uint16_t Max_s;
+} Appliance_Def;
+
+static const Appliance_Def Appliances[] = {
+		{"Bouilloire", 2200, 120, 240},
+		{"Micro-ondes", 1100, 60, 300},
+		{"Lave-linge chauffe", 2000, 600, 1200},
+		{"Four", 2500, 900, 2700},
+		{"Aspirateur", 700, 300, 1200}};
+#define APPLIANCE_COUNT	(sizeof(Appliances) / sizeof(Appliance_Def))
+
+typedef struct
+{
+		uint32_t Start_s;
+		uint32_t End_s;
+		float Value;  // Atténuation du PV ou puissance de l'appareil
+} Sim_Event;
+
+typedef struct
+{
+		uint32_t Time_s;
+		float PV;
+		float Load;
+} Trace_Row;
+
+static EmulPV_Class Emul_PV;
+static Sim_Scenario_Params Params;
+static std::vector<Sim_Event> Clouds;
+static std::vector<Sim_Event> Loads;
+static std::vector<Trace_Row> Trace;
+static size_t Trace_Index = 0;
+
+// ********************************************************************************
+// Tirages aléatoires reproductibles (xorshift32)
+// ********************************************************************************
+
+static uint32_t Random_State = 1;
+
+static uint32_t Random_Next(void)
+{
+	uint32_t x = Random_State;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	Random_State = x;
+	return x;
+}
+
+static float Random_Uniform(float min, float max)
+{
+	return min + (max - min) * (Random_Next() / 4294967296.0);
+}
+
+// Intervalle aléatoire de moyenne mean_s (loi exponentielle)
+static uint32_t Random_Interval(uint32_t mean_s)
+{
+	float u = Random_Uniform(1e-6, 1.0);
+	return 1 + (uint32_t) (-log(u) * mean_s);
+}
+
+// ********************************************************************************
+// Trace enregistrée
+// ********************************************************************************
+
+// Heure en s depuis minuit : "36000" ou "10:00:00"
+static bool Parse_Time(const char *str, uint32_t *time_s)
+{
+	unsigned int h, m, s = 0;
+	if (sscanf(str, "%u:%u:%u", &h, &m, &s) >= 2)
+	{
+		*time_s = h * 3600 + m * 60 + s;
+		return true;
+	}
+	char *end;
+	double t = strtod(str, &end);
+	if (end == str)
+		return false;
+	*time_s = (uint32_t) t;
+	return true;
+}
+
+static bool Load_Trace(const char *trace_file)
+{
+	FILE *file = fopen(trace_file, "r");
+	if (file == NULL)
+	{
+		fprintf(stderr, "Trace %s introuvable\n", trace_file);
+		return false;
+	}
+
+	char line[256];
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		char *fields[3] = {line, NULL, NULL};
+		int count = 1;
+		for (char *c = line; (*c != 0) && (*c != '\n') && (*c != '\r'); c++)
+		{
+			if ((*c == ';') || (*c == ',') || (*c == '\t'))
+			{
+				*c = 0;
+				if (count < 3)
+					fields[count++] = c + 1;
+			}
+		}
+		line[strcspn(line, "\r\n")] = 0;
+		if (count < 3)
+			continue;
+		fields[2][strcspn(fields[2], "\r\n")] = 0;
+
+		Trace_Row row;
+		// Les lignes d'en-tête ou de commentaire sont ignorées
+		if ((line[0] == '#') || !Parse_Time(fields[0], &row.Time_s))
+			continue;
+		row.PV = (fields[1][0] == 0) ? -1.0 : atof(fields[1]);
+		row.Load = atof(fields[2]);
+		Trace.push_back(row);
+	}
+	fclose(file);
+
+	if (Trace.empty())
+	{
+		fprintf(stderr, "Trace %s vide\n", trace_file);
+		return false;
+	}
+	return true;
+}
+
+// ********************************************************************************
+// Scénario
+// ********************************************************************************
+
+static void Generate_Events(std::vector<Sim_Event> &events, uint32_t mean_s, bool cloud)
+{
+	uint32_t time = Params.Start_s;
+
+	if (mean_s == 0)
+		return;
+	for (;;)
+	{
+		time += Random_Interval(mean_s);
+		if (time >= Params.End_s)
+			break;
+
+		Sim_Event event;
+		event.Start_s = time;
+		if (cloud)
+		{
+			event.End_s = time + (uint32_t) Random_Uniform(10, 180);
+			event.Value = Random_Uniform(0.2, 0.7);
+		}
+		else
+		{
+			const Appliance_Def &app = Appliances[Random_Next() % APPLIANCE_COUNT];
+			event.End_s = time + (uint32_t) Random_Uniform(app.Min_s, app.Max_s);
+			event.Value = app.Power;
+		}
+		events.push_back(event);
+	}
+}
+
+bool Scenario_Initialize(const Sim_Scenario_Params &params, const char *trace_file)
+{
+	PVSite_Struct site;
+
+	Params = params;
+	Random_State = (params.Seed != 0) ? params.Seed : 1;
+
+	site.latitude = SITE_LATITUDE;
+	site.longitude = SITE_LONGITUDE;
+	site.altitude = SITE_ALTITUDE;
+	site.orientation = SITE_ORIENTATION;
+	site.inclinaison = SITE_INCLINAISON;
+	site.PV_puissance = params.PV_Peak;
+	site.Mask_Matin = 0;
+	site.Mask_Soir = 0;
+	site.PV_Coeff_Puissance = -0.41;
+	site.PV_Noct = 44;
+	site.Ond_PowerACMax = params.PV_Peak;
+	site.Ond_Rendement = 95.7;
+	Emul_PV.Init_From_Array(site);
+	// Heure d'été approximative : d'avril à octobre
+	Emul_PV.setSummerTime((params.Month > 3) && (params.Month < 11));
+	Emul_PV.setDateTime(params.Day, params.Month, params.Year);
+
+	Clouds.clear();
+	Loads.clear();
+	Trace.clear();
+	Trace_Index = 0;
+	if ((trace_file != NULL) && !Load_Trace(trace_file))
+		return false;
+	if (trace_file == NULL)
+	{
+		Generate_Events(Clouds, params.Cloud_Interval_s, true);
+		Generate_Events(Loads, params.Appliance_Interval_s, false);
+	}
+	return true;
+}
+
+/**
+ * Production PV et consommation à l'instant time_us du temps simulé
+ */
+void Scenario_Input(uint64_t time_us, float *pv, float *load)
+{
+	uint32_t now_s = Params.Start_s + (uint32_t) (time_us / 1000000);
+	float pv_th = Emul_PV.Compute_Power_TH(now_s);
+
+	if (!Trace.empty())
+	{
+		while ((Trace_Index + 1 < Trace.size()) && (Trace[Trace_Index + 1].Time_s <= now_s))
+			Trace_Index++;
+		const Trace_Row &row = Trace[Trace_Index];
+		*pv = (row.PV < 0.0) ? pv_th : row.PV;
+		*load = row.Load;
+		return;
+	}
+
+	*pv = pv_th;
+	for (const Sim_Event &cloud : Clouds)
+	{
+		if (cloud.Start_s > now_s)
+			break;
+		if (now_s < cloud.End_s)
+			*pv *= 1.0 - cloud.Value;
+	}
+
+	*load = BASE_LOAD;
+	if ((now_s % FRIDGE_PERIOD_s) < FRIDGE_ON_s)
+		*load += FRIDGE_LOAD;
+	for (const Sim_Event &app : Loads)
+	{
+		if (app.Start_s > now_s)
+			break;
+		if (now_s < app.End_s)
+			*load += app.Value;
+	}
+}
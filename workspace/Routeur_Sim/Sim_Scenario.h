@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * Scénario de la simulation : production PV et consommation de la maison
+ *
+ * - Production PV : puissance théorique d'Emul_PV (Compute_Power_TH) pour le jour et le site,
+ * avec des passages nuageux aléatoires (atténuation brusque de 20 à 70% pendant 10 s à 3 min).
+ * - Consommation : un fond de 200 W, un réfrigérateur (100 W, 10 min toutes les 30 min) et des appareils
+ * aléatoires (bouilloire, micro-ondes, lave-linge, four, ...).
+ * - Ou une trace enregistrée : fichier csv "heure;PV;maison" (heure en s depuis minuit ou hh:mm:ss,
+ * puissances en W, séparateur ';', ',' ou tabulation). Si la colonne PV est vide ou négative,
+ * on utilise Emul_PV. La valeur est gardée jusqu'à la ligne suivante.
+ *
+ * Les tirages aléatoires dépendent seulement de la graine : un scénario est reproductible.
+ */
+
+#include <stdint.h>
+
+typedef struct
+{
+		uint8_t Day, Month, Year;  // Année sur deux chiffres
+		uint32_t Start_s;          // Début de la simulation, en s depuis minuit (heure légale)
+		uint32_t End_s;
+		float PV_Peak;             // Puissance crête Wc
+		uint32_t Cloud_Interval_s; // Intervalle moyen entre deux nuages, 0 pour un ciel clair
+		uint32_t Appliance_Interval_s;  // Intervalle moyen entre deux appareils, 0 pour aucun
+		uint32_t Seed;
+} Sim_Scenario_Params;
+
+bool Scenario_Initialize(const Sim_Scenario_Params &params, const char *trace_file);
+void Scenario_Input(uint64_t time_us, float *pv, float *load);
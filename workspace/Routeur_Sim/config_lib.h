@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * Config file of the host simulation (see config_lib.h of Routeur_CS5490)
+ * Only the define used by the CIRRUS, SSR and Emul_PV libraries.
+ * The GPIO are simulated (see Sim_Core.cpp).
+ */
+
+/**********************************************************
+ * Cirrus define
+ **********************************************************/
+#define CIRRUS_RESET_GPIO	14
+#define CIRRUS_RX_GPIO	16
+#define CIRRUS_TX_GPIO	17
+#define CIRRUS_INT_GPIO	13  // Pin INT simulée, mode événement avec l'option -i
+
+#define CIRRUS_USE_UART // If not defined then SPI is used
+#ifdef CIRRUS_USE_UART
+#define CIRRUS_UART_BAUD	512000
+#endif
+
+#define CIRRUS_RMS_FULL  // To have U, I and P RMS. Otherwise only U and P RMS
+
+/**********************************************************
+ * SSR define
+ **********************************************************/
+#define USE_SSR
+#define ZERO_CROSS_GPIO	12
+#define ZERO_CROSS_TOP_Xms	20	// Allow to have a top 200 ms created by the zero cross (10 * X ms)
+#define SSR_COMMAND_GPIO	15
+#define SSR_LED_GPIO	-1
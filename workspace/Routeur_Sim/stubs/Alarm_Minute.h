@@ -0,0 +1,33 @@
+#pragma once
+
+/**
+ * Alarm_Minute minimal pour la simulation : le boost avec alarme du SSR n'est pas simulé,
+ * les alarmes sont acceptées mais jamais déclenchées.
+ */
+
+#include "Arduino.h"
+
+// Number of minutes in a day
+#define MINUTESINDAY	1440
+
+typedef void (*AlarmFunction_t)(size_t idAlarm, bool state, int param);
+
+class Alarm_Minute
+{
+	public:
+		int add_one(int end, const AlarmFunction_t &pAlarmAction, int param, bool updateTimeList = true)
+		{
+			(void) end;
+			(void) pAlarmAction;
+			(void) param;
+			(void) updateTimeList;
+			return 0;
+		}
+		void deleteAlarm(size_t idAlarm, bool updateTimeList = true)
+		{
+			(void) idAlarm;
+			(void) updateTimeList;
+		}
+};
+
+extern Alarm_Minute Alarm;
@@ -0,0 +1,319 @@
+#pragma once
+
+/**
+ * Arduino/ESP32 minimal pour la simulation sur PC (voir Sim_Core.h)
+ * Seulement ce qui est utilisé par les librairies SSR, CIRRUS, Emul_PV et TeleInfo.
+ * Le temps (millis, micros, delay) est le temps simulé : un delay() fait avancer la simulation
+ * et exécute les interruptions (zéro-cross, timer SSR) qui tombent pendant l'attente.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#ifndef ESP32
+#define ESP32
+#endif
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION	ESP_IDF_VERSION_VAL(5, 1, 0)  // Comme le core ESP32 3.x
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define F(string_literal)	(string_literal)
+
+#define LOW	0
+#define HIGH	1
+#define INPUT	0x01
+#define OUTPUT	0x03
+#define INPUT_PULLUP	0x05
+#define RISING	0x01
+#define FALLING	0x02
+#define CHANGE	0x03
+
+#define PI	3.1415926535897932384626433832795
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// ********************************************************************************
+// Temps et GPIO (Sim_Core.cpp)
+// ********************************************************************************
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+#define digitalPinToInterrupt(p)	(p)
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// Timer ESP32 3.x : un seul timer, celui du SSR
+typedef struct hw_timer_s hw_timer_t;
+hw_timer_t* timerBegin(uint32_t frequency);
+void timerAttachInterrupt(hw_timer_t *timer, void (*isr)(void));
+void timerRestart(hw_timer_t *timer);
+void timerAlarm(hw_timer_t *timer, uint64_t alarm_value, bool autoreload, uint64_t reload_count);
+
+// Led PWM : sans effet
+inline bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution)
+{
+	(void) pin;
+	(void) freq;
+	(void) resolution;
+	return true;
+}
+inline bool ledcWrite(uint8_t pin, uint32_t duty)
+{
+	(void) pin;
+	(void) duty;
+	return true;
+}
+
+// ********************************************************************************
+// FreeRTOS : une seule tâche, la simulation
+// ********************************************************************************
+
+typedef void* SemaphoreHandle_t;
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+typedef int portMUX_TYPE;
+
+#define pdTRUE	1
+#define pdFALSE	0
+#define pdMS_TO_TICKS(ms)	((TickType_t) (ms))
+#define portMUX_INITIALIZER_UNLOCKED	0
+#define portENTER_CRITICAL_ISR(mux)	(void) (mux)
+#define portEXIT_CRITICAL_ISR(mux)	(void) (mux)
+#define portENTER_CRITICAL(mux)	(void) (mux)
+#define portEXIT_CRITICAL(mux)	(void) (mux)
+#define portYIELD_FROM_ISR(...)	do {} while (0)
+
+#define portMAX_DELAY	((TickType_t) 0xFFFFFFFF)
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+
+// Mutex récursif (IniFiles) : sans effet avec une seule tâche
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+	static int mutex;
+	return &mutex;
+}
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t timeout)
+{
+	(void) sem;
+	(void) timeout;
+	return pdTRUE;
+}
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+	(void) sem;
+	return pdTRUE;
+}
+inline void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+	(void) sem;
+}
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t timeout);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+void taskYIELD(void);
+
+// ********************************************************************************
+// String
+// ********************************************************************************
+
+class String: public std::string
+{
+	public:
+		String()
+		{
+		}
+		String(const char *s) :
+				std::string((s) ? s : "")
+		{
+		}
+		String(const std::string &s) :
+				std::string(s)
+		{
+		}
+		explicit String(char c) :
+				std::string(1, c)
+		{
+		}
+		String(int val) :
+				std::string(std::to_string(val))
+		{
+		}
+		String(unsigned int val) :
+				std::string(std::to_string(val))
+		{
+		}
+		String(long val) :
+				std::string(std::to_string(val))
+		{
+		}
+		String(unsigned long val) :
+				std::string(std::to_string(val))
+		{
+		}
+		String(double val, unsigned int decimal = 2)
+		{
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "%.*f", decimal, val);
+			assign(buffer);
+		}
+
+		const char* c_str() const
+		{
+			return std::string::c_str();
+		}
+		unsigned int length() const
+		{
+			return size();
+		}
+		bool isEmpty() const
+		{
+			return empty();
+		}
+		float toFloat() const
+		{
+			return atof(c_str());
+		}
+		long toInt() const
+		{
+			return atol(c_str());
+		}
+		String substring(unsigned int from) const
+		{
+			return String(substr(from));
+		}
+		String substring(unsigned int from, unsigned int to) const
+		{
+			return String(substr(from, to - from));
+		}
+		int indexOf(char c, unsigned int from = 0) const
+		{
+			size_t pos = find(c, from);
+			return (pos == npos) ? -1 : (int) pos;
+		}
+};
+
+inline String operator+(const String &a, const String &b)
+{
+	return String(static_cast<const std::string&>(a) + static_cast<const std::string&>(b));
+}
+inline String operator+(const String &a, const char *b)
+{
+	return a + String(b);
+}
+inline String operator+(const char *a, const String &b)
+{
+	return String(a) + b;
+}
+
+// ********************************************************************************
+// UART : la liaison avec le Cirrus est émulée (CS5490_Emul)
+// Les ports créés par les librairies (TeleInfo : HardwareSerial(1)) lisent la ligne
+// branchée par le test avec Sim_Serial_Port(), à la vitesse du port
+// ********************************************************************************
+
+#define SERIAL_8N1	0x800001c
+
+class Sim_Serial_Line
+{
+	public:
+		virtual ~Sim_Serial_Line()
+		{
+		}
+		virtual int available(unsigned long baud) = 0;
+		virtual int read(unsigned long baud) = 0;
+};
+
+// La ligne branchée sur l'UART uart_nr (0 à 2), NULL par défaut
+inline Sim_Serial_Line*& Sim_Serial_Port(uint8_t uart_nr)
+{
+	static Sim_Serial_Line *ports[3] = {NULL, NULL, NULL};
+	return ports[uart_nr % 3];
+}
+
+class HardwareSerial
+{
+	public:
+		HardwareSerial(int8_t uart_nr = -1) :
+				_uart_nr(uart_nr)
+		{
+		}
+		virtual ~HardwareSerial()
+		{
+		}
+		virtual void begin(unsigned long baud)
+		{
+			_baud = baud;
+		}
+		void begin(unsigned long baud, uint32_t config, int8_t rx, int8_t tx = -1)
+		{
+			(void) config;
+			setPins(rx, tx);
+			begin(baud);
+		}
+		virtual void updateBaudRate(unsigned long baud)
+		{
+			_baud = baud;
+		}
+		void setPins(int8_t rx, int8_t tx)
+		{
+			(void) rx;
+			(void) tx;
+		}
+		virtual int available(void)
+		{
+			Sim_Serial_Line *line = (_uart_nr >= 0) ? Sim_Serial_Port(_uart_nr) : NULL;
+			return (line) ? line->available(_baud) : 0;
+		}
+		virtual int read(void)
+		{
+			Sim_Serial_Line *line = (_uart_nr >= 0) ? Sim_Serial_Port(_uart_nr) : NULL;
+			return (line) ? line->read(_baud) : -1;
+		}
+		virtual size_t write(uint8_t c)
+		{
+			(void) c;
+			return 1;
+		}
+		virtual size_t write(const uint8_t *buffer, size_t size)
+		{
+			for (size_t i = 0; i < size; i++)
+				write(buffer[i]);
+			return size;
+		}
+		size_t readBytes(uint8_t *buffer, size_t length)
+		{
+			size_t count = 0;
+			while (count < length)
+			{
+				int c = read();
+				if (c < 0)
+					break;
+				buffer[count++] = (uint8_t) c;
+			}
+			return count;
+		}
+
+	protected:
+		int8_t _uart_nr;
+		unsigned long _baud = 0;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * Fichiers sur le disque du PC pour la simulation (profil d'horizon, cache de prévision d'Emul_PV)
+ * et les tests (IniFiles, Line_Reader). Les chemins sont relatifs au répertoire courant.
+ * Set_Max_Read() limite la taille d'une lecture : lectures partielles comme en fin de bloc LittleFS.
+ */
+
+#include "Arduino.h"
+
+class File
+{
+	public:
+		File(FILE *file = NULL) :
+				_file(file)
+		{
+		}
+		explicit operator bool() const
+		{
+			return (_file != NULL);
+		}
+		size_t read(uint8_t *buffer, size_t size)
+		{
+			if ((_max_read != 0) && (size > _max_read))
+				size = _max_read;
+			return fread(buffer, 1, size, _file);
+		}
+		size_t write(const uint8_t *buffer, size_t size)
+		{
+			return fwrite(buffer, 1, size, _file);
+		}
+		size_t print(const char *str)
+		{
+			return fwrite(str, 1, strlen(str), _file);
+		}
+		bool seek(uint32_t pos)
+		{
+			return (fseek(_file, pos, SEEK_SET) == 0);
+		}
+		size_t position(void) const
+		{
+			return ftell(_file);
+		}
+		size_t size(void) const
+		{
+			long pos = ftell(_file);
+			fseek(_file, 0, SEEK_END);
+			long size = ftell(_file);
+			fseek(_file, pos, SEEK_SET);
+			return size;
+		}
+		void Set_Max_Read(size_t max_read)
+		{
+			_max_read = max_read;
+		}
+		void close(void)
+		{
+			if (_file != NULL)
+				fclose(_file);
+			_file = NULL;
+		}
+
+	private:
+		FILE *_file;
+		size_t _max_read = 0;
+};
+
+namespace fs
+{
+class FS
+{
+	public:
+		File open(const char *path, const char *mode)
+		{
+			const char *lmode = (mode[0] == 'w') ? "wb" : ((strcmp(mode, "r+") == 0) ? "r+b" : "rb");
+			return File(fopen(local(path).c_str(), lmode));
+		}
+		bool exists(const char *path)
+		{
+			FILE *file = fopen(local(path).c_str(), "rb");
+			if (file != NULL)
+				fclose(file);
+			return (file != NULL);
+		}
+
+	private:
+		std::string local(const char *path)
+		{
+			return (path[0] == '/') ? std::string(".") + path : std::string(path);
+		}
+};
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+/**
+ * HardwareSerial pour la simulation : la classe est dans Arduino.h (voir Sim_Serial_Port())
+ */
+
+#include "Arduino.h"
@@ -0,0 +1,46 @@
+#pragma once
+
+/**
+ * IniFiles minimal pour la simulation : Emul_PV est initialisé par Init_From_Array(),
+ * les fonctions ini ne lisent rien et renvoient les valeurs par défaut.
+ */
+
+#include "Arduino.h"
+
+class IniFiles
+{
+	public:
+		IniFiles(const char *file = NULL)
+		{
+			(void) file;
+		}
+		bool Begin(bool create = false)
+		{
+			(void) create;
+			return false;
+		}
+		float ReadFloat(const char *section, const char *key, float def)
+		{
+			(void) section;
+			(void) key;
+			return def;
+		}
+		char* ReadString(const char *section, const char *key, const char *def)
+		{
+			(void) section;
+			(void) key;
+			// Comme IniFiles : copie à libérer par l'appelant
+			return strdup(def);
+		}
+		void WriteFloat(const char *section, const char *key, float val, const char *comment = "")
+		{
+			(void) section;
+			(void) key;
+			(void) val;
+			(void) comment;
+		}
+		void SaveFile(const char *header)
+		{
+			(void) header;
+		}
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * Partition data minimale pour la simulation (voir FS.h)
+ */
+
+#include "FS.h"
+
+extern fs::FS *Data_Partition;
+extern fs::FS *FS_Partition;
+extern volatile bool Lock_File;
@@ -0,0 +1,16 @@
+#pragma once
+
+/**
+ * RTCLocal minimal pour la simulation : l'heure du jour est le temps simulé
+ * (voir Sim_Set_Day_Time() de Sim_Core.h)
+ */
+
+#include "Arduino.h"
+
+class RTCLocal
+{
+	public:
+		int getMinuteOfTheDay(void) const;
+};
+
+extern RTCLocal RTC_Local;
@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * Wire (I2C) pour les tests sur PC : chaque transmission est comptée puis passée au composant
+ * branché à l'adresse par le test avec Sim_I2C_Device() (émulation de l'écran SSD1327, ...)
+ * La taille du buffer est celle du core ESP32.
+ */
+
+#include "Arduino.h"
+
+#define I2C_BUFFER_LENGTH	128
+
+class Sim_I2C_Slave
+{
+	public:
+		virtual ~Sim_I2C_Slave()
+		{
+		}
+		virtual void receive(const uint8_t *data, size_t size) = 0;
+};
+
+// Le composant branché à l'adresse (7 bits), NULL par défaut
+inline Sim_I2C_Slave*& Sim_I2C_Device(uint8_t address)
+{
+	static Sim_I2C_Slave *devices[128] = {NULL};
+	return devices[address & 0x7F];
+}
+
+class TwoWire
+{
+	public:
+		uint32_t Transmissions = 0;  // Nombre de transmissions
+		uint32_t Bytes = 0;  // Octets transmis, sans l'adresse
+
+		bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0)
+		{
+			(void) sda;
+			(void) scl;
+			(void) frequency;
+			return true;
+		}
+		void setClock(uint32_t frequency)
+		{
+			(void) frequency;
+		}
+		void beginTransmission(uint16_t address)
+		{
+			_address = address;
+			_count = 0;
+		}
+		size_t write(uint8_t data)
+		{
+			if (_count >= I2C_BUFFER_LENGTH)
+				return 0;
+			_buffer[_count++] = data;
+			return 1;
+		}
+		size_t write(const uint8_t *data, size_t size)
+		{
+			for (size_t i = 0; i < size; i++)
+				if (write(data[i]) == 0)
+					return i;
+			return size;
+		}
+		// 0 : ok, 2 : pas de composant à l'adresse (NACK)
+		uint8_t endTransmission(bool stop = true)
+		{
+			(void) stop;
+			Sim_I2C_Slave *device = Sim_I2C_Device(_address);
+			if (device == NULL)
+				return 2;
+			Transmissions++;
+			Bytes += _count;
+			device->receive(_buffer, _count);
+			return 0;
+		}
+
+	private:
+		uint16_t _address = 0;
+		uint8_t _buffer[I2C_BUFFER_LENGTH];
+		size_t _count = 0;
+};
+
+// Une seule instance pour tout le programme (C++14 : pas de variable inline)
+inline TwoWire& Sim_Wire(void)
+{
+	static TwoWire wire;
+	return wire;
+}
+#define Wire	Sim_Wire()
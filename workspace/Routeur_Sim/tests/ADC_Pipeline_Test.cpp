@@ -0,0 +1,172 @@
+/**
+ * Test d'ADC_Pipeline (Library/ADC_utils) : courant RMS et puissance des pinces par trames
+ *
+ * Trois pinces avec des amplitudes, des phases et des zéros différents, échantillonnées à
+ * 128 points par période (6400 Hz), un bruit de ±1 LSB (d'où une tolérance absolue en plus des 0,2 %). Les zéro-cross de la tension arrivent
+ * toutes les demi-périodes sous forme d'index d'échantillon, avec des trames de taille aléatoire.
+ * - Courant (moyenne des carrés) et puissance (produit avec le sinus de référence) comparés
+ * aux valeurs analytiques : A² / 2 et A * ADC_PIPELINE_SINUS * cos(phi) / √2.
+ * - 400 échantillons sans zéro-cross : la synchronisation est perdue puis reprise au zéro-cross
+ * suivant. La demi-période interrompue est abandonnée, le résultat suivant est exact.
+ * - Un lecteur dans un autre thread : les résultats des pinces viennent toujours de la même
+ * publication (le rapport des courants entre les pinces reste celui des amplitudes, alors que
+ * la charge change toutes les 16 périodes).
+ */
+#include "ADC_Pipeline.h"
+#include <stdio.h>
+#include <math.h>
+#include <random>
+#include <thread>
+#include <atomic>
+
+#define PERIOD	128
+#define NB_CLAMP	3
+#define SAMPLE_COUNT	2000000
+#define GAP_START	1000000  // Pas de zéro-cross pendant GAP_LENGTH échantillons
+#define GAP_LENGTH	400
+#define TOLERANCE	0.002
+
+static const int16_t Zero[NB_CLAMP] = {2048, 1990, 2110};
+static const float Amplitude[NB_CLAMP] = {1500.0, 600.0, 250.0};
+static const float Phase[NB_CLAMP] = {0.0, 0.6, -1.2};  // Déphasage du courant (rad)
+
+static ADC_Pipeline Pipe;
+static std::mt19937 Random(1234);
+static std::atomic<bool> Done = {false};
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+// La charge change toutes les 16 périodes, au zéro-cross et pour toutes les pinces en même temps
+static float Load(uint32_t index)
+{
+	return 0.4 + 0.6 * ((index / (16 * PERIOD)) % 5) / 4.0;
+}
+
+static int16_t Sample(uint8_t clamp, uint32_t index)
+{
+	float angle = 2.0 * M_PI * (index % PERIOD) / PERIOD - Phase[clamp];
+	int noise = (int) (Random() % 3) - 1;
+	return (int16_t) lround(Zero[clamp] + Load(index) * Amplitude[clamp] * sin(angle)) + noise;
+}
+
+// Tolérance relative plus l'effet du bruit sur 5 demi-périodes (4 écarts types)
+static bool Near(float value, float expected, float noise)
+{
+	return fabs(value - expected) <= TOLERANCE * fabs(expected) + noise;
+}
+
+// Le lecteur : les courants des pinces gardent le rapport des amplitudes
+static void Reader(uint32_t *reads, uint32_t *torn)
+{
+	uint32_t loop = 0;
+	while (!Done)
+	{
+		if (Pipe.results.GetCount() > 0)
+		{
+			ADC_Pipeline_Results results = Pipe.results.Get();
+			float ratio = sqrt((float) results.clamp[1].current_raw / results.clamp[0].current_raw);
+			if (fabs(ratio - Amplitude[1] / Amplitude[0]) > 0.01)
+				(*torn)++;
+			(*reads)++;
+		}
+		if ((++loop & 0x3F) == 0)
+			std::this_thread::yield();
+	}
+}
+
+int main(void)
+{
+	static int16_t frame[NB_CLAMP][300];
+	const int16_t *samples[NB_CLAMP] = {frame[0], frame[1], frame[2]};
+	uint32_t reads = 0, torn = 0;
+	uint32_t checked = 0, wrong = 0;
+	uint32_t last_count = 0;
+	uint32_t index = 0;
+	uint32_t next_zc = 0;
+	uint32_t resync_count = 0;
+	bool lost_sync = false;
+
+	Check(ADC_Pipeline_Init(&Pipe, NB_CLAMP, Zero, PERIOD), "initialisation");
+	Check(!ADC_Pipeline_Init(&Pipe, ADC_MAX_CLAMP + 1, Zero, PERIOD), "trop de pinces refusé");
+	Check(ADC_Pipeline_Init(&Pipe, NB_CLAMP, Zero, PERIOD), "nouvelle initialisation");
+
+	std::thread reader(Reader, &reads, &torn);
+
+	while (index < SAMPLE_COUNT)
+	{
+		uint16_t count = 1 + Random() % 300;
+		uint32_t zc_index[8];
+		uint8_t zc_count = 0;
+
+		for (uint16_t i = 0; i < count; i++)
+			for (uint8_t c = 0; c < NB_CLAMP; c++)
+				frame[c][i] = Sample(c, index + i);
+
+		// Les zéro-cross montants et descendants de la trame, sauf pendant le trou
+		while ((next_zc < index + count) && (zc_count < 8))
+		{
+			if ((next_zc < GAP_START) || (next_zc >= GAP_START + GAP_LENGTH))
+				zc_index[zc_count++] = next_zc;
+			next_zc += PERIOD / 2;
+		}
+		ADC_Pipeline_Process(&Pipe, samples, count, zc_index, zc_count);
+		index += count;
+
+		if ((index > GAP_START) && !Pipe.synchronised)
+			lost_sync = true;
+
+		// Un nouveau résultat : on vérifie ceux dont les 5 demi-périodes ont la même charge
+		uint32_t publication = Pipe.results.GetCount();
+		if (publication == last_count)
+			continue;
+		last_count = publication;
+		if (lost_sync && (index > GAP_START + GAP_LENGTH))
+			resync_count++;
+		// Les résultats juste après le trou sont vérifiés aussi : la demi-période interrompue est abandonnée
+		uint32_t window_start = index - count - 6 * PERIOD / 2;
+		if ((index > GAP_START) && (window_start < GAP_START + GAP_LENGTH))
+			window_start -= GAP_LENGTH;
+		if (Load(window_start) != Load(index))
+			continue;
+
+		checked++;
+		for (uint8_t c = 0; c < NB_CLAMP; c++)
+		{
+			ADC_Clamp_Result result;
+			float a = Load(index) * Amplitude[c];
+			ADC_Pipeline_Get(&Pipe, c, &result);
+			if (!Near(result.current_raw, a * a / 2, 0.3 * a)
+					|| !Near(result.power_raw, a * ADC_PIPELINE_SINUS * cos(Phase[c]) / M_SQRT2, 0.2 * ADC_PIPELINE_SINUS))
+			{
+				if (wrong++ < 5)
+					printf("  pince %u à l'échantillon %u : courant %d au lieu de %.0f, puissance %d au lieu de %.0f\n", c,
+							index, result.current_raw, a * a / 2, result.power_raw,
+							a * ADC_PIPELINE_SINUS * cos(Phase[c]) / M_SQRT2);
+			}
+		}
+	}
+	Done = true;
+	reader.join();
+
+	printf("ADC_Pipeline : %u publications, %u vérifiées, %u lectures concurrentes\n", last_count, checked, reads);
+	Check(checked > 1000, "résultats publiés");
+	Check(wrong == 0, "courant et puissance à 0,2 % des valeurs analytiques");
+	Check(lost_sync, "synchronisation perdue sans zéro-cross");
+	Check(resync_count > 1000, "synchronisation reprise au zéro-cross suivant");
+	Check(torn == 0, "lecteur : résultats de publications différentes");
+
+	ADC_Clamp_Result result;
+	Check(!ADC_Pipeline_Get(&Pipe, NB_CLAMP, &result), "pince inexistante");
+
+	if (Errors == 0)
+		printf("ADC_Pipeline : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+/**
+ * Test de la lecture en rafale des registres du Cirrus (CIRRUS_Base::read_registers et get_data_multi)
+ *
+ * La liaison série est l'émulation du CS5490 (CS5490_Emul) espionnée : on vérifie les octets émis
+ * (sélection de page seulement si elle change, effacement de DRDY dans la même transaction,
+ * les N commandes de lecture) et le nombre d'octets de réponse lus (3 par registre).
+ * Les valeurs décodées d'un lot sur deux pages sont comparées à celles des lectures une par une.
+ */
+#include "Arduino.h"
+#include "config_lib.h"
+#include "CIRRUS.h"
+#include "CS5490_Emul.h"
+#include "Sim_Core.h"
+#include <stdio.h>
+#include <vector>
+
+// La liaison série espionnée
+class Spy_UART: public CS5490_Emul
+{
+	public:
+		std::vector<uint8_t> Sent;
+		uint32_t Received = 0;
+
+		size_t write(uint8_t c)
+		{
+			Sent.push_back(c);
+			return CS5490_Emul::write(c);
+		}
+		using HardwareSerial::write;
+
+		int read(void)
+		{
+			int c = CS5490_Emul::read();
+			if (c >= 0)
+				Received++;
+			return c;
+		}
+
+		void Clear(void)
+		{
+			Sent.clear();
+			Received = 0;
+		}
+};
+
+static Spy_UART UART;
+static CIRRUS_Communication Com = CIRRUS_Communication(&UART, CIRRUS_RESET_GPIO);
+static CIRRUS_CS5490 Cirrus = CIRRUS_CS5490(Com);
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+static void Check_Sent(const std::vector<uint8_t> &expected, const char *message)
+{
+	bool same = (UART.Sent == expected);
+	Check(same, message);
+	if (!same)
+	{
+		printf("  émis   :");
+		for (uint8_t c : UART.Sent)
+			printf(" %02X", c);
+		printf("\n  attendu :");
+		for (uint8_t c : expected)
+			printf(" %02X", c);
+		printf("\n");
+	}
+}
+
+// Le CS5490 n'a qu'un canal : les registres sont ceux du canal 1
+static void Write(uint8_t page, uint8_t reg, uint32_t value)
+{
+	Bit_List data;
+	data.Bit32 = value;
+	Cirrus.write_register(reg, page, &data);
+}
+
+// Une conversion complète du Cirrus émulé (1 s) : DRDY passe à 1
+static void Conversion(void)
+{
+	Sim_HalfPeriod half = {0, 230.0, 0.0, 0.0, 0.0, -500.0, false, true};
+
+	Cirrus.send_instruction(CONT_CONV);
+	for (int i = 0; i < 110; i++)
+	{
+		Sim_Advance_us(SIM_HALF_PERIOD_us);
+		UART.Add_HalfPeriod(half);
+	}
+	Cirrus.send_instruction(HALT_CONV);
+}
+
+int main(void)
+{
+	Com.begin();
+	if (!Cirrus.begin(CIRRUS_UART_BAUD, true) || !Cirrus.TryConnexion())
+	{
+		printf("ECHEC : pas de communication avec le Cirrus\n");
+		return 1;
+	}
+	Cirrus.Calibration(NULL);
+	float scale[2];
+	Cirrus.GetScale(scale);
+	UART.Set_Scale(scale);
+
+	// Valeurs connues, conversion arrêtée : la page 16 est sélectionnée en dernier
+	Write(PAGE0, P0_V1_PEAK, 0x400000);
+	Write(PAGE0, P0_I1_PEAK, 0xE00000);
+	Write(PAGE16, P16_V1_RMS, 0x5A8279);
+	Write(PAGE16, P16_I1_RMS, 0x123456);
+	Write(PAGE16, P16_P1_AVG, 0xF00000);
+	Write(PAGE16, P16_PF1, 0x7FFFFF);
+
+	// Rafale sur la page courante : pas de sélection de page
+	const uint8_t regs16[] = {P16_V1_RMS, P16_I1_RMS, P16_P1_AVG};
+	Bit_List results[CIRRUS_MAX_BURST];
+	UART.Clear();
+	Check(Cirrus.read_registers(PAGE16, regs16, 3, results), "lecture en rafale page 16");
+	Check_Sent({(uint8_t) (REGISTER_READ | regs16[0]), (uint8_t) (REGISTER_READ | regs16[1]),
+			(uint8_t) (REGISTER_READ | regs16[2])}, "octets émis sans sélection de page");
+	Check(UART.Received == 3 * 3, "3 octets lus par registre");
+	Check((results[0].Bit32 & 0xFFFFFF) == 0x5A8279, "valeur V RMS");
+	Check((results[1].Bit32 & 0xFFFFFF) == 0x123456, "valeur I RMS");
+	Check((results[2].Bit32 & 0xFFFFFF) == 0xF00000, "valeur P moyen");
+
+	// Changement de page
+	const uint8_t regs0[] = {P0_V1_PEAK, P0_I1_PEAK};
+	UART.Clear();
+	Check(Cirrus.read_registers(PAGE0, regs0, 2, results), "lecture en rafale page 0");
+	Check_Sent({PAGE_SELECT | PAGE0, (uint8_t) (REGISTER_READ | regs0[0]), (uint8_t) (REGISTER_READ | regs0[1])},
+			"octets émis avec sélection de page");
+	Check(UART.Received == 2 * 3, "3 octets lus par registre après la sélection de page");
+	Check((results[0].Bit32 & 0xFFFFFF) == 0x400000, "valeur V peak");
+	Check((results[1].Bit32 & 0xFFFFFF) == 0xE00000, "valeur I peak");
+	UART.Clear();
+	Check(Cirrus.read_registers(PAGE0, regs0, 1, results), "lecture en rafale page 0 (bis)");
+	Check_Sent({(uint8_t) (REGISTER_READ | regs0[0])}, "page courante mémorisée");
+
+	// Effacement de DRDY dans la même transaction, depuis la page 16 : mode événement (pin INT)
+	// La notification est simulée, l'effacement est différé à la lecture suivante
+	Cirrus.DataReady_Initialize(CIRRUS_INT_GPIO);
+	Conversion();
+	Bit_List status;
+	Check(Cirrus.read_register(P0_Status0, PAGE0, &status) && ((status.Bit32 & 0x800000) != 0), "DRDY à 1");
+	Write(PAGE16, P16_PF1, 0x7FFFFF);
+	CIRRUS_Base::onDataReady(&Cirrus);
+	Check(Cirrus.wait_for_data_ready(true), "notification de DRDY");
+	UART.Clear();
+	Check(Cirrus.read_registers(PAGE16, regs16, 1, results), "lecture en rafale avec effacement de DRDY");
+	Check_Sent({PAGE_SELECT | PAGE0, REGISTER_WRITE | P0_Status0, 0x00, 0x00, 0x80, PAGE_SELECT | PAGE16,
+			(uint8_t) (REGISTER_READ | regs16[0])}, "octets émis avec effacement de DRDY");
+	Check(UART.Received == 3, "réponse d'un seul registre après l'effacement de DRDY");
+	Check(Cirrus.read_register(P0_Status0, PAGE0, &status) && ((status.Bit32 & 0x800000) == 0), "DRDY effacé");
+
+	// Paramètres invalides
+	Check(!Cirrus.read_registers(PAGE16, regs16, 0, results), "rafale vide refusée");
+	Check(!Cirrus.read_registers(PAGE16, regs16, CIRRUS_MAX_BURST + 1, results), "rafale trop longue refusée");
+
+	// Lot sur deux pages : la page courante (0) d'abord, puis la page 16 avec sa sélection
+	const CIRRUS_Data list[] = {CIRRUS_RMS_Voltage, CIRRUS_Peak_Voltage, CIRRUS_RMS_Current, CIRRUS_Active_Power,
+			CIRRUS_Peak_Current, CIRRUS_Power_Factor};
+	const uint8_t count = sizeof(list) / sizeof(list[0]);
+	float multi[count];
+	float single[count];
+	for (uint8_t i = 0; i < count; i++)
+	{
+		single[i] = -1000.0;
+		Cirrus.get_data(list[i], &single[i]);
+	}
+	Cirrus.read_register(P0_Status0, PAGE0, &status);
+	UART.Clear();
+	Check(Cirrus.get_data_multi(list, count, multi), "lecture du lot sur deux pages");
+	Check_Sent({(uint8_t) (REGISTER_READ | P0_V1_PEAK), (uint8_t) (REGISTER_READ | P0_I1_PEAK),
+			PAGE_SELECT | PAGE16, (uint8_t) (REGISTER_READ | P16_V1_RMS),
+			(uint8_t) (REGISTER_READ | P16_I1_RMS), (uint8_t) (REGISTER_READ | P16_P1_AVG),
+			(uint8_t) (REGISTER_READ | P16_PF1)}, "octets émis pour le lot sur deux pages");
+	Check(UART.Received == count * 3, "3 octets lus par donnée du lot");
+	for (uint8_t i = 0; i < count; i++)
+	{
+		if (multi[i] != single[i])
+			printf("  donnée %d : %f au lieu de %f\n", list[i], multi[i], single[i]);
+		Check(multi[i] == single[i], "valeur décodée identique à la lecture simple");
+	}
+	Check((multi[1] > 0.0) && (multi[4] < 0.0) && (multi[3] < 0.0), "signes des valeurs décodées");
+
+	// Donnée inconnue : non lue, les autres le sont
+	const CIRRUS_Data bad_list[] = {CIRRUS_RMS_Voltage, (CIRRUS_Data) 0x7F};
+	float bad[2] = {0.0, 123.0};
+	Check(!Cirrus.get_data_multi(bad_list, 2, bad), "donnée inconnue signalée");
+	Check((bad[0] == single[0]) && (bad[1] == 123.0), "donnée inconnue non modifiée");
+
+	if (Errors == 0)
+		printf("Lecture en rafale du Cirrus : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
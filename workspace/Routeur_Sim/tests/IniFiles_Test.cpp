@@ -0,0 +1,176 @@
+/**
+ * Test d'IniFiles (Library/IniFiles) : sauvegarde sur place et durée de lecture et de recherche
+ *
+ * - Une valeur modifiée est réécrite sur place si le fichier n'a pas changé, y compris après
+ * une première réécriture sur place.
+ * - Un upload du fichier de la même taille entre la lecture et la sauvegarde : les positions des valeurs
+ * ne sont plus valables, le fichier doit être réécrit entièrement (pas de valeur écrite au milieu d'une autre).
+ * - Durée de Begin() et d'une recherche (ReadFloat) pour 3 tailles de fichier. La recherche par hash
+ * ne doit pas dépendre du nombre de clés (rapport borné entre le petit et le grand fichier).
+ */
+#include "Arduino.h"
+#include "config_lib.h"
+#include "Partition_utils.h"
+#include "../../../Library/IniFiles/IniFiles.h"  // La librairie, pas stubs/IniFiles.h (Emul_PV)
+#include <stdio.h>
+#include <string>
+#include <chrono>
+
+#define BENCH_REPEAT	50
+
+static fs::FS Partition;
+fs::FS *FS_Partition = &Partition;
+fs::FS *Data_Partition = &Partition;
+
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+static void Put(const char *filename, const std::string &data)
+{
+	FILE *file = fopen(filename, "wb");
+	fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+}
+
+static std::string Get(const char *filename)
+{
+	std::string data;
+	FILE *file = fopen(filename, "rb");
+	int c;
+	while ((c = fgetc(file)) != EOF)
+		data += (char) c;
+	fclose(file);
+	return data;
+}
+
+// ********************************************************************************
+// Sauvegarde sur place
+// ********************************************************************************
+
+static void Test_Save_In_Place(void)
+{
+	Put("place.ini", "[A]\nk1=111 ; un\nk2=222\n[B]\nk3=333\n");
+	{
+		IniFiles ini("place.ini");
+		ini.Begin();
+		ini.WriteInteger("A", "k2", 7);
+		ini.SaveFile("");
+		Check(Get("place.ini") == "[A]\nk1=111 ; un\nk2=7  \n[B]\nk3=333\n", "valeur réécrite sur place");
+
+		// Le hash suit la réécriture : la suivante est aussi sur place
+		ini.WriteString("A", "k1", "1", "deux");
+		ini.SaveFile("");
+		Check(Get("place.ini") == "[A]\nk1=1 ; deux\nk2=7  \n[B]\nk3=333\n", "deuxième réécriture sur place");
+	}
+}
+
+static void Test_Same_Size_Upload(void)
+{
+	Put("upload.ini", "[A]\nk1=111\nk2=222\n[B]\nk3=333\n");
+	IniFiles ini("upload.ini");
+	ini.Begin();
+
+	// Upload d'un fichier de la même taille, les sections dans l'autre ordre
+	std::string upload = "[B]\nk3=333\n[A]\nk1=111\nk2=222\n";
+	Put("upload.ini", upload);
+	Check(Get("upload.ini").size() == 29, "upload de la même taille");
+
+	ini.WriteInteger("A", "k1", 999);
+	ini.SaveFile("");
+
+	// Le contenu en mémoire est réécrit entièrement
+	IniFiles saved("upload.ini");
+	saved.Begin();
+	Check((saved.ReadInteger("A", "k1", 0) == 999) && (saved.ReadInteger("A", "k2", 0) == 222)
+			&& (saved.ReadInteger("B", "k3", 0) == 333), "upload : valeurs relues");
+	Check((saved.GetNbSections() == 2) && (Get("upload.ini").find("k3=333\n") != std::string::npos),
+			"upload : pas de valeur écrite sur place");
+}
+
+// ********************************************************************************
+// Durée de lecture et de recherche
+// ********************************************************************************
+
+static std::string Generate(int sections, int keys)
+{
+	std::string data;
+	for (int s = 0; s < sections; s++)
+	{
+		data += "\n[S" + std::to_string(s) + "] ; section\n";
+		for (int k = 0; k < keys; k++)
+			data += "Key_" + std::to_string(k) + "=" + std::to_string(s * 1000 + k) + ".500000"
+					+ ((k % 3 == 0) ? " ; comment " + std::to_string(k) : "") + "\r\n";
+	}
+	return data;
+}
+
+// Durée d'une recherche en ns
+static double Bench(int sections, int keys)
+{
+	char section_names[INI_MAX_SECTION][8];
+	char key_names[64][12];
+	double parse_us = 1e9;
+	double lookup_ns = 1e9;
+	bool values_ok = true;
+
+	for (int s = 0; s < sections; s++)
+		snprintf(section_names[s], sizeof(section_names[s]), "S%d", s);
+	for (int k = 0; k < keys; k++)
+		snprintf(key_names[k], sizeof(key_names[k]), "Key_%d", k);
+	Put("bench.ini", Generate(sections, keys));
+
+	// Le meilleur temps des essais
+	for (int r = 0; r < BENCH_REPEAT; r++)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		IniFiles ini("bench.ini");
+		ini.Begin();
+		auto t1 = std::chrono::steady_clock::now();
+		double sum = 0;
+		for (int s = 0; s < sections; s++)
+			for (int k = 0; k < keys; k++)
+				sum += ini.ReadFloat(section_names[s], key_names[k], 0.0);
+		auto t2 = std::chrono::steady_clock::now();
+
+		double expected = 0;
+		for (int s = 0; s < sections; s++)
+			for (int k = 0; k < keys; k++)
+				expected += s * 1000 + k + 0.5;
+		values_ok = values_ok && (sum == expected);
+
+		double parse = std::chrono::duration<double, std::micro>(t1 - t0).count();
+		double lookup = std::chrono::duration<double, std::nano>(t2 - t1).count() / (sections * keys);
+		if (parse < parse_us)
+			parse_us = parse;
+		if (lookup < lookup_ns)
+			lookup_ns = lookup;
+	}
+
+	Check(values_ok, "valeurs lues");
+	printf("%2d sections x %2d clés : Begin %.0f us, recherche %.1f ns\n", sections, keys, parse_us, lookup_ns);
+	return lookup_ns;
+}
+
+int main(void)
+{
+	Test_Save_In_Place();
+	Test_Same_Size_Upload();
+
+	double small = Bench(3, 12);
+	Bench(12, 25);
+	double large = Bench(50, 40);
+	// Une recherche linéaire serait environ 50 fois plus longue sur le grand fichier
+	Check(large < 5 * small, "durée de recherche indépendante du nombre de clés");
+
+	if (Errors == 0)
+		printf("IniFiles : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,350 @@
+/**
+ * Test de Line_Reader (Library/Partition_utils) et de la lecture/écriture d'IniFiles qui l'utilise
+ *
+ * - Line_Reader : fichiers aléatoires (fins de ligne \n, \r\n, \r seul, lignes vides, lignes plus longues
+ * que le buffer) lus avec des buffers de toutes les tailles et des lectures partielles du fichier.
+ * Chaque ligne (contenu, longueur, position, troncature) est comparée à un découpage de référence
+ * et on vérifie que rien n'est écrit après le buffer.
+ * - IniFiles : fichiers mal formés (sans '=' ni ']', lignes de 1 Ko) lus puis sauvés et relus :
+ * le contenu relu est le même. Une section et un commentaire de presque une ligne sont sauvés
+ * (débordement de pile de WriteFile avec sprintf).
+ * - Durée de lecture d'un CSV de 20000 lignes, par blocs et caractère par caractère (readStringUntil),
+ * pour information.
+ *
+ * Le test tourne avec les sanitizers (voir CMakeLists.txt) : un débordement est une erreur.
+ */
+#include "Arduino.h"
+#include "config_lib.h"
+#include "Partition_utils.h"
+#include "Line_Reader.h"
+#include "../../../Library/IniFiles/IniFiles.h"  // La librairie, pas stubs/IniFiles.h (Emul_PV)
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#define LR_FILE_COUNT	20000
+#define INI_FILE_COUNT	3000
+#define CSV_LINE_COUNT	20000
+
+static fs::FS Partition;
+fs::FS *FS_Partition = &Partition;
+fs::FS *Data_Partition = &Partition;
+
+static std::mt19937 Random(1234);
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+static void Put(const char *filename, const std::string &data)
+{
+	FILE *file = fopen(filename, "wb");
+	fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+}
+
+// Fichier en mémoire pour Line_Reader, data ne doit pas être vide
+static File Memory_File(const std::string &data)
+{
+	return File(fmemopen((void*) data.data(), data.size(), "r"));
+}
+
+// Texte aléatoire : lettres, séparateurs et fins de ligne, parfois une longue ligne
+static std::string Random_Text(uint32_t max_size, const char *symbols, uint32_t long_rate, uint32_t long_size)
+{
+	std::string data;
+	uint32_t count = Random() % max_size;
+	uint32_t symbol_count = strlen(symbols);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (Random() % 10 < 6)
+			data += (char) ('a' + Random() % 26);
+		else
+			data += symbols[Random() % symbol_count];
+		if (Random() % long_rate == 0)
+			data += std::string(long_size + Random() % 100, 'x');
+	}
+	return data;
+}
+
+// ********************************************************************************
+// Line_Reader
+// ********************************************************************************
+
+typedef struct
+{
+		std::string Line;
+		uint32_t Position;
+		bool Truncated;
+} Reference_Line;
+
+/**
+ * Découpage de référence : une ligne se termine par '\n', les '\r' à la fin sont supprimés.
+ * Une ligne de size - 1 caractères ou plus (avec les '\r') ne tient pas dans le buffer avec sa fin de ligne :
+ * elle est tronquée.
+ */
+static std::vector<Reference_Line> Reference(const std::string &data, uint16_t size)
+{
+	std::vector<Reference_Line> lines;
+	size_t pos = 0;
+
+	while (pos < data.size())
+	{
+		size_t end = data.find('\n', pos);
+		if (end == std::string::npos)
+			end = data.size();
+		std::string line = data.substr(pos, end - pos);
+		bool truncated = (line.size() >= (size_t) (size - 1));
+		if (truncated)
+			line.resize(size - 1);
+		while (!line.empty() && (line.back() == '\r'))
+			line.pop_back();
+		lines.push_back({line, (uint32_t) pos, truncated});
+		pos = end + 1;
+	}
+	return lines;
+}
+
+static void Test_Line_Reader(void)
+{
+	uint32_t lines = 0;
+	uint32_t truncated = 0;
+
+	for (uint32_t n = 0; n < LR_FILE_COUNT; n++)
+	{
+		std::string data = Random_Text(300, "ab=[];# \r\n\n\r\n,\t", 50, 0);
+		if (data.empty())
+			continue;
+		uint16_t size = 2 + Random() % 70;
+		File file = Memory_File(data);
+		file.Set_Max_Read((Random() % 3 == 0) ? 1 + Random() % 7 : 0);
+
+		// Un octet de garde après le buffer
+		std::vector<char> buffer(size + 1, 'Z');
+		buffer[size] = 'G';
+		Line_Reader reader(file, buffer.data(), size);
+		std::vector<Reference_Line> reference = Reference(data, size);
+		uint32_t i = 0;
+		bool same = true;
+		while (same && reader.Next())
+		{
+			same = (i < reference.size()) && (reference[i].Line == std::string(reader.line(), reader.length()))
+					&& (strlen(reader.line()) == reader.length()) && (reference[i].Position == reader.position())
+					&& (reference[i].Truncated == reader.truncated());
+			truncated += reader.truncated();
+			i++;
+		}
+		file.close();
+		if (!same || (i != reference.size()) || (buffer[size] != 'G'))
+		{
+			printf("  fichier %u, buffer de %u, ligne %u\n", n, size, i);
+			Check(false, "Line_Reader : ligne différente de la référence");
+			return;
+		}
+		lines += i;
+	}
+	printf("Line_Reader : %u fichiers, %u lignes (%u tronquées)\n", LR_FILE_COUNT, lines, truncated);
+
+	// Un fichier vide, un buffer trop petit
+	char small[2];
+	Put("empty.txt", "");
+	File empty = Partition.open("/empty.txt", "r");
+	Line_Reader reader_empty(empty, small, sizeof(small));
+	Check(!reader_empty.Next(), "Line_Reader : fichier vide");
+	empty.close();
+	File one = Memory_File("a\n");
+	Line_Reader reader_one(one, small, 1);
+	Check(!reader_one.Next(), "Line_Reader : buffer de 1 octet refusé");
+	one.close();
+}
+
+static void Test_Split(void)
+{
+	char *fields[8];
+
+	char line1[] = "1\t2\t\t4";
+	Check((Line_Reader::Split(line1, '\t', fields, 8) == 4) && (strcmp(fields[0], "1") == 0)
+			&& (strcmp(fields[2], "") == 0) && (strcmp(fields[3], "4") == 0), "Split : champs vides");
+	char line2[] = "a,b,c,d";
+	Check((Line_Reader::Split(line2, ',', fields, 2) == 2) && (strcmp(fields[1], "b,c,d") == 0),
+			"Split : fin de ligne dans le dernier champ");
+	char line3[] = "";
+	Check((Line_Reader::Split(line3, ',', fields, 2) == 1) && (fields[0][0] == '\0'), "Split : ligne vide");
+	Check(Line_Reader::Split(line3, ',', fields, 0) == 0, "Split : aucun champ");
+}
+
+// ********************************************************************************
+// IniFiles
+// ********************************************************************************
+
+// Le contenu lu : sections, clés, valeurs et commentaires
+static std::string Ini_Content(IniFiles &ini)
+{
+	std::string content;
+
+	for (uint16_t i = 0; i < ini.GetNbSections(); i++)
+	{
+		TSection *section = ini.GetSection_ByID(i);
+		content += "[" + std::string(section->Section) + "]" + ((section->Comment) ? section->Comment : "") + "\n";
+		for (uint16_t id = section->First; id != INI_NONE; id = ini.GetRecord_ByID(id)->Next)
+		{
+			TRecord *record = ini.GetRecord_ByID(id);
+			content += std::string(record->Key) + "=" + ((record->Value) ? record->Value : "") + "|"
+					+ ((record->Comment) ? record->Comment : "") + "\n";
+		}
+	}
+	return content;
+}
+
+static bool Has_Long_Line(const std::string &data, size_t max)
+{
+	size_t pos = 0;
+	size_t end;
+	while ((end = data.find('\n', pos)) != std::string::npos)
+	{
+		if (end - pos >= max)
+			return true;
+		pos = end + 1;
+	}
+	return (data.size() - pos >= max);
+}
+
+static void Test_IniFiles(void)
+{
+	uint32_t compared = 0;
+
+	for (uint32_t n = 0; n < INI_FILE_COUNT; n++)
+	{
+		// Fins de ligne \n ou \r\n (un '\r' seul à la fin d'une valeur n'est pas relu)
+		std::string text = Random_Text(400, "=[]];;# \n\n\n ", 600, 1000);
+		std::string data;
+		for (char c : text)
+		{
+			if ((c == '\n') && (Random() % 2 == 0))
+				data += '\r';
+			data += c;
+		}
+		Put("fuzz.ini", data);
+
+		IniFiles ini("fuzz.ini");
+		ini.Begin();
+		// Une clé absente est ajoutée avec la valeur par défaut
+		for (uint8_t s = 0; s < 4; s++)
+		{
+			char section[2] = {(char) ('a' + s), 0};
+			char key[2] = {(char) ('a' + Random() % 6), 0};
+			free(ini.ReadString(section, key, "x"));
+		}
+		std::string content = Ini_Content(ini);
+
+		// Sauvé sous un autre nom : réécriture complète
+		ini.SaveFile("/fuzz_save.ini");
+		IniFiles saved("fuzz_save.ini");
+		saved.Begin();
+		// Les lignes longues sont tronquées à la lecture, les blancs ajoutés par la sauvegarde changent la troncature
+		if (!Has_Long_Line(data, INI_MAX_LINESIZE - 64))
+		{
+			compared++;
+			if (Ini_Content(saved) != content)
+			{
+				printf("  fichier %u\n", n);
+				Check(false, "IniFiles : contenu relu différent après la sauvegarde");
+				return;
+			}
+		}
+	}
+	printf("IniFiles : %u fichiers mal formés lus et sauvés, %u relus identiques\n", INI_FILE_COUNT, compared);
+
+	// Lignes de section de la taille max (1022 caractères) : nom seul ou nom et commentaire
+	std::string name(INI_MAX_LINESIZE - 8, 's');
+	std::string name_b(500, 'b');
+	std::string comment_b(INI_MAX_LINESIZE - 2 - 505, 'c');
+	std::string comment(INI_MAX_LINESIZE - 16, 'k');
+	Put("long.ini", "[" + name + "]\nkey=1\n[" + name_b + "] ; " + comment_b + "\nkey=2 ; " + comment + "\n");
+	{
+		IniFiles ini("long.ini");
+		ini.Begin();
+		ini.WriteString(name_b.c_str(), "new", "3");
+		ini.SaveFile("");
+	}
+	IniFiles ini("long.ini");
+	ini.Begin();
+	Check((ini.GetNbSections() == 2) && (ini.GetSection_ByID(0)->Section == name)
+			&& (ini.GetSection_ByID(1)->Section == name_b) && (ini.GetSection_ByID(1)->Comment != NULL)
+			&& (ini.GetSection_ByID(1)->Comment == comment_b), "IniFiles : section et commentaire longs sauvés");
+	Check((ini.ReadInteger(name.c_str(), "key", 0) == 1) && (ini.ReadInteger(name_b.c_str(), "key", 0) == 2)
+			&& (ini.ReadInteger(name_b.c_str(), "new", 0) == 3), "IniFiles : valeurs après une section longue");
+	TRecord *record = ini.GetRecord_ByID(1);
+	Check((record != NULL) && (record->Comment != NULL) && (record->Comment == comment),
+			"IniFiles : commentaire long d'une valeur");
+}
+
+// ********************************************************************************
+// Durée de lecture d'un CSV
+// ********************************************************************************
+
+static void Test_Perf(void)
+{
+	FILE *csv = fopen("perf.csv", "wb");
+	for (int i = 0; i < CSV_LINE_COUNT; i++)
+		fprintf(csv, "12:%02d:%02d\t%.2f\t%.2f\t%.2f\t%.2f\r\n", i / 60 % 60, i % 60, 230.5 + i % 7, 1520.25, -300.5,
+				12345.67);
+	fclose(csv);
+
+	uint32_t lines_block = 0;
+	uint32_t lines_char = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	{
+		char buffer[256];
+		File file = Partition.open("/perf.csv", "r");
+		Line_Reader reader(file, buffer, sizeof(buffer));
+		while (reader.Next())
+			lines_block++;
+		file.close();
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	{
+		// Comme readStringUntil('\n') : un caractère par lecture, la ligne dans une String
+		File file = Partition.open("/perf.csv", "r");
+		String line;
+		uint8_t c;
+		while (file.read(&c, 1) == 1)
+		{
+			if (c == '\n')
+			{
+				lines_char++;
+				line = "";
+			}
+			else
+				line += (char) c;
+		}
+		file.close();
+	}
+	auto t2 = std::chrono::steady_clock::now();
+
+	Check((lines_block == CSV_LINE_COUNT) && (lines_char == CSV_LINE_COUNT), "lecture du CSV : nombre de lignes");
+	printf("CSV de %d lignes : Line_Reader %.0f us, caractère par caractère %.0f us\n", CSV_LINE_COUNT,
+			std::chrono::duration<double, std::micro>(t1 - t0).count(),
+			std::chrono::duration<double, std::micro>(t2 - t1).count());
+}
+
+int main(void)
+{
+	Test_Line_Reader();
+	Test_Split();
+	Test_IniFiles();
+	Test_Perf();
+
+	if (Errors == 0)
+		printf("Line_Reader : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+/**
+ * Test de Log_Ring (Library/Debug_utils/Log_Ring.h) : buffer circulaire des messages de log
+ *
+ * - Un seul thread : messages de toutes les tailles (jusqu'à la troncature) sur un petit buffer
+ * pour passer souvent la fin du buffer, relus à l'identique avec des blocs de toutes les tailles.
+ * Quand tout est lu, le buffer doit être entièrement à 0 (en-têtes et messages effacés par Pop).
+ * - Débordement : les messages refusés sont comptés, GetOverflow(true) remet le compteur à 0.
+ * - Plusieurs écrivains et un lecteur (comme la tâche de log) : chaque message reçu est intact
+ * (texte UTF-8, donc des octets avec le bit LOG_RECORD_READY), dans l'ordre de chaque écrivain,
+ * et les messages reçus plus ceux refusés font le total envoyé.
+ *
+ * Compilé avec ThreadSanitizer.
+ */
+#define LOG_RING_SIZE	1024
+#include "Log_Ring.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <random>
+#include <type_traits>
+
+#define WRITER_COUNT	4
+#define MESSAGE_COUNT	40000
+
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+// Le buffer est le premier membre de Log_Ring
+static_assert(std::is_standard_layout<Log_Ring>::value, "Log_Ring doit être standard layout");
+
+static bool Is_Clean(const Log_Ring &ring)
+{
+	const uint32_t *buffer = reinterpret_cast<const uint32_t*>(&ring);
+	for (uint32_t i = 0; i < LOG_RING_SIZE / 4; i++)
+		if (buffer[i] != 0)
+			return false;
+	return true;
+}
+
+// Texte du message : UTF-8 et ASCII, sans '\n'
+static std::string Text(uint32_t seed, size_t len)
+{
+	static const char *pieces[] = {"é", "à", "°C", "x", "Log ", "ü", "0"};
+	std::string text;
+	while (text.size() < len)
+		text += pieces[(seed++ * 5 + 3) % 7];
+	text.resize(len);
+	return text;
+}
+
+// ********************************************************************************
+// Un seul thread
+// ********************************************************************************
+
+static void Test_Single(void)
+{
+	static Log_Ring ring;
+	std::mt19937 random(1234);
+	char chunk[LOG_RING_MAX_MESSAGE + 64];
+
+	for (int round = 0; round < 20000; round++)
+	{
+		std::string expected;
+		int count = 1 + random() % 6;
+		for (int m = 0; m < count; m++)
+		{
+			size_t len = (random() % 10 == 0) ? random() % 700 : random() % 120;
+			std::string text = Text(random(), len);
+			Log_Part parts[3] = {{"[", 1}, {text.c_str(), text.size()}, {"]\r\n", 3}};
+			if (ring.Push(parts, 3))
+			{
+				std::string message = "[" + text + "]\r\n";
+				if (message.size() > LOG_RING_MAX_MESSAGE)
+					message.resize(LOG_RING_MAX_MESSAGE);
+				expected += message;
+			}
+		}
+
+		std::string received;
+		size_t size = LOG_RING_MAX_MESSAGE + random() % 64;
+		size_t n;
+		while ((n = ring.Pop(chunk, size)) > 0)
+			received.append(chunk, n);
+
+		if ((received != expected) || !ring.IsEmpty() || !Is_Clean(ring))
+		{
+			printf("  tour %d : %u octets lus au lieu de %u\n", round, (unsigned) received.size(),
+					(unsigned) expected.size());
+			Check(false, "un thread : messages relus différents ou buffer non effacé");
+			return;
+		}
+	}
+	ring.GetOverflow(true);
+}
+
+static void Test_Overflow(void)
+{
+	static Log_Ring ring;
+	char chunk[LOG_RING_MAX_MESSAGE];
+	std::string text = Text(0, 96);  // 100 octets avec l'en-tête
+	Log_Part part = {text.c_str(), text.size()};
+	uint32_t accepted = 0;
+	uint32_t refused = 0;
+
+	for (int i = 0; i < 25; i++)
+		(ring.Push(&part, 1)) ? accepted++ : refused++;
+	Check((accepted == LOG_RING_SIZE / 100) && (refused == 25 - accepted), "débordement : messages acceptés");
+	Check(ring.GetOverflow() == refused, "débordement : messages perdus comptés");
+	Check(ring.GetOverflow(true) == refused, "débordement : lecture et remise à 0");
+	Check(ring.GetOverflow() == 0, "débordement : compteur remis à 0");
+
+	// Une place libérée est réutilisable
+	Check(ring.Pop(chunk, sizeof(chunk)) == 5 * text.size(), "débordement : lecture par blocs");
+	Check(ring.Push(&part, 1), "débordement : place libérée");
+	while (ring.Pop(chunk, sizeof(chunk)) > 0)
+		;
+	Check(ring.IsEmpty() && Is_Clean(ring), "débordement : buffer vidé et effacé");
+}
+
+// ********************************************************************************
+// Plusieurs écrivains, un lecteur
+// ********************************************************************************
+
+static Log_Ring Shared;
+
+static void Writer(uint32_t id, uint32_t *refused)
+{
+	char prefix[24];
+
+	for (uint32_t seq = 0; seq < MESSAGE_COUNT; seq++)
+	{
+		int len = snprintf(prefix, sizeof(prefix), "%u %u ", id, seq);
+		std::string text = Text(id + seq, (seq * 13) % 150);
+		Log_Part parts[3] = {{prefix, (size_t) len}, {text.c_str(), text.size()}, {"\n", 1}};
+		if (!Shared.Push(parts, 3))
+			(*refused)++;
+		if (seq % 4 == 0)
+			std::this_thread::yield();
+	}
+}
+
+static void Test_Multi_Writers(void)
+{
+	std::vector<std::thread> writers;
+	uint32_t refused[WRITER_COUNT] = {0};
+	int32_t last_seq[WRITER_COUNT];
+	uint32_t received[WRITER_COUNT] = {0};
+	uint32_t bad = 0;
+	uint32_t running = WRITER_COUNT;
+	std::atomic<uint32_t> done = {0};
+	char chunk[LOG_RING_MAX_MESSAGE];
+	std::string pending;
+
+	for (int w = 0; w < WRITER_COUNT; w++)
+	{
+		last_seq[w] = -1;
+		writers.push_back(std::thread([w, &refused, &done]()
+		{
+			Writer(w, &refused[w]);
+			done++;
+		}));
+	}
+
+	// Le lecteur : découpe les lignes et vérifie chaque message
+	while (running > 0)
+	{
+		bool finished = (done.load() == WRITER_COUNT);
+		size_t n;
+		while ((n = Shared.Pop(chunk, sizeof(chunk))) > 0)
+			pending.append(chunk, n);
+
+		size_t start = 0;
+		size_t end;
+		while ((end = pending.find('\n', start)) != std::string::npos)
+		{
+			unsigned id, seq;
+			int offset = 0;
+			std::string line = pending.substr(start, end - start);
+			start = end + 1;
+			if ((sscanf(line.c_str(), "%u %u %n", &id, &seq, &offset) != 2) || (id >= WRITER_COUNT)
+					|| ((int32_t) seq <= last_seq[id])
+					|| (line.substr(offset) != Text(id + seq, (seq * 13) % 150)))
+			{
+				bad++;
+				continue;
+			}
+			last_seq[id] = seq;
+			received[id]++;
+		}
+		pending.erase(0, start);
+
+		if (finished && Shared.IsEmpty())
+			running = 0;
+		else
+			std::this_thread::yield();
+	}
+	for (auto &writer : writers)
+		writer.join();
+
+	uint32_t total_refused = 0;
+	bool complete = true;
+	for (int w = 0; w < WRITER_COUNT; w++)
+	{
+		total_refused += refused[w];
+		complete = complete && (received[w] + refused[w] == MESSAGE_COUNT);
+	}
+	printf("Log_Ring : %u écrivains, %u messages, %u perdus (buffer plein)\n", WRITER_COUNT,
+			WRITER_COUNT * MESSAGE_COUNT, total_refused);
+	Check(bad == 0, "plusieurs écrivains : messages corrompus ou dans le désordre");
+	Check(pending.empty(), "plusieurs écrivains : message incomplet");
+	Check(complete, "plusieurs écrivains : messages reçus + perdus = messages envoyés");
+	Check(Shared.GetOverflow() == total_refused, "plusieurs écrivains : compteur de messages perdus");
+	Check(Is_Clean(Shared), "plusieurs écrivains : buffer effacé");
+}
+
+int main(void)
+{
+	Test_Single();
+	Test_Overflow();
+	Test_Multi_Writers();
+
+	if (Errors == 0)
+		printf("Log_Ring : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
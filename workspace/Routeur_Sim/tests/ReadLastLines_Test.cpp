@@ -0,0 +1,194 @@
+/**
+ * Test de ReadLastLines (Library/Partition_utils/Line_Reader.cpp) : lecture des dernières lignes
+ * d'un fichier à reculons, par blocs de TAIL_BLOCK_SIZE
+ *
+ * - Fichiers aléatoires : fins de ligne \n et \r\n mélangées, lignes vides, avec ou sans fin de ligne
+ * à la fin, n de 1 à 10 et buffers plus petits que les lignes. Le résultat est comparé à une référence
+ * et on vérifie que rien n'est écrit après le buffer.
+ * - Grand fichier CSV (énergie) : la dernière ligne et les 3 dernières.
+ */
+#include "Arduino.h"
+#include "config_lib.h"
+#include "Line_Reader.h"
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#define FILE_COUNT	20000
+#define CSV_LINE_COUNT	50000
+
+static fs::FS Partition;
+static std::mt19937 Random(2024);
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+static void Put(const char *filename, const std::string &data)
+{
+	FILE *file = fopen(filename, "wb");
+	fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+}
+
+static bool Is_EOL(char c)
+{
+	return (c == '\r') || (c == '\n');
+}
+
+/**
+ * Référence : les lignes non vides de data, on garde les k dernières (k <= n) dont le texte, le caractère
+ * de fin de ligne qui les précède et la fin du fichier tiennent dans size - 1 caractères.
+ * Le résultat va du début de la plus ancienne à la fin de la dernière, sans la fin de ligne.
+ */
+static uint8_t Reference(const std::string &data, uint8_t n, size_t size, std::string &result)
+{
+	std::vector<size_t> starts;
+	std::vector<size_t> ends;
+	size_t i = 0;
+
+	while (i < data.size())
+	{
+		if (Is_EOL(data[i]))
+		{
+			i++;
+			continue;
+		}
+		starts.push_back(i);
+		while ((i < data.size()) && !Is_EOL(data[i]))
+			i++;
+		ends.push_back(i);
+	}
+
+	uint8_t count = 0;
+	while ((count < n) && (count < starts.size()))
+	{
+		size_t start = starts[starts.size() - 1 - count];
+		size_t needed = data.size() - ((start > 0) ? start - 1 : 0);
+		if (needed > size - 1)
+			break;
+		count++;
+	}
+	result = (count == 0) ? "" : data.substr(starts[starts.size() - count], ends.back() - starts[starts.size() - count]);
+	return count;
+}
+
+static std::string Random_File(void)
+{
+	static const char *eol[] = {"\n", "\r\n", "\n\n", "\r\n\r\n", "\n\r\n"};
+	std::string data;
+	uint32_t lines = Random() % 60;
+
+	// Parfois des lignes vides au début
+	if (Random() % 4 == 0)
+		data += eol[Random() % 5];
+	for (uint32_t l = 0; l < lines; l++)
+	{
+		uint32_t len = (Random() % 8 == 0) ? Random() % 400 : Random() % 40;
+		for (uint32_t c = 0; c < len; c++)
+			data += (char) ('0' + Random() % 60);
+		if ((l + 1 < lines) || (Random() % 3 != 0))
+			data += eol[Random() % 5];
+	}
+	return data;
+}
+
+static void Test_Random(void)
+{
+	uint32_t lines = 0;
+
+	for (uint32_t f = 0; f < FILE_COUNT; f++)
+	{
+		std::string data = Random_File();
+		uint8_t n = 1 + Random() % 10;
+		size_t size = 2 + Random() % 600;
+
+		Put("tail.txt", data);
+		File file = Partition.open("/tail.txt", "r");
+		std::vector<char> buffer(size + 1, 'Z');
+		buffer[size] = 'G';
+		uint8_t count = ReadLastLines(file, n, buffer.data(), size);
+		file.close();
+
+		std::string expected;
+		uint8_t expected_count = Reference(data, n, size, expected);
+		if ((count != expected_count) || (expected != buffer.data()) || (buffer[size] != 'G'))
+		{
+			printf("  fichier %u : %u octets, n = %u, buffer de %u : %u lignes au lieu de %u\n", f,
+					(unsigned) data.size(), n, (unsigned) size, count, expected_count);
+			Check(false, "dernières lignes différentes de la référence");
+			return;
+		}
+		lines += count;
+	}
+	printf("ReadLastLines : %u fichiers, %u lignes lues\n", FILE_COUNT, lines);
+}
+
+static void Test_Cases(void)
+{
+	char buffer[64];
+
+	Put("empty.txt", "");
+	File file = Partition.open("/empty.txt", "r");
+	Check((ReadLastLines(file, 1, buffer, sizeof(buffer)) == 0) && (buffer[0] == 0), "fichier vide");
+	file.close();
+
+	Put("eol.txt", "\r\n\n\r\n");
+	file = Partition.open("/eol.txt", "r");
+	Check((ReadLastLines(file, 2, buffer, sizeof(buffer)) == 0) && (buffer[0] == 0), "seulement des fins de ligne");
+	file.close();
+
+	Put("lines.txt", "un\r\ndeux\n\n\r\ntrois\r\n\r\n");
+	file = Partition.open("/lines.txt", "r");
+	Check((ReadLastLines(file, 1, buffer, sizeof(buffer)) == 1) && (strcmp(buffer, "trois") == 0), "dernière ligne");
+	Check((ReadLastLines(file, 2, buffer, sizeof(buffer)) == 2) && (strcmp(buffer, "deux\n\n\r\ntrois") == 0),
+			"deux lignes séparées par des lignes vides");
+	Check((ReadLastLines(file, 5, buffer, sizeof(buffer)) == 3) && (strcmp(buffer, "un\r\ndeux\n\n\r\ntrois") == 0),
+			"moins de lignes que demandé");
+	Check(ReadLastLines(file, 0, buffer, sizeof(buffer)) == 0, "aucune ligne demandée");
+	// "trois\r\n\r\n" et le '\n' avant : 10 caractères, 18 avec "deux"
+	Check((ReadLastLines(file, 1, buffer, 10) == 0) && (buffer[0] == 0), "buffer plus petit que la ligne");
+	Check((ReadLastLines(file, 1, buffer, 11) == 1) && (strcmp(buffer, "trois") == 0), "buffer juste assez grand");
+	Check((ReadLastLines(file, 3, buffer, 18) == 1) && (strcmp(buffer, "trois") == 0),
+			"buffer trop petit pour toutes les lignes");
+	file.close();
+}
+
+static void Test_Large_CSV(void)
+{
+	FILE *csv = fopen("energy.csv", "wb");
+	fprintf(csv, "Date\tE_Conso\tE_Surplus\tE_Prod\r\n");
+	for (int i = 1; i <= CSV_LINE_COUNT; i++)
+		fprintf(csv, "%d\t%.2f\t%.2f\t%.2f\r\n", i, i * 10.5, i * 2.25, i * 7.75);
+	fclose(csv);
+
+	char buffer[256];
+	char expected[256];
+	File file = Partition.open("/energy.csv", "r");
+	snprintf(expected, sizeof(expected), "%d\t%.2f\t%.2f\t%.2f", CSV_LINE_COUNT, CSV_LINE_COUNT * 10.5,
+			CSV_LINE_COUNT * 2.25, CSV_LINE_COUNT * 7.75);
+	Check((ReadLastLines(file, 1, buffer, sizeof(buffer)) == 1) && (strcmp(buffer, expected) == 0),
+			"grand CSV : dernière ligne");
+	Check((ReadLastLines(file, 3, buffer, sizeof(buffer)) == 3)
+			&& (strncmp(buffer, "49998\t", 6) == 0) && (strstr(buffer, "\r\n49999\t") != NULL)
+			&& (strstr(buffer, expected) != NULL), "grand CSV : 3 dernières lignes");
+	file.close();
+}
+
+int main(void)
+{
+	Test_Cases();
+	Test_Random();
+	Test_Large_CSV();
+
+	if (Errors == 0)
+		printf("ReadLastLines : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,335 @@
+/**
+ * Test de SSD1327_Flush() (Library/SSD1327) : rafraîchissement partiel de l'écran
+ *
+ * L'écran est émulé derrière le stub Wire : fenêtre (colonnes, lignes), incrément automatique et
+ * mémoire GDDRAM. Après chaque SSD1327_Flush(), un SSD1327_Display() complet ne doit rien changer
+ * dans la mémoire de l'écran : tout ce qui a été modifié dans le buffer a bien été envoyé.
+ *
+ * - Les pages 1 et 2 d'Affichage (Routeur_CS5480 : Font12, OLED_RIGHT_LEFT) toutes les secondes,
+ * avec un changement de page toutes les 10 secondes. On compte les octets envoyés par rapport
+ * à un rafraîchissement complet.
+ * - Dessins aléatoires (points, lignes, rectangles, cercles, texte, effacement de zones).
+ *
+ * Le test est compilé avec la copie de l'écran (SSD1327_SHADOW, par défaut sur ESP32) et sans
+ * (SSD1327_NO_SHADOW) : seuls les seuils d'octets envoyés changent.
+ */
+#include "Arduino.h"
+#include "Wire.h"
+#include "SSD1327.h"
+#include <stdio.h>
+#include <string.h>
+#include <random>
+
+#define OLED_ADDRESS	0x3C
+#define COLUMN	5  // Comme Affichage.cpp
+#define SECONDS	600
+
+static std::mt19937 Random(1327);
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+// ********************************************************************************
+// Emulation du SSD1327 : mode incrément horizontal, une colonne = 2 pixels
+// ********************************************************************************
+
+class SSD1327_Emul: public Sim_I2C_Slave
+{
+	public:
+		uint8_t GDDRAM[128][64];
+
+		SSD1327_Emul()
+		{
+			memset(GDDRAM, 0xA5, sizeof(GDDRAM));  // Contenu inconnu au démarrage
+		}
+
+		void receive(const uint8_t *data, size_t size)
+		{
+			if (size == 0)
+				return;
+			if (data[0] == 0x40)
+			{
+				for (size_t i = 1; i < size; i++)
+					Write_Data(data[i]);
+			}
+			else
+				if (data[0] == 0x00)
+				{
+					for (size_t i = 1; i < size; i++)
+						Command(data[i]);
+				}
+				else
+					Bad_Control++;
+		}
+
+		uint32_t Bad_Control = 0;
+
+	private:
+		uint8_t col_start = 0, col_end = 63, row_start = 0, row_end = 127;
+		uint8_t col = 0, row = 0;
+		uint8_t command = 0;
+		uint8_t args[2];
+		uint8_t arg_count = 0;  // Arguments attendus
+		uint8_t arg_index = 0;
+
+		void Write_Data(uint8_t value)
+		{
+			GDDRAM[row][col] = value;
+			if (++col > col_end)
+			{
+				col = col_start;
+				if (++row > row_end)
+					row = row_start;
+			}
+		}
+
+		// Les commandes et leurs arguments peuvent être envoyés en plusieurs transmissions
+		void Command(uint8_t value)
+		{
+			if (arg_index < arg_count)
+			{
+				if (arg_index < 2)
+					args[arg_index] = value;
+				if (++arg_index < arg_count)
+					return;
+				if (command == 0x15)
+				{
+					col_start = args[0] & 0x3F;
+					col_end = args[1] & 0x3F;
+					col = col_start;
+				}
+				if (command == 0x75)
+				{
+					row_start = args[0] & 0x7F;
+					row_end = args[1] & 0x7F;
+					row = row_start;
+				}
+				arg_count = 0;
+				return;
+			}
+			command = value;
+			arg_index = 0;
+			switch (value)
+			{
+				case 0x15: // Column address
+				case 0x75: // Row address
+					arg_count = 2;
+					break;
+				case 0x81: case 0xA0: case 0xA1: case 0xA2: case 0xA8: case 0xAB: case 0xB1: case 0xB3:
+				case 0xB5: case 0xB6: case 0xBC: case 0xBE: case 0xD5: case 0xFD:
+					arg_count = 1;
+					break;
+				default:
+					arg_count = 0;
+			}
+		}
+};
+
+static SSD1327_Emul Screen;
+
+// Octets envoyés par f() et vérification de la mémoire de l'écran avec un affichage complet
+template<typename Func>
+static uint32_t Send(Func f, const char *message)
+{
+	uint32_t bytes = Wire.Bytes;
+	f();
+	bytes = Wire.Bytes - bytes;
+
+	static uint8_t flushed[128][64];
+	memcpy(flushed, Screen.GDDRAM, sizeof(flushed));
+	SSD1327_Display();
+	Check(memcmp(flushed, Screen.GDDRAM, sizeof(flushed)) == 0, message);
+	return bytes;
+}
+
+// ********************************************************************************
+// Pages d'Affichage
+// ********************************************************************************
+
+static char Text[30];
+
+static void Print(uint8_t line, uint8_t col, const char *text)
+{
+	SSD1327_String(TPoint(7 * col, 12 * line), text, &Font12, FONT_BACKGROUND, SSD1327_WHITE);
+}
+
+static void Print_Power(uint8_t line, float value, const char *unit)
+{
+	snprintf(Text, sizeof(Text), "%.2f%s", value, unit);
+	for (char *p = Text; *p; p++)
+		if (*p == '.')
+			*p = ',';
+	Print(line, COLUMN, Text);
+}
+
+static void Show_Page1(uint32_t second)
+{
+	static float conso = 800.0;
+	static float prod = 1500.0;
+	uint8_t line = 0;
+
+	// Les puissances varient de quelques dizaines de watts par seconde, la production s'arrête
+	conso += ((int) (Random() % 4001) - 2000) / 100.0;
+	prod = (second < SECONDS / 2) ? prod + ((int) (Random() % 2001) - 1000) / 100.0 : 0;
+
+	snprintf(Text, sizeof(Text), "%02u:%02u:%02u", 12 + second / 3600, (second / 60) % 60, second % 60);
+	Print(line++, 6, Text);
+	line++;
+	Print(line++, 1, "P conso : ");
+	Print_Power(line++, conso, " W");
+	Print(line++, 1, "P prod : ");
+	Print_Power(line++, prod, " W");
+	Print(line++, 1, "P Talema : ");
+	Print_Power(line++, (Random() % 100 == 0) ? 0 : 1000.0 + (Random() % 1000) / 100.0, " W");
+}
+
+static void Show_Page2(uint32_t second)
+{
+	uint8_t line = 0;
+
+	Print(line++, 5, "Energie");
+	line++;
+	Print(line++, 1, "E conso : ");
+	Print_Power(line++, 1200.0 + second / 10, " Wh");
+	Print(line++, 1, "E surplus : ");
+	Print_Power(line++, 3400.0 + second / 20, " Wh");
+	Print(line++, 1, "E prod : ");
+	Print_Power(line++, 8000.0 + second / 5, " Wh");
+}
+
+static void Test_Pages(void)
+{
+	uint32_t full = Send(SSD1327_Display, "affichage complet");
+	uint32_t page_bytes[2] = {0, 0};
+	uint32_t page_count[2] = {0, 0};
+	uint32_t change_bytes = 0;
+	uint32_t change_count = 0;
+	uint8_t page = 0;
+
+	for (uint32_t second = 0; second < SECONDS; second++)
+	{
+		bool change = (second > 0) && (second % 10 == 0);
+		if (change)
+			page = 1 - page;
+
+		// DISPLAY_Task : IHM_Clear(), la page puis IHM_Display()
+		uint32_t bytes = Send([&]()
+		{
+			SSD1327_Clear(SSD1327_BACKGROUND);
+			(page == 0) ? Show_Page1(second) : Show_Page2(second);
+			SSD1327_Flush();
+		}, "page : mémoire de l'écran différente du buffer");
+
+		if (change)
+		{
+			change_bytes += bytes;
+			change_count++;
+		}
+		else
+			if (second > 0)
+			{
+				page_bytes[page] += bytes;
+				page_count[page]++;
+			}
+	}
+
+	float page1 = (float) page_bytes[0] / page_count[0];
+	float page2 = (float) page_bytes[1] / page_count[1];
+	float change = (float) change_bytes / change_count;
+	printf("Affichage complet : %u octets\n", full);
+	printf("Page 1 : %.0f octets/s (%.1f %%), page 2 : %.0f octets/s (%.1f %%), changement de page : %.0f octets (%.0f %%)\n",
+			page1, 100.0 * page1 / full, page2, 100.0 * page2 / full, change, 100.0 * change / full);
+
+#ifdef SSD1327_SHADOW
+	Check(page1 < 0.06 * full, "page 1 : moins de 6 % d'un affichage complet");
+	Check(page2 < 0.01 * full, "page 2 : moins de 1 % d'un affichage complet");
+	Check(change < 0.6 * full, "changement de page : moins de 60 % d'un affichage complet");
+#else
+	// Sans la copie, IHM_Clear() marque tout l'écran : on gagne seulement les transmissions
+	Check(page1 <= full, "page 1 : pas plus qu'un affichage complet");
+#endif
+}
+
+// ********************************************************************************
+// Dessins aléatoires
+// ********************************************************************************
+
+static TPoint Random_Point(void)
+{
+	return TPoint(Random() % 128, Random() % 128);
+}
+
+static void Draw_Random(void)
+{
+	COLOR color = Random() % 16;
+	TPoint p1 = Random_Point();
+	TPoint p2 = Random_Point();
+
+	if (p2.X < p1.X)
+		SSD1327_Swap(p1.X, p2.X);
+	if (p2.Y < p1.Y)
+		SSD1327_Swap(p1.Y, p2.Y);
+	switch (Random() % 7)
+	{
+		case 0:
+			SSD1327_SetColor(p1, color);
+			break;
+		case 1:
+			SSD1327_DrawLine(p1, p2, color, LINE_SOLID, DOT_PIXEL_1X1);
+			break;
+		case 2:
+			SSD1327_DrawRectangle(p1, p2, color, (Random() % 2) ? DRAW_FULL : DRAW_EMPTY, DOT_PIXEL_1X1);
+			break;
+		case 3:
+			SSD1327_DrawCircle(p1, 1 + Random() % 30, color, DRAW_EMPTY, DOT_PIXEL_1X1);
+			break;
+		case 4:
+			SSD1327_String(p1, "Test 1327", &Font12, FONT_BACKGROUND, color);
+			break;
+		case 5:
+			SSD1327_ClearWindow(p1, p2, color);
+			break;
+		default:
+			if (Random() % 20 == 0)
+				SSD1327_Clear(color);
+			else
+				SSD1327_DrawPoint(p1, color, DOT_PIXEL_2X2, DOT_FILL_AROUND);
+	}
+}
+
+static void Test_Random(void)
+{
+	for (int i = 0; i < 3000; i++)
+	{
+		Send([]()
+		{
+			int count = Random() % 8;
+			for (int d = 0; d < count; d++)
+				Draw_Random();
+			SSD1327_Flush();
+		}, "dessins aléatoires : mémoire de l'écran différente du buffer");
+		if (Errors != 0)
+			return;
+	}
+}
+
+int main(void)
+{
+	Sim_I2C_Device(OLED_ADDRESS) = &Screen;
+	Check(SSD1327_Init(21, 22, OLED_ADDRESS), "initialisation");
+
+	Test_Pages();
+	Test_Random();
+	Check(Screen.Bad_Control == 0, "octet de contrôle I2C");
+
+	if (Errors == 0)
+		printf("SSD1327_Flush : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+/**
+ * Test des courbes d'amorçage du SSR (Library/SSR/SSR_Curve.h et SSR_Percent_To_Delay)
+ *
+ * Toutes les fractions Q16 de 0 à 65536 sont converties en délai avec les deux courbes :
+ * - SSR_Curve_Power : la puissance délivrée par une charge résistive avec ce délai
+ * (Sim_Conduction_Fraction) doit être la fraction demandée à 0,15 % près de la pleine puissance.
+ * - SSR_Curve_Acos : le délai est comparé à l'ancienne formule acos(2p - 1) en double, la tension
+ * moyenne (1 + cos(a)) / 2 doit être la fraction demandée à 0,10 % près.
+ * Les délais doivent décroître avec la fraction, de la demi-période (0 %) à 0 (100 %).
+ */
+#include "Arduino.h"
+#include "config_lib.h"
+#include "SSR.h"
+#include "Sim_Core.h"
+#include <stdio.h>
+#include <math.h>
+
+#define HALF_PERIOD_us	10000
+
+static uint32_t Errors = 0;
+
+// Messages du SSR (Routeur_Sim.cpp les affiche en mode verbeux)
+void PrintTerminal(const char *text)
+{
+	(void) text;
+}
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+typedef struct
+{
+		double max_error;       // Ecart max de la fraction délivrée
+		uint32_t worst_q16;
+		uint32_t max_delay_gap; // Ecart max avec le délai de l'ancienne formule (us)
+		bool monotonic;
+} Curve_Result;
+
+static Curve_Result Sweep(SSR_Curve_typedef curve)
+{
+	Curve_Result res = {0, 0, 0, true};
+	uint32_t last = HALF_PERIOD_us;
+
+	SSR_Set_Curve(curve);
+	for (uint32_t q = 0; q <= 65536; q++)
+	{
+		double f = q / 65536.0;
+		uint32_t delay = SSR_Percent_To_Delay(q);
+		double output;
+
+		if (curve == SSR_Curve_Power)
+			output = Sim_Conduction_Fraction(delay);
+		else
+		{
+			uint32_t old = lround(fabs(acos(2.0 * f - 1.0)) / M_PI * HALF_PERIOD_us);
+			uint32_t gap = (delay > old) ? delay - old : old - delay;
+			if (gap > res.max_delay_gap)
+				res.max_delay_gap = gap;
+			output = (1.0 + cos(M_PI * delay / HALF_PERIOD_us)) / 2.0;
+		}
+
+		if (fabs(output - f) > res.max_error)
+		{
+			res.max_error = fabs(output - f);
+			res.worst_q16 = q;
+		}
+		if (delay > last)
+			res.monotonic = false;
+		last = delay;
+	}
+	return res;
+}
+
+int main(void)
+{
+	Check(SSR_Get_Curve() == SSR_Curve_Power, "courbe par défaut : puissance");
+
+	Curve_Result power = Sweep(SSR_Curve_Power);
+	printf("Courbe puissance : écart max %.4f %% (fraction %.4f)\n", 100.0 * power.max_error,
+			power.worst_q16 / 65536.0);
+	Check(power.max_error <= 0.0015, "courbe puissance : puissance délivrée à 0,15 %");
+	Check(power.monotonic, "courbe puissance : délai décroissant");
+
+	Curve_Result acos_curve = Sweep(SSR_Curve_Acos);
+	printf("Courbe acos : écart max %.4f %% (fraction %.4f), délai à %u us de l'ancienne formule\n",
+			100.0 * acos_curve.max_error, acos_curve.worst_q16 / 65536.0, acos_curve.max_delay_gap);
+	Check(acos_curve.max_error <= 0.0010, "courbe acos : tension moyenne à 0,10 %");
+	Check(acos_curve.monotonic, "courbe acos : délai décroissant");
+	Check(SSR_Get_Curve() == SSR_Curve_Acos, "courbe sélectionnée");
+
+	// Les extrémités : pas d'amorçage à 0 %, pleine onde à 100 %
+	for (int c = SSR_Curve_Power; c <= SSR_Curve_Acos; c++)
+	{
+		SSR_Set_Curve((SSR_Curve_typedef) c);
+		Check(SSR_Percent_To_Delay(0) == HALF_PERIOD_us, "0 % : délai d'une demi-période");
+		Check(SSR_Percent_To_Delay(65536) == 0, "100 % : délai nul");
+		Check(SSR_Percent_To_Delay(70000) == 0, "plus de 100 % : délai nul");
+	}
+	SSR_Set_Curve(SSR_Curve_Power);
+
+	if (Errors == 0)
+		printf("SSR_Curve : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/**
+ * Test de Snapshot (Library/Tasks_utils/Snapshot.h) : un producteur, plusieurs lecteurs
+ *
+ * Le producteur publie une structure dont tous les champs valent le numéro de la publication.
+ * Les lecteurs vérifient que chaque copie est cohérente (tous les champs égaux) et que les numéros
+ * ne reculent pas. Read() avec peu d'essais ne doit jamais modifier la donnée en cas d'échec.
+ * Les threads cèdent la main régulièrement pour tourner aussi sur une machine à un seul cœur.
+ */
+#include "Snapshot.h"
+#include <stdio.h>
+#include <sched.h>
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#define PUBLISH_COUNT	200000
+#define READER_COUNT	3
+#define FIELD_COUNT	64
+
+typedef struct
+{
+		uint32_t Value[FIELD_COUNT];
+} Test_Data;
+
+static Snapshot<Test_Data> Test_Snapshot;
+static std::atomic<bool> Producer_Done = {false};
+static std::atomic<uint32_t> Errors = {0};
+
+static void Fill(Test_Data &data, uint32_t value)
+{
+	for (int i = 0; i < FIELD_COUNT; i++)
+		data.Value[i] = value;
+}
+
+static bool Is_Consistent(const Test_Data &data)
+{
+	for (int i = 1; i < FIELD_COUNT; i++)
+		if (data.Value[i] != data.Value[0])
+			return false;
+	return true;
+}
+
+static void Producer(void)
+{
+	Test_Data data;
+
+	for (uint32_t n = 1; n <= PUBLISH_COUNT; n++)
+	{
+		Fill(data, n);
+		Test_Snapshot.Publish(data);
+		if ((n & 0xFF) == 0)
+			sched_yield();
+	}
+	Producer_Done = true;
+}
+
+static void Reader(uint32_t *reads, uint32_t *failed)
+{
+	uint32_t last = 0;
+	uint32_t loop = 0;
+	Test_Data data;
+
+	while (!Producer_Done)
+	{
+		// Get() : toujours une copie cohérente
+		data = Test_Snapshot.Get();
+		if (!Is_Consistent(data) || (data.Value[0] < last))
+			Errors++;
+		last = data.Value[0];
+		(*reads)++;
+
+		// Read() sans nouvel essai : en cas d'échec, la donnée n'est pas modifiée
+		Fill(data, 0xFFFFFFFF);
+		if (Test_Snapshot.Read(data, 0))
+		{
+			if (!Is_Consistent(data) || (data.Value[0] < last))
+				Errors++;
+			last = data.Value[0];
+		}
+		else
+		{
+			if (data.Value[0] != 0xFFFFFFFF || !Is_Consistent(data))
+				Errors++;
+			(*failed)++;
+		}
+
+		if ((++loop & 0x3F) == 0)
+			sched_yield();
+	}
+}
+
+int main(void)
+{
+	std::vector<std::thread> threads;
+	uint32_t reads[READER_COUNT] = {0};
+	uint32_t failed[READER_COUNT] = {0};
+
+	for (int i = 0; i < READER_COUNT; i++)
+		threads.push_back(std::thread(Reader, &reads[i], &failed[i]));
+	threads.push_back(std::thread(Producer));
+	for (auto &t : threads)
+		t.join();
+
+	uint32_t total = 0;
+	uint32_t total_failed = 0;
+	for (int i = 0; i < READER_COUNT; i++)
+	{
+		total += reads[i];
+		total_failed += failed[i];
+	}
+
+	// Dernière publication
+	Test_Data data = Test_Snapshot.Get();
+	if (!Is_Consistent(data) || (data.Value[0] != PUBLISH_COUNT) || (Test_Snapshot.GetCount() != PUBLISH_COUNT))
+		Errors++;
+
+	printf("Snapshot : %u publications, %u lectures, %u Read() en échec, %u erreurs\n", PUBLISH_COUNT, total,
+			total_failed, Errors.load());
+	if (Errors != 0)
+	{
+		printf("ECHEC : copie incohérente ou donnée modifiée\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,360 @@
+/**
+ * Test de TeleInfo (Library/TeleInfo) : relecture de trames des modes historique et standard
+ *
+ * Le compteur est une ligne série simulée (Replay_Line) branchée sur l'UART 1 créé par TeleInfo.
+ * Les caractères arrivent au rythme de la vitesse de la ligne dans le temps simulé (millis de Sim_Core),
+ * le temps avance de 1 ms à chaque lecture du port sans caractère (la tâche attend).
+ * Si la vitesse du port n'est pas celle de la ligne, le port reçoit des caractères sans signification.
+ * On vérifie les valeurs décodées, le rejet d'un groupe au checksum faux, les notifications
+ * et le délai du changement de vitesse automatique.
+ */
+#include "Arduino.h"
+#include "config_lib.h"
+#include "TeleInfo.h"
+#include "Sim_Core.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <deque>
+
+#define TI_RX_GPIO	14
+#define TI_UART	1
+#define FRAME_GAP_ms	20    // Entre deux trames (16,7 à 33,4 ms en mode historique)
+#define UART_RX_SIZE	256   // Taille du buffer de réception de l'UART
+
+// Trames relevées (voir l'en-tête de TeleInfo.h)
+static const char *Captured_Historic = "\nADCO 040622146651 <\r\nOPTARIF BASE 0\r\nISOUSC 15 <\r"
+		"\nBASE 029757986 @\r\nPTEC TH.. $\r\nIINST 000 W\r\nIMAX 003 B\r\nPAPP 00000 !\r\nMOTDETAT 000000 B\r";
+static const char *Captured_Standard = "\nADSC\t041876097353\tB\r\nDATE\tE230415101523\t\t9\r"
+		"\nEAST\t001234567\t+\r\nSINSTS\t01234\tP\r\nSMAXSN\tE230415063012\t04512\t1\r";
+
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+static bool Same(const char *value, const char *expected)
+{
+	return (value != NULL) && (strcmp(value, expected) == 0);
+}
+
+// ********************************************************************************
+// Construction des groupes, checksum de la spécification Enedis
+// ********************************************************************************
+
+static char Checksum(const std::string &body)
+{
+	uint8_t sum = 0;
+	for (char c : body)
+		sum += (uint8_t) c;
+	return (char) ((sum & 0x3F) + 0x20);
+}
+
+// Historique : le checksum porte sur "étiquette SP donnée"
+static std::string Historic(const char *label, const std::string &data)
+{
+	std::string body = std::string(label) + " " + data;
+	return "\n" + body + " " + Checksum(body) + "\r";
+}
+
+// Standard : le checksum porte sur "étiquette HT [horodate HT] donnée HT"
+static std::string Standard(const char *label, const std::string &data, const char *date = NULL)
+{
+	std::string body = std::string(label) + "\t" + ((date) ? std::string(date) + "\t" : "") + data + "\t";
+	return "\n" + body + Checksum(body) + "\r";
+}
+
+// ********************************************************************************
+// Le compteur : envoie les trames dans l'ordre, la dernière est répétée
+// ********************************************************************************
+
+class Replay_Line: public Sim_Serial_Line
+{
+	public:
+		uint32_t Baud_Changes = 0;
+		uint32_t Switch_ms = 0;      // Dernier changement de vitesse du port
+		uint32_t Frames_Sent = 0;    // Trames complètes envoyées
+
+		Replay_Line(unsigned long baud, const std::vector<std::string> &frames, uint32_t silent_ms = 0) :
+				Baud(baud), Frames(frames)
+		{
+			Next_us = Sim_Now_us() + (uint64_t) silent_ms * 1000;
+			Load_Frame();
+			Sim_Serial_Port(TI_UART) = this;
+		}
+		~Replay_Line()
+		{
+			Sim_Serial_Port(TI_UART) = NULL;
+		}
+
+		int available(unsigned long baud)
+		{
+			Receive(baud);
+			if (Rx.empty())
+			{
+				Sim_Advance_us(1000);
+				Receive(baud);
+			}
+			return Rx.size();
+		}
+
+		int read(unsigned long baud)
+		{
+			Receive(baud);
+			if (Rx.empty())
+				return -1;
+			uint8_t c = Rx.front();
+			Rx.pop_front();
+			return c;
+		}
+
+	private:
+		unsigned long Baud;
+		unsigned long Port_Baud = 0;
+		std::vector<std::string> Frames;
+		std::string Frame;
+		size_t Frame_Pos = 0;
+		uint32_t Frame_Index = 0;
+		uint64_t Next_us;
+		std::deque<uint8_t> Rx;
+		uint32_t Seed = 12345;
+
+		void Load_Frame(void)
+		{
+			Frame = "\x02" + Frames[Frame_Index] + "\x03";
+			Frame_Pos = 0;
+			if (Frame_Index + 1 < Frames.size())
+				Frame_Index++;
+		}
+
+		uint8_t Garbage(void)
+		{
+			Seed = Seed * 1103515245 + 12345;
+			return (Seed >> 16) & 0xFF;
+		}
+
+		// Les caractères émis par le compteur jusqu'à maintenant
+		void Receive(unsigned long baud)
+		{
+			if (baud != Port_Baud)
+			{
+				if (Port_Baud != 0)
+				{
+					Baud_Changes++;
+					Switch_ms = millis();
+				}
+				Port_Baud = baud;
+			}
+
+			bool match = (baud == Baud);
+			// Mauvaise vitesse : un caractère au rythme de la plus lente
+			uint64_t char_us = 10000000 / ((match || (Baud < baud)) ? Baud : baud);
+			while (Next_us <= Sim_Now_us())
+			{
+				uint8_t c = Frame[Frame_Pos++];
+				if (Rx.size() < UART_RX_SIZE)
+					Rx.push_back((match) ? c : Garbage());
+				Next_us += char_us;
+				if (Frame_Pos == Frame.size())
+				{
+					Frames_Sent++;
+					Next_us += FRAME_GAP_ms * 1000;
+					Load_Frame();
+				}
+			}
+		}
+};
+
+// Attend une nouvelle trame valide avec Process(), au plus timeout_ms
+static bool Wait_Frame(TeleInfo &TI, uint32_t timeout_ms)
+{
+	uint32_t start = millis();
+	TI.ResetAvailable();
+	while (!TI.Available() && (millis() - start < timeout_ms))
+		TI.Process();
+	return TI.Available();
+}
+
+// ********************************************************************************
+// Les tests
+// ********************************************************************************
+
+static void Test_Historic_Captured(void)
+{
+	Replay_Line line(TI_BAUD_HISTORIC, {Captured_Historic});
+	TeleInfo TI(TI_RX_GPIO, 10000, TI_BAUD_HISTORIC);
+	uint32_t start = millis();
+
+	Check(TI.Configure(5000), "historique : configuration");
+	// Une trame complète reçue après le début de trame (au plus 2 trames)
+	Check(millis() - start < 2 * 1200 + 100, "historique : délai de configuration");
+	Check(TI.getMode() == TI_Historic, "historique : mode");
+	Check(TI.getPowerVA() == 0, "historique : puissance");
+	Check(TI.getIndexWh() == 29757986, "historique : index");
+	Check(Same(TI.getPowerVA_str(), "00000"), "historique : puissance (texte)");
+	Check(Same(TI.getIndexWh_str(), "029757986"), "historique : index (texte)");
+	Check(Same(TI.getStringVal("ADCO"), "040622146651"), "historique : ADCO");
+	Check(Same(TI.getStringVal("PTEC"), "TH.."), "historique : PTEC");
+	Check(TI.getLongVal("ISOUSC") == 15, "historique : ISOUSC");
+	Check(Same(TI.getDateVal("PAPP"), ""), "historique : pas d'horodate");
+	Check((TI.getStringVal("SINSTS") == NULL) && (TI.getLongVal("SINSTS") < 0), "historique : étiquette absente");
+}
+
+static void Test_Standard_Captured(void)
+{
+	Replay_Line line(TI_BAUD_STANDARD, {Captured_Standard});
+	TeleInfo TI(TI_RX_GPIO, 10000, TI_BAUD_AUTO);
+	uint32_t start = millis();
+
+	// Le timeout est porté à TI_CONFIGURE_MS en vitesse automatique
+	Check(TI.Configure(1000), "standard : configuration en vitesse automatique");
+	// Ecoute à 1200 bauds pendant TI_AUTO_BAUD_MS après la reprise (100 ms) puis 9600 bauds
+	uint32_t switch_ms = line.Switch_ms - start;
+	if ((line.Baud_Changes != 1) || (switch_ms < 100 + TI_AUTO_BAUD_MS) || (switch_ms > 100 + TI_AUTO_BAUD_MS + 10))
+		printf("  %u changements de vitesse, le dernier à %u ms\n", line.Baud_Changes, switch_ms);
+	Check(line.Baud_Changes == 1, "standard : un seul changement de vitesse");
+	Check((switch_ms >= 100 + TI_AUTO_BAUD_MS) && (switch_ms <= 100 + TI_AUTO_BAUD_MS + 10),
+			"standard : changement de vitesse après TI_AUTO_BAUD_MS");
+	Check(millis() - start < 100 + TI_AUTO_BAUD_MS + 500, "standard : délai de configuration");
+	Check(TI.getMode() == TI_Standard, "standard : mode");
+	Check(TI.getPowerVA() == 1234, "standard : puissance");
+	Check(TI.getIndexWh() == 1234567, "standard : index");
+	Check(TI.getLongVal("SINSTS") == 1234, "standard : SINSTS");
+	Check(Same(TI.getStringVal("ADSC"), "041876097353"), "standard : ADSC");
+	Check(Same(TI.getStringVal("DATE"), "") && Same(TI.getDateVal("DATE"), "E230415101523"), "standard : DATE");
+	Check((TI.getLongVal("SMAXSN") == 4512) && Same(TI.getDateVal("SMAXSN"), "E230415063012"),
+			"standard : SMAXSN horodaté");
+	Check(Same(TI.getDateVal("EAST"), ""), "standard : EAST sans horodate");
+}
+
+/**
+ * Le pire cas de la vitesse automatique : le compteur historique ne répond pas pendant l'essai à 1200 bauds,
+ * l'essai à 9600 bauds échoue et la trame arrive au retour à 1200 bauds, dans le délai TI_CONFIGURE_MS
+ */
+static void Test_Auto_Baud_Worst_Case(void)
+{
+	{
+		Replay_Line line(TI_BAUD_HISTORIC, {Captured_Historic}, 100 + TI_AUTO_BAUD_MS + 500);
+		TeleInfo TI(TI_RX_GPIO, 10000, TI_BAUD_AUTO);
+		uint32_t start = millis();
+
+		Check(TI.Configure(1000), "vitesse automatique : configuration au retour à 1200 bauds");
+		Check(line.Baud_Changes == 2, "vitesse automatique : retour à 1200 bauds");
+		// La reprise de l'écoute (100 ms) puis TI_CONFIGURE_MS au plus
+		Check(millis() - start <= 100 + TI_CONFIGURE_MS, "vitesse automatique : délai TI_CONFIGURE_MS");
+		Check((TI.getMode() == TI_Historic) && (TI.getIndexWh() == 29757986), "vitesse automatique : trame historique");
+	}
+
+	// Pas de compteur : échec après TI_CONFIGURE_MS
+	{
+		Replay_Line line(TI_BAUD_HISTORIC, {Captured_Historic}, 1000000);
+		TeleInfo TI(TI_RX_GPIO, 10000, TI_BAUD_AUTO);
+		uint32_t start = millis();
+
+		Check(!TI.Configure(1000), "sans compteur : échec de la configuration");
+		uint32_t elapsed = millis() - start;
+		Check((elapsed >= 100 + TI_CONFIGURE_MS) && (elapsed <= 100 + TI_CONFIGURE_MS + 10),
+				"sans compteur : délai TI_CONFIGURE_MS");
+	}
+}
+
+/**
+ * Suite de trames historiques (option heures creuses) traitées par Process()
+ * La trame 2 a un checksum faux : elle est ignorée. La trame 5 a une nouvelle étiquette.
+ */
+static std::vector<int32_t> Notified;
+
+static void onPower(const char *label, const char *data, int32_t value)
+{
+	if ((strcmp(label, "PAPP") != 0) || (atol(data) != value))
+		Errors++;
+	Notified.push_back(value);
+}
+
+static std::string Historic_HC(int power, const char *extra = NULL)
+{
+	char papp[6];
+	snprintf(papp, sizeof(papp), "%05d", power);
+	std::string frame = Historic("ADCO", "040622146651") + Historic("OPTARIF", "HC..") + Historic("ISOUSC", "45")
+			+ Historic("HCHC", "001234000") + Historic("HCHP", "000005678") + Historic("PTEC", "HP..")
+			+ Historic("IINST", "003") + Historic("PAPP", papp);
+	if (extra)
+		frame += Historic(extra, "00");
+	return frame + Historic("MOTDETAT", "000000");
+}
+
+static void Test_Historic_Process(void)
+{
+	// Checksum faux dans la trame 2 : PAPP 00200 avec le checksum de PAPP 00100
+	std::string bad = Historic_HC(200);
+	std::string good_100 = Historic("PAPP", "00100");
+	size_t pos = bad.find("PAPP");
+	bad[pos + 11] = good_100[12];
+
+	Replay_Line line(TI_BAUD_HISTORIC, {Historic_HC(100), bad, Historic_HC(300), Historic_HC(300),
+			Historic_HC(400, "ADPS")});
+	TeleInfo TI(TI_RX_GPIO, 10000, TI_BAUD_HISTORIC);
+
+	Notified.clear();
+	Check(TI.Subscribe("PAPP", onPower), "abonnement à PAPP");
+	Check(TI.Configure(5000), "heures creuses : configuration");
+	Check((TI.getPowerVA() == 100) && (TI.getIndexWh() == 1234000 + 5678), "heures creuses : trame 1");
+
+	Check(Wait_Frame(TI, 5000), "heures creuses : trame suivante");
+	Check(line.Frames_Sent >= 3, "heures creuses : trame 2 ignorée");
+	Check(TI.getPowerVA() == 300, "heures creuses : puissance de la trame 3");
+
+	Check(Wait_Frame(TI, 5000) && (TI.getPowerVA() == 300), "heures creuses : trame 4");
+	Check(TI.getLongVal("ADPS") < 0, "heures creuses : ADPS absent");
+	Check(Wait_Frame(TI, 5000) && (TI.getPowerVA() == 400), "heures creuses : trame 5");
+	Check(TI.getLongVal("ADPS") == 0, "heures creuses : nouvelle étiquette ADPS");
+
+	// Une notification à la première trame puis à chaque changement
+	Check((Notified.size() == 3) && (Notified[0] == 100) && (Notified[1] == 300) && (Notified[2] == 400),
+			"notifications de PAPP");
+	TI.Unsubscribe("PAPP");
+}
+
+/**
+ * Trames standard avec une donnée plus longue que DATA_MAX_SIZE (tronquée) et un index qui change
+ */
+static std::string Standard_Frame(int power, int index)
+{
+	char sinsts[6], east[10];
+	snprintf(sinsts, sizeof(sinsts), "%05d", power);
+	snprintf(east, sizeof(east), "%09d", index);
+	std::string pjourf = "00008001 NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE NONUTILE"
+			" NONUTILE NONUTILE";
+	return Standard("ADSC", "041876097353") + Standard("DATE", "", "E230415101523") + Standard("EAST", east)
+			+ Standard("SINSTS", sinsts) + Standard("PJOURF+1", pjourf) + Standard("MSG1", "PAS DE          MESSAGE         ");
+}
+
+static void Test_Standard_Process(void)
+{
+	Replay_Line line(TI_BAUD_STANDARD, {Standard_Frame(500, 1000), Standard_Frame(2500, 1001)});
+	TeleInfo TI(TI_RX_GPIO, 10000, TI_BAUD_STANDARD);
+
+	Check(TI.Configure(5000), "standard 9600 : configuration");
+	Check(Wait_Frame(TI, 5000) && (TI.getPowerVA() == 2500) && (TI.getIndexWh() == 1001), "standard 9600 : trame 2");
+	Check(Same(TI.getStringVal("PJOURF+1"), "00008001 NONUTILE NONUTILE NONUT"), "standard 9600 : donnée tronquée");
+	Check(Same(TI.getStringVal("MSG1"), "PAS DE          MESSAGE         "), "standard 9600 : MSG1");
+}
+
+int main(void)
+{
+	Test_Historic_Captured();
+	Test_Standard_Captured();
+	Test_Auto_Baud_Worst_Case();
+	Test_Historic_Process();
+	Test_Standard_Process();
+
+	if (Errors == 0)
+		printf("TeleInfo : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
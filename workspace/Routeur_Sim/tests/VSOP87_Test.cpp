@@ -0,0 +1,150 @@
+/**
+ * Test de vsop87 (Library/Emul_PV) : coordonnées héliocentriques de la Terre
+ *
+ * - Exemple 25.b de Meeus (13/10/1992 à 0h TD, JDE 2448908.5) : L = 19,907372° avant la
+ * correction FK5, 19,907347° après, B = -0,62" et R = 0,99760775 ua avec les séries du livre.
+ * Avec les séries complètes, R = 0,99760853 ua (valeur donnée par Meeus) et L, B restent dans la
+ * précision des séries tronquées du livre (1" en L, 0,15" en B).
+ * - L'ancien évaluateur (somme par puissance de tau arrêtée au premier terme nul, puis
+ * r0 + tau.(r1 + tau.(...))) est refait ici sur les mêmes séries : TVSOP_Calc et earth_coord
+ * doivent donner exactement les mêmes valeurs de 1800 à 2100 (tous les 3,17 jours, 13,7 jours
+ * avec les séries complètes).
+ *
+ * Compilé avec les séries de Meeus (par défaut) et avec VSOP87_FULL.
+ */
+#include "vsop87.h"
+#include <stdio.h>
+#include <math.h>
+
+extern const TVSOPSeries vsop87_ear_r[];
+extern const uint8_t vsop87_ear_r_count;
+extern const TVSOPSeries vsop87_ear_b[];
+extern const uint8_t vsop87_ear_b_count;
+extern const TVSOPSeries vsop87_ear_l[];
+extern const uint8_t vsop87_ear_l_count;
+
+double TVSOP_Calc(const TVSOPSeries *series, uint8_t count);
+void TVSOP_DynamicToFK5(double *longitude, double *latitude);
+
+// Nombre de séries dans les tables (r5 et b2 à b4 sont un terme nul avec les séries de Meeus)
+#define R_SERIES	6
+#define B_SERIES	5
+#define L_SERIES	6
+
+#ifdef VSOP87_FULL
+#define R_MEEUS	0.99760853
+#define STEP	13.7
+#else
+#define R_MEEUS	0.99760775
+#define STEP	3.17
+#endif
+
+static uint32_t Errors = 0;
+
+static void Check(bool condition, const char *message)
+{
+	if (!condition)
+	{
+		printf("ECHEC : %s\n", message);
+		Errors++;
+	}
+}
+
+// L'ancien TVSOP_Calc : un terme hors de la série vaut 0 et arrête la somme de la puissance
+static double Old_Calc(const TVSOPSeries *series, uint8_t series_count, double t)
+{
+	double r[6];
+
+	for (uint8_t j = 0; j < 6; j++)
+	{
+		double current;
+		int i = 0;
+		r[j] = 0;
+		do
+		{
+			current = 0;
+			if ((j < series_count) && (i < series[j].size))
+				current = series[j].terms[i][0] * cos(series[j].terms[i][1] + series[j].terms[i][2] * t);
+			r[j] += current;
+			i++;
+		} while (current != 0);
+	}
+	return (r[0] + t * (r[1] + t * (r[2] + t * (r[3] + t * (r[4] + t * r[5]))))) * 1e-8;
+}
+
+static void Old_Earth_Coord(TDateTime date, double *l, double *b, double *r)
+{
+	double t = (date - 36526 - 0.5) / 365250.0;
+
+	*r = Old_Calc(vsop87_ear_r, R_SERIES, t);
+	*l = Old_Calc(vsop87_ear_l, L_SERIES, t);
+	*b = Old_Calc(vsop87_ear_b, B_SERIES, t);
+	TVSOP_DynamicToFK5(l, b);
+	*l = Put_in_360(RadToDeg(*l));
+	*b = RadToDeg(*b);
+}
+
+static void Test_Meeus(void)
+{
+	TDateTime date;
+	double l, b, r;
+
+	Check(EncodeDate(1992, 10, 13, &date), "date de l'exemple");
+	earth_coord(date, &l, &b, &r);
+	printf("Exemple 25.b : L = %.6f°, B = %.3f\", R = %.8f ua\n", l, b * 3600, r);
+
+	// Avant la correction FK5, avec les séries de Meeus
+	double t = (date - 36526 - 0.5) / 365250.0;
+	double l_dynamic = Put_in_360(RadToDeg(Old_Calc(vsop87_ear_l, L_SERIES, t)));
+#ifdef VSOP87_MEEUS
+	Check(fabs(l_dynamic - 19.907372) < 1e-6, "exemple 25.b : L avant FK5");
+	Check(fabs(l - 19.907347) < 1e-6, "exemple 25.b : L");
+	Check(fabs(b * 3600 + 0.62) < 0.005, "exemple 25.b : B");
+#else
+	// Les séries complètes : dans la précision des séries tronquées de Meeus
+	(void) l_dynamic;
+	Check(fabs(l - 19.907347) * 3600 < 1.0, "exemple 25.b : L");
+	Check(fabs(b * 3600 + 0.62) < 0.15, "exemple 25.b : B");
+#endif
+	Check(fabs(r - R_MEEUS) < 1e-8, "exemple 25.b : R");
+}
+
+static void Test_Old_Evaluator(void)
+{
+	TDateTime start, end;
+	uint32_t dates = 0, different = 0;
+
+	EncodeDate(1800, 1, 1, &start);
+	EncodeDate(2100, 1, 1, &end);
+	for (TDateTime date = start; date < end; date += STEP)
+	{
+		double l, b, r;
+		double old_l, old_b, old_r;
+		double t = (date - 36526 - 0.5) / 365250.0;
+
+		earth_coord(date, &l, &b, &r);
+		Old_Earth_Coord(date, &old_l, &old_b, &old_r);
+		// earth_coord vient de régler tau pour TVSOP_Calc
+		if ((l != old_l) || (b != old_b) || (r != old_r)
+				|| (TVSOP_Calc(vsop87_ear_r, vsop87_ear_r_count) != Old_Calc(vsop87_ear_r, R_SERIES, t))
+				|| (TVSOP_Calc(vsop87_ear_b, vsop87_ear_b_count) != Old_Calc(vsop87_ear_b, B_SERIES, t))
+				|| (TVSOP_Calc(vsop87_ear_l, vsop87_ear_l_count) != Old_Calc(vsop87_ear_l, L_SERIES, t)))
+		{
+			if (different++ < 5)
+				printf("  %.2f : L %.9f / %.9f, B %.9f / %.9f, R %.10f / %.10f\n", date, l, old_l, b, old_b, r, old_r);
+		}
+		dates++;
+	}
+	printf("Ancien évaluateur : %u dates de 1800 à 2100, %u différentes\n", dates, different);
+	Check(different == 0, "mêmes coordonnées que l'ancien évaluateur");
+}
+
+int main(void)
+{
+	Test_Meeus();
+	Test_Old_Evaluator();
+
+	if (Errors == 0)
+		printf("VSOP87 : OK\n");
+	return (Errors == 0) ? 0 : 1;
+}
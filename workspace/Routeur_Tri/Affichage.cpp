@@ -4,6 +4,9 @@
 
 #include "RTCLocal.h"
 #include "Server_utils.h"
+#ifdef USE_SERVER_PUSH
+#include "Server_Push.h"
+#endif
 #include "Debug_utils.h"
 #include "display.h"
 #include "SSR.h"
@@ -69,7 +72,7 @@ page_typedef operator ++(page_typedef &id, int)
 extern ServerConnexion myServer;
 
 // Data
-extern Data_Struct Current_Data;
+extern Snapshot<Data_Struct> Data_Snapshot;
 
 // PV théorique
 extern EmulPV_Class emul_PV;
@@ -103,6 +106,9 @@ int Action_Wifi = 0;
 
 int Count_Action_Needed = 0;
 
+// Mode de régulation (zéro ou burst) à reprendre à l'arrêt du boost
+static SSR_Action_typedef Action_Before_Boost = SSR_Action_Surplus;
+
 /**
  * Définition des leds PCF8574
  */
@@ -249,10 +255,11 @@ void PCF8574_Keyboard_Action(uint8_t Btn_Clicked)
 					case menuSSR:
 						if (Action_Needed)
 						{
-							if (SSR_Get_Action() == SSR_Action_Surplus)
+							if ((SSR_Get_Action() == SSR_Action_Surplus) || (SSR_Get_Action() == SSR_Action_Burst))
 							{
 								if (Cursor_Pos == 0)
 								{
+									Action_Before_Boost = SSR_Get_Action();
 									SSR_Set_Action(SSR_Action_FULL, true);
 									TaskList.ResumeTask("SSR_BOOST_Task");
 								}
@@ -262,7 +269,7 @@ void PCF8574_Keyboard_Action(uint8_t Btn_Clicked)
 							else
 							{
 								TaskList.SuspendTask("SSR_BOOST_Task");
-								SSR_Set_Action(SSR_Action_Surplus, true);
+								SSR_Set_Action(Action_Before_Boost, true);
 							}
 							Action_Needed = false;
 							Cursor_Pos = 0;
@@ -499,30 +506,31 @@ void Show_Page_Test(void)
 void Show_Page1(void)
 {
 	uint8_t line = 0;
+	Data_Struct data = Data_Snapshot.Get();
 
 	// date
 	IHM_Print(line++, 6, (char*) RTC_Local.the_time(), false);
 	line++;
 
 	// Puissance phase 1, 2, 3
-	Fast_Printf(&buffer[0], Current_Data.Phase1.ActivePower, 2, "P ph1 : ", " W", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Phase1.ActivePower, 2, "P ph1 : ", " W", Buffer_End, &len);
 	IHM_Print(line++, 0, buffer, false);
 
-	Fast_Printf(&buffer[0], Current_Data.Phase2.ActivePower, 2, "P ph2 : ", " W", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Phase2.ActivePower, 2, "P ph2 : ", " W", Buffer_End, &len);
 	IHM_Print(line++, 0, buffer, false);
 
-	Fast_Printf(&buffer[0], Current_Data.Phase3.ActivePower, 2, "P ph3 : ", " W", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Phase3.ActivePower, 2, "P ph3 : ", " W", Buffer_End, &len);
 	IHM_Print(line++, 0, buffer, false);
 
-	Fast_Printf(&buffer[0], Current_Data.Production.ActivePower, 2, "P prod : ", " W", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Production.ActivePower, 2, "P prod : ", " W", Buffer_End, &len);
 	IHM_Print(line++, 0, buffer, false);
 
-	Fast_Printf(&buffer[0], Current_Data.get_total_power(), 2, "P tot : ", " W", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.get_total_power(), 2, "P tot : ", " W", Buffer_End, &len);
 	IHM_Print(line++, 0, buffer, false);
 
 	// Puissance Talema
 	IHM_Print(line++, 1, "P Talema : ", false);
-	Fast_Printf(&buffer[0], Current_Data.Talema_Power, 2, "", " W", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Talema_Power, 2, "", " W", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// Afficher Idle
@@ -534,29 +542,31 @@ void Show_Page1(void)
 void Show_Page2(void)
 {
 	uint8_t line = 0;
+	Data_Struct data = Data_Snapshot.Get();
 
 	IHM_Print(line++, 5, "Energie", false);
 	line++;
 
 	// Energie conso
 	IHM_Print(line++, 1, "E conso : ", false);
-	Fast_Printf(&buffer[0], Current_Data.energy_day_conso, 2, "", " Wh", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.energy_day_conso, 2, "", " Wh", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// Energie surplus
 	IHM_Print(line++, 1, "E surplus : ", false);
-	Fast_Printf(&buffer[0], Current_Data.energy_day_surplus, 2, "", " Wh", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.energy_day_surplus, 2, "", " Wh", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// Energie prod
 	IHM_Print(line++, 1, "E prod : ", false);
-	Fast_Printf(&buffer[0], *Current_Data.energy_day_prod, 2, "", " Wh", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.get_energy_day_prod(), 2, "", " Wh", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 }
 
 void Show_Page3(void)
 {
 	uint8_t line = 0;
+	Data_Struct data = Data_Snapshot.Get();
 
 	// Température
 	IHM_Print(line++, 5, "Temperature", false);
@@ -564,53 +574,55 @@ void Show_Page3(void)
 
 	// Cirrus
 	IHM_Print(line++, 1, "Cirrus : ", false);
-	Fast_Printf(&buffer[0], Current_Data.Cirrus2_Temp, 2, "", " `C", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Cirrus2_Temp, 2, "", " `C", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// DS18B20
 	IHM_Print(line++, 1, "DS18B20 interne : ", false);
-	Fast_Printf(&buffer[0], Current_Data.DS18B20_Int, 2, "", " `C", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.DS18B20_Int, 2, "", " `C", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// DS18B20
 	IHM_Print(line++, 1, "DS18B20 externe : ", false);
-	Fast_Printf(&buffer[0], Current_Data.DS18B20_Ext, 2, "", " `C", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.DS18B20_Ext, 2, "", " `C", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 }
 
 void Show_Page4(void)
 {
 	uint8_t line = 0;
+	Data_Struct data = Data_Snapshot.Get();
 
 	// Tension phase 1, 2, 3
-	Fast_Printf(&buffer[0], Current_Data.Phase1.Voltage, 2, "U ph1 : ", " V", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Phase1.Voltage, 2, "U ph1 : ", " V", Buffer_End, &len);
 	IHM_Print(line++, 0, buffer, false);
 
-	Fast_Printf(&buffer[0], Current_Data.Phase2.Voltage, 2, "U ph2 : ", " V", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Phase2.Voltage, 2, "U ph2 : ", " V", Buffer_End, &len);
 	IHM_Print(line++, 0, buffer, false);
 
-	Fast_Printf(&buffer[0], Current_Data.Phase3.Voltage, 2, "U ph3 : ", " V", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Phase3.Voltage, 2, "U ph3 : ", " V", Buffer_End, &len);
 	IHM_Print(line++, 0, buffer, false);
 
 	// Cosphi
 	IHM_Print(line++, 1, "Cosphi ph2 : ", false);
-	Fast_Printf(&buffer[0], Current_Data.Cirrus2_PF, 2, "", "", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Cirrus2_PF, 2, "", "", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// Puissance apparente
 	IHM_Print(line++, 1, "P apparente ph2 : ", false);
-	Fast_Printf(&buffer[0], Current_Data.Phase2.ApparentPower, 2, "", " VA", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Phase2.ApparentPower, 2, "", " VA", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// Puissance TI
 	IHM_Print(line++, 1, "P compteur TI : ", false);
-	Fast_Printf(&buffer[0], Current_Data.TI_Power, 0, "", " VA", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.TI_Power, 0, "", " VA", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 }
 
 void Show_Page5(void)
 {
 	uint8_t line = 0;
+	Data_Struct data = Data_Snapshot.Get();
 
 	// Température
 	IHM_Print(line++, 5, "PV info", false);
@@ -618,12 +630,12 @@ void Show_Page5(void)
 
 	// Puissance prod
 	IHM_Print(line++, 1, "P prod : ", false);
-	Fast_Printf(&buffer[0], Current_Data.Production.ActivePower, 2, "", " W", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Production.ActivePower, 2, "", " W", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// Puissance théorique
 	IHM_Print(line++, 1, "P theorique : ", false);
-	Fast_Printf(&buffer[0], Current_Data.Prod_Th, 2, "", " W", Buffer_End, &len);
+	Fast_Printf(&buffer[0], data.Prod_Th, 2, "", " W", Buffer_End, &len);
 	IHM_Print(line++, COLUMN, buffer, false);
 
 	// Heure lever, coucher Soleil
@@ -685,8 +697,9 @@ void Show_Page_SSR(uint8_t cursor)
 	switch (SSR_Get_Action())
 	{
 		case SSR_Action_Surplus:
+		case SSR_Action_Burst:
 			if (SSR_Get_State() != SSR_OFF)
-				IHM_Print(3, 1, "SSR ON", false);
+				IHM_Print(3, 1, (SSR_Get_Action() == SSR_Action_Burst) ? "SSR BURST ON" : "SSR ON", false);
 			else
 				IHM_Print(3, 1, "SSR OFF", false);
 			IHM_Print(5, 1, "Boost CE (1 h)", false);
@@ -712,6 +725,7 @@ void Show_Page_SSR_Action(uint8_t cursor)
 	switch (SSR_Get_Action())
 	{
 		case SSR_Action_Surplus:
+		case SSR_Action_Burst:
 			if (cursor == 0)
 				IHM_Print(3, 1, "Boost CE (1 h)", false);
 			else
@@ -736,6 +750,9 @@ void Show_Page_Wifi(void)
 	IHM_Print(4, 1, myServer.getCurrentRSSI().c_str(), false);
 	if (getESPMacAddress(mac))
 		IHM_Print(5, 1, mac.c_str(), false);
+#ifdef USE_SERVER_PUSH
+	IHM_Print(6, 1, Server_Push_Info().c_str(), false);
+#endif
 
 	IHM_Print(7, 1, "Reset Wifi ?", false);
 }
@@ -17,6 +17,11 @@
 #endif
 #include "Fast_Printf.h"
 #include "Emul_PV.h"
+#include "TimeSeries.h"
+#ifdef USE_SERVER_PUSH
+#include "Server_Push.h"
+extern void Push_Last_Data(void);
+#endif
 
 #ifdef CIRRUS_USE_TASK
 #include "Tasks_utils.h"
@@ -47,14 +52,22 @@ extern EmulPV_Class emul_PV;
 // Calcul des extra data : TI, ADC, PV
 int ExtraDataCount = 1;
 
-// data au format CSV
-const String CSV_Filename = "/data.csv";
+// data du jour au format binaire, exporté en CSV à la demande (/getCSV) et au changement de jour
+// U1, P1, U2, P2, U3, P3, Pprod, Temp, DS_Int, DS_Ext, E_conso, E_surplus, E_prod
+// Les fichiers du jour non exportés (/yy-mm-dd.tsb) ont les mêmes colonnes
+#define DATA_TS_COLUMNS	{{TS_Int16, 0.01}, {TS_Int16, 1.0}, {TS_Int16, 0.01}, {TS_Int16, 1.0}, \
+		{TS_Int16, 0.01}, {TS_Int16, 1.0}, {TS_Int16, 1.0}, {TS_Int16, 0.01}, {TS_Int16, 0.01}, {TS_Int16, 0.01}, \
+		{TS_Int32, 0.01}, {TS_Int32, 0.01}, {TS_Int32, 0.01}}
+TimeSeries Data_TS("/data.tsb", DATA_TS_COLUMNS);
 String Energy_Filename = "/energy_2025.csv";
 String Energy_Heading = "Date\tE_Conso\tE_Surplus\tE_Prod\r\n";
 
 // Data 200 ms
 Data_Struct Current_Data; //{0,{0}};
 
+// Les données publiées pour les autres tâches (web, affichage, log, ESP Now, ...)
+Snapshot<Data_Struct> Data_Snapshot;
+
 // Les données actualisées pour le SSR
 #ifdef USE_SSR
 extern Gestion_SSR_TypeDef Gestion_SSR_CallBack;
@@ -70,6 +83,10 @@ extern CIRRUS_CS548x CS5484;
 // Booléen indiquant une acquisition de donnée en cours
 bool Data_acquisition = false;
 
+// Remise à zéro des énergies du jour demandée au changement de jour (task RTC),
+// faite par la task Cirrus au début du prochain Get_Data() (voir Restart_Energy())
+static volatile bool Energy_Restart_Request = false;
+
 // Gestion énergie
 uint32_t Cumul_time = millis();
 #ifdef USE_ADC
@@ -79,8 +96,8 @@ Talema_Params_Typedef TalemaParams = {Phase1};
 float *TalemaPhase = &Current_Data.Phase1.Voltage;
 
 // Gestion log pour le graphique
-volatile Graphe_Data log_cumul;
-bool log_new_data = false;
+Graphe_Data log_cumul;
+Snapshot<Graphe_Data> Log_Snapshot;
 
 // Sauvegarde du log
 volatile SemaphoreHandle_t logSemaphore = NULL;
@@ -111,6 +128,7 @@ void UpdateLedSurplus(float power);
 void GetExtraData(void);
 void append_data(void);
 void append_energy(uint8_t year, bool restart);
+void Restart_Energy(void);
 void AddFileToListFile(StringList_td &list, const String &file);
 
 // Function for debug message, may be redefined elsewhere
@@ -177,6 +195,13 @@ void Get_Data(void)
 	CIRRUS_CS548x *CurrentCirrus;
 	Data_acquisition = true;
 
+	// Nouveau jour : les énergies repartent de zéro
+	if (Energy_Restart_Request)
+	{
+		Energy_Restart_Request = false;
+		Restart_Energy();
+	}
+
 	// Sélection du premier cirrus : CS5484, phase 1 et 3
 	CurrentCirrus = (CIRRUS_CS548x*) CS_Com.SelectCirrus(0, Channel_1);
 	log1 = CurrentCirrus->GetData(Channel_all);
@@ -277,6 +302,9 @@ void Get_Data(void)
 	// Get extra data
 	GetExtraData();
 
+	// Publication des données pour les autres tâches
+	Data_Snapshot.Publish(Current_Data);
+
 	// Log
 	if (log1 && log2)
 	{
@@ -296,9 +324,9 @@ void Get_Data(void)
 		log_cumul.Power_prod = data.ActivePower;
 
 		log_cumul.Temp = temp;
-
-		// Pour le rafraichissement de la page Internet si connecté
-		log_new_data = true;
+		// Pour le rafraichissement de la page Internet si connecté : chaque client compare
+		// Log_Snapshot.GetCount() avec le dernier compteur vu (voir Get_Last_Data)
+		Log_Snapshot.Publish(log_cumul);
 
 		// Sauvegarde des données, à faire dans une task
 //		append_data();
@@ -310,6 +338,12 @@ void Get_Data(void)
 //	if (ESPNowSemaphore != NULL)
 //		xSemaphoreGive(ESPNowSemaphore);
 
+#ifdef USE_SERVER_PUSH
+	// Une trame par cycle pour les clients abonnés (SSE/WebSocket)
+	if (Server_Push_Count() > 0)
+		Push_Last_Data();
+#endif
+
 	Data_acquisition = false;
 }
 
@@ -399,6 +433,7 @@ uint8_t Update_IHM(const char *first_text, const char *last_text, bool display)
 {
 	char buffer[30];  // Normalement 20 caractères + eol mais on sait jamais
 	uint8_t line = 0;
+	Data_Struct data;
 
 	if (IHM_IsDisplayOff())
 		return line;
@@ -424,23 +459,23 @@ uint8_t Update_IHM(const char *first_text, const char *last_text, bool display)
 	}
 #endif
 
-	sprintf(buffer, "Urms: %.2f", Current_Data.Phase1.Voltage);
+	data = Data_Snapshot.Get();
+
+	sprintf(buffer, "Urms: %.2f", data.Phase1.Voltage);
 	IHM_Print(line++, (char*) buffer);
 
 #ifdef CIRRUS_RMS_FULL
-	sprintf(buffer, "Irms:%.2f  ", Current_Data.Phase1.Current);
+	sprintf(buffer, "Irms:%.2f  ", data.Phase1.Current);
 	IHM_Print(line++, (char*) buffer);
 #endif
 
-	sprintf(buffer, "Prms:%.2f   ", Current_Data.Phase1.ActivePower);
+	sprintf(buffer, "Prms:%.2f   ", data.Phase1.ActivePower);
 	IHM_Print(line++, (char*) buffer);
 
-	float conso, surplus;
-	CS5484.GetEnergy(Channel_1, &conso, &surplus);
-	sprintf(buffer, "Energie:%.2f   ", conso); // energy_day_conso
+	sprintf(buffer, "Energie:%.2f   ", data.Phase1.Energy); // energy_day_conso
 	IHM_Print(line++, (char*) buffer);
 
-	sprintf(buffer, "T:%.2f", Current_Data.Cirrus2_Temp);
+	sprintf(buffer, "T:%.2f", data.Cirrus2_Temp);
 	IHM_Print(line++, (char*) buffer);
 
 	if (strlen(last_text) > 0)
@@ -454,14 +489,23 @@ uint8_t Update_IHM(const char *first_text, const char *last_text, bool display)
 	return line;
 }
 
-bool Get_Last_Data(float *Energy, float *Surplus, float *Prod)
+/**
+ * Les énergies du jour
+ * log_seen : le numéro de la dernière ligne du graphe vue par le client (Log_Snapshot.GetCount()),
+ * mis à jour. Renvoie true si une nouvelle ligne du graphe est disponible pour ce client.
+ */
+bool Get_Last_Data(float *Energy, float *Surplus, float *Prod, uint32_t *log_seen)
 {
-	bool _log_new_data = log_new_data;
-	log_new_data = false;
-	*Energy = Current_Data.energy_day_conso;
-	*Surplus = Current_Data.energy_day_surplus;
-	*Prod = *Current_Data.energy_day_prod;
-	return _log_new_data;
+	Data_Struct data;
+	uint32_t count = Log_Snapshot.GetCount();
+	bool new_log = (count != 0) && (count != *log_seen);
+
+	*log_seen = count;
+	data = Data_Snapshot.Get();
+	*Energy = data.energy_day_conso;
+	*Surplus = data.energy_day_surplus;
+	*Prod = data.get_energy_day_prod();
+	return new_log;
 }
 
 // ********************************************************************************
@@ -474,95 +518,47 @@ void append_data(void)
 	if (Lock_File)
 		return;
 
-	char buffer[255] = {0};
-	char *pbuffer = &buffer[0];
-	uint16_t len;
+	Data_Struct data;
+	Graphe_Data log;
 
-	// Ouvre le fichier en append, le crée s'il n'existe pas
+	data = Data_Snapshot.Get();
+	log = Log_Snapshot.Get();
+
+	float values[] = {log.Voltage_ph1, log.Power_ph1, log.Voltage_ph2, log.Power_ph2, log.Voltage_ph3,
+			log.Power_ph3, log.Power_prod, log.Temp, data.DS18B20_Int, data.DS18B20_Ext, data.energy_day_conso,
+			data.energy_day_surplus, data.get_energy_day_prod()};
+
+	// Ajoute l'enregistrement, crée le fichier s'il n'existe pas
 	Lock_File = true;
-	File temp = Data_Partition->open(CSV_Filename, "a");
-	if (temp)
-	{
-		sprintf(buffer, "%ld", RTC_Local.getUNIXDateTime()); // Copie la date
-		Fast_Set_Decimal_Separator('.');
-		pbuffer = Fast_Pos_Buffer(buffer, "\t", Buffer_End, &len); // On se positionne en fin de chaine
-		pbuffer = Fast_Printf(pbuffer, 2, "\t", Buffer_End, true,
-				{log_cumul.Voltage_ph1, log_cumul.Power_ph1, log_cumul.Voltage_ph2, log_cumul.Power_ph2, log_cumul.Voltage_ph3,
-						log_cumul.Power_ph3, log_cumul.Power_prod});
-
-		// Temperatures, Energy
-		pbuffer = Fast_Printf(pbuffer, 2, "\t", Buffer_End, false,
-				{log_cumul.Temp, Current_Data.DS18B20_Int, Current_Data.DS18B20_Ext, Current_Data.energy_day_conso,
-						Current_Data.energy_day_surplus, *Current_Data.energy_day_prod});
-
-		// End line
-		Fast_Add_EndLine(pbuffer, Buffer_End);
-		Fast_Set_Decimal_Separator(',');
-		temp.print(buffer);
-		temp.close();
-	}
+	Data_TS.Append(RTC_Local.getUNIXDateTime(), values);
 	Lock_File = false;
 //	print_debug("Log save");
 }
 
+/**
+ * Relit les énergies du jour du dernier enregistrement après un reboot
+ * Appelée dans le setup avant la création de la task Cirrus : seul accès à Current_Data
+ * et au Cirrus hors de cette task. Ne pas appeler une fois les tasks lancées.
+ */
 void reboot_energy(void)
 {
-	const int MAX_LINESIZE = 255;
-
 	// On vérifie qu'on n'est pas en train de l'uploader
 	if (Lock_File)
 		return;
 
-	// Ouvre le fichier en read
+	// Lecture directe du dernier enregistrement
 	Lock_File = true;
-	if (Data_Partition->exists(CSV_Filename))
+	uint32_t time;
+	float data[TS_MAX_COLUMNS];
+	if (Data_TS.ReadLast(&time, data))
 	{
-		File temp = Data_Partition->open(CSV_Filename, "r");
-		if (temp)
-		{
-			String strLine = "";
-			char line[MAX_LINESIZE] = {0};
-			char *pbuffer;
-			float data[20]; // to be large
-			int i = 0;
-			// Read until last line
-			while (temp.available())
-			{
-				strLine = temp.readStringUntil('\n');
-			}
-			temp.close();
-
-//			print_debug(strLine);
-
-			// split last line
-			if (!strLine.isEmpty())
-			{
-				strLine.toCharArray(line, MAX_LINESIZE);
-				pbuffer = strtok((char*) line, "\t");
-				while (pbuffer != NULL)
-				{
-					data[i] = strtof(pbuffer, NULL);
-//					print_debug(String(data[i]));
-					pbuffer = strtok(NULL, "\t");
-					i++;
-				}
-			}
-			// The last 3 data is energy
-			if (i > 3)
-			{
-//				// energy_day_conso, energy_day_surplus
-//				CS5480.RestartEnergy(Channel_1, data[i - 3], data[i - 2]);
-//				// energy_day_prod
-//				CS5480.RestartEnergy(Channel_2, data[i - 1]);
-				Current_Data.energy_day_conso = data[i - 3];
-				Current_Data.energy_day_surplus = data[i - 2];
-//				*Current_Data.energy_day_prod = data[i - 1];
-				// On doit ré-initialiser au niveau du Cirrus
-				CS5480.RestartEnergy(Channel_2, data[i - 1], 0);
-			}
-		}
+		// The last 3 data is energy
+		int i = Data_TS.getColumnCount();
+		Current_Data.energy_day_conso = data[i - 3];
+		Current_Data.energy_day_surplus = data[i - 2];
+		// On doit ré-initialiser au niveau du Cirrus
+		CS5480.RestartEnergy(Channel_2, data[i - 1], 0);
 	}
-
 	Lock_File = false;
 }
 
@@ -573,14 +569,25 @@ void append_energy(uint8_t year, bool restart)
 		return;
 
 	char buffer[255] = {0};
-	char *pbuffer = &buffer[0];
 	uint16_t len;
+	Data_Struct data = Data_Snapshot.Get();
 
 	Energy_Filename = "/energy_20" + (String) year + ".csv";
 	// Ouvre le fichier en append, le crée s'il n'existe pas
 	Lock_File = true;
 	bool Exist = Data_Partition->exists(Energy_Filename);
-	File temp = Data_Partition->open(Energy_Filename, "a");
+
+	// On regarde la dernière ligne : si le jour est déjà enregistré (double appel au
+	// changement de jour), on ne l'ajoute pas une deuxième fois
+	char last_line[255] = {0};
+	RTC_Local.getShortDate(buffer); // Copie la date
+	len = strlen(buffer);
+	bool Already_Saved = Exist && (ReadLastLines(Energy_Filename, 1, last_line, 255, true) == 1)
+			&& (strncmp(last_line, buffer, len) == 0) && (last_line[len] == '\t');
+
+	File temp;
+	if (!Already_Saved)
+		temp = Data_Partition->open(Energy_Filename, "a");
 	if (temp)
 	{
 		// Le fichier n'existait pas (nouvelle année), on ajoute la première ligne
@@ -588,35 +595,35 @@ void append_energy(uint8_t year, bool restart)
 			temp.print(Energy_Heading);
 
 		// Time, Econso, Esurplus, Eprod
-		RTC_Local.getShortDate(buffer); // Copie la date
-		Fast_Set_Decimal_Separator('.');
-		pbuffer = Fast_Pos_Buffer(buffer, "\t", Buffer_End, &len); // On se positionne en fin de chaine
-		pbuffer = Fast_Printf(pbuffer, 2, "\t", Buffer_End, false,
-				{Current_Data.energy_day_conso, Current_Data.energy_day_surplus, *Current_Data.energy_day_prod});
-
-		// End line
-		Fast_Add_EndLine(pbuffer, Buffer_End);
-		Fast_Set_Decimal_Separator(',');
+		Fast_Writer writer(&buffer[len], 255 - len, {'.', 2});
+		writer.Add('\t').Add({data.energy_day_conso, data.energy_day_surplus, data.get_energy_day_prod()}, "\t",
+				false).EndLine();
 
 		temp.print(buffer);
 		temp.close();
 	}
 	Lock_File = false;
 
-	// Restart energy
+	// Restart energy, Current_Data et le Cirrus appartiennent à la task Cirrus
 	if (restart)
-	{
-		Current_Data.energy_day_conso = 0.0;
-		Current_Data.energy_day_surplus = 0.0;
-//  	*Current_Data.energy_day_prod = 0.0;
-		Current_Data.Talema_Energy = 0.0;
-		CS5480.RestartEnergy();
-		CS5484.RestartEnergy();
+		Energy_Restart_Request = true;
+}
+
+/**
+ * Remise à zéro des énergies du jour, task Cirrus seulement (Get_Data())
+ */
+void Restart_Energy(void)
+{
+	Current_Data.energy_day_conso = 0.0;
+	Current_Data.energy_day_surplus = 0.0;
+//  *Current_Data.energy_day_prod = 0.0;
+	Current_Data.Talema_Energy = 0.0;
+	CS5480.RestartEnergy();
+	CS5484.RestartEnergy();
 #ifdef USE_TI
-		if (TI_OK)
-			Current_Data.TI_Counter = TI.getIndexWh();
+	if (TI_OK)
+		Current_Data.TI_Counter = TI.getIndexWh();
 #endif
-	}
 }
 
 void onDaychange(uint8_t year, uint8_t month, uint8_t day)
@@ -626,17 +633,34 @@ void onDaychange(uint8_t year, uint8_t month, uint8_t day)
 	append_energy(year, true);
 
 	// On archive le fichier data du jour en lui donnant le nom du jour
-	if (Data_Partition->exists(CSV_Filename))
+	// Le fichier est converti en CSV pour garder le même format d'archive
+	if (Data_Partition->exists(Data_TS.getFilename()))
 	{
 		while (Lock_File)
 			;
 		char buffer[20] = {0};
 		sprintf(buffer, "/%02d-%02d-%02d.csv", year, month, day);
 		String Day_Name = String(buffer);
-		Data_Partition->rename(CSV_Filename, Day_Name);
-		GZFile(Day_Name, true, true);
-		Day_Name += ".gz";
-		AddFileToListFile(listFile, Day_Name);
+		Lock_File = true;
+		if (Data_TS.ExportToCSV(Day_Name))
+		{
+			Data_Partition->remove(Data_TS.getFilename());
+			Lock_File = false;
+			GZFile(Day_Name, true, true);
+			Day_Name += ".gz";
+			AddFileToListFile(listFile, Day_Name);
+		}
+		else
+		{
+			// Export impossible (partition pleine, ...) : on garde le fichier binaire du jour
+			// sous le nom du jour pour ne pas perdre les données
+			print_debug("Export error: " + Day_Name);
+			Data_Partition->remove(Day_Name);
+			Day_Name.replace(".csv", ".tsb");
+			if (Data_Partition->rename(Data_TS.getFilename(), Day_Name))
+				AddFileToListFile(listFile, Day_Name);
+			Lock_File = false;
+		}
 	}
 }
 
@@ -663,12 +687,44 @@ void AddFileToListFile(StringList_td &list, const String &file)
 
 /**
  * List all fles in data partition with filter extension
- * Exclude data.csv and energy files
+ * Exclude data.csv, data.tsb and energy files
+ * The list is sorted by name (/yy-mm-dd), the oldest file first for the rotation
  */
-void FillListFile(const String &filter)
+void FillListFile(const StringList_td &filter)
 {
 	const StringList_td skip = {"data", "energy"};
-	FillListFile(true, "/", listFile, {filter}, skip);
+	FillListFile(true, "/", listFile, filter, skip);
+	listFile.sort();
+}
+
+/**
+ * Nouvel essai d'export des fichiers du jour restés en binaire (/yy-mm-dd.tsb)
+ * après un échec au changement de jour (partition pleine, ...)
+ * A appeler au démarrage après FillListFile(), le fichier compressé remplace le binaire dans la liste
+ */
+void Retry_Export_Day_Files(void)
+{
+	for (auto &l : listFile)
+	{
+		if (!l.endsWith(".tsb"))
+			continue;
+
+		String Day_Name = l;
+		Day_Name.replace(".tsb", ".csv");
+		TimeSeries Day_TS(l, DATA_TS_COLUMNS);
+		if (Day_TS.ExportToCSV(Day_Name))
+		{
+			Data_Partition->remove(l);
+			GZFile(Day_Name, true, true);
+			l = Day_Name + ".gz";
+			print_debug("Export retry: " + l);
+		}
+		else
+		{
+			print_debug("Export error: " + Day_Name);
+			Data_Partition->remove(Day_Name);
+		}
+	}
 }
 
 void PrintListFile(void)
@@ -677,7 +733,7 @@ void PrintListFile(void)
 }
 
 /**
- * Zip all the files in ListFile
+ * Zip all the CSV files in ListFile
  * @param: remove. if true, delete file after zip
  */
 void GZListFile(bool remove)
@@ -685,7 +741,9 @@ void GZListFile(bool remove)
 	int time = millis();
 	for (auto const &l : listFile)
 	{
-		GZFile(l, true, remove);
+		// Seulement les CSV, pas les fichiers binaires (.tsb) ni ceux déjà compressés
+		if (l.endsWith(".csv"))
+			GZFile(l, true, remove);
 	}
   print_debug("Compress time: " + (String)(millis() - time));
 }
@@ -7,6 +7,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "CIRRUS.h"
+#include "Snapshot.h"
+#include "Partition_utils.h"	// StringList_td
 
 /**
  * Uniquement pour le Cirrus CS5480 : 2 channel
@@ -59,8 +61,6 @@ typedef struct
 		float energy_day_conso = 0.0;
 		float energy_day_surplus = 0.0;
 
-		// Un raccourci sur la production
-		float *energy_day_prod = &Production.Energy;
 		// Extra data sur le CS5480
 		float Cirrus2_PF;
 		float Cirrus2_Freq;
@@ -82,11 +82,18 @@ typedef struct
 		uint32_t TI_Power = 0;
 
 		// Somme des puissances des 3 phases pour avoir le surplus
-		float get_total_power(void)
+		float get_total_power(void) const
 		{
 			return Phase1.ActivePower + Phase2.ActivePower + Phase3.ActivePower;
 		}
 
+		// Un raccourci sur l'énergie de la production
+		// (pas de pointeur dans la structure car elle est copiée dans le snapshot)
+		float get_energy_day_prod(void) const
+		{
+			return Production.Energy;
+		}
+
 } Data_Struct;
 
 typedef struct {
@@ -94,8 +101,15 @@ typedef struct {
 } Talema_Params_Typedef;
 
 // To access cirrus data
+// Current_Data is the working copy of Get_Data (CIRRUS task only)
+// The other tasks must read the snapshots published once per cycle by Get_Data
 extern Data_Struct Current_Data;
-extern volatile Graphe_Data log_cumul;
+extern Snapshot<Data_Struct> Data_Snapshot;
+extern Snapshot<Graphe_Data> Log_Snapshot;
+
+// Les données du jour (data.tsb)
+class TimeSeries;
+extern TimeSeries Data_TS;
 
 // Task to save log every 10 s
 #define LOG_DATA_TASK	{condCreate, "LOG_DATA_Task", 4096, 3, 10000, Core1, Log_Data_Task_code}
@@ -107,12 +121,13 @@ void SetTalemaParams(Phase_ID phase);
 
 void Get_Data(void);
 uint8_t Update_IHM(const char *first_text, const char *last_text, bool display = true);
-bool Get_Last_Data(float *Energy, float *Surplus, float *Prod);
+bool Get_Last_Data(float *Energy, float *Surplus, float *Prod, uint32_t *log_seen);
 
 void reboot_energy(void);
 void onDaychange(uint8_t year, uint8_t month, uint8_t day);
 
-void FillListFile(const String &filter = ".csv");
+void FillListFile(const StringList_td &filter = {".csv"});
+void Retry_Export_Day_Files(void);
 void PrintListFile(void);
 void GZListFile(bool remove);
 
@@ -13,6 +13,10 @@
 #include "display.h"				  	// Display functions
 #include "CIRRUS.h"
 #include "Get_Data.h"
+#include "TimeSeries.h"
+#ifdef USE_SERVER_PUSH
+#include "Server_Push.h"
+#endif
 #ifdef USE_DS
 #include "DS18B20.h"
 #endif
@@ -302,7 +306,7 @@ void ESPNOW_Task_code(void *parameter)
 	{
 //		if (xSemaphoreTake(ESPNowSemaphore, 0) == pdTRUE)
 		{
-			ESPNow_Data.power = Current_Data.get_total_power();
+			ESPNow_Data.power = Data_Snapshot.Get().get_total_power();
 			if (!routeur_master->send_message((uint8_t *) &ESPNow_Data, sizeof(ESPNow_Data)))
 			{
 				print_debug("ESP Now send error");
@@ -316,6 +320,23 @@ void ESPNOW_Task_code(void *parameter)
 #define ESPNOW_DATA_TASK {condCreate, "ESPNOW_Task", 4096, 3, 100, CoreAny, ESPNOW_Task_code}
 #endif
 
+// ********************************************************************************
+// Prévision de production de l'année
+// ********************************************************************************
+
+// Calcule 2 jours par seconde jusqu'à ce que la prévision soit prête (ou lue dans le cache)
+// Relance le calcul au changement d'année ou des paramètres du site
+void FORECAST_Task_code(void *parameter)
+{
+	BEGIN_TASK_CODE("FORECAST_Task");
+	for (EVER)
+	{
+		emul_PV.Forecast_Update(2);
+		END_TASK_CODE(false);
+	}
+}
+#define FORECAST_DATA_TASK {condCreate, "FORECAST_Task", 4096, 2, 1000, CoreAny, FORECAST_Task_code}
+
 // ********************************************************************************
 // Définition PCF8574
 // ********************************************************************************
@@ -343,9 +364,15 @@ bool UserAnalyseMessage(void);
 void handleInitialization(CB_SERVER_PARAM);
 void handleInitPVData(CB_SERVER_PARAM);
 void handleLastData(CB_SERVER_PARAM);
+void Push_Last_Data(void);
+
+// Taille de la trame des données instantanées avec la ligne du graphe (pire cas 365 caractères)
+#define LAST_DATA_SIZE	512
 void handleOperation(CB_SERVER_PARAM);
 void handleCirrus(CB_SERVER_PARAM);
 void handleFillTheoric(CB_SERVER_PARAM);
+void handleForecast(CB_SERVER_PARAM);
+void handleGetCSV(CB_SERVER_PARAM);
 void onNewDaychange(uint8_t year, uint8_t month, uint8_t day)
 {
 	// Mise à jour des données pour le nouveau jour
@@ -361,6 +388,42 @@ void onDumpComputed(float power)
 	SSR_Set_Action(lastSSRAction, lastSSRState);
 }
 
+#ifdef USE_ZC_SSR
+// The PID parameters found by the auto-tune, saved later by the loop
+// The copy is protected by AutoTune_Mux : written by the Cirrus task, read by the loop
+static portMUX_TYPE AutoTune_Mux = portMUX_INITIALIZER_UNLOCKED;
+static SSR_PID_Params AutoTune_Params;
+static bool AutoTune_ToSave = false;
+
+// Called from the Cirrus task : no file access here
+void SSR_onAutoTuneDone(const SSR_PID_Params &params)
+{
+	portENTER_CRITICAL(&AutoTune_Mux);
+	AutoTune_Params = params;
+	AutoTune_ToSave = true;
+	portEXIT_CRITICAL(&AutoTune_Mux);
+}
+
+// Save the PID parameters found by the auto-tune in the ini file
+// Called from the loop, the ini file is locked against the web server
+void SSR_Save_AutoTune(void)
+{
+	SSR_PID_Params params;
+	bool tosave;
+
+	portENTER_CRITICAL(&AutoTune_Mux);
+	params = AutoTune_Params;
+	tosave = AutoTune_ToSave;
+	AutoTune_ToSave = false;
+	portEXIT_CRITICAL(&AutoTune_Mux);
+
+	if (!tosave)
+		return;
+	init_routeur.WriteFloat("SSR", "Kp", params.Kp);
+	init_routeur.WriteFloat("SSR", "Ki", params.Ki);
+}
+#endif
+
 // ********************************************************************************
 // Initialization
 // ********************************************************************************
@@ -423,13 +486,15 @@ void setup()
 	// Gestion des fichiers data
 	print_debug(F("Free Data space : "), false);
 	print_debug((int) Partition_FreeSpace(true));
-	FillListFile(".gz"); //
+	// Les fichiers du jour restés en binaire (.tsb) sont dans la rotation et exportés à nouveau
+	FillListFile({".gz", ".tsb"});
+	Retry_Export_Day_Files();
 
 //	PrintListFile();
 //	GZListFile(true);
 //	print_debug(F("Free Data space : "), false);
 //	print_debug((int)Partition_FreeSpace(true));
-//	FillListFile(".gz");
+//	FillListFile({".gz"});
 //	PrintListFile();
 
 	// Initialisation fichier ini
@@ -465,7 +530,7 @@ void setup()
 #ifdef USE_TI
 	IHM_Print0("Test TI");
 
-	if (TI.Configure(10000))
+	if (TI.Configure(TI_CONFIGURE_MS))
 	{
 		print_debug(F("Configuration TeleInfo OK"));
 		TI.PrintAllToSerial();
@@ -503,6 +568,11 @@ void setup()
 	// Initialisation CS5484 : phase 1, phase 3
 	if (Cirrus_OK)
 		Cirrus_OK = CIRRUS_Generic_Initialization(CS5484, &CS1_Calib, &CS1_Config, false, false, '1');
+#ifdef CIRRUS_INT1_GPIO
+	// Attente des données sur la pin INT, le polling reste en secours
+	if (Cirrus_OK)
+		CS5484.DataReady_Initialize(CIRRUS_INT1_GPIO);
+#endif
 
 	// Configure second Cirrus : CS5480
 	CS_Com.SelectCirrus(1);
@@ -514,6 +584,9 @@ void setup()
 		if (Cirrus_OK)
 		{
 			CS5480.GetRMSData(Channel_1)->SetWantData(exd_PF | exd_PApparent);
+#ifdef CIRRUS_INT2_GPIO
+			CS5480.DataReady_Initialize(CIRRUS_INT2_GPIO);
+#endif
 		}
 	}
 
@@ -543,6 +616,16 @@ void setup()
 	SSR_Set_Target(init_routeur.ReadFloat("SSR", "Target", 0)); // Par défaut 0, voir page web
 	SSR_Set_Percent(init_routeur.ReadFloat("SSR", "Pourcent", 10)); // Par défaut à 10%, voir page web
 
+	// Paramètres du régulateur du mode zéro
+	SSR_PID_Params pid;
+	pid.Kp = init_routeur.ReadFloat("SSR", "Kp", pid.Kp);
+	pid.Ki = init_routeur.ReadFloat("SSR", "Ki", pid.Ki);
+	pid.Kff = init_routeur.ReadFloat("SSR", "Kff", pid.Kff);
+	pid.Band = init_routeur.ReadFloat("SSR", "Band", pid.Band);
+	SSR_Set_PID_Params(pid);
+	// Fenêtre du mode burst en demi-périodes
+	SSR_Set_Burst_Window(init_routeur.ReadInteger("SSR", "Burst_Window", SSR_BURST_WINDOW));
+
 	Set_PhaseCE((Phase_ID) init_routeur.ReadInteger("SSR", "Phase_CE", 1));
 
 	//	SSR_Compute_Dump_power();
@@ -656,6 +739,7 @@ void setup()
 //	ESPNOW_Task: 3068 / 4096
 	TaskList.AddTask(RTC_DATA_TASK); // RTC Task
 	TaskList.AddTask(UART_DATA_TASK); // UART Task
+	TaskList.AddTask(LOG_DEBUG_TASK); // Debug log Task
 #ifdef USE_KEEPALIVE_TASK
 	if (!myServer.ISSoftAP() && myServer.IsConnected())
 	  TaskList.AddTask(KEEP_ALIVE_DATA_TASK); // Keep alive Wifi Task
@@ -699,6 +783,7 @@ void setup()
 	if (routeur_master && myServer.IsConnected())
 		TaskList.AddTask(ESPNOW_DATA_TASK); // ESPNOW get data Task
 #endif
+	TaskList.AddTask(FORECAST_DATA_TASK); // Prévision de production
 
 	// Create all the tasks
 	TaskList.Create(USE_IDLE_TASK);
@@ -722,12 +807,15 @@ void loop()
 	// Listen for HTTP requests from clients
 #ifndef USE_ASYNC_WEBSERVER
 	server.handleClient();
-	vTaskDelay(10);
-#else
-	// Temporisation à adapter
-//
-	vTaskDelete(NULL);
 #endif
+	// La loop est gardée avec le serveur asynchrone pour les envois du push et les écritures différées
+#ifdef USE_SERVER_PUSH
+	Server_Push_Loop();
+#endif
+#ifdef USE_ZC_SSR
+	SSR_Save_AutoTune();
+#endif
+	vTaskDelay(10);
 }
 
 // ********************************************************************************
@@ -742,7 +830,7 @@ void loop()
 void OnAfterConnexion(void)
 {
 	// Server default events
-	Server_CommonEvent(default_Events | Ev_ListFile | Ev_ResetESP | Ev_SetTime | Ev_GetTime);
+	Server_CommonEvent(default_Events | Ev_ListFile | Ev_ResetESP | Ev_SetTime | Ev_GetTime | Ev_CacheInfo);
 
 	// Server specific events (voir le javascript)
 	server.on("/getUARTData", HTTP_GET, [](CB_SERVER_PARAM)
@@ -762,6 +850,14 @@ void OnAfterConnexion(void)
 	server.on("/getCirrus", HTTP_PUT, handleCirrus);
 
 	server.on("/getTheoric", HTTP_POST, handleFillTheoric);
+	server.on("/getForecast", HTTP_GET, handleForecast);
+
+	server.on("/getCSV", HTTP_GET, handleGetCSV);
+
+#ifdef USE_SERVER_PUSH
+	// Les données instantanées sont envoyées aux clients connectés (/events ou /ws)
+	Server_Push_Begin();
+#endif
 }
 
 // ********************************************************************************
@@ -819,7 +915,10 @@ void handleInitialization(CB_SERVER_PARAM)
 		if (SSR_Get_Action() == SSR_Action_Surplus)
 			message = "2#";
 		else
-			message = "3#";
+			if (SSR_Get_Action() == SSR_Action_Burst)
+				message = "4#";
+			else
+				message = "3#";
 	message += (String) SSR_Get_Dump_Power() + '#';
 	message += (String) Get_PhaseCE() + '#';
 	message += (String) SSR_Get_Target() + '#';
@@ -878,95 +977,218 @@ void handleInitPVData(CB_SERVER_PARAM)
 
 /**
  * Inst data
- * Time#Ph1_data#Ph2_data#Ph3_data#Prod_data#Temp_data#SSR_state#Log_data
+ * Time#Ph1_data#Ph2_data#Ph3_data#Prod_data#Temp_data#SSR_state#Relay_state[#LOG=n#Log_data]
+ * La ligne du graphe (Log_data) est précédée de son numéro n (Log_Snapshot.GetCount()), elle est
+ * ajoutée si log_seen (le dernier numéro vu par le client) est différent, ou toujours si log_seen est NULL.
+ * Le buffer doit faire au moins LAST_DATA_SIZE caractères
+ * Renvoie false si le buffer est trop petit
  */
-void handleLastData(CB_SERVER_PARAM)
+bool Fill_Last_Data(char *buffer, uint16_t size, uint32_t *log_seen)
 {
-	char buffer[255] = {0};
-	char *pbuffer = &buffer[0];
-	uint16_t len = 0;
 	float Energy, Surplus, Prod;
-	bool graphe = Get_Last_Data(&Energy, &Surplus, &Prod);
-
-	strcpy(buffer, RTC_Local.the_time()); // Copie la date
-	pbuffer = Fast_Pos_Buffer(buffer, "#", Buffer_End, &len); // On se positionne en fin de chaine
-	pbuffer = Fast_Printf(pbuffer, 2, "#", Buffer_End, true,
-			{Current_Data.Phase1.Voltage, Current_Data.Phase1.ActivePower, Current_Data.Phase1.Energy,
-					Current_Data.Phase2.Voltage, Current_Data.Phase2.ActivePower, Current_Data.Phase2.Energy,
-					Current_Data.Phase3.Voltage, Current_Data.Phase3.ActivePower, Current_Data.Phase3.Energy,
-					Current_Data.Production.ActivePower, Current_Data.Prod_Th, Current_Data.Production.Energy,
-					Current_Data.get_total_power(), Energy, Surplus});
+	uint32_t log_count = 0;
+	bool graphe = Get_Last_Data(&Energy, &Surplus, &Prod, (log_seen != NULL) ? log_seen : &log_count);
+	if (log_seen == NULL)
+		graphe = (log_count != 0);
+	Data_Struct data = Data_Snapshot.Get();
+	Fast_Writer writer(buffer, size, {',', 2});
+
+	writer.Add(RTC_Local.the_time()).Add('#'); // Copie la date
+	writer.Add({data.Phase1.Voltage, data.Phase1.ActivePower, data.Phase1.Energy,
+			data.Phase2.Voltage, data.Phase2.ActivePower, data.Phase2.Energy,
+			data.Phase3.Voltage, data.Phase3.ActivePower, data.Phase3.Energy,
+			data.Production.ActivePower, data.Prod_Th, data.Production.Energy,
+			data.get_total_power(), Energy, Surplus}, "#", true);
 
 	// TI, Talema
-	pbuffer = Fast_Printf(pbuffer, Current_Data.TI_Energy, 0, "", "#", Buffer_End, &len);
-	pbuffer = Fast_Printf(pbuffer, Current_Data.TI_Power, 0, "", "#", Buffer_End, &len);
-	pbuffer = Fast_Printf(pbuffer, Current_Data.Talema_Power, 2, "", "#", Buffer_End, &len);
+	writer.Add(data.TI_Energy, 0).Add('#').Add(data.TI_Power, 0).Add('#');
+	writer.Add(data.Talema_Power).Add('#');
 
 	// Temperatures
-	pbuffer = Fast_Printf(pbuffer, 2, "#", Buffer_End, true,
-			{Current_Data.Cirrus2_Temp, Current_Data.DS18B20_Int, Current_Data.DS18B20_Ext});
+	writer.Add({data.Cirrus2_Temp, data.DS18B20_Int, data.DS18B20_Ext}, "#", true);
 
 	// Etat du SSR
-	pbuffer = Fast_Printf(pbuffer, (int) SSR_Get_State(), 0, "SSR=", "#", Buffer_End, &len);
+	writer.Add("SSR=").AddInt((int) SSR_Get_State()).Add('#');
 
 	// Etat des relais
 #ifdef USE_RELAY
-	pbuffer = Fast_Pos_Buffer(buffer, Relay.getAllState().c_str(), Buffer_End, &len);
+	writer.Add(Relay.getAllState().c_str());
 #else
-	pbuffer = Fast_Pos_Buffer(buffer, "OFF,OFF,OFF,OFF", Buffer_End, &len);
+	writer.Add("OFF,OFF,OFF,OFF");
 #endif
 
 	// On a de nouvelles données pour le graphe
 	if (graphe)
 	{
-		Fast_Set_Decimal_Separator('.');
-		pbuffer = Fast_Pos_Buffer(pbuffer, "#", Buffer_End, &len); // On se positionne en fin de chaine
-		pbuffer = Fast_Printf(pbuffer, 2, "#", Buffer_End, false, {log_cumul.Voltage_ph1, log_cumul.Power_ph1,
-				log_cumul.Voltage_ph2, log_cumul.Power_ph2, log_cumul.Voltage_ph3, log_cumul.Power_ph3,
-				log_cumul.Power_prod, log_cumul.Temp, Current_Data.DS18B20_Int, Current_Data.DS18B20_Ext, Energy, Surplus, Prod});
-		Fast_Set_Decimal_Separator(',');
+		Graphe_Data log = Log_Snapshot.Get();
+		writer.format.decimal = '.';
+		writer.Add("#LOG=").AddInt((log_seen != NULL) ? *log_seen : log_count);
+		writer.Add('#').Add({log.Voltage_ph1, log.Power_ph1,
+				log.Voltage_ph2, log.Power_ph2, log.Voltage_ph3, log.Power_ph3,
+				log.Power_prod, log.Temp, data.DS18B20_Int, data.DS18B20_Ext, Energy, Surplus, Prod}, "#", false);
 	}
 
 //	print_debug(buffer);
+	return !writer.overflow();
+}
+
+/**
+ * Argument LOG : le numéro de la dernière ligne du graphe reçue par la page.
+ * Sans cet argument (ancienne page), un numéro commun à tous les clients.
+ */
+void handleLastData(CB_SERVER_PARAM)
+{
+	static uint32_t poll_log_seen = 0;
+	char buffer[LAST_DATA_SIZE] = {0};
+	uint32_t log_seen;
+	bool ok;
+
+	if (pserver->hasArg("LOG"))
+	{
+		log_seen = strtoul(pserver->arg("LOG").c_str(), NULL, 10);
+		ok = Fill_Last_Data(buffer, LAST_DATA_SIZE, &log_seen);
+	}
+	else
+		ok = Fill_Last_Data(buffer, LAST_DATA_SIZE, &poll_log_seen);
 
+	// Pas de trame tronquée : la page ignorerait des champs ou les décalerait
+	if (!ok)
+	{
+		print_debug(F("Last data: buffer overflow"));
+		pserver->send(500, "text/plain", "Last data: buffer overflow");
+		return;
+	}
 	pserver->send(200, "text/plain", buffer);
 }
 
+/**
+ * Envoie des données instantanées aux clients abonnés (appelé à chaque cycle d'acquisition)
+ * La trame est la même que celle de /getLastData mais contient toujours la dernière ligne
+ * du graphe : une trame perdue par un client lent ne lui fait pas perdre la ligne,
+ * la page ne l'ajoute que si son numéro LOG est nouveau.
+ */
+void Push_Last_Data(void)
+{
+#ifdef USE_SERVER_PUSH
+	char buffer[LAST_DATA_SIZE] = {0};
+	if (Fill_Last_Data(buffer, LAST_DATA_SIZE, NULL))
+		Server_Push_Publish(buffer, strlen(buffer));
+	else
+		print_debug(F("Push data: buffer overflow"));
+#endif
+}
+
+/**
+ * Export des données du jour (data.tsb) en CSV (même format que l'ancien data.csv) ou en JSON
+ * Arguments optionnels : FROM, TO (UNIX time), JSON
+ * L'export est envoyé par blocs sans charger le fichier en mémoire.
+ * Seuls les enregistrements présents au début de l'export sont envoyés, on ne bloque donc
+ * pas l'ajout de nouvelles données pendant le transfert.
+ */
+void handleGetCSV(CB_SERVER_PARAM)
+{
+	uint32_t from = (pserver->hasArg("FROM")) ? pserver->arg("FROM").toInt() : 0;
+	uint32_t to = (pserver->hasArg("TO")) ? pserver->arg("TO").toInt() : 0xFFFFFFFF;
+	bool json = pserver->hasArg("JSON");
+
+	std::shared_ptr<TS_Export> exp = std::make_shared<TS_Export>();
+	if (!Data_TS.BeginExport(*exp, from, to, json))
+		return pserver->send(404, "text/plain", "404: Not found for " + Data_TS.getFilename());
+
+	auto fill = [exp](char *buffer, size_t size) -> size_t
+	{
+		size_t len = Data_TS.Export(*exp, buffer, size);
+		// Export() return 0 if the buffer is too small for a line
+		if ((len == 0) && (exp->step != 3))
+			return STREAM_TRY_AGAIN;
+		return len;
+	};
+#ifdef USE_ASYNC_WEBSERVER
+	SendStream(pserver, (json) ? "application/json" : "text/plain", fill);
+#else
+	SendStream((json) ? "application/json" : "text/plain", fill);
+#endif
+}
+
+/**
+ * La courbe de puissance théorique du jour de minuit à DATA_DATE (en minute) sur DATA_NB points
+ * Les valeurs sont séparées par une tabulation. Elles sont calculées au fil de l'envoi.
+ */
 void handleFillTheoric(CB_SERVER_PARAM)
 {
 	// Default
 	RETURN_BAD_ARGUMENT();
 
-	int nb = pserver->arg("DATA_NB").toInt();
-	int last_date = pserver->arg("DATA_DATE").toInt();
-
-//	print_debug("DATA_NB: " + pserver->arg("DATA_NB") + ",  last_date=" + pserver->arg("DATA_DATE"));
+	typedef struct
+	{
+			uint32_t nb;
+			uint32_t last_date;
+			uint32_t index;
+	} Theoric_State;
 
-	int *data = NULL;
-	data = (int*) malloc((nb) * sizeof(int));
+	std::shared_ptr<Theoric_State> state = std::make_shared<Theoric_State>();
+	state->nb = pserver->arg("DATA_NB").toInt();
+	state->last_date = pserver->arg("DATA_DATE").toInt();
+	state->index = 0;
 
-	emul_PV.Fill_Power_Day(last_date, nb, data);
+//	print_debug("DATA_NB: " + pserver->arg("DATA_NB") + ",  last_date=" + pserver->arg("DATA_DATE"));
 
-//	char buffer[5000] = {0};
-//	char *pbuffer = &buffer[0];
-//	uint16_t len = 0;
-//	for (int i = 0; i < nb; i++)
-//	{
-//	  pbuffer = Fast_Printf(pbuffer, data[i], 0, "", "\t", Buffer_End, &len);
-//	  if (len + 5 > 5000)
-//	  	break;
-//	}
-//	buffer[len-1] = 0;
+	auto fill = [state](char *buffer, size_t size) -> size_t
+	{
+		const size_t MAX_VALUE = 12; // Tab + int
+		size_t len = 0;
+		while ((state->index < state->nb) && (len + MAX_VALUE < size))
+		{
+			uint32_t step = (state->last_date * state->index) / state->nb;
+			int power = (int) emul_PV.Compute_Power_TH(step * 60);
+			len += sprintf(&buffer[len], (state->index == 0) ? "%d" : "\t%d", power);
+			state->index++;
+		}
+		if ((len == 0) && (state->index < state->nb))
+			return STREAM_TRY_AGAIN;
+		return len;
+	};
+#ifdef USE_ASYNC_WEBSERVER
+	SendStream(pserver, "text/plain", fill);
+#else
+	SendStream("text/plain", fill);
+#endif
+}
 
-	String message = (String) data[0];
-	for (int i = 1; i < nb; i++)
+/**
+ * La prévision de production de l'année, une ligne par jour :
+ * jour de l'année, énergie (Wh), lever et coucher du Soleil (minute, heure locale du jour :
+ * heure d'été du dernier dimanche de mars au dernier dimanche d'octobre)
+ */
+void handleForecast(CB_SERVER_PARAM)
+{
+	if (!emul_PV.Forecast_Ready())
 	{
-		message += "\t" + (String) data[i];
+		pserver->send(503, "text/plain", "Forecast not ready");
+		return;
 	}
 
-	free(data);
+	std::shared_ptr<uint16_t> day = std::make_shared<uint16_t>(1);
 
-	pserver->send(200, "text/plain", message);
+	auto fill = [day](char *buffer, size_t size) -> size_t
+	{
+		const size_t MAX_LINE = 32;
+		size_t len = 0;
+		while ((*day <= emul_PV.Forecast_Count()) && (len + MAX_LINE < size))
+		{
+			len += sprintf(&buffer[len], "%d\t%d\t%d\t%d\r\n", *day, (int) emul_PV.getDayEnergy(*day),
+					emul_PV.getDaySunRise_int(*day, true), emul_PV.getDaySunSet_int(*day, true));
+			(*day)++;
+		}
+		if ((len == 0) && (*day <= emul_PV.Forecast_Count()))
+			return STREAM_TRY_AGAIN;
+		return len;
+	};
+#ifdef USE_ASYNC_WEBSERVER
+	SendStream(pserver, "text/plain", fill);
+#else
+	SendStream("text/plain", fill);
+#endif
 }
 
 void handleOperation(CB_SERVER_PARAM)
@@ -1041,7 +1263,7 @@ void handleOperation(CB_SERVER_PARAM)
 	}
 
 #ifdef USE_ZC_SSR
-	// Change le mode d'action Pourcent/Zéro
+	// Change le mode d'action Pourcent/Zéro/Burst
 	// Ne pas oublier de redémarrer le SSR après
 	if (pserver->hasArg("SSRAction"))
 	{
@@ -1051,9 +1273,12 @@ void handleOperation(CB_SERVER_PARAM)
 			if (pserver->arg("SSRAction") == "zero")
 				SSR_Set_Action(SSR_Action_Surplus);
 			else
-				SSR_Set_Action(SSR_Action_FULL);
+				if (pserver->arg("SSRAction") == "burst")
+					SSR_Set_Action(SSR_Action_Burst);
+				else
+					SSR_Set_Action(SSR_Action_FULL);
 
-		init_routeur.WriteInteger("SSR", "Action", SSR_Get_Action(), "Full=1, Percent=2, Zero=3");
+		init_routeur.WriteInteger("SSR", "Action", SSR_Get_Action(), "Full=1, Percent=2, Zero=3, Burst=5");
 	}
 
 	// La puissance du CE pour le mode zéro
@@ -1069,6 +1294,32 @@ void handleOperation(CB_SERVER_PARAM)
 		init_routeur.WriteFloat("SSR", "Target", target);
 	}
 
+	// Les paramètres du régulateur du mode zéro, chacun peut être envoyé seul
+	if (pserver->hasArg("PID_Kp") || pserver->hasArg("PID_Ki") || pserver->hasArg("PID_Kff")
+			|| pserver->hasArg("PID_Band"))
+	{
+		SSR_PID_Params pid = SSR_Get_PID_Params();
+		if (pserver->hasArg("PID_Kp"))
+			pid.Kp = pserver->arg("PID_Kp").toFloat();
+		if (pserver->hasArg("PID_Ki"))
+			pid.Ki = pserver->arg("PID_Ki").toFloat();
+		if (pserver->hasArg("PID_Kff"))
+			pid.Kff = pserver->arg("PID_Kff").toFloat();
+		if (pserver->hasArg("PID_Band"))
+			pid.Band = pserver->arg("PID_Band").toFloat();
+		SSR_Set_PID_Params(pid);
+		init_routeur.WriteFloat("SSR", "Kp", pid.Kp);
+		init_routeur.WriteFloat("SSR", "Ki", pid.Ki);
+		init_routeur.WriteFloat("SSR", "Kff", pid.Kff);
+		init_routeur.WriteFloat("SSR", "Band", pid.Band);
+	}
+
+	// Auto-tune du régulateur, le SSR doit être en mode zéro et actif
+	if (pserver->hasArg("PID_AutoTune"))
+	{
+		SSR_Start_AutoTune();
+	}
+
 	// La phase du CE
 	if (pserver->hasArg("CEPhase"))
 	{
@@ -59,6 +59,12 @@
 //#define USE_MDNS
 
 #define USE_ASYNC_WEBSERVER
+
+// Push of the live data : SSE on /events (sync server) or WebSocket on /ws (async server)
+#define USE_SERVER_PUSH
+
+// Cache of the web pages in RAM with ETag (304 Not Modified), see /getCacheInfo
+#define USE_ASSET_CACHE
 // Necessary for HTTPUPDATER with LITTLEFS in async server
 // MUST BE PUT IN DEFINE OF THE PROJECT
 //#define ESPASYNCHTTPUPDATESERVER_LITTLEFS
@@ -136,6 +142,10 @@
 #define CIRRUS_TX_GPIO	GPIO_NUM_17  // UART2
 #define CIRRUS_CS1_GPIO	GPIO_NUM_18
 #define CIRRUS_CS2_GPIO	GPIO_NUM_19
+// Pin INT des Cirrus (DRDY) si elles sont câblées : attente des données sur interruption.
+// Sinon, le registre Status0 est lu en boucle (polling)
+//#define CIRRUS_INT1_GPIO	GPIO_NUM_25
+//#define CIRRUS_INT2_GPIO	GPIO_NUM_26
 
 #define CIRRUS_USE_UART // If not defined then SPI is used
 #ifdef CIRRUS_USE_UART
@@ -169,6 +179,7 @@
 #define RUN_TASK_MEMORY	false // true or false. To check the memory used by tasks
 
 #define UART_USE_TASK        // A basic task to analyse UART message
+//#define LOG_DEBUG_USE_TASK   // The debug log file is written by a task (with LOG_DEBUG)
 #define RTC_USE_TASK         // To run RTCLocal in a task
 #define KEEP_ALIVE_USE_TASK  // A basic task to keep alive the Wifi connexion
 #define DS18B20_USE_TASK     // A basic task to check DS18B20 temperature every 2 s